@@ -0,0 +1,168 @@
+/*------------------------------------------------------------------------------
+
+  AcquisitionMetrics.h
+
+  Instrumentação do caminho crítico da aquisição: duração de cada etapa em
+  histogramas com faixas logarítmicas (potências de 2), lidos sem bloqueio
+  pelo endpoint /metrics.
+
+  Etapas
+  ------------------------------------------------------------------------------
+  METRICS_COMMAND:     escrita do comando de aquisição (registro 0x00).
+  METRICS_BUSY_POLL:   sinalizador de ocupado: cada consulta de poll() ou a
+                       espera inteira de read() com monitorBusyFlag.
+  METRICS_RESULT_READ: leitura do resultado (0x8f, ou 0x8e com a qualidade).
+  METRICS_FILTER:      cadeia de filtros (FilterBank::process).
+  METRICS_DAC:         entrega da distância à saída analógica
+                       (AnalogOutput::submit; o DAC é escrito pelo temporizador).
+  METRICS_PUBLISH:     publicação da amostra (seqlock e anel de amostras).
+  METRICS_SAMPLE_INTERVAL: intervalo entre amostras publicadas (jitter do laço).
+  METRICS_OUTPUT_INTERVAL: intervalo entre atualizações da saída analógica
+                       (jitter do temporizador, AnalogOutput.h).
+  METRICS_WAKE_LATENCY: da interrupção do temporizador de amostragem ao
+                       despertar da tarefa de aquisição (SamplingScheduler.h).
+  METRICS_MOTION:      estimativa de movimento e previsão do limite de zona
+                       (MotionEstimator::update).
+
+  A duração é medida em ticks de metricsNow(): ciclos da CPU no ESP32 e o
+  relógio virtual (µs) no ambiente nativo. A faixa b conta durações menores
+  que 2^(b + METRICS_FIRST_BUCKET_SHIFT) ticks; a última conta o restante. O
+  total de amostras é a soma das faixas, para que a faixa +Inf do /metrics
+  sempre coincida com _count.
+
+  Cada histograma tem um único escritor (a tarefa de aquisição ou, em
+  METRICS_OUTPUT_INTERVAL, o temporizador da saída analógica): os contadores
+  são atômicos apenas para que os leitores não vejam valores rasgados, e o
+  escritor usa load/store relaxados, sem operações read-modify-write. A soma
+  fica em µs (32 bits) e volta a zero após ~71 min acumulados na etapa, o que
+  o Prometheus trata como reinício do contador.
+
+  Com -D LIDAR_METRICS=0 StageTimer e metricsRecord() ficam vazios e a
+  instrumentação some do binário; /metrics continua com os demais valores.
+
+------------------------------------------------------------------------------*/
+#ifndef AcquisitionMetrics_h
+#define AcquisitionMetrics_h
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <atomic>
+
+#ifndef LIDAR_METRICS
+#define LIDAR_METRICS 1
+#endif
+
+#define METRICS_BUCKETS 20
+#define METRICS_FIRST_BUCKET_SHIFT 5
+
+enum MetricsStage
+{
+    METRICS_COMMAND = 0,
+    METRICS_BUSY_POLL,
+    METRICS_RESULT_READ,
+    METRICS_FILTER,
+    METRICS_DAC,
+    METRICS_PUBLISH,
+    METRICS_SAMPLE_INTERVAL,
+    METRICS_OUTPUT_INTERVAL,
+    METRICS_WAKE_LATENCY,
+    METRICS_MOTION,
+    METRICS_STAGE_COUNT
+};
+
+// Nome de cada etapa no rótulo stage do /metrics
+extern const char *const metricsStageNames[METRICS_STAGE_COUNT];
+
+inline uint32_t metricsNow()
+{
+#ifdef LIDAR_NATIVE
+    return micros();
+#else
+    return ESP.getCycleCount();
+#endif
+}
+
+// Ticks de metricsNow() por µs
+#ifdef LIDAR_NATIVE
+inline uint32_t metricsTicksPerMicro() { return 1; }
+#else
+extern uint32_t metricsCpuMHz;
+inline uint32_t metricsTicksPerMicro() { return metricsCpuMHz; }
+#endif
+
+void metricsBegin();
+
+class LatencyHistogram
+{
+  public:
+      LatencyHistogram();
+
+      void record(uint32_t ticks)
+      {
+          int bucket = 0;
+          if (ticks >= (1UL << METRICS_FIRST_BUCKET_SHIFT))
+          {
+              bucket = 32 - __builtin_clz(ticks) - METRICS_FIRST_BUCKET_SHIFT;
+              if (bucket >= METRICS_BUCKETS)
+              {
+                  bucket = METRICS_BUCKETS - 1;
+              }
+          }
+          buckets[bucket].store(buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+          pendingTicks += ticks;
+          uint32_t perMicro = metricsTicksPerMicro();
+          if (pendingTicks >= perMicro)
+          {
+              sumMicros.store(sumMicros.load(std::memory_order_relaxed) + pendingTicks / perMicro, std::memory_order_relaxed);
+              pendingTicks %= perMicro;
+          }
+      }
+
+      uint32_t samples() const;
+      uint32_t bucket(int index) const { return buckets[index].load(std::memory_order_relaxed); }
+      uint32_t totalMicros() const { return sumMicros.load(std::memory_order_relaxed); }
+      uint32_t quantileTicks(float q) const;
+      void reset(); // Só com o escritor parado
+
+      // Limite superior da faixa, em ticks (0 na última faixa, sem limite)
+      static uint32_t upperBoundTicks(int index)
+      {
+          return index < METRICS_BUCKETS - 1 ? 1UL << (index + METRICS_FIRST_BUCKET_SHIFT) : 0;
+      }
+
+  private:
+      std::atomic<uint32_t> buckets[METRICS_BUCKETS];
+      std::atomic<uint32_t> sumMicros;
+      uint32_t pendingTicks; // Ticks ainda não somados a sumMicros (só o escritor)
+};
+
+extern LatencyHistogram acquisitionMetrics[METRICS_STAGE_COUNT];
+
+inline void metricsRecord(MetricsStage stage, uint32_t ticks)
+{
+#if LIDAR_METRICS
+    acquisitionMetrics[stage].record(ticks);
+#else
+    (void)stage;
+    (void)ticks;
+#endif
+}
+
+// Mede a duração do escopo em que é declarado
+class StageTimer
+{
+  public:
+#if LIDAR_METRICS
+      explicit StageTimer(MetricsStage stage) : stage(stage), start(metricsNow()) {}
+      ~StageTimer() { acquisitionMetrics[stage].record(metricsNow() - start); }
+
+  private:
+      MetricsStage stage;
+      uint32_t start;
+#else
+      explicit StageTimer(MetricsStage) {}
+#endif
+};
+
+#endif
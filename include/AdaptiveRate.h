@@ -0,0 +1,71 @@
+/*------------------------------------------------------------------------------
+
+  AdaptiveRate.h
+
+  Controle adaptativo da taxa de amostragem pelo movimento do alvo e pelas
+  zonas. A cada leitura do sensor 0 o controlador recebe a distância bruta, a
+  filtrada e a zona atual e devolve a taxa do temporizador de amostragem
+  (SamplingScheduler.h):
+
+  - ADAPTIVE_ACTIVE, taxa máxima (a taxa alvo configurada): enquanto há zona
+    ocupada, há movimento, ou ainda não passaram holdMicros desde o último.
+  - ADAPTIVE_IDLE, taxa ociosa: nenhuma zona ocupada e a distância filtrada
+    dentro de ±bandCm da referência por holdMicros.
+
+  Movimento é uma leitura aceita cuja distância bruta ou filtrada sai de
+  ±bandCm da referência; a referência passa a ser a distância filtrada atual.
+  Uma única leitura basta para voltar à taxa máxima, de modo que a reação fica
+  limitada a um período ocioso mais a duração de uma medição. Leituras
+  descartadas pela qualidade não indicam movimento, mas deixam o tempo de
+  estabilidade correr (cena sem retorno também cai para a taxa ociosa).
+
+  O filtro e o ZoneEngine contam amostras, não tempo: na taxa ociosa a
+  constante de tempo do filtro cresce na mesma proporção.
+
+  Um único escritor (a tarefa de aquisição); estado e contadores são
+  atômicos para leitura sem bloqueio pelo servidor HTTP.
+
+------------------------------------------------------------------------------*/
+#ifndef AdaptiveRate_h
+#define AdaptiveRate_h
+
+#include <stdint.h>
+#include <atomic>
+
+enum AdaptiveRateState
+{
+    ADAPTIVE_ACTIVE = 0,
+    ADAPTIVE_IDLE = 1
+};
+
+class AdaptiveRate
+{
+  public:
+      AdaptiveRate();
+      void configure(uint32_t maxHz, uint32_t idleHz, uint16_t bandCm, uint32_t holdMicros);
+      uint32_t update(uint32_t timestampMicros, int rawDistance, int filteredDistance, uint8_t zone, bool accepted);
+
+      // Ativo apenas com a taxa ociosa abaixo da máxima
+      bool enabled() const { return idleRate.load(std::memory_order_relaxed) < maxRate.load(std::memory_order_relaxed); }
+      uint32_t rate() const { return state() == ADAPTIVE_IDLE ? idleRate.load(std::memory_order_relaxed) : maxRate.load(std::memory_order_relaxed); }
+      uint32_t maxHz() const { return maxRate.load(std::memory_order_relaxed); }
+      uint32_t idleHz() const { return idleRate.load(std::memory_order_relaxed); }
+      AdaptiveRateState state() const { return (AdaptiveRateState)currentState.load(std::memory_order_relaxed); }
+      uint32_t wakeups() const { return wakeupCount.load(std::memory_order_relaxed); }  // Saídas da taxa ociosa
+      uint32_t idleMillis() const { return idleTotal.load(std::memory_order_relaxed); } // Tempo já encerrado na taxa ociosa
+
+  private:
+      std::atomic<uint32_t> maxRate;
+      std::atomic<uint32_t> idleRate;
+      std::atomic<int> currentState;
+      std::atomic<uint32_t> wakeupCount;
+      std::atomic<uint32_t> idleTotal;
+      uint16_t band;
+      uint32_t hold;
+      bool started;
+      int32_t reference;   // Distância filtrada no início do período estável
+      uint32_t stableSince;
+      uint32_t idleSince;
+};
+
+#endif
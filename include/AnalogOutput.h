@@ -0,0 +1,100 @@
+/*------------------------------------------------------------------------------
+
+  AnalogOutput.h
+
+  Estágio da saída analógica (DAC de 8 bits), desacoplado da aquisição. A
+  tarefa de aquisição apenas entrega a distância de cada leitura aceita com
+  submit(); um temporizador periódico chama tick() em ritmo fixo e escreve o
+  código retornado no DAC, de modo que a saída é atualizada em intervalos
+  regulares, independentemente do ritmo irregular do laço de aquisição.
+
+  Escala
+  ------------------------------------------------------------------------------
+  A distância é limitada ao fundo de escala e multiplicada por um fator em
+  Q16 calculado em configure(): código = min(d, F) * (255 * 65536 / F) em Q16.
+  Não há divisão por amostra; o resultado difere de
+  constrain(map(d, 0, F, 0, 255), 0, 255) em no máximo 1 código.
+
+  Modos
+  ------------------------------------------------------------------------------
+  OUTPUT_DIRECT:      o próximo tick() escreve o valor da última amostra.
+  OUTPUT_INTERPOLATE: a saída vai do valor atual ao da nova amostra em linha
+                      reta ao longo do intervalo entre as duas últimas amostras,
+                      medido em ticks (até OUTPUT_MAX_SPAN); a saída fica
+                      atrasada de um período de amostragem. A divisão pelo
+                      intervalo é uma multiplicação por uma tabela de recíprocos.
+  OUTPUT_SLEW:        a saída anda em direção ao valor da última amostra no
+                      máximo slewCmPerSecond por segundo.
+
+  Um único escritor chama submit() e configure() (a tarefa de aquisição) e um
+  único leitor chama tick() (o temporizador). O alvo é passado em uma única
+  palavra atômica e os parâmetros em atômicos independentes; uma troca de
+  configuração pode misturar parâmetros antigos e novos em um único tick.
+
+------------------------------------------------------------------------------*/
+#ifndef AnalogOutput_h
+#define AnalogOutput_h
+
+#include <stdint.h>
+#include <atomic>
+
+#define OUTPUT_CODE_MAX 255
+
+// Maior intervalo entre amostras usado na interpolação, em ticks
+#define OUTPUT_MAX_SPAN 64
+
+enum AnalogOutputSource
+{
+    OUTPUT_SOURCE_RAW = 0,      // Distância bruta do sensor
+    OUTPUT_SOURCE_FILTERED = 1  // Distância após o filtro
+};
+
+enum AnalogOutputMode
+{
+    OUTPUT_DIRECT = 0,
+    OUTPUT_INTERPOLATE = 1,
+    OUTPUT_SLEW = 2
+};
+
+class AnalogOutput
+{
+  public:
+      AnalogOutput();
+      void configure(int fullScaleCm, AnalogOutputMode mode, uint32_t updateHz, uint32_t slewCmPerSecond);
+
+      // Tarefa de aquisição: entrega a distância de uma leitura aceita
+      void submit(int distanceCm)
+      {
+          uint32_t limit = fullScale.load(std::memory_order_relaxed);
+          uint32_t d = distanceCm < 0 ? 0 : (uint32_t)distanceCm > limit ? limit : (uint32_t)distanceCm;
+          // +1: 0 indica que não há alvo novo
+          pendingTarget.store(d * scaleQ16.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+      uint8_t tick();
+      uint8_t code() const { return lastCode; }
+
+      // Código de 8 bits de um valor em Q16, arredondado e limitado
+      static uint8_t codeOf(int32_t valueQ16)
+      {
+          int32_t code = (valueQ16 + 0x8000) >> 16;
+          return code < 0 ? 0 : code > OUTPUT_CODE_MAX ? OUTPUT_CODE_MAX : (uint8_t)code;
+      }
+
+  private:
+      std::atomic<uint32_t> fullScale;
+      std::atomic<uint32_t> scaleQ16;    // Código Q16 por cm
+      std::atomic<uint32_t> slewStepQ16; // Maior variação por tick no modo OUTPUT_SLEW
+      std::atomic<int> outputMode;
+      std::atomic<uint32_t> pendingTarget;
+
+      // Estado do temporizador (apenas tick())
+      int32_t currentQ16;
+      int32_t targetQ16;
+      int32_t stepQ16;
+      uint32_t remaining;   // Ticks restantes da interpolação
+      uint32_t sinceSample; // Ticks desde a amostra anterior
+      uint8_t lastCode;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*------------------------------------------------------------------------------
+
+  BiasCorrectionPolicy.h
+
+  Política de agendamento da correção de bias do receptor do LIDAR-Lite v3HP.
+  A aquisição com correção de bias (comando 0x04 no registro 0x00) é mais lenta
+  que a aquisição sem correção (0x03) e só precisa ser executada periodicamente;
+  esta classe decide, leitura a leitura, qual comando usar.
+
+  Modos
+  ------------------------------------------------------------------------------
+  BIAS_ALWAYS:   toda leitura usa correção de bias (comportamento original).
+  BIAS_EVERY_N:  uma leitura com correção a cada `parameter` leituras.
+  BIAS_PERIODIC: uma leitura com correção a cada `parameter` milissegundos.
+  BIAS_DRIFT:    correção a cada `parameter` leituras no máximo, antecipada
+                 quando a força do sinal ou a distância saltam além dos limiares
+                 (indício de deriva térmica ou mudança de cena).
+
+------------------------------------------------------------------------------*/
+#ifndef BiasCorrectionPolicy_h
+#define BiasCorrectionPolicy_h
+
+#include <stdint.h>
+
+// Salto de força do sinal (registro 0x0e) que antecipa a correção no modo BIAS_DRIFT
+#define BIAS_DRIFT_SIGNAL_JUMP 24
+// Salto de distância (cm) que antecipa a correção no modo BIAS_DRIFT
+#define BIAS_DRIFT_DISTANCE_JUMP_CM 50
+
+enum BiasCorrectionMode
+{
+    BIAS_ALWAYS = 0,
+    BIAS_EVERY_N = 1,
+    BIAS_PERIODIC = 2,
+    BIAS_DRIFT = 3
+};
+
+class BiasCorrectionPolicy
+{
+  public:
+      BiasCorrectionPolicy();
+      void configure(BiasCorrectionMode mode, uint32_t parameter);
+      BiasCorrectionMode mode() const { return policyMode; }
+      uint32_t parameter() const { return policyParameter; }
+
+      bool shouldCorrect(unsigned long nowMillis);
+      void observe(int distance, int signalStrength = -1);
+
+  private:
+      BiasCorrectionMode policyMode;
+      uint32_t policyParameter;
+      uint32_t readingsSinceCorrection;
+      unsigned long lastCorrectionMillis;
+      bool driftDetected;
+      int lastDistance;
+      int lastSignalStrength;
+};
+
+#endif
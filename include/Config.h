@@ -0,0 +1,134 @@
+/*------------------------------------------------------------------------------
+
+  Config.h
+
+  Configuração do dispositivo em RAM, já validada e convertida para inteiros.
+
+  Config é carregada da NVS uma única vez na inicialização e substituída por
+  inteiro a cada /salvar ou /resetar bem-sucedido. As tarefas não leem a NVS
+  nem variáveis globais soltas: consultam configStore.version() (uma leitura
+  atômica) e, quando a versão muda, copiam a configuração nova com snapshot().
+
+  ConfigStore mantém duas cópias: o escritor preenche a inativa e só então
+  troca o índice, incrementando a versão. O leitor copia a ativa sem bloquear
+  e repete a cópia apenas se, durante ela, uma segunda publicação começou a
+  reescrever a mesma cópia. Um único escritor (a tarefa do servidor HTTP).
+
+  Cada campo é descrito em configFields[]: nome no formulário de /salvar,
+  chave na NVS e em /recuperar, tipo, limites e valor padrão. configDiff()
+  compara duas configurações campo a campo (bit i = configFields[i]), para
+  que apenas as chaves alteradas sejam gravadas na NVS; configMask() monta a
+  máscara de um grupo de chaves, para testar se alguma delas mudou.
+
+------------------------------------------------------------------------------*/
+#ifndef Config_h
+#define Config_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define CONFIG_TEXT_SIZE 65 // Capacidade dos campos de texto, com o terminador
+
+// Número máximo de tentativas de cópia concorrente com o escritor
+#define CONFIG_READ_RETRIES 8
+
+struct Config
+{
+    char ssid[CONFIG_TEXT_SIZE];
+    char senha[CONFIG_TEXT_SIZE];
+    char ipServidor[CONFIG_TEXT_SIZE]; // Broker MQTT; vazio (padrão) desativa a publicação
+    int32_t portaServidor;
+    char token[CONFIG_TEXT_SIZE];
+    int32_t mqttQos;       // 0 ou 1
+    int32_t mqttLote;      // Amostras por mensagem
+    int32_t mqttIntervalo; // Intervalo máximo entre lotes, em ms
+    int32_t inicioZona[3]; // Zonas [início, fim), em cm; início = fim desativa a zona
+    int32_t fimZona[3];
+    int32_t zonaHisterese;   // cm
+    int32_t zonaPermanencia; // ms
+    int32_t antecedenciaAlerta; // ms antes da entrada prevista em uma zona (MotionEstimator); 0 desativa
+    int32_t velocidadeMinima;   // cm/s de aproximação mínimos para prever a entrada
+    int32_t fatorDivisao;    // Distância (cm) correspondente ao fundo de escala do DAC
+    int32_t cadeiaFiltro;    // FilterChainId
+    int32_t biasModo;        // BiasCorrectionMode
+    int32_t biasParametro;   // Leituras ou milissegundos, conforme o modo
+    int32_t modoAquisicao;   // 0 = disparado em pipeline, 1 = contínuo
+    int32_t taxaLivre;       // Taxa interna do modo contínuo, em Hz
+    int32_t taxaAlvo;        // Períodos/s do temporizador de amostragem; 0 = sem ritmo fixo
+    int32_t taxaOciosa;      // Períodos/s com a cena estável (AdaptiveRate); >= taxaAlvo desativa
+    int32_t faixaMovimento;  // Variação da distância, em cm, considerada movimento
+    int32_t tempoEstavel;    // ms de cena estável antes de reduzir a taxa
+    int32_t profundidadeBuffer; // Amostras do buffer circular (aplicada na inicialização)
+    int32_t taxaStream;      // Quadros/s do stream ao vivo
+    int32_t leituraQualidade;  // 1 = lê força do sinal e status a cada leitura
+    int32_t sinalMinimo;       // Força do sinal mínima de uma leitura válida
+    int32_t rejeicaoQualidade; // Classes descartadas (bit q = SignalQuality q)
+    int32_t fonteSaida;  // AnalogOutputSource
+    int32_t modoSaida;   // AnalogOutputMode
+    int32_t taxaSaida;   // Atualizações da saída analógica por segundo
+    int32_t rampaSaida;  // cm/s, no modo OUTPUT_SLEW
+};
+
+enum ConfigFieldType
+{
+    CONFIG_TEXT,
+    CONFIG_INT
+};
+
+struct ConfigField
+{
+    const char *form;         // Nome no JSON de /salvar
+    const char *key;          // Chave na NVS e no JSON de /recuperar
+    ConfigFieldType type;
+    size_t offset;            // Posição do campo em Config
+    int32_t min;              // Limites de CONFIG_INT
+    int32_t max;
+    const char *defaultValue;
+};
+
+extern const ConfigField configFields[];
+extern const size_t configFieldCount;
+
+bool configSetField(Config &config, const ConfigField &field, const char *text);
+bool configSetInt(Config &config, const ConfigField &field, int32_t value);
+void configDefaults(Config &config);
+const char *configValidate(const Config &config);
+uint64_t configDiff(const Config &a, const Config &b);
+uint64_t configMask(const char *const *keys, size_t count);
+
+inline int32_t &configInt(Config &config, const ConfigField &field)
+{
+    return *(int32_t *)((uint8_t *)&config + field.offset);
+}
+
+inline int32_t configInt(const Config &config, const ConfigField &field)
+{
+    return *(const int32_t *)((const uint8_t *)&config + field.offset);
+}
+
+inline char *configText(Config &config, const ConfigField &field)
+{
+    return (char *)&config + field.offset;
+}
+
+inline const char *configText(const Config &config, const ConfigField &field)
+{
+    return (const char *)&config + field.offset;
+}
+
+class ConfigStore
+{
+  public:
+      ConfigStore();
+      void publish(const Config &config);
+      bool snapshot(Config &config) const;
+      uint32_t version() const { return sequence.load(std::memory_order_acquire) >> 1; }
+
+  private:
+      Config slots[2];
+      // Ímpar durante uma publicação; a cópia ativa é slots[(sequence / 2) & 1]
+      std::atomic<uint32_t> sequence;
+};
+
+#endif
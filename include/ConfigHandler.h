@@ -1,40 +1,56 @@
-// config_handler.h
-#ifndef CONFIG_HANDLER_H
-#define CONFIG_HANDLER_H
-
-#include <Arduino.h>
-#include <ESPAsyncWebServer.h>
-#include <Preferences.h>
-
-/**
- * @brief Salva as configurações recebidas na memória não volátil (NVS).
- * 
- * @param request Ponteiro para o objeto AsyncWebServerRequest contendo os dados da requisição.
- * @param preferences Referência ao objeto Preferences utilizado para armazenar os dados na NVS.
- */
-void salvarConfiguracoes(AsyncWebServerRequest *request, Preferences &preferences);
-
-/**
- * @brief Recupera as configurações salvas da memória não volátil (NVS).
- * 
- * @param request Ponteiro para o objeto AsyncWebServerRequest contendo os dados da requisição.
- * @param preferences Referência ao objeto Preferences utilizado para recuperar os dados da NVS.
- */
-void recuperarConfiguracoes(AsyncWebServerRequest *request, Preferences &preferences);
-
-/**
- * @brief Reseta as configurações para os valores padrão.
- * 
- * @param preferences Referência ao objeto Preferences utilizado para resetar os dados na NVS.
- */
-void resetarConfiguracoes(Preferences &preferences);
-
-/**
- * @brief Configura as rotas do servidor para manipulação das configurações.
- * 
- * @param server Referência ao objeto AsyncWebServer utilizado para configurar as rotas.
- * @param preferences Referência ao objeto Preferences utilizado para manipular os dados da NVS.
- */
-void setupConfigHandler(AsyncWebServer &server, Preferences &preferences);
-
+// config_handler.h
+#ifndef CONFIG_HANDLER_H
+#define CONFIG_HANDLER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <Preferences.h>
+
+/**
+ * @brief Carrega as configurações da memória não volátil (NVS) para a configuração em RAM (configStore).
+ * 
+ * @param preferences Referência ao objeto Preferences utilizado para recuperar os dados da NVS.
+ */
+void carregarConfiguracoes(Preferences &preferences);
+
+/**
+ * @brief Valida as configurações recebidas, grava na memória não volátil (NVS) apenas as alteradas e as aplica em RAM.
+ * 
+ * @param request Ponteiro para o objeto AsyncWebServerRequest contendo os dados da requisição.
+ * @param preferences Referência ao objeto Preferences utilizado para armazenar os dados na NVS.
+ * @param data Corpo completo da requisição (JSON); os trechos de um corpo
+ *             recebido em várias chamadas são juntados antes (ConfigHandler.cpp).
+ * @param len Tamanho do corpo.
+ */
+void salvarConfiguracoes(AsyncWebServerRequest *request, Preferences &preferences, uint8_t *data, size_t len);
+
+/**
+ * @brief Responde com a configuração em RAM, sem acessar a NVS.
+ * 
+ * @param request Ponteiro para o objeto AsyncWebServerRequest contendo os dados da requisição.
+ */
+void recuperarConfiguracoes(AsyncWebServerRequest *request);
+
+/**
+ * @brief Apaga as credenciais de WiFi na configuração em RAM e na NVS (apenas as chaves alteradas).
+ * 
+ * @param preferences Referência ao objeto Preferences utilizado para armazenar os dados na NVS.
+ */
+void limparCredenciaisWiFi(Preferences &preferences);
+
+/**
+ * @brief Reseta as configurações para os valores padrão, na NVS e em RAM.
+ * 
+ * @param preferences Referência ao objeto Preferences utilizado para resetar os dados na NVS.
+ */
+void resetarConfiguracoes(Preferences &preferences);
+
+/**
+ * @brief Configura as rotas do servidor para manipulação das configurações.
+ * 
+ * @param server Referência ao objeto AsyncWebServer utilizado para configurar as rotas.
+ * @param preferences Referência ao objeto Preferences utilizado para manipular os dados da NVS.
+ */
+void setupConfigHandler(AsyncWebServer &server, Preferences &preferences);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*------------------------------------------------------------------------------
+
+  CorrelationRecord.h
+
+  Captura do registro de correlação do LiDAR para a memória e análise da forma
+  de onda no próprio dispositivo, para diagnóstico em campo (óptica suja,
+  retornos de múltiplos alvos).
+
+  O registro tem uma parte positiva seguida de um pulso negativo aproximadamente
+  simétrico; o cruzamento por zero entre o pico positivo e o vale negativo é o
+  atraso efetivo do retorno. analyzeCorrelation() calcula, em inteiros:
+
+  - pico e vale principais e suas posições;
+  - cruzamento por zero em Q8 (1/256 de posição), interpolado linearmente
+    entre as duas palavras que cercam o cruzamento;
+  - ruído de fundo: média do valor absoluto fora da janela do retorno
+    principal (CORRELATION_GUARD palavras antes do pico e depois do vale);
+  - segundo pico: maior valor positivo fora dessa janela, que indica um
+    segundo alvo (ou reflexo na janela do sensor) quando fica bem acima do
+    ruído. Uma relação pico/ruído baixa indica sinal atenuado (óptica suja).
+
+  CorrelationCapture guarda a última captura em um buffer preparado de antemão.
+  Qualquer tarefa pede uma captura com request(); a tarefa de aquisição, dona
+  do barramento, executa-a com service() entre duas leituras. Os leitores
+  copiam o registro e a análise com read() sem bloquear: a versão é conferida
+  antes e depois da cópia (ímpar durante a escrita), como em SamplePublisher,
+  e read() retorna false se uma captura estava em andamento.
+
+------------------------------------------------------------------------------*/
+#ifndef CorrelationRecord_h
+#define CorrelationRecord_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "LIDARLite.h"
+
+// Tamanho da memória de correlação do sensor, em palavras
+#define CORRELATION_MAX_WORDS 1024
+
+// Palavras capturadas quando o pedido não informa o tamanho
+#define CORRELATION_DEFAULT_WORDS 256
+
+// Palavras excluídas antes do pico e depois do vale no cálculo do ruído
+#define CORRELATION_GUARD 8
+
+struct CorrelationAnalysis
+{
+    uint32_t sequence;        // Número da captura, a partir de 1
+    uint32_t timestampMicros; // Instante da captura, em micros()
+    uint32_t captureMicros;   // Duração da captura (barramento ocupado)
+    uint16_t words;           // Palavras capturadas
+    uint8_t sensor;           // Índice do sensor (LidarArray.h)
+    int16_t peak;             // Pico positivo principal
+    uint16_t peakIndex;
+    int16_t trough;           // Vale negativo que segue o pico
+    uint16_t troughIndex;
+    int32_t zeroCrossingQ8;   // Posição do cruzamento por zero em Q8; -1 se não há
+    uint16_t noiseFloor;      // Média do valor absoluto fora do retorno principal
+    int16_t secondPeak;       // Maior valor positivo fora do retorno principal
+    uint16_t secondPeakIndex;
+};
+
+void analyzeCorrelation(const int16_t *record, int words, CorrelationAnalysis &analysis);
+
+class CorrelationCapture
+{
+  public:
+      CorrelationCapture();
+      void request(int words, uint8_t sensor = 0);
+      bool pending() const { return requested.load(std::memory_order_acquire) != 0; }
+      uint8_t requestedSensor() const { return requestSensor.load(std::memory_order_relaxed); }
+      bool service(LIDARLite &lidar, char lidarliteAddress, uint8_t sensor = 0);
+      bool read(CorrelationAnalysis &analysis, int16_t *record = NULL) const;
+
+  private:
+      std::atomic<int> requested; // Palavras pedidas; 0 sem pedido
+      std::atomic<uint8_t> requestSensor;
+      std::atomic<uint32_t> version;
+      uint32_t captures;
+      CorrelationAnalysis result;
+      int16_t samples[CORRELATION_MAX_WORDS];
+};
+
+#endif
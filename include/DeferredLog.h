@@ -0,0 +1,143 @@
+/*------------------------------------------------------------------------------
+
+  DeferredLog.h
+
+  Registro de mensagens diferido: quem registra grava um registro binário de
+  tamanho fixo (código, instante e argumentos inteiros) em um buffer circular
+  estático, e uma tarefa de baixa prioridade formata e escreve na serial. A
+  escrita na UART (115200 baud, ~87 µs por caractere) sai das tarefas de
+  aquisição e do servidor web; uma mensagem custa alguns acessos atômicos.
+
+  Códigos
+  ------------------------------------------------------------------------------
+  Cada mensagem tem um código (LogCode) com nível, origem e formato fixos na
+  tabela logCodes; o texto só é montado pela tarefa de escrita, com até
+  LOG_MAX_ARGS argumentos inteiros (%d, %u ou %x). Não há texto livre: dados
+  sensíveis, como credenciais, não têm como chegar ao registro.
+
+  Buffer
+  ------------------------------------------------------------------------------
+  Vários escritores (tarefas, callbacks do servidor web e do temporizador) e
+  um leitor, sem bloqueio e sem alocação. O escritor reserva uma posição com
+  compare-and-swap no índice de escrita; cada posição guarda uma sequência que
+  diz se está livre para a volta atual, preenchida, ou ainda não consumida da
+  volta anterior. Com o buffer cheio a mensagem é descartada e contada em
+  dropped(); o escritor nunca espera pelo leitor.
+
+  Limite de repetição
+  ------------------------------------------------------------------------------
+  Cada código aceita até LOG_RATE_BURST mensagens por janela de
+  2^LOG_RATE_WINDOW_SHIFT µs (~1 s); as excedentes são contadas em
+  suppressed() e no registro seguinte do mesmo código (repeats). Se o código
+  não se repetir, a tarefa de escrita emite um resumo com as suprimidas após
+  o fim da janela (readSuppressed()).
+
+------------------------------------------------------------------------------*/
+#ifndef DeferredLog_h
+#define DeferredLog_h
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Profundidade do buffer (potência de 2): 128 registros de 20 bytes
+#define LOG_RING_DEPTH 128
+#define LOG_MAX_ARGS 3
+
+// Mensagens por código em cada janela de ~1,05 s
+#define LOG_RATE_WINDOW_SHIFT 20
+#define LOG_RATE_BURST 4
+
+// Maior linha formatada, com o instante e o prefixo
+#define LOG_LINE_MAX 112
+
+enum LogLevel
+{
+    LOG_ERROR = 0,
+    LOG_WARNING,
+    LOG_INFO
+};
+
+enum LogCode
+{
+    LOG_I2C_NACK = 0,        // endereço, registro
+    LOG_I2C_READ_TIMEOUT,    // endereço, espera em µs, registro
+    LOG_CONFIG_BODY,         // bytes do trecho, posição, total
+    LOG_CONFIG_INVALID_JSON, // código do DeserializationError, bytes
+    LOG_LOGIN_ACCEPTED,
+    LOG_LOGIN_REJECTED,
+    LOG_DISTANCE,            // distância filtrada em cm, zona
+    LOG_CODE_COUNT
+};
+
+struct LogCodeInfo
+{
+    uint8_t level;
+    const char *source;
+    const char *format;
+};
+
+// Nível, origem e formato de cada código
+extern const LogCodeInfo logCodes[LOG_CODE_COUNT];
+
+// Mensagem gravada no buffer (20 bytes)
+struct LogRecord
+{
+    uint32_t timestampMicros;
+    uint16_t code;
+    uint16_t repeats;         // Suprimidas antes desta; em um resumo, o total
+    int32_t args[LOG_MAX_ARGS];
+};
+
+class DeferredLog
+{
+  public:
+      DeferredLog();
+      bool write(uint16_t code, uint32_t timestampMicros, int32_t a = 0, int32_t b = 0, int32_t c = 0);
+      bool read(LogRecord &record);
+      bool readSuppressed(uint32_t nowMicros, LogRecord &record);
+      static size_t format(const LogRecord &record, bool summary, char *line, size_t size);
+
+      uint32_t written() const { return writtenCount.load(std::memory_order_relaxed); }
+      uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+      uint32_t suppressed() const { return suppressedCount.load(std::memory_order_relaxed); }
+
+  private:
+      bool admit(uint16_t code, uint32_t timestampMicros);
+
+      struct Slot
+      {
+          std::atomic<uint32_t> sequence; // Posição + 1 preenchida; posição livre
+          LogRecord record;
+      };
+
+      Slot slots[LOG_RING_DEPTH];
+      std::atomic<uint32_t> head;   // Próxima posição a reservar
+      uint32_t tail;                // Próxima posição a ler (só o leitor)
+      uint16_t summaryCode;         // Próximo código verificado por readSuppressed()
+
+      // Por código: janela (bits altos) e mensagens aceitas nela (8 bits baixos)
+      std::atomic<uint32_t> rateState[LOG_CODE_COUNT];
+      std::atomic<uint32_t> pending[LOG_CODE_COUNT]; // Suprimidas ainda não relatadas
+
+      std::atomic<uint32_t> writtenCount;
+      std::atomic<uint32_t> droppedCount;
+      std::atomic<uint32_t> suppressedCount;
+};
+
+extern DeferredLog deferredLog;
+
+/**
+ * @brief Registra uma mensagem com o instante atual; não bloqueia.
+ */
+inline void logEvent(LogCode code, int32_t a = 0, int32_t b = 0, int32_t c = 0)
+{
+    deferredLog.write(code, micros(), a, b, c);
+}
+
+#ifndef LIDAR_NATIVE
+void setupDeferredLog();
+#endif
+
+#endif
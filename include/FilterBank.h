@@ -0,0 +1,65 @@
+/*------------------------------------------------------------------------------
+
+  FilterBank.h
+
+  Conjunto de cadeias de filtros pré-instanciadas (FilterChain.h), das quais
+  uma é selecionada em tempo de execução pela configuração ("cadeia-filtro").
+  A seleção é um switch sobre tipos concretos: cada cadeia continua expandida
+  inline e não há chamada virtual por amostra.
+
+  Cadeias
+  ------------------------------------------------------------------------------
+  FILTER_NONE:          sem filtro, a saída é a distância bruta.
+  FILTER_KALMAN:        Kalman escalar (Q = 0,001, R = 0,5), o filtro original.
+  FILTER_MEDIAN_EMA:    mediana de 5 seguida de EMA com alfa = 1/8.
+  FILTER_MEDIAN_KALMAN: mediana de 5 seguida do Kalman escalar.
+  FILTER_STABLE:        mediana de 3, limitador de 20 cm/amostra, EMA com
+                        alfa = 1/4 e banda morta de 2 cm (saída estável para
+                        exibição e saída analógica).
+
+------------------------------------------------------------------------------*/
+#ifndef FilterBank_h
+#define FilterBank_h
+
+#include <stdint.h>
+#include "FilterChain.h"
+
+enum FilterChainId
+{
+    FILTER_NONE = 0,
+    FILTER_KALMAN = 1,
+    FILTER_MEDIAN_EMA = 2,
+    FILTER_MEDIAN_KALMAN = 3,
+    FILTER_STABLE = 4,
+    FILTER_CHAIN_COUNT
+};
+
+// Variâncias do Kalman original em Q16: Q = 0,001 e R = 0,5
+#define FILTER_KALMAN_Q 66
+#define FILTER_KALMAN_R 32768
+
+typedef KalmanStage<FILTER_KALMAN_Q, FILTER_KALMAN_R> LegacyKalman;
+
+typedef FilterChain<LegacyKalman> KalmanChain;
+typedef FilterChain<MedianStage<5>, EmaStage<3>> MedianEmaChain;
+typedef FilterChain<MedianStage<5>, LegacyKalman> MedianKalmanChain;
+typedef FilterChain<MedianStage<3>, RateLimitStage<20>, EmaStage<2>, DeadBandStage<2>> StableChain;
+
+class FilterBank
+{
+  public:
+      FilterBank();
+      void select(FilterChainId id);
+      FilterChainId selected() const { return active; }
+      int process(int distanceCm);
+
+  private:
+      FilterChainId active;
+      bool primed;
+      KalmanChain kalman;
+      MedianEmaChain medianEma;
+      MedianKalmanChain medianKalman;
+      StableChain stable;
+};
+
+#endif
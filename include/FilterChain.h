@@ -0,0 +1,219 @@
+/*------------------------------------------------------------------------------
+
+  FilterChain.h
+
+  Estágios de filtragem da distância do LiDAR, compostos em tempo de compilação.
+  FilterChain<A, B, C> aplica A, depois B, depois C; cada estágio é um tipo
+  concreto, de modo que a cadeia inteira é expandida inline pelo compilador,
+  sem chamadas virtuais nem alocação.
+
+  Todos os estágios trabalham em ponto fixo: os valores são centímetros em
+  Q8 (cm * 256, ver FILTER_Q8) em int32_t, e os coeficientes são parâmetros
+  de template inteiros. Nenhum estágio usa float ou double.
+
+  Interface de um estágio
+  ------------------------------------------------------------------------------
+  void reset(int32_t value);     reinicia o estado com o valor informado (Q8)
+  int32_t process(int32_t value); filtra uma amostra (Q8) e retorna a saída (Q8)
+
+------------------------------------------------------------------------------*/
+#ifndef FilterChain_h
+#define FilterChain_h
+
+#include <stdint.h>
+
+// Conversão entre centímetros e a representação interna Q8
+#define FILTER_Q8(cm) ((int32_t)(cm) * 256)
+#define FILTER_CM(q8) (((q8) + 128) >> 8)
+
+/*------------------------------------------------------------------------------
+  Mediana das últimas N amostras (N ímpar, até 9): remove picos isolados
+------------------------------------------------------------------------------*/
+template <int N>
+class MedianStage
+{
+    static_assert(N % 2 == 1 && N >= 3 && N <= 9, "N deve ser impar entre 3 e 9");
+
+  public:
+      void reset(int32_t value)
+      {
+          for (int i = 0; i < N; i++)
+          {
+              window[i] = value;
+          }
+          next = 0;
+      }
+
+      int32_t process(int32_t value)
+      {
+          window[next] = value;
+          next = next + 1 == N ? 0 : next + 1;
+
+          // Ordenação por inserção de uma cópia da janela (N pequeno)
+          int32_t sorted[N];
+          for (int i = 0; i < N; i++)
+          {
+              int32_t v = window[i];
+              int j = i;
+              for (; j > 0 && sorted[j - 1] > v; j--)
+              {
+                  sorted[j] = sorted[j - 1];
+              }
+              sorted[j] = v;
+          }
+          return sorted[N / 2];
+      }
+
+  private:
+      int32_t window[N];
+      int next;
+};
+
+/*------------------------------------------------------------------------------
+  Média móvel exponencial com alfa = 1 / 2^Shift
+------------------------------------------------------------------------------*/
+template <int Shift>
+class EmaStage
+{
+    static_assert(Shift >= 1 && Shift <= 8, "Shift deve estar entre 1 e 8");
+
+  public:
+      void reset(int32_t value) { state = value; }
+
+      int32_t process(int32_t value)
+      {
+          // Arredonda para o mais próximo em vez de truncar para -infinito
+          state += (value - state + (1 << (Shift - 1))) >> Shift;
+          return state;
+      }
+
+  private:
+      int32_t state;
+};
+
+/*------------------------------------------------------------------------------
+  Filtro de Kalman escalar (modelo de posição constante)
+
+  QQ16 e RQ16 são as variâncias do processo e da medição em Q16 (1.0 = 65536).
+  O ganho não depende das medições e converge para um valor fixo; a divisão
+  de 64 bits deixa de ser feita assim que P se estabiliza.
+------------------------------------------------------------------------------*/
+template <uint32_t QQ16, uint32_t RQ16>
+class KalmanStage
+{
+  public:
+      void reset(int32_t value)
+      {
+          estimate = value;
+          p = 65536; // P inicial = 1
+          gain = 0;
+          settled = false;
+      }
+
+      int32_t process(int32_t value)
+      {
+          if (!settled)
+          {
+              // Previsão e atualização da variância do erro de estimativa
+              uint32_t predicted = p + QQ16;
+              gain = (uint32_t)(((uint64_t)predicted << 16) / (predicted + RQ16));
+              uint32_t updated = (uint32_t)(((uint64_t)(65536 - gain) * predicted) >> 16);
+              settled = updated == p;
+              p = updated;
+          }
+          estimate += (int32_t)(((int64_t)gain * (value - estimate) + 32768) >> 16);
+          return estimate;
+      }
+
+  private:
+      int32_t estimate;
+      uint32_t p;
+      uint32_t gain;
+      bool settled;
+};
+
+/*------------------------------------------------------------------------------
+  Limitador de taxa: a saída varia no máximo MaxStepCm centímetros por amostra
+------------------------------------------------------------------------------*/
+template <int MaxStepCm>
+class RateLimitStage
+{
+  public:
+      void reset(int32_t value) { output = value; }
+
+      int32_t process(int32_t value)
+      {
+          int32_t step = value - output;
+          if (step > FILTER_Q8(MaxStepCm))
+          {
+              step = FILTER_Q8(MaxStepCm);
+          }
+          else if (step < -FILTER_Q8(MaxStepCm))
+          {
+              step = -FILTER_Q8(MaxStepCm);
+          }
+          output += step;
+          return output;
+      }
+
+  private:
+      int32_t output;
+};
+
+/*------------------------------------------------------------------------------
+  Banda morta: a saída só acompanha a entrada quando ela se afasta mais de
+  BandCm centímetros do último valor mantido (evita oscilação na saída)
+------------------------------------------------------------------------------*/
+template <int BandCm>
+class DeadBandStage
+{
+  public:
+      void reset(int32_t value) { output = value; }
+
+      int32_t process(int32_t value)
+      {
+          int32_t diff = value - output;
+          if (diff > FILTER_Q8(BandCm) || diff < -FILTER_Q8(BandCm))
+          {
+              output = value;
+          }
+          return output;
+      }
+
+  private:
+      int32_t output;
+};
+
+/*------------------------------------------------------------------------------
+  Composição dos estágios
+------------------------------------------------------------------------------*/
+template <typename... Stages>
+class FilterChain;
+
+// Cadeia vazia: repassa o valor
+template <>
+class FilterChain<>
+{
+  public:
+      void reset(int32_t) {}
+      int32_t process(int32_t value) { return value; }
+};
+
+template <typename First, typename... Rest>
+class FilterChain<First, Rest...>
+{
+  public:
+      void reset(int32_t value)
+      {
+          head.reset(value);
+          tail.reset(value);
+      }
+
+      int32_t process(int32_t value) { return tail.process(head.process(value)); }
+
+  private:
+      First head;
+      FilterChain<Rest...> tail;
+};
+
+#endif
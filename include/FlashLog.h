@@ -0,0 +1,106 @@
+/*------------------------------------------------------------------------------
+
+  FlashLog.h
+
+  Registro persistente de amostras e transições de zona durante quedas do
+  enlace (store-and-forward). Enquanto o MQTT está desconectado a tarefa do
+  MQTT acrescenta os dados ao registro; na reconexão ela o esvazia, do mais
+  antigo para o mais recente, em ritmo limitado para não atrasar o tráfego ao vivo.
+
+  Organização
+  ------------------------------------------------------------------------------
+  - Os dados são divididos em segmentos de até `segmentSize` bytes; no máximo
+    `maxSegments` segmentos existem ao mesmo tempo. Ao exceder o limite, o
+    segmento mais antigo é descartado (contado em segmentsDropped).
+  - As escritas são agrupadas: os registros são montados em uma página em RAM
+    (FLASH_LOG_PAGE_SIZE) e a página inteira é gravada de uma vez, reduzindo
+    o número de escritas e de páginas parcialmente gravadas na flash.
+  - As amostras são agrupadas em lotes de até FLASH_LOG_BATCH e gravadas como
+    um quadro de SampleCodec.h (delta + varint, com CRC).
+
+  Registro no segmento (inteiros em little-endian)
+  ------------------------------------------------------------------------------
+    u8   tipo      FLASH_LOG_SAMPLES ou FLASH_LOG_EVENT
+    u16  tamanho   bytes do conteúdo
+    ...  conteúdo  quadro de SampleCodec ou ZoneEvent (20 bytes; 12 nos registros
+                   gravados antes da velocidade e do alerta de aproximação, 16
+                   antes do tipo, com o alerta indicado por leadMillis > 0)
+
+  peek() lê apenas o que já foi gravado: chame flush() antes de esvaziar o
+  registro. Um registro truncado no fim de um segmento (queda de energia durante a
+  escrita) encerra a leitura daquele segmento. A posição de leitura não é
+  persistida: após reiniciar, o registro é lido desde o segmento mais antigo
+  e registros já enviados podem ser repetidos (entrega ao menos uma vez).
+
+------------------------------------------------------------------------------*/
+#ifndef FlashLog_h
+#define FlashLog_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "LogStorage.h"
+#include "SampleCodec.h"
+#include "ZoneEngine.h"
+
+#define FLASH_LOG_PAGE_SIZE 2048
+#define FLASH_LOG_BATCH 64
+#define FLASH_LOG_RECORD_HEADER 3
+// Maior conteúdo de um registro (quadro com FLASH_LOG_BATCH amostras no pior caso)
+#define FLASH_LOG_MAX_PAYLOAD SAMPLE_CODEC_FRAME_SIZE(FLASH_LOG_BATCH)
+
+#define FLASH_LOG_SAMPLES 1
+#define FLASH_LOG_EVENT 2
+
+struct FlashLogStats
+{
+    uint32_t pageWrites;      // Escritas de página no armazenamento
+    uint32_t bytesWritten;    // Bytes gravados
+    uint32_t recordsWritten;  // Registros gravados
+    uint32_t recordsRead;     // Registros retirados (pop)
+    uint32_t segmentsDropped; // Segmentos descartados por falta de espaço
+    uint32_t writeErrors;     // Escritas recusadas pelo armazenamento
+};
+
+class FlashLog
+{
+  public:
+      FlashLog();
+      bool begin(LogStorage &storage, size_t segmentSize, uint32_t maxSegments, uint32_t deviceId);
+      void append(const LidarSample &sample);
+      void append(const ZoneEvent &event);
+      void flush();
+      bool empty();
+      size_t peek(uint8_t &type, uint8_t *payload, size_t capacity);
+      void pop();
+      uint32_t segments() const { return writeSegment - readSegment + 1; }
+      const FlashLogStats &stats() const { return logStats; }
+
+  private:
+      void appendRecord(uint8_t type, const uint8_t *payload, size_t length);
+      void writePage();
+      void flushBatch();
+      void enforceLimit();
+      size_t readLimit();
+      void nextReadSegment();
+
+      LogStorage *storage;
+      size_t segmentSize;
+      uint32_t maxSegments;
+      uint32_t deviceId;
+
+      uint8_t page[FLASH_LOG_PAGE_SIZE];
+      size_t pageUsed;
+      LidarSample batch[FLASH_LOG_BATCH];
+      size_t batchCount;
+      uint8_t frame[FLASH_LOG_MAX_PAYLOAD];
+
+      uint32_t writeSegment;
+      size_t writeOffset;
+      uint32_t readSegment;
+      size_t readOffset;
+      size_t readSegmentSize;
+      size_t peekedLength;
+      FlashLogStats logStats;
+};
+
+#endif
@@ -1,42 +1,73 @@
-#ifndef GLOBALS_H
-#define GLOBALS_H
-
-#include <Arduino.h>
-#include <freertos/FreeRTOS.h>
-#include <freertos/semphr.h>
-
-// Declaração das variáveis globais como `extern` para serem usadas em outros módulos
-
-// Mutex para proteger o acesso à variável global de distância
-extern SemaphoreHandle_t xDistanceMutex;
-
-// Variável global para armazenar a distância medida
-extern volatile int globalDistance;
-
-// Fator de divisão para ajustar a leitura da distância
-extern volatile int fator_divisao;
-
-// Início e fim da Zona 1
-extern volatile int zona1_inicio;
-extern volatile int zona1_fim;
-
-// Início e fim da Zona 2
-extern volatile int zona2_inicio;
-extern volatile int zona2_fim;
-
-// Início e fim da Zona 3
-extern volatile int zona3_inicio;
-extern volatile int zona3_fim;
-// Token de autenticação do MQTT
-extern std::string tokenMqt;
-
-// variavel com ip do servidor
-extern std::string ipServidor;
-
-// variavel com porta do servidor
-extern std::string portaServidor;
-
-extern volatile int FiltroKalman;
-
-
-#endif // GLOBALS_H
+#ifndef GLOBALS_H
+#define GLOBALS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "LidarArray.h"
+#include "SamplePublisher.h"
+#include "SampleRing.h"
+#include "ZoneEngine.h"
+#include "Config.h"
+#include "CorrelationRecord.h"
+#include "LogStorage.h"
+#include "AdaptiveRate.h"
+#include "SamplingScheduler.h"
+#include "MotionEstimator.h"
+#include "Trace.h"
+
+// Declaração das variáveis globais como `extern` para serem usadas em outros módulos
+
+// Sensores LiDAR no barramento I2C, definidos em main.cpp e usados pela tarefa
+// de aquisição; o sensor 0 alimenta a saída analógica, as zonas e as amostras
+extern LidarArray lidars;
+
+// Amostra mais recente do LiDAR, publicada sem bloqueio pela tarefa de aquisição
+extern SamplePublisher samplePublisher;
+
+// Histórico recente de amostras, para retirada em lote (GET /samples?since=N)
+extern SampleRing sampleRing;
+
+// Transições de zona recentes, publicadas pela tarefa de aquisição
+extern ZoneEventRing zoneEvents;
+
+// Configuração em RAM, carregada da NVS na inicialização e substituída a cada
+// /salvar; as tarefas aplicam a nova versão na próxima iteração (ver Config.h)
+extern ConfigStore configStore;
+
+// Última captura do registro de correlação, pedida via POST /correlacao e
+// executada pela tarefa de aquisição entre duas leituras
+extern CorrelationCapture correlacao;
+
+// Gravação de traces do sensor 0 (POST /trace), em arquivo no SPIFFS: o estado
+// do pipeline é copiado pela tarefa de aquisição e as amostras são retiradas do
+// sampleRing e gravadas por loop()
+extern FSLogStorage armazenamentoTrace;
+extern TraceRecorder traceRecorder;
+
+// Amostragem em ritmo fixo: taxa alvo, jitter do período e overruns, atualizados
+// pela tarefa de aquisição a cada despertar do temporizador
+extern SamplingScheduler agendadorAmostragem;
+
+// Taxa adaptativa: reduz a amostragem com a cena estável e volta à taxa alvo
+// com movimento ou zona ocupada; decidida pela tarefa de aquisição
+extern AdaptiveRate taxaAdaptativa;
+
+// Velocidade do alvo e tempo previsto até o próximo limite de zona, estimados
+// pela tarefa de aquisição a cada leitura aceita do sensor 0
+extern MotionEstimator estimadorMovimento;
+
+// Taxa de amostragem efetiva medida pela tarefa do LiDAR, em amostras/s
+extern volatile uint32_t taxaAmostragem;
+
+// Taxa de leituras de cada sensor na última janela de um segundo, em leituras/s
+extern volatile uint32_t taxaSensores[LIDAR_ARRAY_MAX_SENSORS];
+
+// Jitter do escritor na última janela de um segundo: maior duração de uma
+// publicação e maior intervalo entre publicações consecutivas, em µs
+extern volatile uint32_t publicacaoMaxUs;
+extern volatile uint32_t intervaloMaxUs;
+
+
+#endif // GLOBALS_H
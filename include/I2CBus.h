@@ -0,0 +1,54 @@
+/*------------------------------------------------------------------------------
+
+  I2CBus.h
+
+  Interface mínima de barramento I2C usada pela biblioteca LIDARLite. Espelha a
+  API do `TwoWire` do Arduino para que o driver possa ser executado tanto sobre o
+  `Wire` real do ESP32 quanto sobre um barramento simulado no ambiente nativo
+  (`[env:native]`), onde o sensor é substituído por um modelo de registradores.
+
+------------------------------------------------------------------------------*/
+#ifndef I2CBus_h
+#define I2CBus_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+class I2CBus
+{
+  public:
+      virtual ~I2CBus() {}
+      virtual void begin(int sda, int scl, uint32_t frequency) = 0;
+      virtual void beginTransmission(uint8_t address) = 0;
+      virtual size_t write(uint8_t value) = 0;
+      virtual uint8_t endTransmission(bool sendStop = true) = 0;
+      virtual uint8_t requestFrom(uint8_t address, uint8_t quantity) = 0;
+      virtual int available() = 0;
+      virtual int read() = 0;
+};
+
+#ifndef LIDAR_NATIVE
+#include <Wire.h>
+
+// Adaptador do barramento `TwoWire` do Arduino para a interface I2CBus
+class WireI2CBus : public I2CBus
+{
+  public:
+      explicit WireI2CBus(TwoWire &wire) : wire(wire) {}
+      void begin(int sda, int scl, uint32_t frequency) override { wire.begin(sda, scl, frequency); }
+      void beginTransmission(uint8_t address) override { wire.beginTransmission(address); }
+      size_t write(uint8_t value) override { return wire.write(value); }
+      uint8_t endTransmission(bool sendStop) override { return wire.endTransmission(sendStop); }
+      uint8_t requestFrom(uint8_t address, uint8_t quantity) override { return wire.requestFrom(address, quantity); }
+      int available() override { return wire.available(); }
+      int read() override { return wire.read(); }
+
+  private:
+      TwoWire &wire;
+};
+
+// Barramento padrão, associado ao objeto global `Wire`
+I2CBus &defaultI2CBus();
+#endif
+
+#endif
@@ -1,45 +1,127 @@
-/*------------------------------------------------------------------------------
-
-  LIDARLite Arduino Library
-  LIDARLite.h
-
-  This library provides quick access to all the basic functions of LIDAR-Lite
-  via the Arduino interface. Additionally, it can provide a user of any
-  platform with a template for their own application code.
-
-  Copyright (c) 2016 Garmin Ltd. or its subsidiaries.
-
-  Licensed under the Apache License, Version 2.0 (the "License");
-  you may not use this file except in compliance with the License.
-  You may obtain a copy of the License at
-
-  http://www.apache.org/licenses/LICENSE-2.0
-
-  Unless required by applicable law or agreed to in writing, software
-  distributed under the License is distributed on an "AS IS" BASIS,
-  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-  See the License for the specific language governing permissions and
-  limitations under the License.
-
-------------------------------------------------------------------------------*/
-#ifndef LIDARLite_h
-#define LIDARLite_h
-
-#define LIDARLITE_ADDR_DEFAULT 0x62
-
-#include <Arduino.h>
-
-class LIDARLite
-{
-  public:
-      LIDARLite();
-      void begin(int = 0, bool = false, char = LIDARLITE_ADDR_DEFAULT);
-      void configure(int = 0, char = LIDARLITE_ADDR_DEFAULT);
-      void reset(char = LIDARLITE_ADDR_DEFAULT);
-      int distance(bool = true, char = LIDARLITE_ADDR_DEFAULT);
-      void write(char, char, char = LIDARLITE_ADDR_DEFAULT);
-      void read(char, int, byte*, bool, char);
-      void correlationRecordToSerial(char = '\n', int = 256, char = LIDARLITE_ADDR_DEFAULT);
-};
-
-#endif
+/*------------------------------------------------------------------------------
+
+  LIDARLite Arduino Library
+  LIDARLite.h
+
+  This library provides quick access to all the basic functions of LIDAR-Lite
+  via the Arduino interface. Additionally, it can provide a user of any
+  platform with a template for their own application code.
+
+  Copyright (c) 2016 Garmin Ltd. or its subsidiaries.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+------------------------------------------------------------------------------*/
+#ifndef LIDARLite_h
+#define LIDARLite_h
+
+#define LIDARLITE_ADDR_DEFAULT 0x62
+
+// Prazo máximo de espera pelo sinalizador de ocupado, em microssegundos
+#define LIDARLITE_BUSY_TIMEOUT_US 20000UL
+
+// Palavras do registro de correlação por leitura em bloco (2 bytes cada; cabe
+// no buffer de 128 bytes do Wire)
+#define LIDARLITE_CORRELATION_CHUNK_WORDS 32
+
+#include <Arduino.h>
+#include "I2CBus.h"
+#include "BiasCorrectionPolicy.h"
+
+// Contadores do caminho de aquisição, usados para diagnóstico e benchmark
+struct LIDARLiteStats
+{
+    uint32_t transactions;     // Transações I2C (escritas e leituras) realizadas
+    uint32_t busyPolls;        // Leituras do registro de status 0x01
+    uint32_t busyPollMicros;   // Tempo total gasto aguardando o sinalizador de ocupado
+    uint32_t nacks;            // Transações não reconhecidas pelo dispositivo
+    uint32_t readTimeouts;     // Leituras abortadas por timeout do sinalizador de ocupado
+    uint32_t biasAcquisitions; // Aquisições disparadas com correção de bias (0x04)
+    uint32_t plainAcquisitions; // Aquisições disparadas sem correção de bias (0x03)
+    uint32_t freeRunReads;     // Leituras do resultado no modo contínuo (readLatest)
+    uint32_t staleReads;       // Leituras do modo contínuo que repetiram o resultado anterior
+    uint32_t bytesRead;        // Bytes de dados recebidos do sensor
+};
+
+// Estado da aquisição assíncrona (startMeasurement / poll / fetchDistance)
+enum LIDARLiteAcqState
+{
+    LIDARLITE_IDLE,    // Nenhuma medição em andamento
+    LIDARLITE_BUSY,    // Medição disparada, sensor ainda ocupado
+    LIDARLITE_READY,   // Resultado disponível para leitura
+    LIDARLITE_TIMEOUT  // Sensor não liberou o sinalizador de ocupado dentro do prazo
+};
+
+class LIDARLite
+{
+  public:
+      LIDARLite();
+      explicit LIDARLite(I2CBus &);
+      void setBus(I2CBus &);
+      void begin(int = 0, bool = false, char = LIDARLITE_ADDR_DEFAULT);
+      void configure(int = 0, char = LIDARLITE_ADDR_DEFAULT);
+      void reset(char = LIDARLITE_ADDR_DEFAULT);
+      void setI2Caddr(char, bool = true, char = LIDARLITE_ADDR_DEFAULT);
+      int distance(bool = true, char = LIDARLITE_ADDR_DEFAULT);
+      void startMeasurement(bool = true, char = LIDARLITE_ADDR_DEFAULT);
+      LIDARLiteAcqState poll(char = LIDARLITE_ADDR_DEFAULT);
+      int fetchDistance(char = LIDARLITE_ADDR_DEFAULT);
+      bool distanceAsync(int &, char = LIDARLITE_ADDR_DEFAULT);
+      BiasCorrectionPolicy &biasCorrection() { return biasPolicy; }
+      void startFreeRunning(unsigned int, char = LIDARLITE_ADDR_DEFAULT);
+      void stopFreeRunning(char = LIDARLITE_ADDR_DEFAULT);
+      bool readLatest(int &, char = LIDARLITE_ADDR_DEFAULT);
+      bool freeRunning() const { return freeRunActive; }
+      unsigned long freeRunPeriod() const { return freeRunPeriodMicros; }
+      LIDARLiteAcqState acquisitionState() const { return acqState; }
+      void setBusyTimeout(unsigned long timeoutMicros) { busyTimeoutMicros = timeoutMicros; }
+      void setQualityRead(bool enabled)
+      {
+          qualityReadEnabled = enabled;
+          lastSignalStrength = -1;
+          lastStatus = -1;
+      }
+      bool qualityRead() const { return qualityReadEnabled; }
+      int signalStrength() const { return lastSignalStrength; }
+      int status() const { return lastStatus; }
+      void write(char, char, char = LIDARLITE_ADDR_DEFAULT);
+      void read(char, int, byte*, bool, char);
+      void correlationRecordToSerial(char = '\n', int = 256, char = LIDARLITE_ADDR_DEFAULT);
+      int correlationRecord(int16_t *, int = 256, char = LIDARLITE_ADDR_DEFAULT);
+      // Leitura do registro de correlação em bloco; desativada por padrão
+      // (conferida apenas no simulador, ver readCorrelationWords)
+      void setCorrelationBulkRead(bool enabled) { correlationBulkEnabled = enabled; }
+      const LIDARLiteStats &stats() const { return acqStats; }
+      void resetStats();
+
+  private:
+      void readCorrelationWords(int16_t *, int, char);
+
+      I2CBus *bus;
+      LIDARLiteStats acqStats;
+      BiasCorrectionPolicy biasPolicy;
+      LIDARLiteAcqState acqState;
+      unsigned long acqStartMicros;
+      unsigned long busyTimeoutMicros;
+      bool qualityReadEnabled;
+      int lastSignalStrength;
+      int lastStatus;
+      byte lastStatusByte;
+      bool freeRunActive;
+      unsigned long freeRunPeriodMicros;
+      int lastFreeRunDistance;
+      unsigned long lastFreeRunMicros;
+      bool correlationBulkEnabled;
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*------------------------------------------------------------------------------
+
+  LidarArray.h
+
+  Vários LIDAR-Lite v3HP no mesmo barramento I2C, com aquisições intercaladas.
+
+  Endereços
+  ------------------------------------------------------------------------------
+  Todos os sensores ligam no endereço 0x62 e o endereço atribuído não é
+  persistente, portanto begin() o atribui a cada inicialização. Cada sensor tem
+  o pino de habilitação de alimentação (PWR_EN) ligado a um GPIO: todos são
+  desligados e então ligados um de cada vez; o sensor recém-ligado, sozinho em
+  0x62, recebe o endereço LIDAR_ARRAY_FIRST_ADDRESS + índice e deixa de
+  responder em 0x62 antes que o próximo seja ligado. Um sensor que não responde
+  é desligado e marcado como ausente. Um único sensor sem pino de habilitação
+  permanece em 0x62.
+
+  Escalonamento
+  ------------------------------------------------------------------------------
+  next() percorre os sensores em rodízio com LIDARLite::distanceAsync(): cada
+  consulta lê o status uma única vez, e um sensor pronto tem o resultado lido e
+  a próxima aquisição disparada na mesma passagem. Assim o sensor B é disparado
+  e lido enquanto A ainda mede, e o barramento não fica parado aguardando o
+  sinalizador de ocupado de um único sensor. Depois de entregar uma leitura, a
+  próxima chamada começa pelo sensor seguinte, para que nenhum sensor monopolize
+  o barramento. No modo contínuo cada sensor é lido com readLatest().
+
+  Cada sensor tem o próprio driver (estado da aquisição, política de bias e
+  contadores), o próprio SamplePipeline (qualidade, filtro e zonas) e a
+  própria saída: a amostra mais recente,
+  publicada sem bloqueio (SamplePublisher) com o índice do sensor em
+  LidarSample::sensor. next() deve ser chamada por uma única tarefa.
+
+  Qualidade
+  ------------------------------------------------------------------------------
+  Com configureQuality(true, ...) cada leitura traz a força do sinal e o status
+  do sensor e é classificada pelo QualityGate do sensor (SignalQuality.h). Uma
+  leitura descartada continua sendo entregue e publicada, com a classe em
+  LidarSample::quality, mas não passa pelo filtro nem pelas zonas: a distância
+  filtrada repete a da última leitura aceita (ver SamplePipeline.h).
+
+------------------------------------------------------------------------------*/
+#ifndef LidarArray_h
+#define LidarArray_h
+
+#include <Arduino.h>
+#include "LIDARLite.h"
+#include "SamplePipeline.h"
+#include "SamplePublisher.h"
+
+#define LIDAR_ARRAY_MAX_SENSORS 4
+
+// Endereço atribuído ao primeiro sensor; os seguintes usam os próximos
+#define LIDAR_ARRAY_FIRST_ADDRESS 0x64
+
+// Tempo de inicialização do sensor após habilitar a alimentação, em ms
+#define LIDAR_ARRAY_POWER_UP_MS 22
+
+// Sensor sem pino de habilitação de alimentação
+#define LIDAR_ARRAY_NO_PIN -1
+
+// Leitura entregue por next()
+struct LidarArrayReading
+{
+    uint8_t sensor;                // Índice do sensor
+    int rawDistance;               // Distância lida, em cm
+    int filteredDistance;          // Distância após o filtro do sensor, em cm
+    int signalStrength;            // Força do sinal (0x0e), -1 se não lida
+    int status;                    // Status do sensor (0x01), -1 se não lido
+    SignalQuality quality;
+    bool accepted;                 // false se descartada pelo QualityGate
+    uint8_t zone;                  // Zona atual do sensor após a leitura
+    bool zoneChanged;              // true se a leitura confirmou uma transição de zona
+    ZoneEvent zoneEvent;           // Transição confirmada, se zoneChanged
+    unsigned long timestampMicros; // Instante da leitura, em micros()
+};
+
+class LidarArray
+{
+  public:
+      LidarArray();
+      explicit LidarArray(I2CBus &);
+      int begin(const int *enablePins, int count, int configuration = 0);
+      int count() const { return sensorCount; }
+      bool present(int sensor) const { return sensors[sensor].present; }
+      uint8_t address(int sensor) const { return sensors[sensor].address; }
+      uint32_t readings(int sensor) const { return sensors[sensor].readings; }
+      LIDARLite &driver(int sensor) { return sensors[sensor].driver; }
+      bool latest(int sensor, LidarSample &sample) const { return sensors[sensor].output.read(sample); }
+
+      const QualityGate &quality(int sensor) const { return sensors[sensor].pipeline.quality(); }
+      const SamplePipeline &pipeline(int sensor) const { return sensors[sensor].pipeline; }
+
+      void selectFilter(FilterChainId id);
+      void configureQuality(bool readQuality, uint8_t minSignal, uint8_t rejectMask);
+      void configureZones(const Zone *zones, int count, uint16_t hysteresisCm, uint32_t dwellMicros);
+      void configureBias(BiasCorrectionMode mode, uint32_t parameter);
+      void startFreeRunning(unsigned int rateHz);
+      void stopFreeRunning();
+      bool freeRunning() const { return freeRunActive; }
+
+      bool next(LidarArrayReading &reading);
+
+  private:
+      struct Sensor
+      {
+          LIDARLite driver;
+          uint8_t address;
+          int enablePin;
+          bool present;
+          uint32_t readings;
+          SamplePipeline pipeline;
+          SamplePublisher output;
+      };
+
+      Sensor sensors[LIDAR_ARRAY_MAX_SENSORS];
+      int sensorCount;
+      int cursor;
+      bool freeRunActive;
+};
+
+#endif
@@ -0,0 +1,36 @@
+// LiveStream.h
+#ifndef LIVE_STREAM_H
+#define LIVE_STREAM_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// Número máximo de clientes simultâneos no stream ao vivo
+#define LIVE_STREAM_MAX_CLIENTS 8
+
+// Contadores do stream ao vivo, atualizados pela tarefa do stream
+struct LiveStreamStats
+{
+    uint32_t clientes;           // Clientes conectados
+    uint32_t quadrosEnviados;    // Quadros entregues a algum cliente
+    uint32_t quadrosDescartados; // Quadros descartados por cliente lento (fila cheia)
+    uint32_t taxaEfetiva;        // Quadros difundidos por segundo na última janela
+};
+
+extern LiveStreamStats liveStreamStats;
+
+/**
+ * @brief Configura o stream ao vivo de distância via WebSocket em "/ws".
+ *
+ * Uma tarefa de baixa prioridade lê a amostra mais recente publicada pela tarefa do
+ * LiDAR e a difunde, agregada (apenas a mais recente), na taxa configurada em
+ * `taxaStream` (Config.h), junto com a zona atual e a velocidade e o tempo previsto até o
+ * próximo limite (MotionEstimator.h). Cada transição de zona e cada alerta de aproximação
+ * é enviado como um quadro próprio ("evento"), sem agregação. Um cliente cuja fila de envio está
+ * cheia perde o quadro em vez de acumular mensagens.
+ *
+ * @param server Referência ao objeto AsyncWebServer ao qual o WebSocket é adicionado.
+ */
+void setupLiveStream(AsyncWebServer &server);
+
+#endif
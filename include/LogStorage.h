@@ -0,0 +1,97 @@
+/*------------------------------------------------------------------------------
+
+  LogStorage.h
+
+  Interface mínima de armazenamento usada pelo FlashLog: segmentos numerados,
+  cada um um arquivo onde só se acrescentam dados. No dispositivo é
+  implementada sobre um sistema de arquivos do Arduino (SPIFFS); no ambiente
+  nativo (`[env:native]`), sobre arquivos do host.
+
+------------------------------------------------------------------------------*/
+#ifndef LogStorage_h
+#define LogStorage_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+class LogStorage
+{
+  public:
+      virtual ~LogStorage() {}
+      virtual bool append(uint32_t segment, const uint8_t *data, size_t length) = 0;
+      virtual size_t read(uint32_t segment, size_t offset, uint8_t *data, size_t length) = 0;
+      virtual size_t size(uint32_t segment) = 0;
+      virtual bool remove(uint32_t segment) = 0;
+      // Segmentos existentes, em qualquer ordem; retorna quantos foram listados
+      virtual size_t list(uint32_t *segments, size_t maxSegments) = 0;
+};
+
+#ifndef LIDAR_NATIVE
+#include <FS.h>
+
+// Segmentos como arquivos "<dir>/<número>.seg" em um sistema de arquivos do Arduino
+class FSLogStorage : public LogStorage
+{
+  public:
+      FSLogStorage(fs::FS &fs, const char *dir) : fs(fs), dir(dir) {}
+
+      bool append(uint32_t segment, const uint8_t *data, size_t length) override
+      {
+          File file = fs.open(path(segment).c_str(), FILE_APPEND);
+          if (!file)
+          {
+              return false;
+          }
+          size_t written = file.write(data, length);
+          file.close();
+          return written == length;
+      }
+
+      size_t read(uint32_t segment, size_t offset, uint8_t *data, size_t length) override
+      {
+          File file = fs.open(path(segment).c_str(), FILE_READ);
+          if (!file || !file.seek(offset))
+          {
+              return 0;
+          }
+          size_t count = file.read(data, length);
+          file.close();
+          return count;
+      }
+
+      size_t size(uint32_t segment) override
+      {
+          File file = fs.open(path(segment).c_str(), FILE_READ);
+          size_t length = file ? file.size() : 0;
+          file.close();
+          return length;
+      }
+
+      bool remove(uint32_t segment) override { return fs.remove(path(segment).c_str()); }
+
+      // Caminho do arquivo do segmento (ex.: para enviá-lo via HTTP)
+      String path(uint32_t segment) const { return String(dir) + "/" + String(segment) + ".seg"; }
+
+      size_t list(uint32_t *segments, size_t maxSegments) override
+      {
+          size_t count = 0;
+          File root = fs.open(dir);
+          for (File file = root.openNextFile(); file && count < maxSegments; file = root.openNextFile())
+          {
+              const char *name = strrchr(file.name(), '/');
+              name = name ? name + 1 : file.name();
+              if (strstr(name, ".seg") != NULL)
+              {
+                  segments[count++] = strtoul(name, NULL, 10);
+              }
+          }
+          return count;
+      }
+
+  private:
+      fs::FS &fs;
+      const char *dir;
+};
+#endif
+
+#endif
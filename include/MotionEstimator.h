@@ -0,0 +1,123 @@
+/*------------------------------------------------------------------------------
+
+  MotionEstimator.h
+
+  Velocidade de aproximação do alvo e tempo previsto até o próximo limite de
+  zona, estimados a cada leitura aceita do sensor 0 pela tarefa de aquisição.
+
+  Modelo
+  ------------------------------------------------------------------------------
+  Filtro alfa-beta (velocidade constante) sobre a distância filtrada
+  (SamplePipeline.h), com posição, velocidade e aceleração em Q16 (cm, cm/s e
+  cm/s²) e ganhos em Q24. A aceleração não entra no modelo nem na previsão: é
+  estimada pelo atraso de uma média móvel da velocidade e apenas publicada.
+  O intervalo entre leituras vem dos instantes das amostras, de modo que a
+  velocidade continua em cm/s quando a taxa adaptativa (AdaptiveRate.h) muda o
+  período; os ganhos, como o filtro e o ZoneEngine, contam amostras. Uma
+  lacuna maior que MOTION_MAX_GAP_MICROS reinicia o rastreamento. Leituras
+  descartadas pela qualidade não atualizam a estimativa.
+
+  Tempo até o limite
+  ------------------------------------------------------------------------------
+  Com o alvo se aproximando a pelo menos `minSpeedCmPerSecond`, o limite é o
+  fim da zona mais próxima abaixo da posição estimada (a entrada nela) ou, sem
+  zona à frente, a distância 0 (tempo até o contato). O tempo é o da
+  velocidade constante: um alvo que freia até parar perto do limite ainda
+  pode disparar o alerta.
+
+  Alerta: a primeira leitura em que o tempo previsto até a entrada em uma zona
+  fica abaixo de `leadMicros`. Cada zona alerta uma vez por aproximação; o
+  alerta é rearmado quando a previsão some ou passa do dobro da antecedência.
+
+  Custo por leitura: multiplicações de 64 bits e, com previsão, uma divisão
+  de 32 bits; o inverso do intervalo só é recalculado quando o intervalo
+  muda (em ritmo fixo, quase nunca).
+
+  Um único escritor (a tarefa de aquisição); a última estimativa é publicada
+  com a mesma técnica do SamplePublisher, para leitura sem bloqueio.
+
+------------------------------------------------------------------------------*/
+#ifndef MotionEstimator_h
+#define MotionEstimator_h
+
+#include <stdint.h>
+#include <atomic>
+#include "ZoneEngine.h"
+
+// Ganhos do filtro em Q24, na relação do filtro de Kalman em regime
+// (beta = 2·(2 - alfa) - 4·sqrt(1 - alfa)); a 1 kHz, sobre a cadeia
+// mediana+EMA, erro de ~3 cm/s 0,5 s após uma mudança de velocidade
+#define MOTION_GAIN_SHIFT 24
+#define MOTION_GAIN(x) ((int64_t)((x) * (1L << MOTION_GAIN_SHIFT) + 0.5))
+#define MOTION_ALPHA MOTION_GAIN(0.02)
+#define MOTION_BETA MOTION_GAIN(0.000202025)
+
+// Média móvel da velocidade para a aceleração: 2^MOTION_ACCEL_SHIFT leituras
+#define MOTION_ACCEL_SHIFT 7
+
+// Intervalos fora desta faixa reiniciam o rastreamento (lacuna) ou são
+// limitados (instantes repetidos)
+#define MOTION_MAX_GAP_MICROS 1000000UL
+#define MOTION_MIN_DT_MICROS 100UL
+
+// Limites da estimativa, em cm/s e cm/s²
+#define MOTION_MAX_SPEED 10000
+#define MOTION_MAX_ACCELERATION 30000
+
+// Tempo até o limite, em ms, quando não há previsão
+#define MOTION_TTC_NONE 0xffff
+
+// Estimativa publicada a cada leitura aceita (16 bytes)
+struct MotionState
+{
+    uint32_t sequence;          // Sequência da amostra (LidarSample) que produziu a estimativa
+    uint32_t timestampMicros;   // Instante da amostra
+    int16_t velocity;           // cm/s, negativa com o alvo se aproximando
+    int16_t acceleration;       // cm/s²
+    uint16_t timeToThresholdMs; // Tempo previsto até o limite, MOTION_TTC_NONE sem previsão
+    uint8_t targetZone;         // Zona cuja entrada foi prevista, 0 para o contato
+    uint8_t alert;              // 1 na leitura que disparou o alerta
+};
+
+class MotionEstimator
+{
+  public:
+      MotionEstimator();
+      void configure(const Zone *zones, int count, uint32_t leadMicros, uint16_t minSpeedCmPerSecond);
+      void reset() { tracking = false; }
+      bool update(uint32_t sequence, uint32_t timestampMicros, int filteredDistance, bool accepted, MotionState &state);
+
+      bool read(MotionState &state) const;
+      uint32_t alerts() const { return alertCount.load(std::memory_order_relaxed); }
+
+  private:
+      void predictThreshold(MotionState &state);
+      void publish(const MotionState &state);
+
+      // Configuração
+      Zone zoneList[ZONE_MAX];
+      int zoneCount;
+      uint32_t lead;
+      int32_t minSpeed;     // Q16 cm/s
+
+      // Estado do filtro
+      bool tracking;
+      uint32_t lastMicros;
+      int64_t position;     // Q16 cm
+      int32_t velocity;     // Q16 cm/s
+      int32_t slowVelocity; // Média móvel da velocidade, Q16 cm/s
+      int32_t acceleration; // Q16 cm/s²
+      uint32_t cachedDt;    // Intervalo do inverso em cache, em µs
+      uint32_t dtQ20;       // Intervalo em s, Q20
+      uint32_t inverse;     // 1/intervalo, em 1/s, Q10
+      uint8_t alertedZone;  // Zona já alertada na aproximação atual
+      MotionState current;
+
+      // Publicação
+      static const int WORDS = sizeof(MotionState) / sizeof(uint32_t);
+      std::atomic<uint32_t> version;
+      std::atomic<uint32_t> words[WORDS];
+      std::atomic<uint32_t> alertCount;
+};
+
+#endif
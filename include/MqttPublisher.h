@@ -0,0 +1,61 @@
+// MqttPublisher.h
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <Arduino.h>
+
+// Limites do lote de amostras por mensagem
+#define MQTT_MAX_LOTE 256
+// Bytes aguardando envio na outbox do cliente acima dos quais a publicação é
+// adiada (as amostras continuam no buffer circular)
+#define MQTT_OUTBOX_MAX (32 * 1024)
+// Intervalo entre mensagens de saúde, em ms
+#define MQTT_INTERVALO_SAUDE 10000
+// Registro em flash durante quedas do enlace (após uma conexão): 24 segmentos
+// de 16 KB (384 KB). O SPIFFS da partição padrão tem 1,375 MB, ~1,2 MB úteis,
+// divididos com os arquivos da página e o trace (/trace), que usa o restante
+#define MQTT_REGISTRO_SEGMENTO 16384
+#define MQTT_REGISTRO_SEGMENTOS 24
+#define MQTT_REGISTRO_BYTES ((size_t)MQTT_REGISTRO_SEGMENTO * MQTT_REGISTRO_SEGMENTOS)
+// Registros retirados da flash por ciclo de 10 ms após a reconexão (cada um com
+// até FLASH_LOG_BATCH amostras), para que o tráfego ao vivo continue fluindo
+#define MQTT_REGISTRO_POR_CICLO 1
+
+// Contadores do publicador MQTT, atualizados pela tarefa do MQTT
+struct MqttStats
+{
+    uint32_t conectado;          // 1 se conectado ao broker
+    uint32_t reconexoes;         // Conexões estabelecidas desde a inicialização
+    uint32_t mensagensEnviadas;  // Mensagens entregues (QoS 0: enviadas ao socket; QoS 1: confirmadas)
+    uint32_t amostrasEnviadas;   // Amostras nas mensagens entregues
+    uint32_t eventosEnviados;    // Transições de zona publicadas
+    uint32_t amostrasPerdidas;   // Amostras sobrescritas no buffer antes de serem publicadas
+    uint32_t publicacoesAdiadas; // Lotes adiados por desconexão ou outbox cheia
+    uint32_t taxaMensagens;      // Mensagens entregues por segundo na última janela
+    uint32_t taxaAmostras;       // Amostras entregues por segundo na última janela
+    uint32_t registroSegmentos;  // Segmentos do registro em flash aguardando envio
+    uint32_t registroGravados;   // Bytes gravados no registro em flash
+    uint32_t registroDescartados; // Segmentos descartados por falta de espaço
+};
+
+extern MqttStats mqttStats;
+
+/**
+ * @brief Inicia a tarefa de publicação MQTT.
+ *
+ * A tarefa conecta ao broker em `ipServidor`:`portaServidor` usando `token`
+ * como usuário (Config.h) e publica, sob "lidar/<id do dispositivo>/":
+ * - "amostras": lotes de amostras no formato binário de SampleCodec.h, com até
+ *   `mqttLote` amostras, enviados quando o lote enche ou a cada `mqttIntervalo` ms;
+ * - "zonas": cada transição de zona e cada alerta de aproximação ("tipo"), em JSON;
+ * - "saude": contadores de aquisição e de rede, em JSON, retida.
+ *
+ * As mensagens são enfileiradas na outbox do cliente esp-mqtt, cuja tarefa faz o
+ * envio e a reconexão automática com prioridade 1, abaixo da tarefa do LiDAR.
+ * Enquanto desconectado, as amostras e transições são gravadas no registro em
+ * flash (FlashLog.h, SPIFFS em "/log") e, na reconexão, publicadas do mais
+ * antigo para o mais recente, em ritmo limitado, depois do tráfego ao vivo.
+ */
+void setupMqttPublisher();
+
+#endif
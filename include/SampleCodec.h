@@ -0,0 +1,97 @@
+/*------------------------------------------------------------------------------
+
+  SampleCodec.h
+
+  Formato binário compacto para lotes de amostras do LiDAR, usado pela
+  exportação HTTP e por qualquer transporte de stream. O mesmo código compila
+  no dispositivo (codificador) e no host, em [env:native] (decodificador).
+
+  Quadro (inteiros multibyte em little-endian)
+  ------------------------------------------------------------------------------
+  Cabeçalho (20 bytes):
+    0  'L' 'S'         assinatura
+    2  versão          SAMPLE_CODEC_VERSION
+    3  flags           bit 0: canal de força do sinal; bit 1: canal de status;
+                       bit 2: canal de zona
+    4  deviceId        u32
+    8  baseSequence    u32, sequência da primeira amostra
+    12 baseTimestamp   u32, micros() da primeira amostra
+    16 count           u16, número de amostras
+    18 reservado       u16
+  Corpo, por amostra (varints LEB128; "zz" = zigzag para valores com sinal):
+    varint   saltos de sequência (seq - seqAnterior - 1; 0 se consecutiva)
+    zz       delta do timestamp em relação à amostra anterior
+    zz       delta da distância bruta em relação à amostra anterior
+    zz       distância filtrada - distância bruta
+    zz       delta da força do sinal            (se flags bit 0)
+    byte     status                             (se flags bit 1)
+    byte     zona                               (se flags bit 2)
+  Rodapé:
+    u32      CRC-32 (IEEE 802.3) do cabeçalho e do corpo
+
+------------------------------------------------------------------------------*/
+#ifndef SampleCodec_h
+#define SampleCodec_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SamplePublisher.h"
+
+#define SAMPLE_CODEC_VERSION 1
+#define SAMPLE_CODEC_HEADER_SIZE 20
+#define SAMPLE_CODEC_CRC_SIZE 4
+
+#define SAMPLE_CODEC_SIGNAL 0x01
+#define SAMPLE_CODEC_STATUS 0x02
+#define SAMPLE_CODEC_ZONE 0x04
+
+// Pior caso de uma amostra codificada: 5 + 5 + 3 + 3 + 2 + 1 + 1 bytes
+#define SAMPLE_CODEC_MAX_SAMPLE_SIZE 20
+
+// Tamanho máximo de um quadro com n amostras
+#define SAMPLE_CODEC_FRAME_SIZE(n) \
+    (SAMPLE_CODEC_HEADER_SIZE + (n) * SAMPLE_CODEC_MAX_SAMPLE_SIZE + SAMPLE_CODEC_CRC_SIZE)
+
+enum SampleCodecError
+{
+    SAMPLE_CODEC_OK = 0,
+    SAMPLE_CODEC_TRUNCATED,   // Quadro menor que o indicado pelo cabeçalho
+    SAMPLE_CODEC_BAD_MAGIC,   // Assinatura ou versão desconhecida
+    SAMPLE_CODEC_BAD_CRC,     // CRC não confere
+    SAMPLE_CODEC_OVERFLOW     // Destino menor que o número de amostras do quadro
+};
+
+struct SampleFrameInfo
+{
+    uint32_t deviceId;
+    uint8_t flags;
+    uint16_t count;
+    size_t frameSize; // Bytes consumidos do buffer, incluindo o CRC
+};
+
+class SampleEncoder
+{
+  public:
+      SampleEncoder(uint8_t *buffer, size_t capacity, uint32_t deviceId, uint8_t flags);
+      bool add(const LidarSample &sample);
+      size_t finish();
+      uint16_t count() const { return sampleCount; }
+
+  private:
+      void putVarint(uint32_t value);
+      void putZigzag(int32_t value);
+
+      uint8_t *out;
+      size_t capacity;
+      size_t pos;
+      uint8_t flags;
+      uint16_t sampleCount;
+      LidarSample previous;
+};
+
+SampleCodecError decodeSampleFrame(const uint8_t *data, size_t length, LidarSample *out,
+                                   size_t maxSamples, SampleFrameInfo &info);
+
+uint32_t sampleCodecCrc32(const uint8_t *data, size_t length);
+
+#endif
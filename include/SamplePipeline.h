@@ -0,0 +1,63 @@
+/*------------------------------------------------------------------------------
+
+  SamplePipeline.h
+
+  Processamento de cada leitura de um sensor, depois da aquisição: classificação
+  da qualidade (QualityGate), filtro (FilterBank) e zonas (ZoneEngine). O mesmo
+  código roda na tarefa de aquisição, por meio do LidarArray, e no host, na
+  reprodução de traces gravados (Trace.h), de modo que uma sequência de
+  leituras brutas produz exatamente as mesmas saídas nos dois ambientes.
+
+  Uma leitura descartada pela qualidade não passa pelo filtro (a distância
+  filtrada repete a da última aceita) nem pelas zonas, e não deve ser entregue
+  à saída analógica (AnalogOutput.h).
+
+  O estado inteiro do pipeline é composto por inteiros de tamanho fixo e pode
+  ser copiado byte a byte (ver TraceRecorder), inclusive entre o ESP32 e o
+  host.
+
+------------------------------------------------------------------------------*/
+#ifndef SamplePipeline_h
+#define SamplePipeline_h
+
+#include <stdint.h>
+#include "FilterBank.h"
+#include "SignalQuality.h"
+#include "ZoneEngine.h"
+
+// Resultado do processamento de uma leitura
+struct PipelineOutput
+{
+    int filteredDistance; // Distância após o filtro, em cm
+    SignalQuality quality;
+    bool accepted;        // false se descartada pelo QualityGate
+    uint8_t zone;         // Zona atual após a leitura
+    bool zoneChanged;     // true se a leitura confirmou uma transição de zona
+    ZoneEvent zoneEvent;  // Transição confirmada, se zoneChanged
+};
+
+class SamplePipeline
+{
+  public:
+      SamplePipeline();
+      void selectFilter(FilterChainId id) { filters.select(id); }
+      void configureQuality(uint8_t minSignal, uint8_t rejectMask) { gate.configure(minSignal, rejectMask); }
+      void configureZones(const Zone *zones, int count, uint16_t hysteresisCm, uint32_t dwellMicros)
+      {
+          zoneEngine.configure(zones, count, hysteresisCm, dwellMicros);
+      }
+
+      void process(uint32_t timestampMicros, int distance, int signalStrength, int status, PipelineOutput &out);
+
+      const QualityGate &quality() const { return gate; }
+      uint8_t zone() const { return zoneEngine.current(); }
+      int lastFiltered() const { return filtered; }
+
+  private:
+      QualityGate gate;
+      FilterBank filters;
+      ZoneEngine zoneEngine;
+      int32_t filtered;
+};
+
+#endif
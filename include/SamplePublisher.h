@@ -0,0 +1,52 @@
+/*------------------------------------------------------------------------------
+
+  SamplePublisher.h
+
+  Publicação sem bloqueio da amostra mais recente do LiDAR (seqlock).
+
+  Um único escritor (a tarefa do LiDAR) publica registros completos de amostra;
+  qualquer número de leitores (loop(), handlers HTTP) copia o registro sem nunca
+  bloquear o escritor. O contador de versão fica ímpar durante a escrita; o
+  leitor repete a cópia se a versão mudou ou estava ímpar. A publicação é
+  wait-free; a leitura desiste após algumas tentativas e retorna false.
+
+------------------------------------------------------------------------------*/
+#ifndef SamplePublisher_h
+#define SamplePublisher_h
+
+#include <stdint.h>
+#include <atomic>
+
+// Registro de uma amostra do LiDAR (16 bytes)
+struct LidarSample
+{
+    uint32_t sequence;         // Número de sequência, incrementado a cada amostra
+    uint32_t timestampMicros;  // Instante da leitura, em micros()
+    uint16_t rawDistance;      // Distância lida do sensor, em cm
+    uint16_t filteredDistance; // Distância após o filtro, em cm
+    uint8_t signalStrength;    // Força do sinal (registro 0x0e), 0 se não lida
+    uint8_t status;            // Registro de status do sensor (0x01), 0 se não lido
+    uint8_t zone;              // Zona atual (ZoneEngine.h), 0 fora de todas as zonas
+    uint8_t sensor : 4;        // Índice do sensor (LidarArray.h), 0 com um único sensor
+    uint8_t quality : 4;       // SignalQuality (SignalQuality.h), 0 = válida
+};
+
+// Número máximo de tentativas de leitura concorrente com o escritor
+#define SAMPLE_READ_RETRIES 8
+
+class SamplePublisher
+{
+  public:
+      SamplePublisher();
+      void publish(const LidarSample &sample);
+      bool read(LidarSample &sample) const;
+      uint32_t sequence() const;
+
+  private:
+      static const int WORDS = sizeof(LidarSample) / sizeof(uint32_t);
+
+      std::atomic<uint32_t> version;
+      std::atomic<uint32_t> words[WORDS];
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*------------------------------------------------------------------------------
+
+  SampleRing.h
+
+  Buffer circular de amostras do LiDAR, preenchido pela tarefa de aquisição e
+  lido em lote pelos consumidores (ex.: GET /samples?since=N).
+
+  Há um único escritor, que sobrescreve as amostras mais antigas sem nunca
+  esperar pelos leitores. Os leitores não consomem as amostras: cada um pede as
+  amostras posteriores a um número de sequência. Cada posição guarda a
+  sequência da amostra que contém; o leitor confere essa sequência antes e
+  depois da cópia e descarta a posição se o escritor a sobrescreveu, sinalizando
+  overrun. Assim nenhum lado bloqueia o outro.
+
+------------------------------------------------------------------------------*/
+#ifndef SampleRing_h
+#define SampleRing_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "SamplePublisher.h"
+
+// Profundidade padrão do buffer (potência de 2): ~3 s a 1,3 kHz, 64 KB
+#define SAMPLE_RING_DEPTH 4096
+#define SAMPLE_RING_MIN_DEPTH 256
+#define SAMPLE_RING_MAX_DEPTH 8192
+
+class SampleRing
+{
+  public:
+      SampleRing();
+      ~SampleRing();
+      bool begin(size_t depth = SAMPLE_RING_DEPTH);
+      void push(const LidarSample &sample);
+      size_t readSince(uint32_t since, LidarSample *out, size_t maxSamples, bool &overrun) const;
+      uint32_t lastSequence() const { return last.load(std::memory_order_acquire); }
+      size_t capacity() const { return slotCount; }
+
+  private:
+      static const int WORDS = sizeof(LidarSample) / sizeof(uint32_t);
+
+      struct Slot
+      {
+          std::atomic<uint32_t> words[WORDS]; // words[0] é a sequência da amostra
+      };
+
+      Slot *slots;
+      size_t slotCount;
+      size_t mask;
+      std::atomic<uint32_t> last;
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*------------------------------------------------------------------------------
+
+  SamplingScheduler.h
+
+  Contabilidade da amostragem em ritmo fixo. Um temporizador de hardware
+  notifica a tarefa de aquisição a cada período (main.cpp); a tarefa chama
+  wake() ao acordar, com o instante e o número de notificações acumuladas, e
+  lê as medições prontas de todos os sensores antes de esperar de novo.
+
+  - Jitter: desvio absoluto entre o intervalo de dois despertares e o período
+    alvo, em µs, em um histograma log-linear (JitterHistogram).
+  - Overrun: períodos que não entregaram leitura nova. São as notificações
+    acumuladas além da primeira (a tarefa ainda tratava o período anterior)
+    e os despertares sem leitura.
+  - Despertares sem leitura: nenhum sensor tinha medição pronta no período (a
+    taxa alvo excede a dos sensores). Também contam como overrun, para que uma
+    taxa alvo inatingível apareça nas métricas e não só na taxa efetiva.
+
+  Cada período entrega a medição disparada no período anterior: com a taxa
+  alvo abaixo da taxa máxima do sensor, a medição termina antes do próximo
+  despertar e o instante de cada leitura fica preso ao temporizador.
+
+  Um único escritor (a tarefa de aquisição) e leitores sem bloqueio (servidor
+  HTTP), como em AcquisitionMetrics.h. configure() zera as estatísticas;
+  retarget() troca apenas o período (taxa adaptativa, AdaptiveRate.h) e o
+  intervalo seguinte, que mistura os dois períodos, não entra no jitter.
+
+------------------------------------------------------------------------------*/
+#ifndef SamplingScheduler_h
+#define SamplingScheduler_h
+
+#include <stdint.h>
+#include <atomic>
+
+// Faixas de 1 µs abaixo de JITTER_LINEAR_LIMIT e JITTER_SUB_BUCKETS faixas por
+// potência de 2 acima dele (erro relativo de até 1/8); desvios a partir de
+// 2^JITTER_MAX_SHIFT µs caem na última faixa
+#define JITTER_LINEAR_SHIFT 5
+#define JITTER_LINEAR_LIMIT (1UL << JITTER_LINEAR_SHIFT)
+#define JITTER_SUB_SHIFT 3
+#define JITTER_SUB_BUCKETS (1UL << JITTER_SUB_SHIFT)
+#define JITTER_MAX_SHIFT 20
+#define JITTER_BUCKETS (JITTER_LINEAR_LIMIT + (JITTER_MAX_SHIFT - JITTER_LINEAR_SHIFT) * JITTER_SUB_BUCKETS)
+
+class JitterHistogram
+{
+  public:
+      JitterHistogram();
+
+      void record(uint32_t micros)
+      {
+          uint32_t index = indexOf(micros);
+          buckets[index].store(buckets[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          if (micros > maxMicros.load(std::memory_order_relaxed))
+          {
+              maxMicros.store(micros, std::memory_order_relaxed);
+          }
+      }
+
+      uint32_t samples() const;
+      uint32_t quantile(float q) const;
+      uint32_t maximum() const { return maxMicros.load(std::memory_order_relaxed); }
+      void reset();
+
+      static uint32_t indexOf(uint32_t micros)
+      {
+          if (micros < JITTER_LINEAR_LIMIT)
+          {
+              return micros;
+          }
+          uint32_t msb = 31 - __builtin_clz(micros);
+          if (msb >= JITTER_MAX_SHIFT)
+          {
+              return JITTER_BUCKETS - 1;
+          }
+          uint32_t sub = (micros >> (msb - JITTER_SUB_SHIFT)) & (JITTER_SUB_BUCKETS - 1);
+          return JITTER_LINEAR_LIMIT + (msb - JITTER_LINEAR_SHIFT) * JITTER_SUB_BUCKETS + sub;
+      }
+
+      // Maior desvio contado na faixa, em µs
+      static uint32_t upperBound(uint32_t index);
+
+  private:
+      std::atomic<uint32_t> buckets[JITTER_BUCKETS];
+      std::atomic<uint32_t> maxMicros;
+};
+
+class SamplingScheduler
+{
+  public:
+      SamplingScheduler();
+      void configure(uint32_t targetHz);
+      void retarget(uint32_t targetHz);
+      void wake(uint32_t nowMicros, uint32_t notifications);
+      void idleWake();
+
+      bool paced() const { return targetHz() != 0; }
+      uint32_t targetHz() const { return targetRate.load(std::memory_order_relaxed); }
+      uint32_t periodMicros() const { return period.load(std::memory_order_relaxed); }
+      uint32_t wakes() const { return wakeCount.load(std::memory_order_relaxed); }
+      uint32_t overruns() const { return overrunCount.load(std::memory_order_relaxed); }
+      uint32_t idleWakes() const { return idleCount.load(std::memory_order_relaxed); }
+      const JitterHistogram &jitter() const { return histogram; }
+
+  private:
+      std::atomic<uint32_t> targetRate;
+      std::atomic<uint32_t> period;
+      std::atomic<uint32_t> wakeCount;
+      std::atomic<uint32_t> overrunCount;
+      std::atomic<uint32_t> idleCount;
+      JitterHistogram histogram;
+      uint32_t lastWake;
+      bool skipInterval;
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*------------------------------------------------------------------------------
+
+  SignalQuality.h
+
+  Classificação da qualidade de cada leitura do LIDAR-Lite v3HP a partir da
+  força do sinal (registro 0x0e, pico da correlação) e do registro de status
+  (0x01), e descarte configurável das leituras ruins antes do filtro e da
+  saída analógica.
+
+  Classes
+  ------------------------------------------------------------------------------
+  SIGNAL_VALID:     leitura aceitável.
+  SIGNAL_WEAK:      força do sinal abaixo de minSignal (alvo distante, pouco
+                    refletivo ou óptica suja); a distância é pouco confiável.
+  SIGNAL_SATURATED: sinal saturado (bit 2 de 0x01 ou força em 0xff), comum com
+                    alvos muito próximos ou retrorrefletores.
+  SIGNAL_NO_RETURN: pico não detectado (bit 3 de 0x01) ou distância 0; o valor
+                    lido não corresponde a um alvo.
+
+  Sem a leitura da força do sinal (-1) e do status (-1), toda leitura é válida.
+
+------------------------------------------------------------------------------*/
+#ifndef SignalQuality_h
+#define SignalQuality_h
+
+#include <stdint.h>
+
+enum SignalQuality
+{
+    SIGNAL_VALID = 0,
+    SIGNAL_WEAK = 1,
+    SIGNAL_SATURATED = 2,
+    SIGNAL_NO_RETURN = 3,
+    SIGNAL_QUALITY_COUNT
+};
+
+// Bits do registro de status (0x01) usados na classificação
+#define SIGNAL_STATUS_OVERFLOW 0x04
+#define SIGNAL_STATUS_INVALID 0x08
+
+// Máscaras de descarte: bit q ligado descarta a classe q
+#define SIGNAL_REJECT_NONE 0
+#define SIGNAL_REJECT_NO_RETURN (1 << SIGNAL_NO_RETURN)
+
+class QualityGate
+{
+  public:
+      QualityGate();
+      void configure(uint8_t minSignal, uint8_t rejectMask);
+      SignalQuality classify(int distance, int signalStrength, int status) const;
+      bool accept(SignalQuality quality);
+
+      uint32_t count(SignalQuality quality) const { return counts[quality]; }
+      uint32_t rejected() const { return rejectedCount; }
+      void resetCounts();
+
+  private:
+      uint8_t minimumSignal;
+      uint8_t rejectQualities;
+      uint32_t counts[SIGNAL_QUALITY_COUNT];
+      uint32_t rejectedCount;
+};
+
+#endif
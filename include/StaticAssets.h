@@ -0,0 +1,50 @@
+// StaticAssets.h
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// Número máximo de arquivos listados em /assets.idx
+#define STATIC_ASSETS_MAX 16
+
+// Arquivo embutido na firmware por tools/compress_assets.py (EmbeddedAssets.h)
+struct EmbeddedAsset
+{
+    const char *path;
+    const char *contentType;
+    bool gzip;
+    const char *etag;
+    const uint8_t *data;
+    size_t length;
+};
+
+// Contadores do servidor de arquivos estáticos
+struct StaticAssetStats
+{
+    uint32_t respostas;       // Respostas 200 com o conteúdo
+    uint32_t naoModificados;  // Respostas 304 (ETag conferiu)
+    uint32_t bytesEnviados;   // Bytes de conteúdo enviados nas respostas 200
+};
+
+extern StaticAssetStats staticAssetStats;
+
+/**
+ * @brief Configura as rotas das páginas e dos arquivos estáticos da interface web.
+ *
+ * Os arquivos são preparados na build por tools/compress_assets.py: comprimidos
+ * com gzip, com um ETag forte cada, e os menores embutidos na firmware (PROGMEM);
+ * os demais ficam no SPIFFS, descritos em /assets.idx. As respostas levam
+ * `Content-Encoding: gzip` e `ETag`; uma requisição com `If-None-Match` igual ao
+ * ETag recebe 304 sem corpo. As páginas HTML são revalidadas a cada acesso
+ * (`no-cache`); CSS e fontes ficam em cache por 10 minutos.
+ *
+ * Sem /assets.idx (imagem do SPIFFS gravada sem a etapa de build), os arquivos
+ * são servidos do SPIFFS sem compressão nem ETag, como antes. Deve ser chamada
+ * depois de montar o SPIFFS.
+ *
+ * @param server Referência ao objeto AsyncWebServer ao qual as rotas são adicionadas.
+ */
+void setupStaticAssets(AsyncWebServer &server);
+
+#endif
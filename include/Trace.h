@@ -0,0 +1,154 @@
+/*------------------------------------------------------------------------------
+
+  Trace.h
+
+  Gravação das leituras brutas do sensor 0 para reprodução determinística do
+  processamento (SamplePipeline.h) no host. Um trace gravado em campo é
+  reproduzido em [env:native] pelo mesmo código de qualidade, filtro e zonas,
+  na velocidade máxima do host, e cada saída reproduzida é
+  comparada bit a bit com a gravada pelo dispositivo.
+
+  Arquivo (inteiros multibyte em little-endian)
+  ------------------------------------------------------------------------------
+  Cabeçalho (16 bytes):
+    0  'L' 'T'         assinatura
+    2  versão          TRACE_VERSION
+    3  flags           bit 0: leitura de qualidade ativa (força do sinal e status)
+    4  deviceId        u32
+    8  firstSequence   u32, sequência da primeira amostra gravada
+    12 stateSize       u16, sizeof(SamplePipeline) no dispositivo
+    14 reservado       u16
+  Estado: cópia byte a byte do SamplePipeline antes da primeira amostra
+  (filtros, zonas e limites já configurados), stateSize bytes.
+  Quadros de SampleCodec.h até o fim do arquivo, com as amostras publicadas:
+  entradas (timestamp, distância bruta, força do sinal, status) e saídas
+  (distância filtrada, zona). Sem a leitura de qualidade os quadros não têm
+  os canais de sinal e de status, que voltam como -1 na reprodução.
+
+  Gravação
+  ------------------------------------------------------------------------------
+  - start() e stop() (servidor HTTP) pedem o início e o fim da gravação.
+  - service() (tarefa de aquisição, entre duas leituras) copia o estado do
+    pipeline e a sequência da próxima amostra; a tarefa continua sem esperar.
+  - drain() (tarefa de menor prioridade) retira as amostras do SampleRing,
+    monta os quadros em uma página em RAM e grava a página inteira, como o
+    FlashLog.
+  A gravação termina ao atingir o limite de amostras, com stop(), quando a
+  configuração do pipeline muda (limit(), chamada pela tarefa de aquisição:
+  as amostras seguintes já usam outro estado) ou quando o SampleRing
+  sobrescreve amostras ainda não gravadas: um trace nunca tem lacunas.
+
+------------------------------------------------------------------------------*/
+#ifndef Trace_h
+#define Trace_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "LogStorage.h"
+#include "SampleCodec.h"
+#include "SamplePipeline.h"
+#include "SampleRing.h"
+
+#define TRACE_VERSION 2
+#define TRACE_HEADER_SIZE 16
+#define TRACE_QUALITY_READ 0x01
+
+// Segmento do LogStorage que contém o trace
+#define TRACE_SEGMENT 0
+// Bytes por amostra usados para estimar o espaço de uma gravação (~8,7 medidos
+// com a leitura de qualidade e ruído de poucos cm; o pior caso do quadro é 20)
+#define TRACE_BYTES_PER_SAMPLE 10
+
+// Amostras por quadro e página gravada de uma vez
+#define TRACE_BATCH 64
+#define TRACE_PAGE_SIZE 2048
+
+enum TraceState
+{
+    TRACE_IDLE = 0,
+    TRACE_REQUESTED, // Aguardando service() na tarefa de aquisição
+    TRACE_ARMED,     // Estado copiado, aguardando drain() gravar o cabeçalho
+    TRACE_RECORDING
+};
+
+enum TraceEnd
+{
+    TRACE_END_NONE = 0,
+    TRACE_END_STOPPED,     // stop()
+    TRACE_END_LIMIT,       // Limite de amostras atingido
+    TRACE_END_CONFIG,      // Configuração do pipeline alterada
+    TRACE_END_OVERRUN,     // Amostras sobrescritas no SampleRing antes de gravadas
+    TRACE_END_WRITE_ERROR  // Escrita recusada pelo armazenamento
+};
+
+class TraceRecorder
+{
+  public:
+      TraceRecorder();
+      void begin(LogStorage &storage, uint32_t deviceId);
+      bool start(uint32_t maxSamples);
+      void stop() { stopRequested.store(true, std::memory_order_release); }
+      bool pending() const { return recorderState.load(std::memory_order_acquire) == TRACE_REQUESTED; }
+      bool active() const { return recorderState.load(std::memory_order_acquire) != TRACE_IDLE; }
+      void service(const SamplePipeline &pipeline, bool qualityRead, uint32_t nextSequence);
+      void limit(uint32_t nextSequence);
+      void drain(const SampleRing &ring);
+
+      TraceState state() const { return (TraceState)recorderState.load(std::memory_order_acquire); }
+      TraceEnd endReason() const { return (TraceEnd)lastEnd.load(std::memory_order_relaxed); }
+      uint32_t samples() const { return recorded.load(std::memory_order_relaxed); }
+      uint32_t bytes() const { return written.load(std::memory_order_relaxed); }
+
+  private:
+      void writeHeader();
+      void addFrame(const LidarSample *samples, size_t count);
+      bool writePage();
+      void finish(TraceEnd reason);
+
+      LogStorage *storage;
+      uint32_t deviceId;
+      std::atomic<int> recorderState;
+      std::atomic<int> lastEnd;
+      std::atomic<bool> stopRequested;
+      std::atomic<uint32_t> endSequence; // Primeira sequência fora do trace (0 = sem limite)
+      std::atomic<uint32_t> recorded;
+      std::atomic<uint32_t> written;
+      uint32_t maxSamples;
+      uint32_t firstSequence;
+      uint32_t lastSequence;
+      uint8_t flags;
+      uint8_t pipelineState[sizeof(SamplePipeline)]; // Cópia do pipeline antes da primeira amostra
+      uint8_t page[TRACE_PAGE_SIZE];
+      size_t pageUsed;
+      LidarSample batch[TRACE_BATCH];
+};
+
+enum TraceError
+{
+    TRACE_OK = 0,
+    TRACE_BAD_HEADER,     // Assinatura, versão ou tamanho do estado incompatíveis
+    TRACE_BAD_FRAME,      // Quadro truncado ou com CRC inválido
+    TRACE_GAP             // Sequência não consecutiva entre amostras
+};
+
+struct TraceReplayResult
+{
+    TraceError error;
+    uint32_t deviceId;
+    uint32_t samples;        // Amostras reproduzidas
+    uint32_t mismatches;     // Amostras cuja distância filtrada ou zona difere da gravada
+    uint32_t firstMismatch;  // Sequência da primeira divergência (0 se nenhuma)
+    uint32_t zoneEvents;     // Transições de zona na reprodução
+    uint32_t rejected;       // Leituras descartadas pela qualidade na reprodução
+    uint32_t durationMicros; // Intervalo coberto pelo trace, em micros() do dispositivo
+};
+
+// Chamada com o pipeline restaurado, antes da primeira amostra: permite avaliar
+// uma alteração (ex.: outra cadeia de filtros) sobre o mesmo trace
+typedef void (*TraceReplayHook)(SamplePipeline &pipeline);
+
+bool replayTrace(const uint8_t *data, size_t length, TraceReplayResult &result,
+                 TraceReplayHook hook = NULL);
+
+#endif
@@ -0,0 +1,109 @@
+/*------------------------------------------------------------------------------
+
+  ZoneEngine.h
+
+  Classificação da distância em zonas, avaliada a cada amostra pela tarefa do
+  LiDAR. Os consumidores (stream ao vivo, HTTP) recebem a zona atual em cada
+  amostra e as transições como eventos com timestamp, em vez de precisarem
+  amostrar a distância rápido o bastante para percebê-las.
+
+  Regras
+  ------------------------------------------------------------------------------
+  - Até ZONE_MAX zonas [início, fim) em cm, numeradas a partir de 1; a zona 0
+    significa fora de todas as zonas. Zonas com início >= fim são ignoradas e,
+    se houver sobreposição, vale a de menor número.
+  - Entrada: a distância precisa estar dentro dos limites da zona.
+  - Saída (histerese): a zona atual só é deixada quando a distância se afasta
+    mais de `hysteresisCm` dos seus limites.
+  - Permanência mínima: a distância precisa se manter fora da zona atual por
+    `dwellMicros` antes da transição ser confirmada; oscilações mais curtas são
+    ignoradas. A nova zona é a da amostra que confirma a transição.
+
+  ZoneEventRing guarda as últimas transições com a mesma técnica do
+  SampleRing (sequência por posição, um escritor, leitores sem bloqueio). No
+  anel global (Global.h) elas se intercalam com os alertas de aproximação do
+  MotionEstimator (type = ZONE_EVENT_APPROACH), que antecipam a transição para
+  toZone sem mudar a zona atual; a tarefa de aquisição numera os dois tipos.
+  Os consumidores só atualizam a ocupação com ZONE_EVENT_TRANSITION.
+
+------------------------------------------------------------------------------*/
+#ifndef ZoneEngine_h
+#define ZoneEngine_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define ZONE_MAX 8
+#define ZONE_NONE 0
+
+// Número de transições guardadas para os consumidores (potência de 2)
+#define ZONE_EVENT_DEPTH 32
+
+struct Zone
+{
+    uint16_t startCm;
+    uint16_t endCm;
+};
+
+// Tipo do evento, definido por quem o produz
+#define ZONE_EVENT_TRANSITION 0 // Transição confirmada pelo ZoneEngine
+#define ZONE_EVENT_APPROACH 1   // Previsão do MotionEstimator: a zona não mudou
+
+// Transição de zona ou alerta de aproximação (20 bytes)
+struct ZoneEvent
+{
+    uint32_t sequence;        // Número do evento, a partir de 1
+    uint32_t timestampMicros; // Instante da amostra que confirmou a transição
+    uint8_t fromZone;
+    uint8_t toZone;
+    uint16_t distance;        // Distância da amostra que confirmou a transição, em cm
+    int16_t velocity;         // Velocidade estimada na amostra (MotionEstimator.h), em cm/s
+    uint16_t leadMillis;      // Alerta: tempo previsto até a entrada em toZone, em ms (>= 1); 0 em transições
+    uint8_t type;             // ZONE_EVENT_TRANSITION ou ZONE_EVENT_APPROACH
+    uint8_t reserved[3];
+};
+
+class ZoneEngine
+{
+  public:
+      ZoneEngine();
+      void configure(const Zone *zones, int count, uint16_t hysteresisCm, uint32_t dwellMicros);
+      bool update(uint16_t distance, uint32_t timestampMicros, ZoneEvent &event);
+      uint8_t current() const { return currentZone; }
+      uint8_t classify(uint16_t distance) const;
+
+  private:
+      bool contains(uint8_t zone, uint16_t distance, uint16_t margin) const;
+
+      Zone zoneList[ZONE_MAX];
+      int zoneCount;
+      uint16_t hysteresis;
+      uint32_t dwell;
+      uint8_t currentZone;
+      bool leaving;
+      uint32_t pendingSinceMicros;
+      uint32_t eventSequence;
+};
+
+class ZoneEventRing
+{
+  public:
+      ZoneEventRing();
+      void push(const ZoneEvent &event);
+      size_t readSince(uint32_t since, ZoneEvent *out, size_t maxEvents) const;
+      uint32_t lastSequence() const { return last.load(std::memory_order_acquire); }
+
+  private:
+      static const int WORDS = sizeof(ZoneEvent) / sizeof(uint32_t);
+
+      struct Slot
+      {
+          std::atomic<uint32_t> words[WORDS]; // words[0] é a sequência do evento
+      };
+
+      Slot slots[ZONE_EVENT_DEPTH];
+      std::atomic<uint32_t> last;
+};
+
+#endif
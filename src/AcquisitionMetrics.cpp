@@ -0,0 +1,80 @@
+// AcquisitionMetrics.cpp
+#include "AcquisitionMetrics.h"
+
+const char *const metricsStageNames[METRICS_STAGE_COUNT] = {
+    "command", "busy_poll", "result_read", "filter", "dac", "publish", "sample_interval",
+    "output_interval", "wake_latency", "motion"};
+
+LatencyHistogram acquisitionMetrics[METRICS_STAGE_COUNT];
+
+#ifndef LIDAR_NATIVE
+uint32_t metricsCpuMHz = 240;
+#endif
+
+/**
+ * @brief Lê a frequência da CPU, que converte ciclos em µs. Chamar no setup(),
+ *        antes de iniciar a tarefa de aquisição.
+ */
+void metricsBegin()
+{
+#ifndef LIDAR_NATIVE
+    metricsCpuMHz = getCpuFreqMHz();
+#endif
+}
+
+LatencyHistogram::LatencyHistogram() : sumMicros(0), pendingTicks(0)
+{
+    for (int i = 0; i < METRICS_BUCKETS; i++)
+    {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Total de durações registradas (soma das faixas).
+ */
+uint32_t LatencyHistogram::samples() const
+{
+    uint32_t total = 0;
+    for (int i = 0; i < METRICS_BUCKETS; i++)
+    {
+        total += bucket(i);
+    }
+    return total;
+}
+
+/**
+ * @brief Estima um quantil pelo limite superior da faixa que o contém.
+ *
+ * @param q Quantil, de 0 a 1.
+ * @return Limite em ticks; 0 sem amostras ou se o quantil cai na última faixa.
+ */
+uint32_t LatencyHistogram::quantileTicks(float q) const
+{
+    uint32_t total = samples();
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint32_t target = (uint32_t)(q * total);
+    uint32_t cumulative = 0;
+    for (int i = 0; i < METRICS_BUCKETS; i++)
+    {
+        cumulative += bucket(i);
+        if (cumulative > target)
+        {
+            return upperBoundTicks(i);
+        }
+    }
+    return 0;
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < METRICS_BUCKETS; i++)
+    {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    sumMicros.store(0, std::memory_order_relaxed);
+    pendingTicks = 0;
+}
@@ -0,0 +1,69 @@
+// AdaptiveRate.cpp
+#include "AdaptiveRate.h"
+
+AdaptiveRate::AdaptiveRate()
+    : maxRate(0), idleRate(0), currentState(ADAPTIVE_ACTIVE), wakeupCount(0), idleTotal(0), band(0), hold(0),
+      started(false), reference(0), stableSince(0), idleSince(0)
+{
+}
+
+/**
+ * @brief Define as taxas e o critério de estabilidade e volta à taxa máxima.
+ *        Chamada pela tarefa de aquisição, ao aplicar a configuração.
+ *
+ * @param maxHz Taxa com movimento ou zona ocupada.
+ * @param idleHz Taxa com a cena estável; igual ou acima de maxHz desativa o controle.
+ * @param bandCm Variação da distância, em cm, considerada movimento.
+ * @param holdMicros Tempo estável antes de reduzir a taxa.
+ */
+void AdaptiveRate::configure(uint32_t maxHz, uint32_t idleHz, uint16_t bandCm, uint32_t holdMicros)
+{
+    maxRate.store(maxHz, std::memory_order_relaxed);
+    idleRate.store(idleHz, std::memory_order_relaxed);
+    currentState.store(ADAPTIVE_ACTIVE, std::memory_order_relaxed);
+    wakeupCount.store(0, std::memory_order_relaxed);
+    idleTotal.store(0, std::memory_order_relaxed);
+    band = bandCm;
+    hold = holdMicros;
+    started = false;
+}
+
+/**
+ * @brief Avalia uma leitura e decide a taxa de amostragem.
+ *
+ * @param timestampMicros Instante da leitura, em micros().
+ * @param rawDistance Distância bruta, em cm.
+ * @param filteredDistance Distância após o filtro, em cm.
+ * @param zone Zona atual (0 = nenhuma).
+ * @param accepted false se a leitura foi descartada pela qualidade.
+ * @return Taxa do temporizador, em Hz.
+ */
+uint32_t AdaptiveRate::update(uint32_t timestampMicros, int rawDistance, int filteredDistance, uint8_t zone, bool accepted)
+{
+    if (!started)
+    {
+        started = true;
+        reference = filteredDistance;
+        stableSince = timestampMicros;
+    }
+
+    bool moved = accepted && (rawDistance - reference > band || reference - rawDistance > band ||
+                              filteredDistance - reference > band || reference - filteredDistance > band);
+    if (moved || zone != 0)
+    {
+        reference = filteredDistance;
+        stableSince = timestampMicros;
+        if (state() == ADAPTIVE_IDLE)
+        {
+            currentState.store(ADAPTIVE_ACTIVE, std::memory_order_relaxed);
+            wakeupCount.store(wakeups() + 1, std::memory_order_relaxed);
+            idleTotal.store(idleMillis() + (timestampMicros - idleSince) / 1000, std::memory_order_relaxed);
+        }
+    }
+    else if (state() == ADAPTIVE_ACTIVE && enabled() && timestampMicros - stableSince >= hold)
+    {
+        currentState.store(ADAPTIVE_IDLE, std::memory_order_relaxed);
+        idleSince = timestampMicros;
+    }
+    return rate();
+}
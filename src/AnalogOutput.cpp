@@ -0,0 +1,97 @@
+// AnalogOutput.cpp
+#include "AnalogOutput.h"
+
+// 65536 / n arredondado, para n de 1 a OUTPUT_MAX_SPAN (interpolação sem divisão)
+static const uint32_t outputReciprocalQ16[OUTPUT_MAX_SPAN + 1] = {
+    0, 65536, 32768, 21845, 16384, 13107, 10923, 9362,
+    8192, 7282, 6554, 5958, 5461, 5041, 4681, 4369,
+    4096, 3855, 3641, 3449, 3277, 3121, 2979, 2849,
+    2731, 2621, 2521, 2427, 2341, 2260, 2185, 2114,
+    2048, 1986, 1928, 1872, 1820, 1771, 1725, 1680,
+    1638, 1598, 1560, 1524, 1489, 1456, 1425, 1394,
+    1365, 1337, 1311, 1285, 1260, 1237, 1214, 1192,
+    1170, 1150, 1130, 1111, 1092, 1074, 1057, 1040,
+    1024};
+
+AnalogOutput::AnalogOutput()
+    : fullScale(OUTPUT_CODE_MAX), scaleQ16(1UL << 16), slewStepQ16(0), outputMode(OUTPUT_DIRECT), pendingTarget(0),
+      currentQ16(0), targetQ16(0), stepQ16(0), remaining(0), sinceSample(0), lastCode(0)
+{
+}
+
+/**
+ * @brief Define a escala e o modo da saída. As divisões são feitas aqui, uma
+ *        vez por configuração.
+ *
+ * @param fullScaleCm Distância (cm) correspondente ao código 255.
+ * @param mode Modo de atualização entre amostras.
+ * @param updateHz Frequência com que tick() é chamada.
+ * @param slewCmPerSecond Maior variação da saída no modo OUTPUT_SLEW, em cm/s.
+ */
+void AnalogOutput::configure(int fullScaleCm, AnalogOutputMode mode, uint32_t updateHz, uint32_t slewCmPerSecond)
+{
+    uint32_t scale = fullScaleCm < 1 ? 1 : (uint32_t)fullScaleCm;
+    uint32_t factor = (uint32_t)(((uint64_t)OUTPUT_CODE_MAX << 16) + scale / 2) / scale;
+    uint32_t step = updateHz ? (uint32_t)((uint64_t)slewCmPerSecond * factor / updateHz) : 0;
+    fullScale.store(scale, std::memory_order_relaxed);
+    scaleQ16.store(factor, std::memory_order_relaxed);
+    slewStepQ16.store(step < 1 ? 1 : step, std::memory_order_relaxed);
+    outputMode.store(mode, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Calcula o próximo código da saída. Chamada pelo temporizador, em ritmo fixo.
+ */
+uint8_t AnalogOutput::tick()
+{
+    if (sinceSample < OUTPUT_MAX_SPAN)
+    {
+        sinceSample++;
+    }
+    int mode = outputMode.load(std::memory_order_relaxed);
+
+    uint32_t pending = pendingTarget.exchange(0, std::memory_order_acquire);
+    if (pending != 0)
+    {
+        targetQ16 = (int32_t)(pending - 1);
+        remaining = 0;
+        if (mode == OUTPUT_INTERPOLATE && sinceSample > 1)
+        {
+            // Percorre a diferença em tantos ticks quanto durou o último intervalo
+            remaining = sinceSample;
+            stepQ16 = (int32_t)(((int64_t)(targetQ16 - currentQ16) * outputReciprocalQ16[remaining]) >> 16);
+        }
+        sinceSample = 0;
+    }
+
+    switch (mode)
+    {
+    case OUTPUT_INTERPOLATE:
+        if (remaining > 1)
+        {
+            currentQ16 += stepQ16;
+            remaining--;
+        }
+        else
+        {
+            currentQ16 = targetQ16;
+            remaining = 0;
+        }
+        break;
+
+    case OUTPUT_SLEW:
+    {
+        int32_t limit = (int32_t)slewStepQ16.load(std::memory_order_relaxed);
+        int32_t delta = targetQ16 - currentQ16;
+        currentQ16 += delta > limit ? limit : delta < -limit ? -limit : delta;
+        break;
+    }
+
+    default: // OUTPUT_DIRECT
+        currentQ16 = targetQ16;
+        break;
+    }
+
+    lastCode = codeOf(currentQ16);
+    return lastCode;
+}
@@ -0,0 +1,94 @@
+// BiasCorrectionPolicy.cpp
+#include "BiasCorrectionPolicy.h"
+#include <stdlib.h>
+
+BiasCorrectionPolicy::BiasCorrectionPolicy()
+    : policyMode(BIAS_ALWAYS), policyParameter(1), readingsSinceCorrection(0),
+      lastCorrectionMillis(0), driftDetected(false), lastDistance(-1), lastSignalStrength(-1)
+{
+}
+
+/**
+ * @brief Seleciona o modo da política e o seu parâmetro.
+ *
+ * Um parâmetro 0 é tratado como 1. A primeira leitura após a reconfiguração
+ * sempre usa correção de bias.
+ *
+ * @param mode Modo de agendamento da correção de bias.
+ * @param parameter Leituras (BIAS_EVERY_N, BIAS_DRIFT) ou milissegundos (BIAS_PERIODIC).
+ */
+void BiasCorrectionPolicy::configure(BiasCorrectionMode mode, uint32_t parameter)
+{
+    policyMode = mode;
+    policyParameter = parameter == 0 ? 1 : parameter;
+    readingsSinceCorrection = policyParameter;
+    driftDetected = true;
+}
+
+/**
+ * @brief Decide se a próxima aquisição deve usar correção de bias (0x04) ou não (0x03).
+ *
+ * Deve ser chamada uma vez por aquisição disparada; atualiza o estado interno
+ * assumindo que a decisão será seguida.
+ *
+ * @param nowMillis Tempo atual em milissegundos (millis()).
+ * @return true se a aquisição deve usar correção de bias.
+ */
+bool BiasCorrectionPolicy::shouldCorrect(unsigned long nowMillis)
+{
+    bool correct;
+    switch (policyMode)
+    {
+    case BIAS_EVERY_N:
+        correct = readingsSinceCorrection >= policyParameter;
+        break;
+
+    case BIAS_PERIODIC:
+        correct = driftDetected || (nowMillis - lastCorrectionMillis) >= policyParameter;
+        break;
+
+    case BIAS_DRIFT:
+        correct = driftDetected || readingsSinceCorrection >= policyParameter;
+        break;
+
+    default: // BIAS_ALWAYS
+        correct = true;
+        break;
+    }
+
+    if (correct)
+    {
+        readingsSinceCorrection = 0;
+        lastCorrectionMillis = nowMillis;
+        driftDetected = false;
+    }
+    readingsSinceCorrection++;
+    return correct;
+}
+
+/**
+ * @brief Informa o resultado de uma leitura para a heurística de deriva.
+ *
+ * @param distance Distância medida, em centímetros.
+ * @param signalStrength Força do sinal (registro 0x0e) ou -1 se não foi lida.
+ */
+void BiasCorrectionPolicy::observe(int distance, int signalStrength)
+{
+    if (policyMode == BIAS_DRIFT)
+    {
+        if (lastDistance >= 0 && abs(distance - lastDistance) > BIAS_DRIFT_DISTANCE_JUMP_CM)
+        {
+            driftDetected = true;
+        }
+        if (signalStrength >= 0 && lastSignalStrength >= 0 &&
+            abs(signalStrength - lastSignalStrength) > BIAS_DRIFT_SIGNAL_JUMP)
+        {
+            driftDetected = true;
+        }
+    }
+    lastDistance = distance;
+    if (signalStrength >= 0)
+    {
+        lastSignalStrength = signalStrength;
+    }
+}
@@ -0,0 +1,221 @@
+// Config.cpp
+#include "Config.h"
+#include "FilterBank.h"
+#include "SampleRing.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define CONFIG_TEXT_FIELD(form, key, member, defaultValue) \
+    {form, key, CONFIG_TEXT, offsetof(Config, member), 0, 0, defaultValue}
+#define CONFIG_INT_FIELD(form, key, member, min, max, defaultValue) \
+    {form, key, CONFIG_INT, offsetof(Config, member), min, max, defaultValue}
+
+const ConfigField configFields[] = {
+    CONFIG_TEXT_FIELD("ssid", "ssid", ssid, "CLARO_D4D094"),
+    CONFIG_TEXT_FIELD("senha", "senha", senha, "NYJmv24gGv"),
+    CONFIG_TEXT_FIELD("ip-servidor", "ipServidor", ipServidor, ""),
+    CONFIG_INT_FIELD("porta-servidor", "portaServidor", portaServidor, 1, 65535, "1883"),
+    CONFIG_TEXT_FIELD("token", "token", token, "default_token"),
+    CONFIG_INT_FIELD("mqtt-qos", "mqttQos", mqttQos, 0, 1, "0"),
+    CONFIG_INT_FIELD("mqtt-lote", "mqttLote", mqttLote, 1, 256, "50"), // MQTT_MAX_LOTE
+    CONFIG_INT_FIELD("mqtt-intervalo", "mqttIntervalo", mqttIntervalo, 10, 60000, "1000"),
+    CONFIG_INT_FIELD("inicio-zona-1", "inicioZona1", inicioZona[0], 0, 65535, "10"),
+    CONFIG_INT_FIELD("fim-zona-1", "fimZona1", fimZona[0], 0, 65535, "20"),
+    CONFIG_INT_FIELD("inicio-zona-2", "inicioZona2", inicioZona[1], 0, 65535, "20"),
+    CONFIG_INT_FIELD("fim-zona-2", "fimZona2", fimZona[1], 0, 65535, "30"),
+    CONFIG_INT_FIELD("inicio-zona-3", "inicioZona3", inicioZona[2], 0, 65535, "30"),
+    CONFIG_INT_FIELD("fim-zona-3", "fimZona3", fimZona[2], 0, 65535, "40"),
+    CONFIG_INT_FIELD("histerese-zona", "zonaHisterese", zonaHisterese, 0, 1000, "5"),
+    CONFIG_INT_FIELD("permanencia-zona", "zonaPermanencia", zonaPermanencia, 0, 60000, "200"),
+    CONFIG_INT_FIELD("antecedencia-alerta", "antecedenciaAlerta", antecedenciaAlerta, 0, 10000, "500"),
+    CONFIG_INT_FIELD("velocidade-minima", "velocidadeMinima", velocidadeMinima, 1, 10000, "20"),
+    CONFIG_INT_FIELD("fator-divisao", "fatorDivisao", fatorDivisao, 1, 65535, "12000"),
+    CONFIG_INT_FIELD("cadeia-filtro", "cadeiaFiltro", cadeiaFiltro, 0, FILTER_CHAIN_COUNT - 1, "0"),
+    CONFIG_INT_FIELD("bias-modo", "biasModo", biasModo, 0, 3, "1"),
+    CONFIG_INT_FIELD("bias-parametro", "biasParametro", biasParametro, 1, 3600000, "100"),
+    CONFIG_INT_FIELD("modo-aquisicao", "modoAquisicao", modoAquisicao, 0, 1, "0"),
+    CONFIG_INT_FIELD("taxa-livre", "taxaLivre", taxaLivre, 1, 2000, "500"),
+    CONFIG_INT_FIELD("taxa-alvo", "taxaAlvo", taxaAlvo, 0, 2000, "1000"),
+    CONFIG_INT_FIELD("taxa-ociosa", "taxaOciosa", taxaOciosa, 1, 2000, "20"),
+    CONFIG_INT_FIELD("faixa-movimento", "faixaMovimento", faixaMovimento, 1, 1000, "5"),
+    CONFIG_INT_FIELD("tempo-estavel", "tempoEstavel", tempoEstavel, 0, 600000, "2000"),
+    CONFIG_INT_FIELD("profundidade-buffer", "profundidadeBuffer", profundidadeBuffer,
+                     SAMPLE_RING_MIN_DEPTH, SAMPLE_RING_MAX_DEPTH, "4096"),
+    CONFIG_INT_FIELD("taxa-stream", "taxaStream", taxaStream, 1, 50, "10"),
+    CONFIG_INT_FIELD("leitura-qualidade", "leituraQualidade", leituraQualidade, 0, 1, "1"),
+    CONFIG_INT_FIELD("sinal-minimo", "sinalMinimo", sinalMinimo, 0, 254, "16"),
+    CONFIG_INT_FIELD("rejeicao-qualidade", "rejeicaoQualidade", rejeicaoQualidade, 0, 15, "8"), // SIGNAL_REJECT_NO_RETURN
+    CONFIG_INT_FIELD("fonte-saida", "fonteSaida", fonteSaida, 0, 1, "1"),
+    CONFIG_INT_FIELD("modo-saida", "modoSaida", modoSaida, 0, 2, "1"),
+    CONFIG_INT_FIELD("taxa-saida", "taxaSaida", taxaSaida, 100, 10000, "1000"),
+    CONFIG_INT_FIELD("rampa-saida", "rampaSaida", rampaSaida, 1, 1000000, "5000"),
+};
+
+const size_t configFieldCount = sizeof(configFields) / sizeof(configFields[0]);
+
+static_assert(sizeof(configFields) / sizeof(configFields[0]) <= 64, "configDiff() usa uma máscara de 64 bits");
+
+/**
+ * @brief Converte e valida o texto de um campo, gravando-o em config.
+ *
+ * @return false se o texto não é um inteiro dentro dos limites do campo, ou se
+ *         não cabe no campo de texto; nesse caso config não é alterada.
+ */
+bool configSetField(Config &config, const ConfigField &field, const char *text)
+{
+    if (field.type == CONFIG_TEXT)
+    {
+        size_t length = strlen(text);
+        if (length >= CONFIG_TEXT_SIZE)
+        {
+            return false;
+        }
+        memcpy(configText(config, field), text, length + 1);
+        return true;
+    }
+
+    char *end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value < INT32_MIN || value > INT32_MAX)
+    {
+        return false;
+    }
+    return configSetInt(config, field, (int32_t)value);
+}
+
+/**
+ * @brief Valida e grava o valor de um campo inteiro em config.
+ *
+ * @return false se o campo não é inteiro ou o valor está fora dos limites; nesse
+ *         caso config não é alterada.
+ */
+bool configSetInt(Config &config, const ConfigField &field, int32_t value)
+{
+    if (field.type != CONFIG_INT || value < field.min || value > field.max)
+    {
+        return false;
+    }
+    configInt(config, field) = value;
+    return true;
+}
+
+/**
+ * @brief Preenche config com os valores padrão de todos os campos.
+ */
+void configDefaults(Config &config)
+{
+    memset(&config, 0, sizeof(config));
+    for (size_t i = 0; i < configFieldCount; i++)
+    {
+        configSetField(config, configFields[i], configFields[i].defaultValue);
+    }
+}
+
+/**
+ * @brief Verificações que envolvem mais de um campo.
+ *
+ * @return NULL se a configuração é válida, ou a chave do primeiro campo inválido.
+ */
+const char *configValidate(const Config &config)
+{
+    static const char *const inicios[3] = {"inicioZona1", "inicioZona2", "inicioZona3"};
+    for (int i = 0; i < 3; i++)
+    {
+        if (config.inicioZona[i] > config.fimZona[i])
+        {
+            return inicios[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Campos com valores diferentes entre a e b.
+ *
+ * @return Máscara com o bit i ligado se configFields[i] difere.
+ */
+uint64_t configDiff(const Config &a, const Config &b)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i < configFieldCount; i++)
+    {
+        const ConfigField &field = configFields[i];
+        bool differs = field.type == CONFIG_TEXT ? strcmp(configText(a, field), configText(b, field)) != 0
+                                                 : configInt(a, field) != configInt(b, field);
+        if (differs)
+        {
+            mask |= 1ULL << i;
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Máscara dos campos com as chaves dadas, no formato de configDiff().
+ *
+ * @param keys Chaves na NVS (ConfigField::key); chaves desconhecidas são ignoradas.
+ */
+uint64_t configMask(const char *const *keys, size_t count)
+{
+    uint64_t mask = 0;
+    for (size_t k = 0; k < count; k++)
+    {
+        for (size_t i = 0; i < configFieldCount; i++)
+        {
+            if (strcmp(configFields[i].key, keys[k]) == 0)
+            {
+                mask |= 1ULL << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+ConfigStore::ConfigStore() : sequence(0)
+{
+    configDefaults(slots[0]);
+    configDefaults(slots[1]);
+}
+
+/**
+ * @brief Substitui a configuração ativa. Deve ser chamada por um único escritor.
+ *
+ * A cópia inativa é preenchida antes da troca; leitores que estejam copiando a
+ * ativa não são afetados.
+ */
+void ConfigStore::publish(const Config &config)
+{
+    uint32_t s = sequence.load(std::memory_order_relaxed);
+    Config &inactive = slots[((s >> 1) + 1) & 1];
+    sequence.store(s + 1, std::memory_order_relaxed); // Ímpar: publicação em andamento
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&inactive, &config, sizeof(Config));
+    sequence.store(s + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Copia a configuração ativa sem bloquear o escritor.
+ *
+ * @return false se publicações sucessivas interromperam todas as tentativas (o
+ *         conteúdo de config não deve ser usado).
+ */
+bool ConfigStore::snapshot(Config &config) const
+{
+    for (int attempt = 0; attempt < CONFIG_READ_RETRIES; attempt++)
+    {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        memcpy(&config, &slots[(before >> 1) & 1], sizeof(Config));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // A cópia ativa só é reescrita pela segunda publicação depois de before,
+        // que começa quando a sequência chega a (before & ~1) + 3
+        if (sequence.load(std::memory_order_relaxed) - (before & ~1u) < 3)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,159 +1,356 @@
-// ConfigHandler.cpp
-#include "ConfigHandler.h"
-#include <ESPAsyncWebServer.h>
-#include <Preferences.h>
-#include <ArduinoJson.h>
-
-/**
- * @brief Salva as configurações recebidas via requisição HTTP na memória não volátil (NVS).
- *
- * Esta função recebe uma requisição HTTP contendo um JSON com as configurações e as salva na memória não volátil.
- * Se algum parâmetro necessário estiver ausente ou se ocorrer um erro na deserialização do JSON, uma resposta de erro é enviada.
- *
- * @param request Ponteiro para o objeto AsyncWebServerRequest que representa a requisição HTTP.
- * @param preferences Referência para o objeto Preferences utilizado para acessar a memória não volátil.
- * @param data Ponteiro para os dados recebidos na requisição HTTP.
- * @param len Tamanho dos dados recebidos.
- */
-void salvarConfiguracoes(AsyncWebServerRequest *request, Preferences &preferences, uint8_t *data, size_t len) {
-  // Converte os dados recebidos em uma string
-  String jsonString = String((char*)data, len);
-
-  // Cria um objeto JSON para armazenar os dados
-  StaticJsonDocument<512> jsonDoc; // Ajuste o tamanho conforme necessário
-
-  // Deserializa a string JSON
-  DeserializationError error = deserializeJson(jsonDoc, jsonString);
-
-  if (error) {
-    Serial.print(F("Erro ao deserializar JSON: "));
-    Serial.println(error.f_str());
-    request->send(400, "application/json", "{\"error\":\"JSON inválido\"}");
-    return;
-  }
-
-  // Extrai os valores do JSON
-  String ssid = jsonDoc["ssid"] | "";
-  String senha = jsonDoc["senha"] | "";
-  String ipServidor = jsonDoc["ip-servidor"] | "";
-  String portaServidor = jsonDoc["porta-servidor"] | "";
-  String token = jsonDoc["token"] | "";
-  String inicioZona1 = jsonDoc["inicio-zona-1"] | "";
-  String fimZona1 = jsonDoc["fim-zona-1"] | "";
-  String inicioZona2 = jsonDoc["inicio-zona-2"] | "";
-  String fimZona2 = jsonDoc["fim-zona-2"] | "";
-  String inicioZona3 = jsonDoc["inicio-zona-3"] | "";
-  String fimZona3 = jsonDoc["fim-zona-3"] | "";
-  String fatorDivisao = jsonDoc["fator-divisao"] | "";
-  String FiltroKalman = jsonDoc["filtro-kalman"] | "";
-
-  // Verifica se todos os campos necessários foram fornecidos
-  //if (ssid == "" || senha == "" || ipServidor == "" || portaServidor == "" || token == "" ||
-  //    inicioZona1 == "" || fimZona1 == "" || inicioZona2 == "" || fimZona2 == "" || inicioZona3 == "" || fimZona3 == "") {
-  //  request->send(400, "application/json", "{\"error\":\"Parâmetros ausentes\"}");
-  //  return;
-  //}
-
-  // Salva as informações na memória não volátil (NVS)
-  preferences.putString("ssid", ssid);
-  preferences.putString("senha", senha);
-  preferences.putString("ipServidor", ipServidor);
-  preferences.putString("portaServidor", portaServidor);
-  preferences.putString("token", token);
-  preferences.putString("inicioZona1", inicioZona1);
-  preferences.putString("fimZona1", fimZona1);
-  preferences.putString("inicioZona2", inicioZona2);
-  preferences.putString("fimZona2", fimZona2);
-  preferences.putString("inicioZona3", inicioZona3);
-  preferences.putString("fimZona3", fimZona3);
-  preferences.putString("fatorDivisao", fatorDivisao);
-  preferences.putString("FiltroKalman", FiltroKalman);
-
-  // Define a flag indicando que a configuração foi salva
-  preferences.putBool("configSalva", true);
-
-  // Envia uma resposta de sucesso
-  request->send(200, "application/json", "{\"message\":\"Configurações salvas com sucesso!\"}");
-}
-
-
-void recuperarConfiguracoes(AsyncWebServerRequest *request, Preferences &preferences) {
-  if (!preferences.getBool("configSalva", false)) {
-    resetarConfiguracoes(preferences);
-  }
-
-  JsonDocument jsonResponse;
-  
-  jsonResponse["ssid"] = preferences.getString("ssid", "CLARO_D4D094");
-  jsonResponse["senha"] = preferences.getString("senha", "NYJmv24gGv");
-  jsonResponse["ipServidor"] = preferences.getString("ipServidor", "192.168.1.1");
-  jsonResponse["portaServidor"] = preferences.getString("portaServidor", "8080");
-  jsonResponse["token"] = preferences.getString("token", "default_token");
-  jsonResponse["inicioZona1"] = preferences.getString("inicioZona1", "10");
-  jsonResponse["fimZona1"] = preferences.getString("fimZona1", "20");
-  jsonResponse["inicioZona2"] = preferences.getString("inicioZona2", "20");
-  jsonResponse["fimZona2"] = preferences.getString("fimZona2", "30");
-  jsonResponse["inicioZona3"] = preferences.getString("inicioZona3", "30");
-  jsonResponse["fimZona3"] = preferences.getString("fimZona3", "40");
-  jsonResponse["fatorDivisao"] = preferences.getString("fatorDivisao", "40");
-  jsonResponse["FiltroKalman"] = preferences.getString("FiltroKalman", "0");
-
-  String response;
-  serializeJson(jsonResponse, response);
-  request->send(200, "application/json", response);
-}
-
-void resetarConfiguracoes(Preferences &preferences) {
-  preferences.putString("ssid", "CLARO_D4D094");
-  preferences.putString("senha", "NYJmv24gGv");
-  preferences.putString("ipServidor", "192.168.1.1");
-  preferences.putString("portaServidor", "8080");
-  preferences.putString("token", "default_token");
-  preferences.putString("inicioZona1", "10");
-  preferences.putString("fimZona1", "20");
-  preferences.putString("inicioZona2", "20");
-  preferences.putString("fimZona2", "30");
-  preferences.putString("inicioZona3", "30");
-  preferences.putString("fimZona3", "40");
-  preferences.putString("fatorDivisao", "40");
-  preferences.putString("FiltroKalman", "0");
-
-  // Define a flag indicando que a configuração não foi salva
-  preferences.putBool("configSalva", false);
-}
-
-void setupConfigHandler(AsyncWebServer &server, Preferences &preferences) {
-  // Define a rota para requisições POST em "/config"
-  // Define a rota para requisições POST em "/salvar"
-  server.on("/salvar", HTTP_POST, 
-    // requestHandler - chamado quando a requisição é recebida
-    [](AsyncWebServerRequest *request){
-      Serial.println("Recebida requisição POST em /salvar");
-      // A resposta será enviada no bodyHandler
-    }, 
-    // uploadHandler - não utilizado neste caso
-    NULL, 
-    // bodyHandler - chamado quando o corpo da requisição é recebido
-    [&preferences](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      Serial.printf("Recebendo dados: %u bytes\n", len);
-      salvarConfiguracoes(request, preferences, data, len);
-    }
-  );
-
-
-  // Servidor para salvar as configurações
-  //server.on("/salvar", HTTP_POST, NULL, NULL, [&preferences](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-  //  salvarConfiguracoes(request, preferences, data, len);
-  //});;
-
-  // Servidor para recuperar as configurações
-  server.on("/recuperar", HTTP_GET, [&preferences](AsyncWebServerRequest *request) {
-    recuperarConfiguracoes(request, preferences);
-  });
-
-  // Servidor para resetar as configurações para os valores padrão
-  server.on("/resetar", HTTP_POST, [&preferences](AsyncWebServerRequest *request) {
-    resetarConfiguracoes(preferences);
-    request->send(200, "text/plain", "Configurações resetadas para os valores padrão com sucesso!");
-  });
-}
+// ConfigHandler.cpp
+#include "ConfigHandler.h"
+#include <ESPAsyncWebServer.h>
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include <nvs.h>
+#include "Global.h"
+#include "DeferredLog.h"
+
+// Maior corpo aceito por /salvar e PATCH /config (37 campos, textos de até 64 caracteres)
+#define CONFIG_BODY_MAX 4096
+
+/**
+ * @brief Grava na NVS os campos indicados, com um único commit.
+ *
+ * Inteiros são gravados como int32 e textos como string; uma chave existente com
+ * outro tipo (versões anteriores gravavam tudo como texto) é apagada antes. A flag
+ * "configSalva" só é gravada se mudar.
+ *
+ * @param preferences Referência para o objeto Preferences, usado para consultar o tipo das chaves.
+ * @param config Valores a gravar.
+ * @param campos Máscara dos campos a gravar (bit i = configFields[i], ver configDiff()).
+ * @param salva Valor da flag "configSalva".
+ * @return Número de chaves gravadas, ou -1 se a NVS não pôde ser aberta ou gravada.
+ */
+static int gravarConfiguracoes(Preferences &preferences, const Config &config, uint64_t campos, bool salva) {
+  nvs_handle_t nvs;
+  if (nvs_open("config", NVS_READWRITE, &nvs) != ESP_OK) {
+    return -1;
+  }
+
+  int gravadas = 0;
+  esp_err_t erro = ESP_OK;
+  for (size_t i = 0; i < configFieldCount && erro == ESP_OK; i++) {
+    if ((campos & (1ULL << i)) == 0) {
+      continue;
+    }
+    const ConfigField &campo = configFields[i];
+    PreferenceType tipoAtual = preferences.getType(campo.key);
+    if (tipoAtual != PT_INVALID && tipoAtual != (campo.type == CONFIG_TEXT ? PT_STR : PT_I32)) {
+      nvs_erase_key(nvs, campo.key);
+    }
+    erro = campo.type == CONFIG_TEXT ? nvs_set_str(nvs, campo.key, configText(config, campo))
+                                     : nvs_set_i32(nvs, campo.key, configInt(config, campo));
+    gravadas++;
+  }
+
+  uint8_t salvaAtual;
+  if (erro == ESP_OK && (nvs_get_u8(nvs, "configSalva", &salvaAtual) != ESP_OK || salvaAtual != salva)) {
+    erro = nvs_set_u8(nvs, "configSalva", salva);
+    gravadas++;
+  }
+  if (erro == ESP_OK) {
+    erro = nvs_commit(nvs);
+  }
+  nvs_close(nvs);
+  return erro == ESP_OK ? gravadas : -1;
+}
+
+/**
+ * @brief Carrega a configuração da NVS para a RAM. Chamada uma vez, em setup().
+ *
+ * Valores ausentes, não numéricos ou fora dos limites são substituídos pelo padrão
+ * do campo. Esses campos, e os inteiros ainda gravados como texto, são regravados
+ * em seguida, de modo que a NVS passa a conter exatamente a configuração em RAM;
+ * /salvar e /resetar dependem disso para gravar apenas as diferenças. Sem
+ * configuração salva, a NVS é resetada para os valores padrão.
+ *
+ * @param preferences Referência para o objeto Preferences utilizado para acessar a memória não volátil.
+ */
+void carregarConfiguracoes(Preferences &preferences) {
+  if (!preferences.getBool("configSalva", false)) {
+    Serial.println("Configurações não salvas. Resetando para valores padrão.");
+    resetarConfiguracoes(preferences);
+    return;
+  }
+
+  Config config;
+  configDefaults(config);
+  uint64_t regravar = 0;
+  for (size_t i = 0; i < configFieldCount; i++) {
+    const ConfigField &campo = configFields[i];
+    PreferenceType tipo = preferences.getType(campo.key);
+    bool valido = false;
+    if (campo.type == CONFIG_INT && tipo == PT_I32) {
+      valido = configSetInt(config, campo, preferences.getInt(campo.key));
+    } else if (tipo == PT_STR) {
+      valido = configSetField(config, campo, preferences.getString(campo.key).c_str());
+      if (campo.type == CONFIG_INT) {
+        regravar |= 1ULL << i; // Formato antigo: converte para int32
+      }
+    } else if (tipo == PT_INVALID && (strcmp(campo.key, "ssid") == 0 || strcmp(campo.key, "senha") == 0)) {
+      // Credenciais removidas por uma versão anterior após falha de conexão:
+      // ficam vazias (modo AP), sem voltar ao padrão nem regravar a chave
+      valido = configSetField(config, campo, "");
+    } else if (tipo == PT_INVALID && strcmp(campo.key, "cadeiaFiltro") == 0 && preferences.isKey("FiltroKalman")) {
+      // Sem a chave nova, "FiltroKalman" = 1 corresponde a FILTER_KALMAN
+      valido = configSetField(config, campo, preferences.getString("FiltroKalman").c_str());
+      regravar |= 1ULL << i;
+    }
+    if (!valido) {
+      Serial.printf("Valor ausente ou inválido para %s; usando o padrão\n", campo.key);
+      regravar |= 1ULL << i;
+    }
+  }
+  const char *invalido = configValidate(config);
+  if (invalido != NULL) {
+    Serial.printf("Configuração inválida em %s; usando as zonas padrão\n", invalido);
+    Config padrao, corrigida = config;
+    configDefaults(padrao);
+    memcpy(corrigida.inicioZona, padrao.inicioZona, sizeof(corrigida.inicioZona));
+    memcpy(corrigida.fimZona, padrao.fimZona, sizeof(corrigida.fimZona));
+    regravar |= configDiff(config, corrigida);
+    config = corrigida;
+  }
+
+  if (regravar != 0) {
+    Serial.printf("Chaves regravadas na NVS: %d\n", gravarConfiguracoes(preferences, config, regravar, true));
+  }
+  configStore.publish(config);
+}
+
+/**
+ * @brief Aplica as configurações recebidas via requisição HTTP e grava na NVS apenas as alteradas.
+ *
+ * Esta função recebe uma requisição HTTP contendo um JSON apenas com os campos a alterar (nomes do formulário),
+ * valida e converte cada um sobre a configuração atual, grava na memória não volátil somente as chaves cujo valor
+ * mudou, em um único commit, e substitui a configuração em RAM, que as tarefas aplicam na próxima iteração.
+ * Campos ausentes, ou numéricos vazios, mantêm o valor atual. Se o JSON for inválido ou algum campo estiver
+ * fora dos limites, uma resposta de erro é enviada e nada é alterado.
+ *
+ * A resposta informa o número de chaves gravadas e a duração da gravação na NVS, em µs.
+ *
+ * @param request Ponteiro para o objeto AsyncWebServerRequest que representa a requisição HTTP.
+ * @param preferences Referência para o objeto Preferences utilizado para acessar a memória não volátil.
+ * @param data Ponteiro para os dados recebidos na requisição HTTP.
+ * @param len Tamanho dos dados recebidos.
+ */
+void salvarConfiguracoes(AsyncWebServerRequest *request, Preferences &preferences, uint8_t *data, size_t len) {
+  // Cria um objeto JSON para armazenar os dados
+  JsonDocument jsonDoc;
+
+  // Deserializa o JSON recebido
+  DeserializationError error = deserializeJson(jsonDoc, (const char *)data, len);
+
+  if (error) {
+    logEvent(LOG_CONFIG_INVALID_JSON, (int32_t)error.code(), (int32_t)len);
+    request->send(400, "application/json", "{\"error\":\"JSON inválido\"}");
+    return;
+  }
+
+  Config atual;
+  if (!configStore.snapshot(atual)) {
+    request->send(503, "application/json", "{\"error\":\"Configuração em atualização\"}");
+    return;
+  }
+
+  // Converte e valida os valores do JSON sobre a configuração atual
+  Config config = atual;
+  for (size_t i = 0; i < configFieldCount; i++) {
+    const ConfigField &campo = configFields[i];
+    JsonVariant valor = jsonDoc[campo.form];
+    String texto;
+    if (valor.is<const char *>()) {
+      texto = valor.as<const char *>();
+    } else if (valor.is<long>()) {
+      texto = String(valor.as<long>());
+    } else if (!valor.isNull()) {
+      texto = "?"; // Tipo não suportado: rejeitado abaixo
+    }
+    if (valor.isNull() || (campo.type == CONFIG_INT && texto.isEmpty())) {
+      continue; // Mantém o valor atual
+    }
+    if (!configSetField(config, campo, texto.c_str())) {
+      request->send(400, "application/json", String("{\"error\":\"Valor inválido\",\"campo\":\"") + campo.form + "\"}");
+      return;
+    }
+  }
+  const char *invalido = configValidate(config);
+  if (invalido != NULL) {
+    request->send(400, "application/json", String("{\"error\":\"Zona com início maior que o fim\",\"campo\":\"") + invalido + "\"}");
+    return;
+  }
+
+  // Grava na memória não volátil (NVS) apenas as chaves alteradas; a profundidade
+  // do buffer é aplicada na próxima inicialização
+  uint64_t alterados = configDiff(atual, config);
+  unsigned long inicio = micros();
+  int gravadas = gravarConfiguracoes(preferences, config, alterados, true);
+  unsigned long duracao = micros() - inicio;
+  if (gravadas < 0) {
+    request->send(500, "application/json", "{\"error\":\"Erro ao gravar na NVS\"}");
+    return;
+  }
+
+  // Substitui a configuração em RAM: as tarefas do LiDAR, do stream e do MQTT
+  // aplicam a nova versão na próxima iteração
+  if (alterados != 0) {
+    configStore.publish(config);
+  }
+
+  // Envia uma resposta de sucesso
+  JsonDocument resposta;
+  resposta["message"] = "Configurações salvas com sucesso!";
+  resposta["chavesGravadas"] = gravadas;
+  resposta["duracaoUs"] = duracao;
+  String json;
+  serializeJson(resposta, json);
+  request->send(200, "application/json", json);
+}
+
+
+/**
+ * @brief Responde com a configuração em RAM, sem acessar a NVS.
+ */
+void recuperarConfiguracoes(AsyncWebServerRequest *request) {
+  Config config;
+  if (!configStore.snapshot(config)) {
+    request->send(503, "application/json", "{\"error\":\"Configuração em atualização\"}");
+    return;
+  }
+
+  JsonDocument jsonResponse;
+  for (size_t i = 0; i < configFieldCount; i++) {
+    const ConfigField &campo = configFields[i];
+    if (campo.type == CONFIG_TEXT) {
+      jsonResponse[campo.key] = configText(config, campo);
+    } else {
+      jsonResponse[campo.key] = configInt(config, campo);
+    }
+  }
+
+  String response;
+  serializeJson(jsonResponse, response);
+  request->send(200, "application/json", response);
+}
+
+/**
+ * @brief Apaga o SSID e a senha do WiFi na configuração em RAM e na NVS, após
+ *        uma falha de conexão; a próxima inicialização entra direto no modo AP.
+ */
+void limparCredenciaisWiFi(Preferences &preferences) {
+  Config atual;
+  if (!configStore.snapshot(atual)) {
+    return;
+  }
+  Config config = atual;
+  config.ssid[0] = '\0';
+  config.senha[0] = '\0';
+  uint64_t alterados = configDiff(atual, config);
+  if (alterados != 0) {
+    gravarConfiguracoes(preferences, config, alterados, true);
+    configStore.publish(config);
+  }
+}
+
+void resetarConfiguracoes(Preferences &preferences) {
+  Config config;
+  configDefaults(config);
+
+  // Antes da carga inicial a configuração em RAM não reflete a NVS: grava todos
+  // os campos; depois, apenas os que diferem do padrão
+  Config atual;
+  uint64_t campos = ~0ULL;
+  if (configStore.version() != 0 && configStore.snapshot(atual)) {
+    campos = configDiff(atual, config);
+  }
+
+  // Define a flag indicando que a configuração não foi salva
+  gravarConfiguracoes(preferences, config, campos, false);
+
+  configStore.publish(config);
+}
+
+/**
+ * @brief Junta os trechos do corpo de /salvar ou PATCH /config e só então o
+ *        processa com salvarConfiguracoes().
+ *
+ * O servidor entrega corpos maiores que um segmento TCP em várias chamadas,
+ * com a posição (index) de cada trecho no total. Um corpo em uma única chamada
+ * é processado direto; os demais são copiados para request->_tempObject,
+ * liberado pelo próprio servidor ao fim da requisição.
+ */
+static void receberConfiguracoes(AsyncWebServerRequest *request, Preferences &preferences, uint8_t *data,
+                                 size_t len, size_t index, size_t total) {
+  if (index == 0 && len == total) {
+    salvarConfiguracoes(request, preferences, data, len);
+    return;
+  }
+  if (total > CONFIG_BODY_MAX) {
+    if (index == 0) {
+      request->send(413, "application/json", "{\"error\":\"Corpo muito grande\"}");
+    }
+    return;
+  }
+  if (index == 0) {
+    request->_tempObject = malloc(total);
+    if (request->_tempObject == NULL) {
+      request->send(503, "application/json", "{\"error\":\"Memória insuficiente\"}");
+      return;
+    }
+  }
+  if (request->_tempObject == NULL || index + len > total) {
+    return; // Sem o início do corpo (já respondido acima)
+  }
+  memcpy((uint8_t *)request->_tempObject + index, data, len);
+  if (index + len == total) {
+    salvarConfiguracoes(request, preferences, (uint8_t *)request->_tempObject, total);
+  }
+}
+
+void setupConfigHandler(AsyncWebServer &server, Preferences &preferences) {
+  // Define a rota para requisições POST em "/config"
+  // Define a rota para requisições POST em "/salvar"
+  server.on("/salvar", HTTP_POST, 
+    // requestHandler - chamado quando a requisição é recebida
+    [](AsyncWebServerRequest *request){
+      // A resposta será enviada no bodyHandler
+    }, 
+    // uploadHandler - não utilizado neste caso
+    NULL, 
+    // bodyHandler - chamado quando o corpo da requisição é recebido
+    [&preferences](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      logEvent(LOG_CONFIG_BODY, (int32_t)len, (int32_t)index, (int32_t)total);
+      receberConfiguracoes(request, preferences, data, len, index, total);
+    }
+  );
+
+
+  // Atualização parcial: o corpo traz apenas os campos alterados (mesmo tratamento de /salvar)
+  server.on("/config", HTTP_PATCH,
+    [](AsyncWebServerRequest *request){
+      // A resposta será enviada no bodyHandler
+    },
+    NULL,
+    [&preferences](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      receberConfiguracoes(request, preferences, data, len, index, total);
+    }
+  );
+
+  // Servidor para salvar as configurações
+  //server.on("/salvar", HTTP_POST, NULL, NULL, [&preferences](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+  //  salvarConfiguracoes(request, preferences, data, len);
+  //});;
+
+  // Servidor para recuperar as configurações
+  server.on("/recuperar", HTTP_GET, [](AsyncWebServerRequest *request) {
+    recuperarConfiguracoes(request);
+  });
+
+  // Servidor para resetar as configurações para os valores padrão
+  server.on("/resetar", HTTP_POST, [&preferences](AsyncWebServerRequest *request) {
+    resetarConfiguracoes(preferences);
+    request->send(200, "text/plain", "Configurações resetadas para os valores padrão com sucesso!");
+  });
+}
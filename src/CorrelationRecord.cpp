@@ -0,0 +1,158 @@
+// CorrelationRecord.cpp
+#include "CorrelationRecord.h"
+#include <string.h>
+
+/**
+ * @brief Analisa o registro de correlação (ver CorrelationRecord.h).
+ *
+ * @param record Palavras do registro, com sinal.
+ * @param words Número de palavras.
+ * @param analysis Recebe o resultado; sequence, timestampMicros, captureMicros
+ *        e sensor não são alterados.
+ */
+void analyzeCorrelation(const int16_t *record, int words, CorrelationAnalysis &analysis)
+{
+    analysis.words = words;
+    analysis.peak = 0;
+    analysis.peakIndex = 0;
+    analysis.trough = 0;
+    analysis.troughIndex = 0;
+    analysis.zeroCrossingQ8 = -1;
+    analysis.noiseFloor = 0;
+    analysis.secondPeak = 0;
+    analysis.secondPeakIndex = 0;
+    if (words <= 0)
+    {
+        return;
+    }
+
+    // Pico principal e o vale que o segue
+    int peakIndex = 0;
+    for (int i = 1; i < words; i++)
+    {
+        if (record[i] > record[peakIndex])
+        {
+            peakIndex = i;
+        }
+    }
+    int troughIndex = peakIndex;
+    for (int i = peakIndex + 1; i < words; i++)
+    {
+        if (record[i] < record[troughIndex])
+        {
+            troughIndex = i;
+        }
+    }
+    analysis.peak = record[peakIndex];
+    analysis.peakIndex = peakIndex;
+    analysis.trough = record[troughIndex];
+    analysis.troughIndex = troughIndex;
+
+    // Primeiro cruzamento do positivo para o não positivo entre o pico e o vale
+    for (int i = peakIndex; i < troughIndex; i++)
+    {
+        if (record[i] > 0 && record[i + 1] <= 0)
+        {
+            int32_t above = record[i];
+            int32_t below = record[i + 1];
+            analysis.zeroCrossingQ8 = i * 256 + above * 256 / (above - below);
+            break;
+        }
+    }
+
+    // Ruído e segundo pico fora da janela do retorno principal
+    int start = peakIndex - CORRELATION_GUARD;
+    int end = troughIndex + CORRELATION_GUARD;
+    uint32_t sum = 0;
+    int count = 0;
+    for (int i = 0; i < words; i++)
+    {
+        if (i >= start && i <= end)
+        {
+            continue;
+        }
+        int value = record[i];
+        sum += value < 0 ? -value : value;
+        count++;
+        if (value > analysis.secondPeak)
+        {
+            analysis.secondPeak = value;
+            analysis.secondPeakIndex = i;
+        }
+    }
+    analysis.noiseFloor = count ? sum / count : 0;
+}
+
+CorrelationCapture::CorrelationCapture() : requested(0), requestSensor(0), version(0), captures(0)
+{
+    memset(&result, 0, sizeof(result));
+    memset(samples, 0, sizeof(samples));
+}
+
+/**
+ * @brief Pede uma captura, executada pela tarefa de aquisição no próximo service().
+ *
+ * @param words Palavras a capturar, de 1 a CORRELATION_MAX_WORDS.
+ * @param sensor Índice do sensor.
+ */
+void CorrelationCapture::request(int words, uint8_t sensor)
+{
+    if (words < 1 || words > CORRELATION_MAX_WORDS)
+    {
+        words = CORRELATION_DEFAULT_WORDS;
+    }
+    requestSensor.store(sensor, std::memory_order_relaxed);
+    requested.store(words, std::memory_order_release);
+}
+
+/**
+ * @brief Executa a captura pedida, se houver. Deve ser chamada pela tarefa que
+ *        usa o barramento, entre duas leituras de distância.
+ *
+ * @return true se uma captura foi feita.
+ */
+bool CorrelationCapture::service(LIDARLite &lidar, char lidarliteAddress, uint8_t sensor)
+{
+    int words = requested.exchange(0, std::memory_order_acq_rel);
+    if (words == 0)
+    {
+        return false;
+    }
+
+    uint32_t v = version.load(std::memory_order_relaxed);
+    version.store(v + 1, std::memory_order_relaxed); // Ímpar: captura em andamento
+    std::atomic_thread_fence(std::memory_order_release);
+
+    unsigned long start = micros();
+    int captured = lidar.correlationRecord(samples, words, lidarliteAddress);
+    result.captureMicros = micros() - start;
+    result.timestampMicros = start;
+    result.sensor = sensor;
+    result.sequence = ++captures;
+    analyzeCorrelation(samples, captured, result);
+
+    version.store(v + 2, std::memory_order_release);
+    return captured > 0;
+}
+
+/**
+ * @brief Copia a análise e, opcionalmente, a forma de onda da última captura.
+ *
+ * @param record Recebe analysis.words palavras; NULL para copiar só a análise.
+ * @return false se uma captura estava em andamento (a cópia não deve ser usada).
+ */
+bool CorrelationCapture::read(CorrelationAnalysis &analysis, int16_t *record) const
+{
+    uint32_t before = version.load(std::memory_order_acquire);
+    if (before & 1)
+    {
+        return false;
+    }
+    memcpy(&analysis, &result, sizeof(analysis));
+    if (record != NULL)
+    {
+        memcpy(record, samples, analysis.words * sizeof(int16_t));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == before;
+}
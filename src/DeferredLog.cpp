@@ -0,0 +1,248 @@
+// DeferredLog.cpp
+#include "DeferredLog.h"
+#include <stdio.h>
+
+#ifndef LIDAR_NATIVE
+// Intervalo entre esvaziamentos do buffer pela tarefa de escrita
+#define LOG_DRAIN_PERIOD_MS 20
+#endif
+
+#define LOG_RATE_COUNT_MASK 0xffUL
+
+const LogCodeInfo logCodes[LOG_CODE_COUNT] = {
+    {LOG_ERROR, "i2c", "nack do 0x%02x no registro 0x%02x"},
+    {LOG_ERROR, "lidar", "leitura falhou: 0x%02x ocupado por %d us (registro 0x%02x)"},
+    {LOG_INFO, "config", "recebidos %d bytes (%d de %d)"},
+    {LOG_WARNING, "config", "JSON inválido (erro %d, %d bytes)"},
+    {LOG_INFO, "web", "login aceito"},
+    {LOG_WARNING, "web", "login recusado"},
+    {LOG_INFO, "lidar", "distância medida: %d cm (zona %d)"},
+};
+
+DeferredLog deferredLog;
+
+DeferredLog::DeferredLog() : head(0), tail(0), summaryCode(0), writtenCount(0), droppedCount(0), suppressedCount(0)
+{
+    for (uint32_t i = 0; i < LOG_RING_DEPTH; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < LOG_CODE_COUNT; i++)
+    {
+        rateState[i].store(0, std::memory_order_relaxed);
+        pending[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Aplica o limite de repetição do código: conta a mensagem na janela
+ *        atual ou a registra como suprimida.
+ *
+ * @return true se a mensagem pode ser gravada.
+ */
+bool DeferredLog::admit(uint16_t code, uint32_t timestampMicros)
+{
+    uint32_t window = timestampMicros >> LOG_RATE_WINDOW_SHIFT;
+    uint32_t state = rateState[code].load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint32_t next;
+        if ((state >> 8) != window)
+        {
+            next = (window << 8) | 1;
+        }
+        else if ((state & LOG_RATE_COUNT_MASK) < LOG_RATE_BURST)
+        {
+            next = state + 1;
+        }
+        else
+        {
+            pending[code].fetch_add(1, std::memory_order_relaxed);
+            suppressedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (rateState[code].compare_exchange_weak(state, next, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Grava uma mensagem no buffer sem bloquear; pode ser chamada de
+ *        qualquer tarefa ou callback, inclusive em paralelo.
+ *
+ * @param code Código da mensagem (LogCode).
+ * @param timestampMicros Instante da mensagem, em micros().
+ * @param a, b, c Argumentos do formato do código.
+ * @return true se a mensagem foi gravada; false se foi suprimida pelo limite
+ *         de repetição ou descartada com o buffer cheio.
+ */
+bool DeferredLog::write(uint16_t code, uint32_t timestampMicros, int32_t a, int32_t b, int32_t c)
+{
+    if (code >= LOG_CODE_COUNT || !admit(code, timestampMicros))
+    {
+        return false;
+    }
+
+    uint32_t position = head.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot &slot = slots[position & (LOG_RING_DEPTH - 1)];
+        int32_t diff = (int32_t)(slot.sequence.load(std::memory_order_acquire) - position);
+        if (diff == 0)
+        {
+            // Posição livre nesta volta: reserva e preenche
+            if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                uint32_t repeats = pending[code].exchange(0, std::memory_order_relaxed);
+                slot.record.timestampMicros = timestampMicros;
+                slot.record.code = code;
+                slot.record.repeats = repeats > 0xffff ? 0xffff : repeats;
+                slot.record.args[0] = a;
+                slot.record.args[1] = b;
+                slot.record.args[2] = c;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                writtenCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // A posição ainda guarda a volta anterior: buffer cheio
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            // Outro escritor reservou a posição primeiro
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Retira a mensagem mais antiga do buffer. Um único leitor.
+ *
+ * @return false se o buffer está vazio ou a mensagem mais antiga ainda está
+ *         sendo preenchida.
+ */
+bool DeferredLog::read(LogRecord &record)
+{
+    Slot &slot = slots[tail & (LOG_RING_DEPTH - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != tail + 1)
+    {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(tail + LOG_RING_DEPTH, std::memory_order_release);
+    tail++;
+    return true;
+}
+
+/**
+ * @brief Resume as mensagens suprimidas de um código cuja janela já terminou
+ *        sem nova mensagem para relatá-las. Um único leitor, como read().
+ *
+ * @param nowMicros Instante atual, em micros().
+ * @param record Recebe o resumo: código, instante e total em repeats.
+ * @return false se não há suprimidas pendentes em janelas encerradas.
+ */
+bool DeferredLog::readSuppressed(uint32_t nowMicros, LogRecord &record)
+{
+    uint32_t window = nowMicros >> LOG_RATE_WINDOW_SHIFT;
+    for (int i = 0; i < LOG_CODE_COUNT; i++)
+    {
+        uint16_t code = summaryCode;
+        summaryCode = (summaryCode + 1) % LOG_CODE_COUNT;
+        if (pending[code].load(std::memory_order_relaxed) == 0 ||
+            (rateState[code].load(std::memory_order_relaxed) >> 8) == window)
+        {
+            continue;
+        }
+        uint32_t count = pending[code].exchange(0, std::memory_order_relaxed);
+        if (count == 0)
+        {
+            continue; // Relatadas por uma mensagem gravada entretanto
+        }
+        record.timestampMicros = nowMicros;
+        record.code = code;
+        record.repeats = count > 0xffff ? 0xffff : count;
+        record.args[0] = record.args[1] = record.args[2] = 0;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Monta a linha de texto de uma mensagem, terminada em '\n'.
+ *
+ * @param summary true para um resumo de readSuppressed().
+ * @return Comprimento da linha, sem o terminador nulo.
+ */
+size_t DeferredLog::format(const LogRecord &record, bool summary, char *line, size_t size)
+{
+    static const char levels[] = "EWI";
+    if (record.code >= LOG_CODE_COUNT || size < 2)
+    {
+        return 0;
+    }
+    const LogCodeInfo &info = logCodes[record.code];
+    int n = snprintf(line, size, "[%5lu.%06lu] %c %s: ", (unsigned long)(record.timestampMicros / 1000000UL),
+                     (unsigned long)(record.timestampMicros % 1000000UL), levels[info.level], info.source);
+    if (n >= 0 && (size_t)n < size)
+    {
+        if (summary)
+        {
+            n += snprintf(line + n, size - n, "%u mensagens suprimidas", record.repeats);
+        }
+        else
+        {
+            n += snprintf(line + n, size - n, info.format, (int)record.args[0], (int)record.args[1], (int)record.args[2]);
+            if (record.repeats > 0 && (size_t)n < size)
+            {
+                n += snprintf(line + n, size - n, " (+%u suprimidas)", record.repeats);
+            }
+        }
+    }
+    // Linha truncada: mantém a quebra no último caractere
+    size_t length = n < 0 ? 0 : (size_t)n < size - 1 ? (size_t)n : size - 2;
+    line[length++] = '\n';
+    line[length] = '\0';
+    return length;
+}
+
+#ifndef LIDAR_NATIVE
+/**
+ * @brief Tarefa de escrita: esvazia o buffer na serial a cada
+ *        LOG_DRAIN_PERIOD_MS. A escrita na UART só atrasa esta tarefa.
+ */
+static void logTask(void *parameter)
+{
+    LogRecord record;
+    char line[LOG_LINE_MAX];
+    for (;;)
+    {
+        while (deferredLog.read(record))
+        {
+            Serial.write((const uint8_t *)line, DeferredLog::format(record, false, line, sizeof(line)));
+        }
+        while (deferredLog.readSuppressed(micros(), record))
+        {
+            Serial.write((const uint8_t *)line, DeferredLog::format(record, true, line, sizeof(line)));
+        }
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+    }
+}
+
+void setupDeferredLog()
+{
+  xTaskCreate(
+      logTask,     // Função da tarefa
+      "Log Task",  // Nome da tarefa
+      3072,        // Tamanho da stack alocada para a tarefa
+      NULL,        // Parâmetros passados para a tarefa (neste caso, nenhum)
+      1,           // Prioridade da tarefa: a menor acima da tarefa ociosa
+      NULL);       // Referência da tarefa criada
+}
+#endif
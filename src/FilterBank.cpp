@@ -0,0 +1,63 @@
+// FilterBank.cpp
+#include "FilterBank.h"
+
+FilterBank::FilterBank() : active(FILTER_NONE), primed(false)
+{
+}
+
+/**
+ * @brief Seleciona a cadeia de filtros ativa.
+ *
+ * A cadeia é reiniciada com a próxima amostra processada, que passa sem filtro.
+ * Identificadores inválidos selecionam FILTER_NONE.
+ *
+ * @param id Cadeia a ser usada a partir da próxima amostra.
+ */
+void FilterBank::select(FilterChainId id)
+{
+    active = (id >= FILTER_NONE && id < FILTER_CHAIN_COUNT) ? id : FILTER_NONE;
+    primed = false;
+}
+
+/**
+ * @brief Filtra uma distância com a cadeia ativa.
+ *
+ * @param distanceCm Distância bruta, em cm.
+ * @return Distância filtrada, em cm.
+ */
+int FilterBank::process(int distanceCm)
+{
+    int32_t value = FILTER_Q8(distanceCm);
+    if (!primed)
+    {
+        kalman.reset(value);
+        medianEma.reset(value);
+        medianKalman.reset(value);
+        stable.reset(value);
+        primed = true;
+        return distanceCm;
+    }
+
+    switch (active)
+    {
+    case FILTER_KALMAN:
+        value = kalman.process(value);
+        break;
+
+    case FILTER_MEDIAN_EMA:
+        value = medianEma.process(value);
+        break;
+
+    case FILTER_MEDIAN_KALMAN:
+        value = medianKalman.process(value);
+        break;
+
+    case FILTER_STABLE:
+        value = stable.process(value);
+        break;
+
+    default: // FILTER_NONE
+        return distanceCm;
+    }
+    return FILTER_CM(value);
+}
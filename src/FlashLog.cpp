@@ -0,0 +1,264 @@
+// FlashLog.cpp
+#include "FlashLog.h"
+#include <string.h>
+
+static_assert(FLASH_LOG_RECORD_HEADER + FLASH_LOG_MAX_PAYLOAD <= FLASH_LOG_PAGE_SIZE,
+              "Um registro deve caber em uma pagina");
+
+// Maior número de segmentos examinados em begin()
+#define FLASH_LOG_SCAN_MAX 256
+
+FlashLog::FlashLog()
+    : storage(NULL), segmentSize(0), maxSegments(0), deviceId(0), pageUsed(0), batchCount(0),
+      writeSegment(1), writeOffset(0), readSegment(1), readOffset(0), readSegmentSize(0),
+      peekedLength(0), logStats()
+{
+}
+
+/**
+ * @brief Associa o registro ao armazenamento e retoma os segmentos existentes.
+ *
+ * A leitura recomeça no segmento mais antigo encontrado; a escrita começa em um
+ * segmento novo, após o mais recente.
+ *
+ * @param storage Armazenamento dos segmentos.
+ * @param segmentSize Tamanho máximo de um segmento, em bytes (ao menos uma página).
+ * @param maxSegments Número máximo de segmentos (limita o espaço ocupado).
+ * @param deviceId Identificador gravado nos quadros de amostras.
+ * @return false se os parâmetros forem inválidos.
+ */
+bool FlashLog::begin(LogStorage &storage, size_t segmentSize, uint32_t maxSegments, uint32_t deviceId)
+{
+    if (segmentSize < FLASH_LOG_PAGE_SIZE || maxSegments < 2)
+    {
+        return false;
+    }
+    this->storage = &storage;
+    this->segmentSize = segmentSize;
+    this->maxSegments = maxSegments;
+    this->deviceId = deviceId;
+
+    uint32_t found[FLASH_LOG_SCAN_MAX];
+    size_t count = storage.list(found, FLASH_LOG_SCAN_MAX);
+    uint32_t oldest = 1, newest = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i == 0 || found[i] < oldest)
+        {
+            oldest = found[i];
+        }
+        if (found[i] > newest)
+        {
+            newest = found[i];
+        }
+    }
+
+    pageUsed = batchCount = peekedLength = 0;
+    writeSegment = newest + 1;
+    writeOffset = 0;
+    readSegment = count ? oldest : writeSegment;
+    readOffset = 0;
+    readSegmentSize = storage.size(readSegment);
+    enforceLimit();
+    return true;
+}
+
+/**
+ * @brief Acrescenta uma amostra ao lote em RAM.
+ */
+void FlashLog::append(const LidarSample &sample)
+{
+    batch[batchCount++] = sample;
+    if (batchCount == FLASH_LOG_BATCH)
+    {
+        flushBatch();
+    }
+}
+
+/**
+ * @brief Acrescenta uma transição de zona ou um alerta de aproximação (com o
+ *        tipo) à página em RAM.
+ */
+void FlashLog::append(const ZoneEvent &event)
+{
+    appendRecord(FLASH_LOG_EVENT, (const uint8_t *)&event, sizeof(event));
+}
+
+/**
+ * @brief Grava o lote de amostras e a página em RAM, mesmo incompletos.
+ */
+void FlashLog::flush()
+{
+    flushBatch();
+    writePage();
+}
+
+void FlashLog::flushBatch()
+{
+    if (batchCount == 0)
+    {
+        return;
+    }
+    SampleEncoder encoder(frame, sizeof(frame), deviceId,
+                          SAMPLE_CODEC_SIGNAL | SAMPLE_CODEC_STATUS | SAMPLE_CODEC_ZONE);
+    for (size_t i = 0; i < batchCount; i++)
+    {
+        encoder.add(batch[i]);
+    }
+    size_t length = encoder.finish();
+    batchCount = 0;
+    appendRecord(FLASH_LOG_SAMPLES, frame, length);
+}
+
+void FlashLog::appendRecord(uint8_t type, const uint8_t *payload, size_t length)
+{
+    if (pageUsed + FLASH_LOG_RECORD_HEADER + length > FLASH_LOG_PAGE_SIZE)
+    {
+        writePage();
+    }
+    page[pageUsed] = type;
+    page[pageUsed + 1] = length & 0xff;
+    page[pageUsed + 2] = length >> 8;
+    memcpy(page + pageUsed + FLASH_LOG_RECORD_HEADER, payload, length);
+    pageUsed += FLASH_LOG_RECORD_HEADER + length;
+    logStats.recordsWritten++;
+}
+
+/**
+ * @brief Grava a página em RAM no segmento atual, abrindo um novo segmento se
+ * ela não couber. Registros nunca ficam divididos entre segmentos.
+ */
+void FlashLog::writePage()
+{
+    if (pageUsed == 0 || storage == NULL)
+    {
+        return;
+    }
+    if (writeOffset > 0 && writeOffset + pageUsed > segmentSize)
+    {
+        if (readSegment == writeSegment)
+        {
+            readSegmentSize = writeOffset; // O segmento de leitura deixa de crescer
+        }
+        writeSegment++;
+        writeOffset = 0;
+        enforceLimit();
+    }
+    if (storage->append(writeSegment, page, pageUsed))
+    {
+        writeOffset += pageUsed;
+        logStats.pageWrites++;
+        logStats.bytesWritten += pageUsed;
+    }
+    else
+    {
+        // A página foi perdida e o segmento pode ter ficado com um registro
+        // truncado: a escrita continua em um segmento novo
+        logStats.writeErrors++;
+        if (readSegment == writeSegment)
+        {
+            readSegmentSize = storage->size(readSegment);
+        }
+        writeSegment++;
+        writeOffset = 0;
+        enforceLimit();
+    }
+    pageUsed = 0;
+}
+
+// Descarta os segmentos mais antigos enquanto o limite for excedido
+void FlashLog::enforceLimit()
+{
+    while (writeSegment - readSegment + 1 > maxSegments)
+    {
+        storage->remove(readSegment);
+        logStats.segmentsDropped++;
+        readSegment++;
+        readOffset = 0;
+        peekedLength = 0;
+        readSegmentSize = readSegment == writeSegment ? 0 : storage->size(readSegment);
+    }
+}
+
+// Bytes legíveis no segmento de leitura
+size_t FlashLog::readLimit()
+{
+    return readSegment == writeSegment ? writeOffset : readSegmentSize;
+}
+
+// Remove o segmento de leitura (já esvaziado) e passa ao seguinte
+void FlashLog::nextReadSegment()
+{
+    storage->remove(readSegment);
+    readSegment++;
+    readOffset = 0;
+    peekedLength = 0;
+    readSegmentSize = readSegment == writeSegment ? 0 : storage->size(readSegment);
+}
+
+/**
+ * @brief true se não houver registros gravados por ler.
+ */
+bool FlashLog::empty()
+{
+    if (storage == NULL)
+    {
+        return true;
+    }
+    while (readSegment != writeSegment && readOffset >= readLimit())
+    {
+        nextReadSegment();
+    }
+    return readOffset >= readLimit();
+}
+
+/**
+ * @brief Copia o registro mais antigo sem retirá-lo; pop() o retira.
+ *
+ * @param type Recebe o tipo do registro (FLASH_LOG_SAMPLES ou FLASH_LOG_EVENT).
+ * @param payload Recebe o conteúdo do registro.
+ * @param capacity Capacidade de payload; use FLASH_LOG_MAX_PAYLOAD.
+ * @return Tamanho do conteúdo, ou 0 se o registro estiver vazio.
+ */
+size_t FlashLog::peek(uint8_t &type, uint8_t *payload, size_t capacity)
+{
+    while (!empty())
+    {
+        uint8_t header[FLASH_LOG_RECORD_HEADER];
+        size_t limit = readLimit();
+        size_t length = 0;
+        if (storage->read(readSegment, readOffset, header, sizeof(header)) == sizeof(header))
+        {
+            length = header[1] | (header[2] << 8);
+        }
+        if (length == 0 || length > capacity || readOffset + FLASH_LOG_RECORD_HEADER + length > limit)
+        {
+            // Registro truncado ou inválido: o restante do segmento é descartado
+            readOffset = limit;
+            continue;
+        }
+        if (storage->read(readSegment, readOffset + FLASH_LOG_RECORD_HEADER, payload, length) != length)
+        {
+            readOffset = limit;
+            continue;
+        }
+        type = header[0];
+        peekedLength = FLASH_LOG_RECORD_HEADER + length;
+        return length;
+    }
+    return 0;
+}
+
+/**
+ * @brief Retira o registro devolvido pelo último peek().
+ */
+void FlashLog::pop()
+{
+    if (peekedLength == 0)
+    {
+        return;
+    }
+    readOffset += peekedLength;
+    peekedLength = 0;
+    logStats.recordsRead++;
+}
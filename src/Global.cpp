@@ -1,39 +1,44 @@
-#include "Global.h"
-#include <cstddef>
-#include <string>
-
-// Definição das variáveis globais
-
-// Mutex para proteger o acesso à variável global de distância
-SemaphoreHandle_t xDistanceMutex = NULL;
-
-// Variável global para armazenar a distância medida
-volatile int globalDistance = 0;
-
-// Fator de divisão para ajustar a medida da distância
-volatile int fator_divisao = 1;
-
-// Início e fim da Zona 1
-volatile int zona1_inicio = 0;
-volatile int zona1_fim = 0;
-
-// Início e fim da Zona 2
-volatile int zona2_inicio = 0;
-volatile int zona2_fim = 0;
-
-// Início e fim da Zona 3
-volatile int zona3_inicio = 0;
-volatile int zona3_fim = 0;
-
-// Token de autenticação do MQTT
-std::string tokenMqt = "";
-
-// variavel com ip do servidor
-std::string ipServidor = "";
-
-// variavel com porta do servidor
-std::string portaServidor = "";
-
-volatile int FiltroKalman = 0;
-
-
+#include "Global.h"
+#include <SPIFFS.h>
+#include <cstddef>
+#include <string>
+
+// Definição das variáveis globais
+
+// Amostra mais recente do LiDAR, publicada sem bloqueio pela tarefa de aquisição
+SamplePublisher samplePublisher;
+
+// Histórico recente de amostras, alocado em setup()
+SampleRing sampleRing;
+
+// Transições de zona recentes
+ZoneEventRing zoneEvents;
+
+// Configuração em RAM (valores padrão até a carga da NVS em setup())
+ConfigStore configStore;
+
+// Captura do registro de correlação (buffer de CORRELATION_MAX_WORDS palavras)
+CorrelationCapture correlacao;
+
+// Trace do sensor 0, em /trace/0.seg no SPIFFS
+FSLogStorage armazenamentoTrace(SPIFFS, "/trace");
+TraceRecorder traceRecorder;
+
+// Estatísticas da amostragem em ritmo fixo
+SamplingScheduler agendadorAmostragem;
+
+// Estado da taxa adaptativa
+AdaptiveRate taxaAdaptativa;
+
+// Estimativa de movimento e alertas de aproximação
+MotionEstimator estimadorMovimento;
+
+// Taxa de amostragem efetiva, em amostras/s
+volatile uint32_t taxaAmostragem = 0;
+
+// Taxa de leituras de cada sensor, em leituras/s
+volatile uint32_t taxaSensores[LIDAR_ARRAY_MAX_SENSORS] = {};
+
+// Jitter do escritor na última janela de um segundo, em µs
+volatile uint32_t publicacaoMaxUs = 0;
+volatile uint32_t intervaloMaxUs = 0;
@@ -1,360 +1,853 @@
-/*------------------------------------------------------------------------------
-
-  Biblioteca LIDARLite para Arduino
-  LIDARLite.cpp
-
-  Esta biblioteca fornece acesso rápido às funções básicas do LIDAR-Lite
-  via a interface Arduino. Além disso, pode fornecer a um usuário de qualquer
-  plataforma um modelo para seu próprio código de aplicação.
-
-  Copyright (c) 2016 Garmin Ltd. ou suas subsidiárias.
-
-  Licensed under the Apache License, Version 2.0 (the "License");
-  you may not use this file except in compliance with the License.
-  You may obtain a copy of the License at
-
-  http://www.apache.org/licenses/LICENSE-2.0
-
-  Unless required by applicable law or agreed to in writing, software
-  distributed under the License is distributed on an "AS IS" BASIS,
-  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-  See the License for the specific language governing permissions and
-  limitations under the License.
-
-------------------------------------------------------------------------------*/
-
-#include <Arduino.h>
-#include <Wire.h>
-#include <stdarg.h>
-#include "LIDARLite.h"
-
-// Endereço padrão I2C do LiDAR-Lite v3HP
-#define LIDAR_LITE_ADDRESS 0x62
-// Registradores do LiDAR-Lite v3HP
-#define REGISTER_ACQ_COMMAND 0x00
-#define REGISTER_DISTANCE_MSB 0x8f
-
-#define SCL_PIN 22
-#define SDA_PIN 21
-#define CLOCKSPEED 400000UL
-
-
-/*------------------------------------------------------------------------------
-  Construtor
-
-  Use LIDARLite::begin para inicializar.
-------------------------------------------------------------------------------*/
-LIDARLite::LIDARLite() {}
-
-/*------------------------------------------------------------------------------
-  Begin
-
-  Inicia o sensor e o I2C.
-
-  Parâmetros
-  ------------------------------------------------------------------------------
-  configuration: Padrão 0. Seleciona uma das várias configurações predefinidas.
-  fasti2c: Padrão 100 kHz. Frequência base do I2C.
-    Se true, a frequência do I2C é definida para 400kHz.
-  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
-    o manual de operação para instruções.
-------------------------------------------------------------------------------*/
-void LIDARLite::begin(int configuration, bool fasti2c, char lidarliteAddress)
-{
-    
-    Wire.begin(SDA_PIN, SCL_PIN, CLOCKSPEED);
-
-    configure(configuration, lidarliteAddress); // Configurações de configuração
-} /* LIDARLite::begin */
-
-/*------------------------------------------------------------------------------
-  Configure
-
-  Seleciona uma das várias configurações predefinidas.
-
-  Parâmetros
-  ------------------------------------------------------------------------------
-  configuration:  Padrão 0.
-    0: Modo padrão, desempenho equilibrado.
-    1: Curto alcance, alta velocidade. Usa contagem máxima de aquisição 0x1d.
-    2: Alcance padrão, maior velocidade em curto alcance. Ativa a detecção de
-        terminação rápida para medições mais rápidas em curto alcance (com precisão
-        reduzida)
-    3: Alcance máximo. Usa contagem máxima de aquisição 0xff.
-    4: Detecção de alta sensibilidade. Sobrescreve o algoritmo de detecção de medição
-        válida padrão, e usa um valor de limiar para alta sensibilidade e ruído.
-    5: Detecção de baixa sensibilidade. Sobrescreve o algoritmo de detecção de medição
-        válida padrão, e usa um valor de limiar para baixa sensibilidade e ruído.
-  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
-    o manual de operação para instruções.
-------------------------------------------------------------------------------*/
-void LIDARLite::configure(int configuration, char lidarliteAddress)
-{
-    switch (configuration)
-    {
-    case 0:                                  // Modo padrão, desempenho equilibrado
-        write(0x02, 0x80, lidarliteAddress); // Padrão
-        write(0x04, 0x08, lidarliteAddress); // Padrão
-        write(0x1c, 0x00, lidarliteAddress); // Padrão
-        break;
-
-    case 1: // Curto alcance, alta velocidade
-        write(0x02, 0x1d, lidarliteAddress);
-        write(0x04, 0x08, lidarliteAddress); // Padrão
-        write(0x1c, 0x00, lidarliteAddress); // Padrão
-        break;
-
-    case 2:                                  // Alcance padrão, maior velocidade em curto alcance
-        write(0x02, 0x80, lidarliteAddress); // Padrão
-        write(0x04, 0x00, lidarliteAddress);
-        write(0x1c, 0x00, lidarliteAddress); // Padrão
-        break;
-
-    case 3: // Alcance máximo
-        write(0x02, 0xff, lidarliteAddress);
-        write(0x04, 0x08, lidarliteAddress); // Padrão
-        write(0x1c, 0x00, lidarliteAddress); // Padrão
-        break;
-
-    case 4:                                  // Detecção de alta sensibilidade, medições errôneas altas
-        write(0x02, 0x80, lidarliteAddress); // Padrão
-        write(0x04, 0x08, lidarliteAddress); // Padrão
-        write(0x1c, 0x80, lidarliteAddress);
-        break;
-
-    case 5:                                  // Detecção de baixa sensibilidade, medições errôneas baixas
-        write(0x02, 0x80, lidarliteAddress); // Padrão
-        write(0x04, 0x08, lidarliteAddress); // Padrão
-        write(0x1c, 0xb0, lidarliteAddress);
-        break;
-    }
-} /* LIDARLite::configure */
-
-/*------------------------------------------------------------------------------
-  Reset
-
-  Reinicia o dispositivo. O dispositivo recarrega as configurações padrão de registro,
-  incluindo o endereço I2C padrão. A reinicialização leva aproximadamente 22ms.
-
-  Parâmetros
-  ------------------------------------------------------------------------------
-  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
-    o manual de operação para instruções.
-------------------------------------------------------------------------------*/
-void LIDARLite::reset(char lidarliteAddress)
-{
-    write(0x00, 0x00, lidarliteAddress);
-} /* LIDARLite::reset */
-
-/*------------------------------------------------------------------------------
-  Distance
-
-  Faz uma medição de distância e lê o resultado.
-
-  Processo
-  ------------------------------------------------------------------------------
-  1.  Escreva 0x04 ou 0x03 no registro 0x00 para iniciar uma aquisição.
-  2.  Leia o registro 0x01 (isto é tratado no comando read())
-      - se o primeiro bit for "1" então o sensor está ocupado, faça loop até que o primeiro
-        bit seja "0"
-      - se o primeiro bit for "0" então o sensor está pronto
-  3.  Leia dois bytes do registro 0x8f e salve
-  4.  Desloque o primeiro valor de 0x8f << 8 e adicione ao segundo valor de 0x8f.
-      O resultado é a distância medida em centímetros.
-
-  Parâmetros
-  ------------------------------------------------------------------------------
-  biasCorrection: Padrão true. Faz aquisição com correção de bias do receptor.
-    Se definido como false, as medições serão mais rápidas. A correção de bias do
-    receptor deve ser realizada periodicamente. (por exemplo, 1 a cada 100 leituras).
-  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
-    o manual de operação para instruções.
-------------------------------------------------------------------------------*/
-int LIDARLite::distance(bool biasCorrection, char lidarliteAddress)
-{
-    if (biasCorrection)
-    {
-        // Faz aquisição e processamento de correlação com correção de bias do receptor
-        write(0x00, 0x04, lidarliteAddress);
-    }
-    else
-    {
-        // Faz aquisição e processamento de correlação sem correção de bias do receptor
-        write(0x00, 0x03, lidarliteAddress);
-    }
-    // Array para armazenar bytes alto e baixo da distância
-    byte distanceArray[2];
-    // Leia dois bytes do registro 0x8f (autoincremento para ler 0x0f e 0x10)
-    read(0x8f, 2, distanceArray, true, lidarliteAddress);
-    // Desloca o byte alto e adiciona ao byte baixo
-    int distance = (distanceArray[0] << 8) + distanceArray[1];
-    return (distance);
-} /* LIDARLite::distance */
-
-/*------------------------------------------------------------------------------
-  Write
-
-  Executa escrita I2C para o dispositivo.
-
-  Parâmetros
-  ------------------------------------------------------------------------------
-  myAddress: endereço do registro para escrever.
-  myValue: valor para escrever.
-  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
-    o manual de operação para instruções.
-------------------------------------------------------------------------------*/
-void LIDARLite::write(char myAddress, char myValue, char lidarliteAddress)
-{
-    Wire.beginTransmission((int)lidarliteAddress);
-    Wire.write((int)myAddress); // Define o registro para escrita
-    Wire.write((int)myValue);   // Escreve myValue no registro
-
-    // Um nack significa que o dispositivo não está respondendo, relata o erro via serial
-    int nackCatcher = Wire.endTransmission();
-    if (nackCatcher != 0)
-    {
-        Serial.println("> nack");
-    }
-
-    delay(1); // Atraso de 1 ms para robustez com leituras e escritas sucessivas
-} /* LIDARLite::write */
-
-/*------------------------------------------------------------------------------
-  Read
-
-  Executa leitura I2C do dispositivo. Detectará um dispositivo não responsivo e
-  relatará o erro via serial. A opção de monitoramento do sinalizador de ocupado
-  pode ser usada para ler registros que são atualizados no final de uma medição
-  de distância para obter os novos dados.
-
-  Parâmetros
-  ------------------------------------------------------------------------------
-  myAddress: endereço do registro para ler.
-  numOfBytes: número de bytes para ler. Pode ser 1 ou 2.
-  arrayToSave: um array para armazenar os valores lidos.
-  monitorBusyFlag: se true, a rotina irá ler repetidamente o registro de status
-    até que o sinalizador de ocupado (LSB) seja 0.
-------------------------------------------------------------------------------*/
-void LIDARLite::read(char myAddress, int numOfBytes, byte arrayToSave[2], bool monitorBusyFlag, char lidarliteAddress)
-{
-    int busyFlag = 0; // busyFlag monitora quando o dispositivo termina uma medição
-    if (monitorBusyFlag)
-    {
-        busyFlag = 1; // Inicia leitura imediatamente se não estiver monitorando sinalizador de ocupado
-    }
-    int busyCounter = 0; // busyCounter conta o número de vezes que o sinalizador de ocupado é verificado, para timeout
-
-    while (busyFlag != 0) // Loop até o dispositivo não estar ocupado
-    {
-        // Lê o registro de status para verificar o sinalizador de ocupado
-        Wire.beginTransmission((int)lidarliteAddress);
-        Wire.write(0x01); // Define o registro de status para ser lido
-
-        // Um nack significa que o dispositivo não está respondendo, relata o erro via serial
-        int nackCatcher = Wire.endTransmission();
-        if (nackCatcher != 0)
-        {
-            Serial.println("> nack");
-        }
-
-        Wire.requestFrom((int)lidarliteAddress, 1); // Lê o registro 0x01
-        busyFlag = bitRead(Wire.read(), 0);         // Atribui o LSB do registro de status a busyFlag
-
-        busyCounter++; // Incrementa busyCounter para timeout
-
-        // Lida com a condição de timeout, sai do loop while e vai para bailout
-        if (busyCounter > 9999)
-        {
-            goto bailout;
-        }
-    }
-
-    // Dispositivo não está ocupado, inicia leitura
-    if (busyFlag == 0)
-    {
-        Wire.beginTransmission((int)lidarliteAddress);
-        Wire.write((int)myAddress); // Define o registro para ser lido
-
-        // Um nack significa que o dispositivo não está respondendo, relata o erro via serial
-        int nackCatcher = Wire.endTransmission();
-        if (nackCatcher != 0)
-        {
-            Serial.println("> nack");
-        }
-
-        // Executa leitura de 1 ou 2 bytes, salva em arrayToSave
-        Wire.requestFrom((int)lidarliteAddress, numOfBytes);
-        int i = 0;
-        if (numOfBytes <= Wire.available())
-        {
-            while (i < numOfBytes)
-            {
-                arrayToSave[i] = Wire.read();
-                i++;
-            }
-        }
-    }
-
-    // bailout relata erro via serial
-    if (busyCounter > 9999)
-    {
-    bailout:
-        busyCounter = 0;
-        Serial.println("> read failed");
-    }
-} /* LIDARLite::read */
-
-/*------------------------------------------------------------------------------
-  Correlation Record To Serial
-
-  O registro de correlação usado para calcular a distância pode ser lido do dispositivo.
-  Ele tem uma forma de onda bipolar, transicionando de uma porção positiva para um
-  pulso negativo aproximadamente simétrico. O ponto onde o sinal cruza zero representa
-  o atraso efetivo para os sinais de referência e retorno.
-
-  Processo
-  ------------------------------------------------------------------------------
-  1.  Faça uma leitura de distância (não há registro de correlação sem pelo menos
-      uma leitura de distância sendo feita)
-  2.  Selecione o banco de memória escrevendo 0xc0 no registro 0x5d
-  3.  Configure o modo de teste selecionando 0x07 no registro 0x40
-  4.  Para tantas leituras quanto quiser (máximo é 1024)
-      1.  Leia dois bytes de 0xd2
-      2.  O byte baixo é o valor do registro
-      3.  O byte alto é o sinal do registro
-
-  Parâmetros
-  ------------------------------------------------------------------------------
-  separator: o separador entre as palavras de dados seriais
-  numberOfReadings: Padrão: 256. Máximo de 1024
-  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
-    o manual de operação para instruções.
-------------------------------------------------------------------------------*/
-void LIDARLite::correlationRecordToSerial(char separator, int numberOfReadings, char lidarliteAddress)
-{
-
-    // Array para armazenar valores lidos
-    byte correlationArray[2];
-    // Var para armazenar o valor do registro de correlação
-    int correlationValue = 0;
-    // Seleciona banco de memória
-    write(0x5d, 0xc0, lidarliteAddress);
-    // Habilita modo de teste
-    write(0x40, 0x07, lidarliteAddress);
-    for (int i = 0; i < numberOfReadings; i++)
-    {
-        // Seleciona byte único
-        read(0xd2, 2, correlationArray, false, lidarliteAddress);
-        // Byte baixo é o valor do registro de correlação
-        correlationValue = correlationArray[0];
-        // se o lsb do byte alto estiver definido, o valor é negativo
-        if ((int)correlationArray[1] == 1)
-        {
-            correlationValue |= 0xff00;
-        }
-        Serial.print((int)correlationValue);
-        Serial.print(separator);
-    }
-    // desabilita modo de teste
-    write(0x40, 0x00, lidarliteAddress);
-} /* LIDARLite::correlationRecordToSerial */
+/*------------------------------------------------------------------------------
+
+  Biblioteca LIDARLite para Arduino
+  LIDARLite.cpp
+
+  Esta biblioteca fornece acesso rápido às funções básicas do LIDAR-Lite
+  via a interface Arduino. Além disso, pode fornecer a um usuário de qualquer
+  plataforma um modelo para seu próprio código de aplicação.
+
+  Copyright (c) 2016 Garmin Ltd. ou suas subsidiárias.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+------------------------------------------------------------------------------*/
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include "LIDARLite.h"
+#include "AcquisitionMetrics.h"
+#include "DeferredLog.h"
+
+// Endereço padrão I2C do LiDAR-Lite v3HP
+#define LIDAR_LITE_ADDRESS 0x62
+// Registradores do LiDAR-Lite v3HP
+#define REGISTER_ACQ_COMMAND 0x00
+#define REGISTER_DISTANCE_MSB 0x8f
+#define REGISTER_SIGNAL_STRENGTH 0x8e // Força do sinal, seguida da distância (autoincremento)
+#define REGISTER_STATUS 0x01
+#define REGISTER_ACQ_CONFIG 0x04
+#define REGISTER_OUTER_LOOP_COUNT 0x11
+#define REGISTER_MEASURE_DELAY 0x45
+#define REGISTER_UNIT_ID 0x96 // UNIT_ID_HIGH (0x16) com autoincremento
+#define REGISTER_I2C_ID_HIGH 0x18
+#define REGISTER_I2C_ID_LOW 0x19
+#define REGISTER_I2C_SEC_ADDR 0x1a
+#define REGISTER_I2C_CONFIG 0x1e
+
+// Unidade do registro MEASURE_DELAY (0x45), em microssegundos
+#define MEASURE_DELAY_UNIT_US 500UL
+
+#define SCL_PIN 22
+#define SDA_PIN 21
+#define CLOCKSPEED 400000UL
+
+
+#ifndef LIDAR_NATIVE
+I2CBus &defaultI2CBus()
+{
+    static WireI2CBus wireBus(Wire);
+    return wireBus;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+  Construtor
+
+  Use LIDARLite::begin para inicializar. O construtor padrão usa o barramento
+  `Wire`; no ambiente nativo o barramento deve ser informado explicitamente.
+------------------------------------------------------------------------------*/
+#ifndef LIDAR_NATIVE
+LIDARLite::LIDARLite()
+    : bus(&defaultI2CBus()), acqStats(), acqState(LIDARLITE_IDLE), acqStartMicros(0),
+      busyTimeoutMicros(LIDARLITE_BUSY_TIMEOUT_US), qualityReadEnabled(false), lastSignalStrength(-1),
+      lastStatus(-1), lastStatusByte(0), freeRunActive(false), freeRunPeriodMicros(0),
+      lastFreeRunDistance(-1), lastFreeRunMicros(0), correlationBulkEnabled(false) {}
+#else
+LIDARLite::LIDARLite()
+    : bus(NULL), acqStats(), acqState(LIDARLITE_IDLE), acqStartMicros(0),
+      busyTimeoutMicros(LIDARLITE_BUSY_TIMEOUT_US), qualityReadEnabled(false), lastSignalStrength(-1),
+      lastStatus(-1), lastStatusByte(0), freeRunActive(false), freeRunPeriodMicros(0),
+      lastFreeRunDistance(-1), lastFreeRunMicros(0), correlationBulkEnabled(false) {}
+#endif
+
+LIDARLite::LIDARLite(I2CBus &i2cBus)
+    : bus(&i2cBus), acqStats(), acqState(LIDARLITE_IDLE), acqStartMicros(0),
+      busyTimeoutMicros(LIDARLITE_BUSY_TIMEOUT_US), qualityReadEnabled(false), lastSignalStrength(-1),
+      lastStatus(-1), lastStatusByte(0), freeRunActive(false), freeRunPeriodMicros(0),
+      lastFreeRunDistance(-1), lastFreeRunMicros(0), correlationBulkEnabled(false) {}
+
+/*------------------------------------------------------------------------------
+  Set Bus
+
+  Substitui o barramento I2C usado pelo driver (ex.: barramento simulado).
+------------------------------------------------------------------------------*/
+void LIDARLite::setBus(I2CBus &i2cBus)
+{
+    bus = &i2cBus;
+} /* LIDARLite::setBus */
+
+/*------------------------------------------------------------------------------
+  Reset Stats
+
+  Zera os contadores de transações, espera por ocupado e erros.
+------------------------------------------------------------------------------*/
+void LIDARLite::resetStats()
+{
+    acqStats = LIDARLiteStats();
+} /* LIDARLite::resetStats */
+
+/*------------------------------------------------------------------------------
+  Begin
+
+  Inicia o sensor e o I2C.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  configuration: Padrão 0. Seleciona uma das várias configurações predefinidas.
+  fasti2c: Padrão 100 kHz. Frequência base do I2C.
+    Se true, a frequência do I2C é definida para 400kHz.
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
+    o manual de operação para instruções.
+------------------------------------------------------------------------------*/
+void LIDARLite::begin(int configuration, bool fasti2c, char lidarliteAddress)
+{
+    
+    bus->begin(SDA_PIN, SCL_PIN, CLOCKSPEED);
+
+    configure(configuration, lidarliteAddress); // Configurações de configuração
+} /* LIDARLite::begin */
+
+/*------------------------------------------------------------------------------
+  Configure
+
+  Seleciona uma das várias configurações predefinidas.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  configuration:  Padrão 0.
+    0: Modo padrão, desempenho equilibrado.
+    1: Curto alcance, alta velocidade. Usa contagem máxima de aquisição 0x1d.
+    2: Alcance padrão, maior velocidade em curto alcance. Ativa a detecção de
+        terminação rápida para medições mais rápidas em curto alcance (com precisão
+        reduzida)
+    3: Alcance máximo. Usa contagem máxima de aquisição 0xff.
+    4: Detecção de alta sensibilidade. Sobrescreve o algoritmo de detecção de medição
+        válida padrão, e usa um valor de limiar para alta sensibilidade e ruído.
+    5: Detecção de baixa sensibilidade. Sobrescreve o algoritmo de detecção de medição
+        válida padrão, e usa um valor de limiar para baixa sensibilidade e ruído.
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
+    o manual de operação para instruções.
+------------------------------------------------------------------------------*/
+void LIDARLite::configure(int configuration, char lidarliteAddress)
+{
+    switch (configuration)
+    {
+    case 0:                                  // Modo padrão, desempenho equilibrado
+        write(0x02, 0x80, lidarliteAddress); // Padrão
+        write(0x04, 0x08, lidarliteAddress); // Padrão
+        write(0x1c, 0x00, lidarliteAddress); // Padrão
+        break;
+
+    case 1: // Curto alcance, alta velocidade
+        write(0x02, 0x1d, lidarliteAddress);
+        write(0x04, 0x08, lidarliteAddress); // Padrão
+        write(0x1c, 0x00, lidarliteAddress); // Padrão
+        break;
+
+    case 2:                                  // Alcance padrão, maior velocidade em curto alcance
+        write(0x02, 0x80, lidarliteAddress); // Padrão
+        write(0x04, 0x00, lidarliteAddress);
+        write(0x1c, 0x00, lidarliteAddress); // Padrão
+        break;
+
+    case 3: // Alcance máximo
+        write(0x02, 0xff, lidarliteAddress);
+        write(0x04, 0x08, lidarliteAddress); // Padrão
+        write(0x1c, 0x00, lidarliteAddress); // Padrão
+        break;
+
+    case 4:                                  // Detecção de alta sensibilidade, medições errôneas altas
+        write(0x02, 0x80, lidarliteAddress); // Padrão
+        write(0x04, 0x08, lidarliteAddress); // Padrão
+        write(0x1c, 0x80, lidarliteAddress);
+        break;
+
+    case 5:                                  // Detecção de baixa sensibilidade, medições errôneas baixas
+        write(0x02, 0x80, lidarliteAddress); // Padrão
+        write(0x04, 0x08, lidarliteAddress); // Padrão
+        write(0x1c, 0xb0, lidarliteAddress);
+        break;
+    }
+} /* LIDARLite::configure */
+
+/*------------------------------------------------------------------------------
+  Reset
+
+  Reinicia o dispositivo. O dispositivo recarrega as configurações padrão de registro,
+  incluindo o endereço I2C padrão. A reinicialização leva aproximadamente 22ms.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
+    o manual de operação para instruções.
+------------------------------------------------------------------------------*/
+void LIDARLite::reset(char lidarliteAddress)
+{
+    write(0x00, 0x00, lidarliteAddress);
+} /* LIDARLite::reset */
+
+/*------------------------------------------------------------------------------
+  Set I2C Address
+
+  Atribui um novo endereço I2C ao sensor. O endereço não é guardado em memória
+  não volátil: volta a 0x62 ao desligar o sensor ou após reset(), portanto deve
+  ser atribuído a cada inicialização.
+
+  Processo
+  ------------------------------------------------------------------------------
+  1.  Leia os dois bytes do número de série em UNIT_ID (0x16 e 0x17)
+  2.  Escreva o número de série em I2C_ID_HIGH (0x18) e I2C_ID_LOW (0x19); o
+      sensor só aceita o novo endereço se o número de série conferir
+  3.  Escreva o novo endereço (deslocado de 1 bit) em I2C_SEC_ADDR (0x1a)
+  4.  Defina o bit 4 de I2C_CONFIG (0x1e) para habilitar o novo endereço
+  5.  Opcionalmente, defina o bit 3 de 0x1e (já pelo novo endereço) para que o
+      sensor deixe de responder em 0x62
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  newAddress: novo endereço de 7 bits.
+  disableDefault: se true, o sensor deixa de responder no endereço padrão, o
+    que é necessário para ligar outro sensor em 0x62 no mesmo barramento.
+  lidarliteAddress: Padrão 0x62. Endereço atual do sensor.
+------------------------------------------------------------------------------*/
+void LIDARLite::setI2Caddr(char newAddress, bool disableDefault, char lidarliteAddress)
+{
+    byte unitId[2] = {0, 0};
+    read(REGISTER_UNIT_ID, 2, unitId, false, lidarliteAddress);
+    write(REGISTER_I2C_ID_HIGH, unitId[0], lidarliteAddress);
+    write(REGISTER_I2C_ID_LOW, unitId[1], lidarliteAddress);
+    write(REGISTER_I2C_SEC_ADDR, newAddress << 1, lidarliteAddress);
+
+    byte i2cConfig = 0;
+    read(REGISTER_I2C_CONFIG, 1, &i2cConfig, false, lidarliteAddress);
+    write(REGISTER_I2C_CONFIG, i2cConfig | 0x10, lidarliteAddress); // Habilita o novo endereço
+
+    if (disableDefault)
+    {
+        read(REGISTER_I2C_CONFIG, 1, &i2cConfig, false, newAddress);
+        write(REGISTER_I2C_CONFIG, i2cConfig | 0x08, newAddress); // Desabilita 0x62
+    }
+} /* LIDARLite::setI2Caddr */
+
+/*------------------------------------------------------------------------------
+  Distance
+
+  Faz uma medição de distância e lê o resultado.
+
+  Processo
+  ------------------------------------------------------------------------------
+  1.  Escreva 0x04 ou 0x03 no registro 0x00 para iniciar uma aquisição.
+  2.  Leia o registro 0x01 (isto é tratado no comando read())
+      - se o primeiro bit for "1" então o sensor está ocupado, faça loop até que o primeiro
+        bit seja "0"
+      - se o primeiro bit for "0" então o sensor está pronto
+  3.  Leia dois bytes do registro 0x8f e salve
+  4.  Desloque o primeiro valor de 0x8f << 8 e adicione ao segundo valor de 0x8f.
+      O resultado é a distância medida em centímetros.
+
+  Com setQualityRead(true) a leitura do passo 3 começa em 0x8e e traz também a
+  força do sinal (um byte a mais na mesma transação); o status do fim da medição
+  é o último lido no passo 2. Ambos ficam em signalStrength() e status().
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  biasCorrection: Padrão true. Faz aquisição com correção de bias do receptor.
+    Se definido como false, as medições serão mais rápidas. A correção de bias do
+    receptor deve ser realizada periodicamente. (por exemplo, 1 a cada 100 leituras).
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
+    o manual de operação para instruções.
+------------------------------------------------------------------------------*/
+int LIDARLite::distance(bool biasCorrection, char lidarliteAddress)
+{
+    // Faz aquisição e processamento de correlação com (0x04) ou sem (0x03)
+    // correção de bias do receptor
+    startMeasurement(biasCorrection, lidarliteAddress);
+    // Array para armazenar a força do sinal e os bytes alto e baixo da distância
+    byte distanceArray[3] = {0, 0, 0};
+    if (qualityReadEnabled)
+    {
+        // Leia três bytes do registro 0x8e (força do sinal, 0x0f e 0x10); o
+        // status é o último lido ao monitorar o sinalizador de ocupado
+        read(REGISTER_SIGNAL_STRENGTH, 3, distanceArray, true, lidarliteAddress);
+        lastSignalStrength = distanceArray[0];
+        lastStatus = lastStatusByte;
+    }
+    else
+    {
+        // Leia dois bytes do registro 0x8f (autoincremento para ler 0x0f e 0x10)
+        read(0x8f, 2, distanceArray + 1, true, lidarliteAddress);
+    }
+    acqState = LIDARLITE_IDLE;
+    // Desloca o byte alto e adiciona ao byte baixo
+    int distance = (distanceArray[1] << 8) + distanceArray[2];
+    return (distance);
+} /* LIDARLite::distance */
+
+/*------------------------------------------------------------------------------
+  Start Measurement
+
+  Dispara uma aquisição sem aguardar o resultado. Use poll() para acompanhar o
+  sinalizador de ocupado e fetchDistance() para ler a distância quando pronta.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  biasCorrection: Padrão true. Veja LIDARLite::distance.
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+------------------------------------------------------------------------------*/
+void LIDARLite::startMeasurement(bool biasCorrection, char lidarliteAddress)
+{
+    {
+        StageTimer timer(METRICS_COMMAND);
+        write(0x00, biasCorrection ? 0x04 : 0x03, lidarliteAddress);
+    }
+    if (biasCorrection)
+    {
+        acqStats.biasAcquisitions++;
+    }
+    else
+    {
+        acqStats.plainAcquisitions++;
+    }
+    acqStartMicros = micros();
+    acqState = LIDARLITE_BUSY;
+} /* LIDARLite::startMeasurement */
+
+/*------------------------------------------------------------------------------
+  Poll
+
+  Lê uma única vez o registro de status 0x01 e atualiza o estado da aquisição.
+  Não bloqueia: se o sensor ainda estiver ocupado retorna LIDARLITE_BUSY, e
+  LIDARLITE_TIMEOUT se o prazo de busyTimeoutMicros já tiver expirado.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+------------------------------------------------------------------------------*/
+LIDARLiteAcqState LIDARLite::poll(char lidarliteAddress)
+{
+    if (acqState != LIDARLITE_BUSY)
+    {
+        return acqState;
+    }
+
+    unsigned long pollStart = micros();
+    byte status = 0;
+    {
+        StageTimer timer(METRICS_BUSY_POLL);
+        read(0x01, 1, &status, false, lidarliteAddress);
+    }
+    acqStats.busyPolls++;
+    acqStats.busyPollMicros += micros() - pollStart;
+
+    unsigned long elapsed = micros() - acqStartMicros;
+    if (bitRead(status, 0) == 0)
+    {
+        acqState = LIDARLITE_READY;
+        lastStatusByte = status;
+    }
+    else if (elapsed > busyTimeoutMicros)
+    {
+        acqState = LIDARLITE_TIMEOUT;
+        acqStats.readTimeouts++;
+        logEvent(LOG_I2C_READ_TIMEOUT, (uint8_t)lidarliteAddress, (int32_t)elapsed, 0x01);
+    }
+    return acqState;
+} /* LIDARLite::poll */
+
+/*------------------------------------------------------------------------------
+  Fetch Distance
+
+  Lê os dois bytes de distância do registro 0x8f sem monitorar o sinalizador
+  de ocupado. Deve ser chamado após poll() retornar LIDARLITE_READY. Com
+  setQualityRead(true) lê também a força do sinal, na mesma transação, e guarda
+  o status lido por poll() (signalStrength() e status()).
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+------------------------------------------------------------------------------*/
+int LIDARLite::fetchDistance(char lidarliteAddress)
+{
+    StageTimer timer(METRICS_RESULT_READ);
+    byte distanceArray[3] = {0, 0, 0};
+    if (qualityReadEnabled)
+    {
+        // Força do sinal e distância na mesma leitura; o status veio de poll()
+        read(REGISTER_SIGNAL_STRENGTH, 3, distanceArray, false, lidarliteAddress);
+        lastSignalStrength = distanceArray[0];
+        lastStatus = lastStatusByte;
+    }
+    else
+    {
+        read(0x8f, 2, distanceArray + 1, false, lidarliteAddress);
+    }
+    acqState = LIDARLITE_IDLE;
+    return (distanceArray[1] << 8) + distanceArray[2];
+} /* LIDARLite::fetchDistance */
+
+/*------------------------------------------------------------------------------
+  Distance Async
+
+  Aquisição em pipeline: quando a medição em andamento termina, lê o resultado
+  e dispara imediatamente a próxima, de modo que o sensor mede enquanto o
+  chamador processa a leitura anterior. Nunca bloqueia. O uso de correção de
+  bias em cada medição disparada é decidido pela política biasCorrection().
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  distance: recebe a distância medida quando a função retorna true.
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+
+  Retorno
+  ------------------------------------------------------------------------------
+  true se uma nova leitura foi obtida; false se o sensor ainda está ocupado (ou
+  a medição expirou e foi disparada novamente).
+------------------------------------------------------------------------------*/
+bool LIDARLite::distanceAsync(int &distance, char lidarliteAddress)
+{
+    switch (poll(lidarliteAddress))
+    {
+    case LIDARLITE_READY:
+        distance = fetchDistance(lidarliteAddress);
+        biasPolicy.observe(distance, lastSignalStrength);
+        startMeasurement(biasPolicy.shouldCorrect(millis()), lidarliteAddress);
+        return true;
+
+    case LIDARLITE_BUSY:
+        return false;
+
+    default: // LIDARLITE_IDLE ou LIDARLITE_TIMEOUT
+        startMeasurement(biasPolicy.shouldCorrect(millis()), lidarliteAddress);
+        return false;
+    }
+} /* LIDARLite::distanceAsync */
+
+/*------------------------------------------------------------------------------
+  Start Free Running
+
+  Coloca o sensor em medição contínua: o laço externo (registro 0x11 em 0xff)
+  repete as aquisições indefinidamente, separadas pelo atraso do registro 0x45
+  (habilitado pelo bit 5 de 0x04). O host passa apenas a ler o resultado mais
+  recente com readLatest().
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  rateHz: taxa interna de repetição desejada, de 8 Hz a 2 kHz. O atraso tem
+    resolução de 0,5 ms e não inclui a duração da aquisição, portanto a taxa
+    efetiva é menor; o período efetivo estimado fica em freeRunPeriod().
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+------------------------------------------------------------------------------*/
+void LIDARLite::startFreeRunning(unsigned int rateHz, char lidarliteAddress)
+{
+    if (rateHz == 0)
+    {
+        rateHz = 1;
+    }
+    unsigned long delayCounts = 1000000UL / MEASURE_DELAY_UNIT_US / rateHz;
+    delayCounts = constrain(delayCounts, 1UL, 255UL);
+
+    // Uma aquisição disparada mede a duração da aquisição com a configuração
+    // atual; somada ao atraso, estima o período interno para detectar repetições
+    unsigned long acquisitionStart = micros();
+    distance(true, lidarliteAddress);
+    unsigned long acquisitionMicros = micros() - acquisitionStart;
+
+    byte acqConfig = 0;
+    read(REGISTER_ACQ_CONFIG, 1, &acqConfig, false, lidarliteAddress);
+    write(REGISTER_MEASURE_DELAY, (char)delayCounts, lidarliteAddress);
+    write(REGISTER_ACQ_CONFIG, acqConfig | 0x20, lidarliteAddress); // Usa o atraso de 0x45
+    write(REGISTER_OUTER_LOOP_COUNT, 0xff, lidarliteAddress);       // Repetição indefinida
+    write(REGISTER_ACQ_COMMAND, 0x04, lidarliteAddress);
+
+    freeRunActive = true;
+    freeRunPeriodMicros = delayCounts * MEASURE_DELAY_UNIT_US + acquisitionMicros;
+    lastFreeRunDistance = -1;
+    lastFreeRunMicros = micros();
+    acqState = LIDARLITE_IDLE;
+} /* LIDARLite::startFreeRunning */
+
+/*------------------------------------------------------------------------------
+  Stop Free Running
+
+  Encerra a medição contínua e restaura o atraso padrão entre aquisições.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+------------------------------------------------------------------------------*/
+void LIDARLite::stopFreeRunning(char lidarliteAddress)
+{
+    byte acqConfig = 0;
+    read(REGISTER_ACQ_CONFIG, 1, &acqConfig, false, lidarliteAddress);
+    write(REGISTER_OUTER_LOOP_COUNT, 0x00, lidarliteAddress);
+    write(REGISTER_ACQ_CONFIG, acqConfig & ~0x20, lidarliteAddress);
+    freeRunActive = false;
+} /* LIDARLite::stopFreeRunning */
+
+/*------------------------------------------------------------------------------
+  Read Latest
+
+  No modo contínuo, lê o resultado mais recente com uma única leitura de dois
+  bytes do registro 0x8f, sem consultar o sinalizador de ocupado.
+
+  O registro de distância não indica se foi atualizado, portanto o resultado é
+  considerado novo se difere do anterior ou se já se passou um período interno
+  estimado desde o último resultado novo (alvo parado). Com o alvo parado e sem
+  ruído a contagem de repetidas é aproximada. Leituras mais rápidas que a taxa
+  interna que repetem o valor são contadas como repetidas (stale).
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  distance: recebe a distância lida (mesmo quando repetida).
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+
+  Retorno
+  ------------------------------------------------------------------------------
+  true se o resultado é novo; false se repete a leitura anterior.
+------------------------------------------------------------------------------*/
+bool LIDARLite::readLatest(int &distance, char lidarliteAddress)
+{
+    byte distanceArray[3] = {0, 0, 0};
+    uint32_t readStart = metricsNow();
+    if (qualityReadEnabled)
+    {
+        // O status não é lido no modo contínuo: o sensor já mede a próxima
+        read(REGISTER_SIGNAL_STRENGTH, 3, distanceArray, false, lidarliteAddress);
+        lastSignalStrength = distanceArray[0];
+    }
+    else
+    {
+        read(REGISTER_DISTANCE_MSB, 2, distanceArray + 1, false, lidarliteAddress);
+    }
+    metricsRecord(METRICS_RESULT_READ, metricsNow() - readStart);
+    distance = (distanceArray[1] << 8) + distanceArray[2];
+    acqStats.freeRunReads++;
+
+    unsigned long now = micros();
+    if (distance != lastFreeRunDistance || (now - lastFreeRunMicros) >= freeRunPeriodMicros)
+    {
+        lastFreeRunDistance = distance;
+        lastFreeRunMicros = now;
+        return true;
+    }
+    acqStats.staleReads++;
+    return false;
+} /* LIDARLite::readLatest */
+
+/*------------------------------------------------------------------------------
+  Write
+
+  Executa escrita I2C para o dispositivo.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  myAddress: endereço do registro para escrever.
+  myValue: valor para escrever.
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
+    o manual de operação para instruções.
+------------------------------------------------------------------------------*/
+void LIDARLite::write(char myAddress, char myValue, char lidarliteAddress)
+{
+    bus->beginTransmission((uint8_t)lidarliteAddress);
+    bus->write((uint8_t)myAddress); // Define o registro para escrita
+    bus->write((uint8_t)myValue);   // Escreve myValue no registro
+
+    // Um nack significa que o dispositivo não está respondendo, registra o erro
+    int nackCatcher = bus->endTransmission();
+    acqStats.transactions++;
+    if (nackCatcher != 0)
+    {
+        acqStats.nacks++;
+        logEvent(LOG_I2C_NACK, (uint8_t)lidarliteAddress, (uint8_t)myAddress);
+    }
+} /* LIDARLite::write */
+
+/*------------------------------------------------------------------------------
+  Read
+
+  Executa leitura I2C do dispositivo. Detectará um dispositivo não responsivo e
+  registrará o erro (DeferredLog.h). A opção de monitoramento do sinalizador de ocupado
+  pode ser usada para ler registros que são atualizados no final de uma medição
+  de distância para obter os novos dados.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  myAddress: endereço do registro para ler.
+  numOfBytes: número de bytes para ler. De 1 a 3.
+  arrayToSave: um array para armazenar os valores lidos.
+  monitorBusyFlag: se true, a rotina irá ler repetidamente o registro de status
+    até que o sinalizador de ocupado (LSB) seja 0 ou até expirar o prazo
+    definido por setBusyTimeout() (padrão LIDARLITE_BUSY_TIMEOUT_US).
+------------------------------------------------------------------------------*/
+void LIDARLite::read(char myAddress, int numOfBytes, byte arrayToSave[2], bool monitorBusyFlag, char lidarliteAddress)
+{
+    int busyFlag = 0; // busyFlag monitora quando o dispositivo termina uma medição
+    if (monitorBusyFlag)
+    {
+        busyFlag = 1; // Inicia leitura imediatamente se não estiver monitorando sinalizador de ocupado
+    }
+    unsigned long busyStart = micros(); // Início da espera, para o prazo de timeout
+    uint32_t stageStart = metricsNow();
+
+    while (busyFlag != 0) // Loop até o dispositivo não estar ocupado
+    {
+        // Lê o registro de status para verificar o sinalizador de ocupado
+        bus->beginTransmission((uint8_t)lidarliteAddress);
+        bus->write(0x01); // Define o registro de status para ser lido
+
+        // Um nack significa que o dispositivo não está respondendo, registra o erro
+        int nackCatcher = bus->endTransmission();
+        acqStats.transactions++;
+        if (nackCatcher != 0)
+        {
+            acqStats.nacks++;
+            logEvent(LOG_I2C_NACK, (uint8_t)lidarliteAddress, 0x01);
+        }
+
+        bus->requestFrom((uint8_t)lidarliteAddress, 1); // Lê o registro 0x01
+        lastStatusByte = bus->read();
+        busyFlag = bitRead(lastStatusByte, 0);          // Atribui o LSB do registro de status a busyFlag
+        acqStats.bytesRead++;
+        acqStats.transactions++;
+        acqStats.busyPolls++;
+
+        // Lida com a condição de timeout, sai do loop while e vai para bailout
+        if (busyFlag != 0 && (micros() - busyStart) > busyTimeoutMicros)
+        {
+            goto bailout;
+        }
+    }
+
+    // Dispositivo não está ocupado, inicia leitura
+    if (busyFlag == 0)
+    {
+        if (monitorBusyFlag)
+        {
+            acqStats.busyPollMicros += micros() - busyStart;
+            uint32_t now = metricsNow();
+            metricsRecord(METRICS_BUSY_POLL, now - stageStart);
+            stageStart = now;
+        }
+
+        bus->beginTransmission((uint8_t)lidarliteAddress);
+        bus->write((uint8_t)myAddress); // Define o registro para ser lido
+
+        // Um nack significa que o dispositivo não está respondendo, registra o erro
+        int nackCatcher = bus->endTransmission();
+        acqStats.transactions++;
+        if (nackCatcher != 0)
+        {
+            acqStats.nacks++;
+            logEvent(LOG_I2C_NACK, (uint8_t)lidarliteAddress, (uint8_t)myAddress);
+        }
+
+        // Executa leitura de 1 a 3 bytes, salva em arrayToSave
+        bus->requestFrom((uint8_t)lidarliteAddress, (uint8_t)numOfBytes);
+        acqStats.transactions++;
+        int i = 0;
+        if (numOfBytes <= bus->available())
+        {
+            while (i < numOfBytes)
+            {
+                arrayToSave[i] = bus->read();
+                i++;
+            }
+            acqStats.bytesRead += numOfBytes;
+        }
+        if (monitorBusyFlag)
+        {
+            // Com o sinalizador monitorado, a leitura é sempre a do resultado
+            metricsRecord(METRICS_RESULT_READ, metricsNow() - stageStart);
+        }
+    }
+
+    // bailout registra o erro
+    if (busyFlag != 0)
+    {
+    bailout:
+        acqStats.busyPollMicros += micros() - busyStart;
+        metricsRecord(METRICS_BUSY_POLL, metricsNow() - stageStart);
+        acqStats.readTimeouts++;
+        logEvent(LOG_I2C_READ_TIMEOUT, (uint8_t)lidarliteAddress, (int32_t)(micros() - busyStart), (uint8_t)myAddress);
+    }
+} /* LIDARLite::read */
+
+/*------------------------------------------------------------------------------
+  Correlation Record To Serial
+
+  O registro de correlação usado para calcular a distância pode ser lido do dispositivo.
+  Ele tem uma forma de onda bipolar, transicionando de uma porção positiva para um
+  pulso negativo aproximadamente simétrico. O ponto onde o sinal cruza zero representa
+  o atraso efetivo para os sinais de referência e retorno.
+
+  Processo
+  ------------------------------------------------------------------------------
+  1.  Faça uma leitura de distância (não há registro de correlação sem pelo menos
+      uma leitura de distância sendo feita)
+  2.  Selecione o banco de memória escrevendo 0xc0 no registro 0x5d
+  3.  Configure o modo de teste selecionando 0x07 no registro 0x40
+  4.  Para tantas leituras quanto quiser (máximo é 1024)
+      1.  Leia dois bytes de 0xd2
+      2.  O byte baixo é o valor do registro
+      3.  O byte alto é o sinal do registro
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  separator: o separador entre as palavras de dados seriais
+  numberOfReadings: Padrão: 256. Máximo de 1024
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado. Veja
+    o manual de operação para instruções.
+------------------------------------------------------------------------------*/
+void LIDARLite::correlationRecordToSerial(char separator, int numberOfReadings, char lidarliteAddress)
+{
+    // Array para armazenar um bloco de valores lidos
+    int16_t correlationArray[LIDARLITE_CORRELATION_CHUNK_WORDS];
+    // Seleciona banco de memória
+    write(0x5d, 0xc0, lidarliteAddress);
+    // Habilita modo de teste
+    write(0x40, 0x07, lidarliteAddress);
+    for (int i = 0; i < numberOfReadings; i += LIDARLITE_CORRELATION_CHUNK_WORDS)
+    {
+        int words = constrain(numberOfReadings - i, 0, LIDARLITE_CORRELATION_CHUNK_WORDS);
+        readCorrelationWords(correlationArray, words, lidarliteAddress);
+        for (int j = 0; j < words; j++)
+        {
+            Serial.print((int)correlationArray[j]);
+            Serial.print(separator);
+        }
+    }
+    // desabilita modo de teste
+    write(0x40, 0x00, lidarliteAddress);
+} /* LIDARLite::correlationRecordToSerial */
+
+/*------------------------------------------------------------------------------
+  Correlation Record
+
+  Copia o registro de correlação da última medição para a memória, palavra a
+  palavra como no manual, ou em leituras em bloco de
+  LIDARLITE_CORRELATION_CHUNK_WORDS palavras com setCorrelationBulkRead(true)
+  (ver readCorrelationWords). Se houver
+  uma medição em andamento, aguarda o seu fim (até busyTimeoutMicros, cedendo a
+  CPU um tick entre as consultas) e copia o registro dela; o resultado de distância continua disponível para poll() e
+  fetchDistance(). O barramento fica ocupado durante toda a cópia.
+
+  Parâmetros
+  ------------------------------------------------------------------------------
+  record: recebe as palavras do registro, com sinal.
+  numberOfReadings: número de palavras a ler. Máximo de 1024
+  lidarliteAddress: Padrão 0x62. Preencha com o novo endereço aqui se alterado.
+
+  Retorno
+  ------------------------------------------------------------------------------
+  Número de palavras copiadas; 0 se a medição em andamento expirou.
+------------------------------------------------------------------------------*/
+int LIDARLite::correlationRecord(int16_t *record, int numberOfReadings, char lidarliteAddress)
+{
+    numberOfReadings = constrain(numberOfReadings, 0, 1024);
+    while (poll(lidarliteAddress) == LIDARLITE_BUSY)
+    {
+        // Cede a CPU por um tick entre as consultas, como a tarefa de
+        // aquisição faz com os sensores ocupados; poll() limita a espera
+#ifndef LIDAR_NATIVE
+        vTaskDelay(1);
+#else
+        delay(1);
+#endif
+    }
+    if (acqState == LIDARLITE_TIMEOUT)
+    {
+        return 0;
+    }
+
+    write(0x5d, 0xc0, lidarliteAddress); // Seleciona banco de memória
+    write(0x40, 0x07, lidarliteAddress); // Habilita modo de teste
+    for (int i = 0; i < numberOfReadings; i += LIDARLITE_CORRELATION_CHUNK_WORDS)
+    {
+        readCorrelationWords(record + i, constrain(numberOfReadings - i, 0, LIDARLITE_CORRELATION_CHUNK_WORDS),
+                             lidarliteAddress);
+    }
+    write(0x40, 0x00, lidarliteAddress); // Desabilita modo de teste
+    return numberOfReadings;
+} /* LIDARLite::correlationRecord */
+
+/*------------------------------------------------------------------------------
+  Read Correlation Words
+
+  Lê words palavras consecutivas da memória de correlação (0xd2). O byte baixo
+  de cada palavra é o valor e o LSB do byte alto é o sinal. O modo de teste
+  deve estar habilitado.
+
+  Por padrão cada palavra é uma leitura de dois bytes de 0xd2, como descrito no
+  manual. A leitura em bloco (setCorrelationBulkRead) pede as palavras em uma
+  única transação e depende de o sensor avançar a memória de correlação a cada
+  par de bytes lido; isso só foi conferido no simulador, não no sensor.
+------------------------------------------------------------------------------*/
+void LIDARLite::readCorrelationWords(int16_t *words, int count, char lidarliteAddress)
+{
+    if (!correlationBulkEnabled)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            byte pair[2] = {0, 0};
+            read(0xd2, 2, pair, false, lidarliteAddress);
+            words[i] = pair[0];
+            if (pair[1] & 0x01)
+            {
+                words[i] |= 0xff00; // Negativo
+            }
+        }
+        return;
+    }
+
+    bus->beginTransmission((uint8_t)lidarliteAddress);
+    bus->write(0xd2);
+    int nackCatcher = bus->endTransmission();
+    acqStats.transactions++;
+    if (nackCatcher != 0)
+    {
+        acqStats.nacks++;
+        logEvent(LOG_I2C_NACK, (uint8_t)lidarliteAddress, 0xd2);
+    }
+
+    bus->requestFrom((uint8_t)lidarliteAddress, (uint8_t)(count * 2));
+    acqStats.transactions++;
+    bool complete = bus->available() >= count * 2;
+    if (complete)
+    {
+        acqStats.bytesRead += count * 2;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        int16_t value = 0;
+        if (complete)
+        {
+            value = bus->read();
+            if (bus->read() & 0x01)
+            {
+                value |= 0xff00; // Negativo
+            }
+        }
+        words[i] = value;
+    }
+} /* LIDARLite::readCorrelationWords */
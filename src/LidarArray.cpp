@@ -0,0 +1,229 @@
+// LidarArray.cpp
+#include "LidarArray.h"
+
+LidarArray::LidarArray() : sensors(), sensorCount(0), cursor(0), freeRunActive(false)
+{
+}
+
+LidarArray::LidarArray(I2CBus &i2cBus) : sensors(), sensorCount(0), cursor(0), freeRunActive(false)
+{
+    for (int i = 0; i < LIDAR_ARRAY_MAX_SENSORS; i++)
+    {
+        sensors[i].driver.setBus(i2cBus);
+    }
+}
+
+/**
+ * @brief Liga os sensores um de cada vez, atribuindo um endereço a cada um, e
+ *        aplica a configuração predefinida (LIDARLite::configure).
+ *
+ * @param enablePins Pino de habilitação de alimentação de cada sensor.
+ * @param count Número de sensores, até LIDAR_ARRAY_MAX_SENSORS.
+ * @param configuration Configuração predefinida de LIDARLite::configure.
+ * @return Número de sensores que responderam.
+ */
+int LidarArray::begin(const int *enablePins, int count, int configuration)
+{
+    sensorCount = constrain(count, 1, LIDAR_ARRAY_MAX_SENSORS);
+    cursor = 0;
+    freeRunActive = false;
+
+    // Todos desligados: apenas o sensor recém-ligado responde em 0x62
+    for (int i = 0; i < sensorCount; i++)
+    {
+        sensors[i].enablePin = enablePins[i];
+        if (sensors[i].enablePin != LIDAR_ARRAY_NO_PIN)
+        {
+            pinMode(sensors[i].enablePin, OUTPUT);
+            digitalWrite(sensors[i].enablePin, LOW);
+        }
+    }
+
+    int found = 0;
+    for (int i = 0; i < sensorCount; i++)
+    {
+        Sensor &sensor = sensors[i];
+        if (sensor.enablePin != LIDAR_ARRAY_NO_PIN)
+        {
+            digitalWrite(sensor.enablePin, HIGH);
+            delay(LIDAR_ARRAY_POWER_UP_MS);
+        }
+
+        uint32_t nacks = sensor.driver.stats().nacks;
+        if (i == 0)
+        {
+            sensor.driver.begin(configuration, true); // Também inicia o barramento
+        }
+        else
+        {
+            sensor.driver.configure(configuration);
+        }
+
+        // Um sensor sem pino de habilitação não pode ser separado dos demais em
+        // 0x62; só é permitido sozinho e mantém o endereço padrão
+        sensor.address = LIDARLITE_ADDR_DEFAULT;
+        if (sensor.enablePin != LIDAR_ARRAY_NO_PIN)
+        {
+            sensor.address = LIDAR_ARRAY_FIRST_ADDRESS + i;
+            sensor.driver.setI2Caddr(sensor.address, true);
+        }
+
+        // Confirma a presença lendo o status no endereço final
+        byte status;
+        sensor.driver.read(0x01, 1, &status, false, sensor.address);
+        sensor.present = sensor.driver.stats().nacks == nacks;
+        if (sensor.present)
+        {
+            found++;
+        }
+        else if (sensor.enablePin != LIDAR_ARRAY_NO_PIN)
+        {
+            // Desligado, para não disputar 0x62 com o próximo sensor
+            digitalWrite(sensor.enablePin, LOW);
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Seleciona a cadeia de filtros de todos os sensores; cada sensor
+ *        mantém o próprio estado de filtro.
+ */
+void LidarArray::selectFilter(FilterChainId id)
+{
+    for (int i = 0; i < sensorCount; i++)
+    {
+        sensors[i].pipeline.selectFilter(id);
+    }
+}
+
+/**
+ * @brief Configura a leitura de qualidade e o descarte de todos os sensores.
+ *
+ * @param readQuality Lê a força do sinal e o status a cada leitura (1 byte a
+ *        mais por leitura, na mesma transação).
+ * @param minSignal Força do sinal mínima de uma leitura válida (QualityGate).
+ * @param rejectMask Classes descartadas (bit q = SignalQuality q).
+ */
+void LidarArray::configureQuality(bool readQuality, uint8_t minSignal, uint8_t rejectMask)
+{
+    for (int i = 0; i < sensorCount; i++)
+    {
+        sensors[i].driver.setQualityRead(readQuality);
+        sensors[i].pipeline.configureQuality(minSignal, rejectMask);
+    }
+}
+
+/**
+ * @brief Define as zonas de todos os sensores (ZoneEngine::configure); a zona
+ *        atual de cada sensor é mantida.
+ */
+void LidarArray::configureZones(const Zone *zones, int count, uint16_t hysteresisCm, uint32_t dwellMicros)
+{
+    for (int i = 0; i < sensorCount; i++)
+    {
+        sensors[i].pipeline.configureZones(zones, count, hysteresisCm, dwellMicros);
+    }
+}
+
+/**
+ * @brief Configura a política de correção de bias de todos os sensores.
+ */
+void LidarArray::configureBias(BiasCorrectionMode mode, uint32_t parameter)
+{
+    for (int i = 0; i < sensorCount; i++)
+    {
+        sensors[i].driver.biasCorrection().configure(mode, parameter);
+    }
+}
+
+/**
+ * @brief Coloca os sensores presentes em medição contínua (LIDARLite::startFreeRunning).
+ */
+void LidarArray::startFreeRunning(unsigned int rateHz)
+{
+    for (int i = 0; i < sensorCount; i++)
+    {
+        if (sensors[i].present)
+        {
+            sensors[i].driver.startFreeRunning(rateHz, sensors[i].address);
+        }
+    }
+    freeRunActive = true;
+}
+
+/**
+ * @brief Encerra a medição contínua; next() volta às aquisições disparadas.
+ */
+void LidarArray::stopFreeRunning()
+{
+    for (int i = 0; i < sensorCount; i++)
+    {
+        if (sensors[i].present && sensors[i].driver.freeRunning())
+        {
+            sensors[i].driver.stopFreeRunning(sensors[i].address);
+        }
+    }
+    freeRunActive = false;
+}
+
+/**
+ * @brief Atende os sensores em rodízio até obter uma leitura nova. Nunca bloqueia.
+ *
+ * A leitura passa pelo SamplePipeline do sensor (qualidade, filtro e zonas)
+ * e é publicada na saída do sensor.
+ *
+ * @param reading Recebe a leitura quando a função retorna true.
+ * @return false se nenhum sensor tinha leitura nova nesta passagem.
+ */
+bool LidarArray::next(LidarArrayReading &reading)
+{
+    for (int n = 0; n < sensorCount; n++)
+    {
+        int index = cursor;
+        cursor = (cursor + 1) % sensorCount;
+        Sensor &sensor = sensors[index];
+        if (!sensor.present)
+        {
+            continue;
+        }
+
+        int distance;
+        bool nova = freeRunActive ? sensor.driver.readLatest(distance, sensor.address)
+                                  : sensor.driver.distanceAsync(distance, sensor.address);
+        if (!nova)
+        {
+            continue;
+        }
+
+        reading.sensor = index;
+        reading.rawDistance = distance;
+        reading.signalStrength = sensor.driver.signalStrength();
+        reading.status = sensor.driver.status();
+        reading.timestampMicros = micros();
+
+        PipelineOutput out;
+        sensor.pipeline.process(reading.timestampMicros, distance, reading.signalStrength, reading.status, out);
+        reading.filteredDistance = out.filteredDistance;
+        reading.quality = out.quality;
+        reading.accepted = out.accepted;
+        reading.zone = out.zone;
+        reading.zoneChanged = out.zoneChanged;
+        reading.zoneEvent = out.zoneEvent;
+        sensor.readings++;
+
+        LidarSample sample = {};
+        sample.sequence = sensor.readings;
+        sample.timestampMicros = reading.timestampMicros;
+        sample.rawDistance = (uint16_t)reading.rawDistance;
+        sample.filteredDistance = (uint16_t)reading.filteredDistance;
+        sample.signalStrength = reading.signalStrength < 0 ? 0 : reading.signalStrength;
+        sample.status = reading.status < 0 ? 0 : reading.status;
+        sample.zone = reading.zone;
+        sample.sensor = index;
+        sample.quality = reading.quality;
+        sensor.output.publish(sample);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,192 @@
+// LiveStream.cpp
+#include "LiveStream.h"
+#include "Global.h"
+
+static AsyncWebSocket ws("/ws");
+
+// Identificadores dos clientes conectados (0 = posição livre)
+static uint32_t clientIds[LIVE_STREAM_MAX_CLIENTS];
+static portMUX_TYPE clientIdsMux = portMUX_INITIALIZER_UNLOCKED;
+
+LiveStreamStats liveStreamStats = {};
+
+/**
+ * @brief Registra conexões e desconexões de clientes do WebSocket.
+ *
+ * Executado na tarefa do servidor assíncrono. Clientes além do limite são recusados.
+ */
+static void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
+                      void *arg, uint8_t *data, size_t len)
+{
+  if (type == WS_EVT_CONNECT)
+  {
+    bool registrado = false;
+    portENTER_CRITICAL(&clientIdsMux);
+    for (int i = 0; i < LIVE_STREAM_MAX_CLIENTS && !registrado; i++)
+    {
+      if (clientIds[i] == 0)
+      {
+        clientIds[i] = client->id();
+        registrado = true;
+      }
+    }
+    portEXIT_CRITICAL(&clientIdsMux);
+
+    if (!registrado)
+    {
+      client->close(1013, "Limite de clientes");
+    }
+  }
+  else if (type == WS_EVT_DISCONNECT)
+  {
+    portENTER_CRITICAL(&clientIdsMux);
+    for (int i = 0; i < LIVE_STREAM_MAX_CLIENTS; i++)
+    {
+      if (clientIds[i] == client->id())
+      {
+        clientIds[i] = 0;
+      }
+    }
+    portEXIT_CRITICAL(&clientIdsMux);
+  }
+}
+
+/**
+ * @brief Envia um quadro de texto a todos os clientes registrados.
+ *
+ * Para cada cliente, o quadro é descartado se a fila de envio estiver cheia, de
+ * modo que um cliente lento perde quadros sem consumir memória dos demais.
+ *
+ * @return true se o quadro foi entregue a pelo menos um cliente.
+ */
+static bool difundir(const char *quadro, size_t tamanho)
+{
+  uint32_t ids[LIVE_STREAM_MAX_CLIENTS];
+  portENTER_CRITICAL(&clientIdsMux);
+  memcpy(ids, clientIds, sizeof(ids));
+  portEXIT_CRITICAL(&clientIdsMux);
+
+  uint32_t clientes = 0;
+  bool enviado = false;
+  for (int i = 0; i < LIVE_STREAM_MAX_CLIENTS; i++)
+  {
+    if (ids[i] == 0)
+    {
+      continue;
+    }
+    AsyncWebSocketClient *cliente = ws.client(ids[i]);
+    if (cliente == NULL || cliente->status() != WS_CONNECTED)
+    {
+      continue;
+    }
+    clientes++;
+    if (cliente->queueIsFull())
+    {
+      liveStreamStats.quadrosDescartados++;
+      continue;
+    }
+    cliente->text(quadro, tamanho);
+    enviado = true;
+  }
+
+  liveStreamStats.clientes = clientes;
+  if (enviado)
+  {
+    liveStreamStats.quadrosEnviados++;
+  }
+  return enviado;
+}
+
+/**
+ * @brief Tarefa que difunde a amostra mais recente aos clientes do WebSocket.
+ *
+ * A cada período envia um único quadro com a última amostra publicada (as
+ * intermediárias são agregadas), precedido de um quadro por transição de zona
+ * ocorrida no período; as transições não são agregadas. Não envia nada se não
+ * houver amostra nem transição nova.
+ */
+static void liveStreamTask(void *pvParameters)
+{
+  TickType_t proximoEnvio = xTaskGetTickCount();
+  uint32_t ultimaSequencia = 0;
+  uint32_t ultimoEvento = zoneEvents.lastSequence();
+  unsigned long inicioJanela = millis();
+  uint32_t quadrosJanela = 0;
+  Config config;
+  uint32_t versaoAplicada = configStore.version() + 1;
+  int taxa = 10;
+
+  while (1)
+  {
+    uint32_t versao = configStore.version();
+    if (versao != versaoAplicada && configStore.snapshot(config))
+    {
+      versaoAplicada = versao;
+      taxa = config.taxaStream;
+    }
+    vTaskDelayUntil(&proximoEnvio, max((TickType_t)1, (TickType_t)pdMS_TO_TICKS(1000 / taxa)));
+
+    ws.cleanupClients(LIVE_STREAM_MAX_CLIENTS);
+
+    unsigned long agora = millis();
+    if (agora - inicioJanela >= 1000)
+    {
+      liveStreamStats.taxaEfetiva = quadrosJanela * 1000UL / (agora - inicioJanela);
+      quadrosJanela = 0;
+      inicioJanela = agora;
+    }
+
+    char quadro[128];
+
+    // Transições de zona e alertas de aproximação desde o último período, em ordem
+    ZoneEvent eventos[ZONE_EVENT_DEPTH];
+    size_t n = zoneEvents.readSince(ultimoEvento, eventos, ZONE_EVENT_DEPTH);
+    for (size_t i = 0; i < n; i++)
+    {
+      int tamanho = snprintf(quadro, sizeof(quadro),
+                             "{\"evento\":%u,\"tipo\":\"%s\",\"t\":%u,\"de\":%u,\"para\":%u,\"d\":%u,\"v\":%d,\"ttc\":%u}",
+                             (unsigned)eventos[i].sequence,
+                             eventos[i].type == ZONE_EVENT_APPROACH ? "alerta" : "transicao",
+                             (unsigned)eventos[i].timestampMicros,
+                             eventos[i].fromZone, eventos[i].toZone, eventos[i].distance, eventos[i].velocity,
+                             eventos[i].leadMillis);
+      difundir(quadro, tamanho);
+      ultimoEvento = eventos[i].sequence;
+    }
+
+    LidarSample amostra;
+    if (!samplePublisher.read(amostra) || amostra.sequence == ultimaSequencia)
+    {
+      continue;
+    }
+    ultimaSequencia = amostra.sequence;
+
+    // Estimativa de movimento da última leitura aceita; ttc 65535 sem previsão
+    MotionState movimento = {};
+    movimento.timeToThresholdMs = MOTION_TTC_NONE;
+    estimadorMovimento.read(movimento);
+
+    int tamanho = snprintf(quadro, sizeof(quadro), "{\"seq\":%u,\"t\":%u,\"d\":%u,\"b\":%u,\"z\":%u,\"v\":%d,\"a\":%d,\"ttc\":%u}",
+                           (unsigned)amostra.sequence, (unsigned)amostra.timestampMicros,
+                           amostra.filteredDistance, amostra.rawDistance, amostra.zone, movimento.velocity,
+                           movimento.acceleration, movimento.timeToThresholdMs);
+    if (difundir(quadro, tamanho))
+    {
+      quadrosJanela++;
+    }
+  }
+}
+
+void setupLiveStream(AsyncWebServer &server)
+{
+  ws.onEvent(onWsEvent);
+  server.addHandler(&ws);
+
+  xTaskCreate(
+      liveStreamTask,     // Função da tarefa
+      "Live Stream Task", // Nome da tarefa
+      4096,               // Tamanho da stack alocada para a tarefa
+      NULL,               // Parâmetros passados para a tarefa (neste caso, nenhum)
+      1,                  // Prioridade da tarefa
+      NULL);              // Referência da tarefa criada
+}
@@ -0,0 +1,212 @@
+// MotionEstimator.cpp
+#include "MotionEstimator.h"
+#include "SamplePublisher.h"
+#include <string.h>
+
+// Conversão de µs para s em Q20: 2^36 / 10^6, aplicada com >> 16
+#define MOTION_MICROS_TO_Q20 68719ULL
+// Inverso do intervalo em Q10: 2^30 / intervalo Q20
+#define MOTION_INVERSE_SHIFT 10
+// Resíduo máximo considerado, em Q16 cm (~32 m)
+#define MOTION_MAX_RESIDUAL 0x7fffffffLL
+
+static int64_t clampMotion(int64_t value, int64_t limit)
+{
+    return value > limit ? limit : value < -limit ? -limit : value;
+}
+
+MotionEstimator::MotionEstimator()
+    : zoneCount(0), lead(0), minSpeed(0), tracking(false), lastMicros(0), position(0), velocity(0),
+      slowVelocity(0), acceleration(0), cachedDt(0), dtQ20(0), inverse(0), alertedZone(ZONE_NONE), current(), version(0),
+      alertCount(0)
+{
+    for (int i = 0; i < WORDS; i++)
+    {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Define as zonas e o critério do alerta. Chamada pela tarefa de
+ *        aquisição, ao aplicar a configuração; a estimativa é mantida.
+ *
+ * @param zones Limites das zonas, como em ZoneEngine::configure().
+ * @param count Número de zonas (no máximo ZONE_MAX).
+ * @param leadMicros Antecedência do alerta; 0 desativa os alertas.
+ * @param minSpeedCmPerSecond Velocidade de aproximação mínima para haver previsão.
+ */
+void MotionEstimator::configure(const Zone *zones, int count, uint32_t leadMicros, uint16_t minSpeedCmPerSecond)
+{
+    zoneCount = count < 0 ? 0 : count > ZONE_MAX ? ZONE_MAX : count;
+    memcpy(zoneList, zones, zoneCount * sizeof(Zone));
+    lead = leadMicros;
+    minSpeed = (int32_t)(minSpeedCmPerSecond > 0 ? minSpeedCmPerSecond : 1) << 16;
+    alertedZone = ZONE_NONE;
+}
+
+/**
+ * @brief Atualiza a estimativa com uma leitura e a publica.
+ *
+ * @param sequence Sequência da amostra publicada para a leitura.
+ * @param timestampMicros Instante da leitura, em micros().
+ * @param filteredDistance Distância após o filtro, em cm.
+ * @param accepted false se a leitura foi descartada pela qualidade.
+ * @param state Recebe a estimativa (a anterior, se a leitura foi descartada).
+ * @return true se a leitura disparou um alerta de aproximação.
+ */
+bool MotionEstimator::update(uint32_t sequence, uint32_t timestampMicros, int filteredDistance, bool accepted,
+                             MotionState &state)
+{
+    if (!accepted)
+    {
+        state = current;
+        return false;
+    }
+
+    int64_t measured = (int64_t)filteredDistance << 16;
+    uint32_t dt = timestampMicros - lastMicros;
+    lastMicros = timestampMicros;
+    if (!tracking || dt > MOTION_MAX_GAP_MICROS)
+    {
+        // Primeira leitura ou lacuna: recomeça parado na distância medida
+        tracking = true;
+        position = measured;
+        velocity = 0;
+        slowVelocity = 0;
+        acceleration = 0;
+    }
+    else
+    {
+        if (dt < MOTION_MIN_DT_MICROS)
+        {
+            dt = MOTION_MIN_DT_MICROS;
+        }
+        if (dt != cachedDt)
+        {
+            cachedDt = dt;
+            dtQ20 = (uint32_t)(((uint64_t)dt * MOTION_MICROS_TO_Q20) >> 16);
+            inverse = (1UL << 30) / dtQ20;
+        }
+
+        // Predição com velocidade constante (Q16 · intervalo Q20, >> 20)
+        int64_t predicted = position + (((int64_t)velocity * dtQ20) >> 20);
+
+        // Correção pelo resíduo; resíduo/intervalo em Q16 cm/s
+        int64_t residual = clampMotion(measured - predicted, MOTION_MAX_RESIDUAL);
+        int64_t rate = (residual * inverse) >> MOTION_INVERSE_SHIFT;
+        position = predicted + ((MOTION_ALPHA * residual) >> MOTION_GAIN_SHIFT);
+        velocity = (int32_t)clampMotion(velocity + ((MOTION_BETA * rate) >> MOTION_GAIN_SHIFT),
+                                        (int64_t)MOTION_MAX_SPEED << 16);
+
+        // Aceleração pelo atraso da média móvel da velocidade: em rampa, a
+        // média fica (velocidade - média) = aceleração · 2^MOTION_ACCEL_SHIFT intervalos atrás
+        slowVelocity += (velocity - slowVelocity) >> MOTION_ACCEL_SHIFT;
+        acceleration = (int32_t)clampMotion(((int64_t)(velocity - slowVelocity) * inverse) >> (MOTION_INVERSE_SHIFT + MOTION_ACCEL_SHIFT),
+                                            (int64_t)MOTION_MAX_ACCELERATION << 16);
+    }
+
+    current.sequence = sequence;
+    current.timestampMicros = timestampMicros;
+    current.velocity = (int16_t)((velocity + 0x8000) >> 16);
+    current.acceleration = (int16_t)((acceleration + 0x8000) >> 16);
+    predictThreshold(current);
+    publish(current);
+    state = current;
+    return current.alert != 0;
+}
+
+/**
+ * @brief Prevê o limite à frente do alvo, o tempo até ele e o alerta.
+ */
+void MotionEstimator::predictThreshold(MotionState &state)
+{
+    state.timeToThresholdMs = MOTION_TTC_NONE;
+    state.targetZone = ZONE_NONE;
+    state.alert = 0;
+
+    if (velocity > -minSpeed)
+    {
+        alertedZone = ZONE_NONE;
+        return;
+    }
+
+    // Entrada mais próxima abaixo da posição: o fim de uma zona (intervalo
+    // [início, fim)); com sobreposição, vale a de menor número
+    int32_t here = position < 0 ? 0 : (int32_t)(position >> 16);
+    uint8_t target = ZONE_NONE;
+    int32_t boundary = 0;
+    for (int i = 0; i < zoneCount; i++)
+    {
+        const Zone &z = zoneList[i];
+        if (z.startCm < z.endCm && z.endCm <= here && z.endCm > boundary)
+        {
+            boundary = z.endCm;
+            target = i + 1;
+        }
+    }
+
+    // Distância até o limite e velocidade em Q8; a distância é limitada para
+    // que distância·1000 caiba em 32 bits
+    int64_t remaining = (position - ((int64_t)boundary << 16)) >> 8;
+    uint32_t gap = remaining < 0 ? 0 : remaining > 4000000 ? 4000000 : (uint32_t)remaining;
+    uint32_t speed = (uint32_t)(-velocity) >> 8;
+    uint32_t ttc = gap * 1000UL / speed;
+    state.timeToThresholdMs = ttc < MOTION_TTC_NONE ? ttc : MOTION_TTC_NONE - 1;
+    state.targetZone = target;
+
+    if (target == ZONE_NONE || lead == 0 || ttc * 1000ULL > 2ULL * lead)
+    {
+        alertedZone = ZONE_NONE;
+    }
+    else if (ttc * 1000ULL <= lead && target != alertedZone)
+    {
+        alertedZone = target;
+        state.alert = 1;
+        alertCount.store(alertCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void MotionEstimator::publish(const MotionState &state)
+{
+    uint32_t raw[WORDS];
+    memcpy(raw, &state, sizeof(raw));
+
+    uint32_t v = version.load(std::memory_order_relaxed);
+    version.store(v + 1, std::memory_order_relaxed); // Ímpar: escrita em andamento
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < WORDS; i++)
+    {
+        words[i].store(raw[i], std::memory_order_relaxed);
+    }
+    version.store(v + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Copia a estimativa mais recente sem bloquear o escritor.
+ *
+ * @return true se a cópia é consistente e já há estimativa; false se o
+ *         escritor interrompeu todas as tentativas ou ainda não publicou.
+ */
+bool MotionEstimator::read(MotionState &state) const
+{
+    uint32_t raw[WORDS];
+    for (int attempt = 0; attempt < SAMPLE_READ_RETRIES; attempt++)
+    {
+        uint32_t before = version.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            continue;
+        }
+        for (int i = 0; i < WORDS; i++)
+        {
+            raw[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) == before)
+        {
+            memcpy(&state, raw, sizeof(raw));
+            return before != 0;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,444 @@
+// MqttPublisher.cpp
+#include "MqttPublisher.h"
+#include "Global.h"
+#include "SampleCodec.h"
+#include "FlashLog.h"
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include <mqtt_client.h>
+
+MqttStats mqttStats = {};
+
+static esp_mqtt_client_handle_t cliente = NULL;
+static volatile bool conectado = false;
+// O broker atual já aceitou uma conexão: só então uma desconexão é uma queda
+static volatile bool enlaceEstabelecido = false;
+
+// Registro em flash das amostras e transições ocorridas com o enlace fora
+static FSLogStorage armazenamento(SPIFFS, "/log");
+static FlashLog registro;
+
+// Mensagens QoS 1 aguardando confirmação: id da mensagem e número de amostras
+#define MQTT_PENDENTES 32
+static struct
+{
+  int msgId;
+  uint16_t amostras;
+} pendentes[MQTT_PENDENTES];
+static portMUX_TYPE pendentesMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Entregas na janela de um segundo, para as taxas
+static volatile uint32_t mensagensJanela = 0;
+static volatile uint32_t amostrasJanela = 0;
+
+static void registrarEntrega(uint16_t amostras)
+{
+  mqttStats.mensagensEnviadas++;
+  mqttStats.amostrasEnviadas += amostras;
+  mensagensJanela++;
+  amostrasJanela += amostras;
+}
+
+/**
+ * @brief Eventos do cliente esp-mqtt, executados na tarefa do cliente.
+ */
+static void onMqttEvent(void *args, esp_event_base_t base, int32_t id, void *dados)
+{
+  esp_mqtt_event_handle_t evento = (esp_mqtt_event_handle_t)dados;
+  switch ((esp_mqtt_event_id_t)id)
+  {
+  case MQTT_EVENT_CONNECTED:
+    conectado = true;
+    enlaceEstabelecido = true;
+    mqttStats.conectado = 1;
+    mqttStats.reconexoes++;
+    break;
+
+  case MQTT_EVENT_DISCONNECTED:
+    conectado = false;
+    mqttStats.conectado = 0;
+    break;
+
+  case MQTT_EVENT_PUBLISHED:
+  {
+    // Confirmação (PUBACK) de uma mensagem QoS 1
+    uint16_t amostras = 0;
+    bool encontrada = false;
+    portENTER_CRITICAL(&pendentesMux);
+    for (int i = 0; i < MQTT_PENDENTES; i++)
+    {
+      if (pendentes[i].msgId == evento->msg_id)
+      {
+        amostras = pendentes[i].amostras;
+        pendentes[i].msgId = 0;
+        encontrada = true;
+        break;
+      }
+    }
+    portEXIT_CRITICAL(&pendentesMux);
+    if (encontrada)
+    {
+      registrarEntrega(amostras);
+    }
+    break;
+  }
+
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Enfileira uma mensagem na outbox do cliente.
+ *
+ * Com QoS 0 a mensagem é contada como entregue ao ser aceita; com QoS 1, quando
+ * o broker confirma (MQTT_EVENT_PUBLISHED).
+ *
+ * @return true se a mensagem foi aceita pelo cliente.
+ */
+static bool publicar(const char *topico, const void *dados, size_t tamanho, int qos, bool reter, uint16_t amostras)
+{
+  int msgId = esp_mqtt_client_enqueue(cliente, topico, (const char *)dados, tamanho, qos, reter, true);
+  if (msgId < 0)
+  {
+    return false;
+  }
+  if (qos == 0)
+  {
+    registrarEntrega(amostras);
+    return true;
+  }
+
+  portENTER_CRITICAL(&pendentesMux);
+  int livre = msgId % MQTT_PENDENTES; // Sobrescreve a entrada mais antiga se não confirmada
+  pendentes[livre].msgId = msgId;
+  pendentes[livre].amostras = amostras;
+  portEXIT_CRITICAL(&pendentesMux);
+  return true;
+}
+
+/**
+ * @brief (Re)cria o cliente com o servidor, a porta e o token atuais.
+ */
+static void conectar(const char *clientId, const Config &configuracao)
+{
+  static std::string host, usuario;
+  static int porta = 0;
+  if (cliente != NULL && host == configuracao.ipServidor && usuario == configuracao.token &&
+      porta == configuracao.portaServidor)
+  {
+    return; // Servidor, porta e token inalterados: mantém a conexão
+  }
+
+  if (cliente != NULL)
+  {
+    esp_mqtt_client_stop(cliente);
+    esp_mqtt_client_destroy(cliente);
+    cliente = NULL;
+    conectado = false;
+    enlaceEstabelecido = false;
+    mqttStats.conectado = 0;
+  }
+
+  host = configuracao.ipServidor;
+  usuario = configuracao.token;
+  porta = configuracao.portaServidor;
+  if (host.empty())
+  {
+    return; // Sem servidor configurado: publicação desativada
+  }
+
+  esp_mqtt_client_config_t config = {};
+  config.host = host.c_str();
+  config.port = porta;
+  config.username = usuario.empty() ? NULL : usuario.c_str();
+  config.client_id = clientId;
+  config.keepalive = 15;
+  config.reconnect_timeout_ms = 2000;
+  config.task_prio = 1; // Abaixo da tarefa do LiDAR (prioridade 5): a rede não preempta a aquisição
+  config.buffer_size = 1024;
+  config.out_buffer_size = SAMPLE_CODEC_FRAME_SIZE(MQTT_MAX_LOTE) + 128;
+
+  cliente = esp_mqtt_client_init(&config);
+  if (cliente == NULL)
+  {
+    return;
+  }
+  esp_mqtt_client_register_event(cliente, MQTT_EVENT_ANY, onMqttEvent, NULL);
+  esp_mqtt_client_start(cliente);
+}
+
+static int formatarEvento(char *json, size_t tamanho, const ZoneEvent &evento)
+{
+  return snprintf(json, tamanho,
+                  "{\"seq\":%u,\"tipo\":\"%s\",\"t\":%u,\"de\":%u,\"para\":%u,\"d\":%u,\"v\":%d,\"ttc\":%u}",
+                  (unsigned)evento.sequence, evento.type == ZONE_EVENT_APPROACH ? "alerta" : "transicao",
+                  (unsigned)evento.timestampMicros, evento.fromZone, evento.toZone, evento.distance,
+                  evento.velocity, evento.leadMillis);
+}
+
+/**
+ * @brief Copia para o registro em flash as amostras e transições ainda não enviadas.
+ */
+static void armazenar(uint32_t &ultimaAmostra, uint32_t &ultimoEvento, LidarSample *lote)
+{
+  ZoneEvent eventos[ZONE_EVENT_DEPTH];
+  size_t n = zoneEvents.readSince(ultimoEvento, eventos, ZONE_EVENT_DEPTH);
+  for (size_t i = 0; i < n; i++)
+  {
+    registro.append(eventos[i]);
+    ultimoEvento = eventos[i].sequence;
+  }
+
+  bool overrun;
+  while ((n = sampleRing.readSince(ultimaAmostra, lote, MQTT_MAX_LOTE, overrun)) > 0)
+  {
+    if (lote[0].sequence - ultimaAmostra > 1)
+    {
+      mqttStats.amostrasPerdidas += lote[0].sequence - ultimaAmostra - 1;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+      registro.append(lote[i]);
+    }
+    ultimaAmostra = lote[n - 1].sequence;
+  }
+}
+
+/**
+ * @brief Publica até MQTT_REGISTRO_POR_CICLO registros do registro em flash.
+ *
+ * Um registro só é retirado depois de aceito pelo cliente.
+ */
+static void drenarRegistro(const char *topicoAmostras, const char *topicoZonas, int qos, uint8_t *quadro)
+{
+  for (int i = 0; i < MQTT_REGISTRO_POR_CICLO; i++)
+  {
+    uint8_t tipo;
+    size_t tamanho = registro.peek(tipo, quadro, FLASH_LOG_MAX_PAYLOAD);
+    if (tamanho == 0)
+    {
+      return;
+    }
+
+    bool aceito = true;
+    if (tipo == FLASH_LOG_SAMPLES)
+    {
+      // O registro já é um quadro de SampleCodec; a contagem está no cabeçalho
+      uint16_t amostras = quadro[16] | (quadro[17] << 8);
+      aceito = publicar(topicoAmostras, quadro, tamanho, qos, false, amostras);
+    }
+    else if (tipo == FLASH_LOG_EVENT && tamanho >= offsetof(ZoneEvent, velocity) && tamanho <= sizeof(ZoneEvent))
+    {
+      // Registros antigos, sem velocidade e antecedência, ficam com ambas em 0;
+      // sem o tipo, o alerta é o evento com antecedência
+      ZoneEvent evento = {};
+      memcpy(&evento, quadro, tamanho);
+      if (tamanho < offsetof(ZoneEvent, type) + 1)
+      {
+        evento.type = evento.leadMillis > 0 ? ZONE_EVENT_APPROACH : ZONE_EVENT_TRANSITION;
+      }
+      char json[128];
+      aceito = publicar(topicoZonas, json, formatarEvento(json, sizeof(json), evento), qos, false, 0);
+    }
+    if (!aceito)
+    {
+      return;
+    }
+    registro.pop();
+  }
+}
+
+/**
+ * @brief Tarefa que agrupa e publica amostras, transições de zona e saúde.
+ *
+ * Roda com prioridade baixa e nunca bloqueia a tarefa do LiDAR: lê o buffer
+ * circular e o anel de eventos sem trava e apenas enfileira mensagens no cliente.
+ */
+static void mqttTask(void *pvParameters)
+{
+  char clientId[24];
+  snprintf(clientId, sizeof(clientId), "lidar-%012llx", (unsigned long long)ESP.getEfuseMac());
+  char topicoAmostras[48], topicoZonas[48], topicoSaude[48];
+  snprintf(topicoAmostras, sizeof(topicoAmostras), "lidar/%s/amostras", clientId + 6);
+  snprintf(topicoZonas, sizeof(topicoZonas), "lidar/%s/zonas", clientId + 6);
+  snprintf(topicoSaude, sizeof(topicoSaude), "lidar/%s/saude", clientId + 6);
+
+  uint8_t *quadro = (uint8_t *)malloc(max((size_t)SAMPLE_CODEC_FRAME_SIZE(MQTT_MAX_LOTE), (size_t)FLASH_LOG_MAX_PAYLOAD));
+  LidarSample *lote = (LidarSample *)malloc(MQTT_MAX_LOTE * sizeof(LidarSample));
+  if (quadro == NULL || lote == NULL)
+  {
+    Serial.println("Erro ao alocar os buffers do MQTT");
+    vTaskDelete(NULL);
+    return;
+  }
+
+  Config configuracao;
+  uint32_t versaoAplicada = configStore.version() + 1; // Diferente da atual: força a conexão inicial
+  uint32_t ultimaAmostra = sampleRing.lastSequence();
+  uint32_t ultimoEvento = zoneEvents.lastSequence();
+  unsigned long ultimoEnvio = millis();
+  unsigned long ultimaSaude = 0;
+  unsigned long inicioJanela = millis();
+  bool registroPendente = false;
+
+  while (1)
+  {
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    // Configuração substituída via /salvar: o lote, o intervalo e o QoS valem no
+    // próximo envio; a conexão só é refeita se o servidor, a porta ou o token mudaram
+    uint32_t versao = configStore.version();
+    if (versao != versaoAplicada && configStore.snapshot(configuracao))
+    {
+      versaoAplicada = versao;
+      conectar(clientId, configuracao);
+    }
+
+    unsigned long agora = millis();
+    if (agora - inicioJanela >= 1000)
+    {
+      mqttStats.taxaMensagens = mensagensJanela * 1000UL / (agora - inicioJanela);
+      mqttStats.taxaAmostras = amostrasJanela * 1000UL / (agora - inicioJanela);
+      mensagensJanela = 0;
+      amostrasJanela = 0;
+      inicioJanela = agora;
+
+      const FlashLogStats &registroStats = registro.stats();
+      mqttStats.registroGravados = registroStats.bytesWritten;
+      mqttStats.registroDescartados = registroStats.segmentsDropped;
+      mqttStats.registroSegmentos = registro.empty() ? 0 : registro.segments();
+    }
+
+    if (cliente == NULL)
+    {
+      continue; // Sem servidor configurado
+    }
+
+    if (!conectado)
+    {
+      if (enlaceEstabelecido)
+      {
+        // Enlace caiu: amostras e transições vão para o registro em flash
+        armazenar(ultimaAmostra, ultimoEvento, lote);
+        registroPendente = true;
+      }
+      else
+      {
+        // Broker ainda não alcançado (ex.: endereço errado): nada a retomar,
+        // a publicação começa pelas amostras da conexão
+        ultimaAmostra = sampleRing.lastSequence();
+        ultimoEvento = zoneEvents.lastSequence();
+      }
+      continue;
+    }
+    if (registroPendente)
+    {
+      // Grava a página parcial para que o registro possa ser esvaziado
+      registro.flush();
+      registroPendente = false;
+    }
+
+    int qos = configuracao.mqttQos;
+    bool outboxCheia = esp_mqtt_client_get_outbox_size(cliente) > MQTT_OUTBOX_MAX;
+
+    // Transições de zona: uma mensagem por evento, sem agrupamento
+    ZoneEvent eventos[ZONE_EVENT_DEPTH];
+    size_t n = outboxCheia ? 0 : zoneEvents.readSince(ultimoEvento, eventos, ZONE_EVENT_DEPTH);
+    for (size_t i = 0; i < n; i++)
+    {
+      char json[128];
+      if (!publicar(topicoZonas, json, formatarEvento(json, sizeof(json), eventos[i]), qos, false, 0))
+      {
+        break;
+      }
+      ultimoEvento = eventos[i].sequence;
+      mqttStats.eventosEnviados++;
+    }
+
+    // Amostras: um lote quando há amostras suficientes ou o intervalo venceu
+    int loteMax = min((int)configuracao.mqttLote, MQTT_MAX_LOTE);
+    uint32_t disponiveis = sampleRing.lastSequence() - ultimaAmostra;
+    bool intervaloVencido = agora - ultimoEnvio >= (unsigned long)configuracao.mqttIntervalo;
+    if (disponiveis == 0 || (disponiveis < (uint32_t)loteMax && !intervaloVencido))
+    {
+      // Nada a enviar ainda
+    }
+    else if (outboxCheia)
+    {
+      mqttStats.publicacoesAdiadas++;
+    }
+    else
+    {
+      bool overrun;
+      size_t lidas = sampleRing.readSince(ultimaAmostra, lote, loteMax, overrun);
+      if (lidas > 0)
+      {
+        if (lote[0].sequence - ultimaAmostra > 1)
+        {
+          mqttStats.amostrasPerdidas += lote[0].sequence - ultimaAmostra - 1;
+        }
+        SampleEncoder encoder(quadro, SAMPLE_CODEC_FRAME_SIZE(MQTT_MAX_LOTE), (uint32_t)ESP.getEfuseMac(),
+                              SAMPLE_CODEC_SIGNAL | SAMPLE_CODEC_STATUS | SAMPLE_CODEC_ZONE);
+        for (size_t i = 0; i < lidas; i++)
+        {
+          encoder.add(lote[i]);
+        }
+        size_t tamanho = encoder.finish();
+        if (publicar(topicoAmostras, quadro, tamanho, qos, false, lidas))
+        {
+          ultimaAmostra = lote[lidas - 1].sequence;
+          ultimoEnvio = agora;
+        }
+        else
+        {
+          mqttStats.publicacoesAdiadas++;
+        }
+      }
+    }
+
+    // Registro em flash: depois do tráfego ao vivo, em ritmo limitado
+    if (!outboxCheia)
+    {
+      drenarRegistro(topicoAmostras, topicoZonas, qos, quadro);
+    }
+
+    // Saúde: retida, para que o backend veja o último estado ao se inscrever
+    if (agora - ultimaSaude >= MQTT_INTERVALO_SAUDE && !outboxCheia)
+    {
+      const LIDARLiteStats &stats = lidars.driver(0).stats();
+      char json[320];
+      int tamanho = snprintf(json, sizeof(json),
+                             "{\"uptime\":%lu,\"taxaAmostragem\":%u,\"nacks\":%u,\"timeouts\":%u,"
+                             "\"heapLivre\":%u,\"rssi\":%d,\"mensagens\":%u,\"amostras\":%u,"
+                             "\"perdidas\":%u,\"adiadas\":%u,\"reconexoes\":%u}",
+                             agora / 1000, (unsigned)taxaAmostragem, (unsigned)stats.nacks,
+                             (unsigned)stats.readTimeouts, (unsigned)ESP.getFreeHeap(), WiFi.RSSI(),
+                             (unsigned)mqttStats.mensagensEnviadas, (unsigned)mqttStats.amostrasEnviadas,
+                             (unsigned)mqttStats.amostrasPerdidas, (unsigned)mqttStats.publicacoesAdiadas,
+                             (unsigned)mqttStats.reconexoes);
+      if (publicar(topicoSaude, json, tamanho, qos, true, 0))
+      {
+        ultimaSaude = agora;
+      }
+    }
+  }
+}
+
+void setupMqttPublisher()
+{
+  // O SPIFFS já foi montado por setupWiFi(); dados de uma queda anterior ao
+  // reinício são retomados e enviados após a conexão
+  if (!registro.begin(armazenamento, MQTT_REGISTRO_SEGMENTO, MQTT_REGISTRO_SEGMENTOS, (uint32_t)ESP.getEfuseMac()))
+  {
+    Serial.println("Erro ao iniciar o registro em flash");
+  }
+
+  xTaskCreate(
+      mqttTask,     // Função da tarefa
+      "MQTT Task",  // Nome da tarefa
+      6144,         // Tamanho da stack alocada para a tarefa
+      NULL,         // Parâmetros passados para a tarefa (neste caso, nenhum)
+      1,            // Prioridade da tarefa
+      NULL);        // Referência da tarefa criada
+}
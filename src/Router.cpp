@@ -1 +1 @@
-#include <ESPAsyncWebServer.h>
+#include <ESPAsyncWebServer.h>
@@ -0,0 +1,262 @@
+// SampleCodec.cpp
+#include "SampleCodec.h"
+#include <string.h>
+
+static void putU16(uint8_t *p, uint16_t value)
+{
+    p[0] = value & 0xff;
+    p[1] = value >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+static uint16_t getU16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief CRC-32 (IEEE 802.3, polinômio refletido 0xEDB88320) com tabela de 16 entradas.
+ */
+uint32_t sampleCodecCrc32(const uint8_t *data, size_t length)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0x0f] ^ (crc >> 4);
+        crc = table[(crc ^ (data[i] >> 4)) & 0x0f] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Inicia um quadro no buffer informado.
+ *
+ * @param buffer Destino do quadro; use SAMPLE_CODEC_FRAME_SIZE(n) para dimensioná-lo.
+ * @param capacity Tamanho do buffer, em bytes.
+ * @param deviceId Identificador do dispositivo gravado no cabeçalho.
+ * @param flags Canais opcionais (SAMPLE_CODEC_SIGNAL, SAMPLE_CODEC_STATUS, SAMPLE_CODEC_ZONE).
+ */
+SampleEncoder::SampleEncoder(uint8_t *buffer, size_t capacity, uint32_t deviceId, uint8_t flags)
+    : out(buffer), capacity(capacity), pos(SAMPLE_CODEC_HEADER_SIZE), flags(flags), sampleCount(0), previous()
+{
+    if (capacity >= SAMPLE_CODEC_HEADER_SIZE)
+    {
+        memset(out, 0, SAMPLE_CODEC_HEADER_SIZE);
+        out[0] = 'L';
+        out[1] = 'S';
+        out[2] = SAMPLE_CODEC_VERSION;
+        out[3] = flags;
+        putU32(out + 4, deviceId);
+    }
+}
+
+void SampleEncoder::putVarint(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out[pos++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    out[pos++] = value;
+}
+
+void SampleEncoder::putZigzag(int32_t value)
+{
+    putVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+/**
+ * @brief Acrescenta uma amostra ao quadro. As sequências devem ser crescentes.
+ *
+ * @return false se não houver espaço para mais uma amostra no pior caso (o quadro
+ *         continua válido e pode ser finalizado).
+ */
+bool SampleEncoder::add(const LidarSample &sample)
+{
+    if (sampleCount == 0xffff || pos + SAMPLE_CODEC_MAX_SAMPLE_SIZE + SAMPLE_CODEC_CRC_SIZE > capacity)
+    {
+        return false;
+    }
+
+    if (sampleCount == 0)
+    {
+        putU32(out + 8, sample.sequence);
+        putU32(out + 12, sample.timestampMicros);
+        previous = sample;
+        previous.sequence = sample.sequence - 1;
+        previous.rawDistance = 0;
+        previous.signalStrength = 0;
+    }
+
+    putVarint(sample.sequence - previous.sequence - 1);
+    putZigzag((int32_t)(sample.timestampMicros - previous.timestampMicros));
+    putZigzag((int32_t)sample.rawDistance - (int32_t)previous.rawDistance);
+    putZigzag((int32_t)sample.filteredDistance - (int32_t)sample.rawDistance);
+    if (flags & SAMPLE_CODEC_SIGNAL)
+    {
+        putZigzag((int32_t)sample.signalStrength - (int32_t)previous.signalStrength);
+    }
+    if (flags & SAMPLE_CODEC_STATUS)
+    {
+        out[pos++] = sample.status;
+    }
+    if (flags & SAMPLE_CODEC_ZONE)
+    {
+        out[pos++] = sample.zone;
+    }
+
+    previous = sample;
+    sampleCount++;
+    return true;
+}
+
+/**
+ * @brief Grava a contagem e o CRC e retorna o tamanho total do quadro.
+ */
+size_t SampleEncoder::finish()
+{
+    putU16(out + 16, sampleCount);
+    putU32(out + pos, sampleCodecCrc32(out, pos));
+    return pos + SAMPLE_CODEC_CRC_SIZE;
+}
+
+static bool getVarint(const uint8_t *data, size_t end, size_t &pos, uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (pos >= end)
+        {
+            return false;
+        }
+        uint8_t byte = data[pos++];
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool getZigzag(const uint8_t *data, size_t end, size_t &pos, int32_t &value)
+{
+    uint32_t raw;
+    if (!getVarint(data, end, pos, raw))
+    {
+        return false;
+    }
+    value = (int32_t)((raw >> 1) ^ (~(raw & 1) + 1));
+    return true;
+}
+
+/**
+ * @brief Decodifica um quadro produzido por SampleEncoder.
+ *
+ * O comprimento do corpo só é conhecido ao percorrê-lo, portanto o CRC é
+ * verificado depois da decodificação; em caso de erro o conteúdo de out não
+ * deve ser usado.
+ *
+ * @param data Início do quadro.
+ * @param length Bytes disponíveis a partir de data (podem seguir outros quadros).
+ * @param out Destino das amostras.
+ * @param maxSamples Capacidade de out.
+ * @param info Recebe o cabeçalho e o tamanho do quadro.
+ * @return SAMPLE_CODEC_OK ou o motivo da falha.
+ */
+SampleCodecError decodeSampleFrame(const uint8_t *data, size_t length, LidarSample *out,
+                                   size_t maxSamples, SampleFrameInfo &info)
+{
+    if (length < SAMPLE_CODEC_HEADER_SIZE + SAMPLE_CODEC_CRC_SIZE)
+    {
+        return SAMPLE_CODEC_TRUNCATED;
+    }
+    if (data[0] != 'L' || data[1] != 'S' || data[2] != SAMPLE_CODEC_VERSION)
+    {
+        return SAMPLE_CODEC_BAD_MAGIC;
+    }
+
+    info.flags = data[3];
+    info.deviceId = getU32(data + 4);
+    info.count = getU16(data + 16);
+    if (info.count > maxSamples)
+    {
+        return SAMPLE_CODEC_OVERFLOW;
+    }
+
+    LidarSample previous = {};
+    previous.sequence = getU32(data + 8) - 1;
+    previous.timestampMicros = getU32(data + 12);
+
+    size_t end = length - SAMPLE_CODEC_CRC_SIZE;
+    size_t pos = SAMPLE_CODEC_HEADER_SIZE;
+    for (uint16_t i = 0; i < info.count; i++)
+    {
+        uint32_t gap;
+        int32_t timeDelta, rawDelta, filteredOffset, signalDelta = 0;
+        if (!getVarint(data, end, pos, gap) || !getZigzag(data, end, pos, timeDelta) ||
+            !getZigzag(data, end, pos, rawDelta) || !getZigzag(data, end, pos, filteredOffset))
+        {
+            return SAMPLE_CODEC_TRUNCATED;
+        }
+        if ((info.flags & SAMPLE_CODEC_SIGNAL) && !getZigzag(data, end, pos, signalDelta))
+        {
+            return SAMPLE_CODEC_TRUNCATED;
+        }
+
+        LidarSample &sample = out[i];
+        sample = LidarSample();
+        sample.sequence = previous.sequence + gap + 1;
+        sample.timestampMicros = previous.timestampMicros + (uint32_t)timeDelta;
+        sample.rawDistance = (uint16_t)(previous.rawDistance + rawDelta);
+        sample.filteredDistance = (uint16_t)(sample.rawDistance + filteredOffset);
+        if (info.flags & SAMPLE_CODEC_SIGNAL)
+        {
+            sample.signalStrength = (uint8_t)(previous.signalStrength + signalDelta);
+        }
+        if (info.flags & SAMPLE_CODEC_STATUS)
+        {
+            if (pos >= end)
+            {
+                return SAMPLE_CODEC_TRUNCATED;
+            }
+            sample.status = data[pos++];
+        }
+        if (info.flags & SAMPLE_CODEC_ZONE)
+        {
+            if (pos >= end)
+            {
+                return SAMPLE_CODEC_TRUNCATED;
+            }
+            sample.zone = data[pos++];
+        }
+        previous = sample;
+    }
+
+    if (pos + SAMPLE_CODEC_CRC_SIZE > length)
+    {
+        return SAMPLE_CODEC_TRUNCATED;
+    }
+    if (sampleCodecCrc32(data, pos) != getU32(data + pos))
+    {
+        return SAMPLE_CODEC_BAD_CRC;
+    }
+    info.frameSize = pos + SAMPLE_CODEC_CRC_SIZE;
+    return SAMPLE_CODEC_OK;
+}
@@ -0,0 +1,35 @@
+// SamplePipeline.cpp
+#include "SamplePipeline.h"
+#include "AcquisitionMetrics.h"
+
+SamplePipeline::SamplePipeline() : filtered(0)
+{
+}
+
+/**
+ * @brief Processa uma leitura: qualidade, filtro e zonas.
+ *
+ * @param timestampMicros Instante da leitura, em micros().
+ * @param distance Distância lida, em cm.
+ * @param signalStrength Força do sinal (0x0e), ou -1 se não foi lida.
+ * @param status Registro de status (0x01), ou -1 se não foi lido.
+ * @param out Recebe o resultado.
+ */
+void SamplePipeline::process(uint32_t timestampMicros, int distance, int signalStrength, int status, PipelineOutput &out)
+{
+    out.quality = gate.classify(distance, signalStrength, status);
+    out.accepted = gate.accept(out.quality);
+    out.zoneChanged = false;
+    if (out.accepted)
+    {
+        {
+            StageTimer timer(METRICS_FILTER);
+            filtered = filters.process(distance);
+        }
+
+        // Zonas sobre a distância filtrada
+        out.zoneChanged = zoneEngine.update((uint16_t)filtered, timestampMicros, out.zoneEvent);
+    }
+    out.filteredDistance = filtered;
+    out.zone = zoneEngine.current();
+}
@@ -0,0 +1,70 @@
+// SamplePublisher.cpp
+#include "SamplePublisher.h"
+#include <string.h>
+
+SamplePublisher::SamplePublisher() : version(0)
+{
+    for (int i = 0; i < WORDS; i++)
+    {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Publica uma nova amostra. Deve ser chamada por um único escritor.
+ *
+ * @param sample Registro completo da amostra.
+ */
+void SamplePublisher::publish(const LidarSample &sample)
+{
+    uint32_t raw[WORDS];
+    memcpy(raw, &sample, sizeof(raw));
+
+    uint32_t v = version.load(std::memory_order_relaxed);
+    version.store(v + 1, std::memory_order_relaxed); // Ímpar: escrita em andamento
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < WORDS; i++)
+    {
+        words[i].store(raw[i], std::memory_order_relaxed);
+    }
+    version.store(v + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Copia a amostra mais recente sem bloquear o escritor.
+ *
+ * @param sample Recebe a amostra quando a leitura é consistente.
+ * @return true se a cópia é consistente; false se o escritor interrompeu todas
+ *         as tentativas (o conteúdo de sample não deve ser usado).
+ */
+bool SamplePublisher::read(LidarSample &sample) const
+{
+    uint32_t raw[WORDS];
+    for (int attempt = 0; attempt < SAMPLE_READ_RETRIES; attempt++)
+    {
+        uint32_t before = version.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            continue;
+        }
+        for (int i = 0; i < WORDS; i++)
+        {
+            raw[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) == before)
+        {
+            memcpy(&sample, raw, sizeof(raw));
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Número de sequência da última amostra publicada (0 se nenhuma).
+ */
+uint32_t SamplePublisher::sequence() const
+{
+    return words[0].load(std::memory_order_relaxed);
+}
@@ -0,0 +1,132 @@
+// SampleRing.cpp
+#include "SampleRing.h"
+#include <string.h>
+#include <new>
+
+SampleRing::SampleRing() : slots(NULL), slotCount(0), mask(0), last(0) {}
+
+SampleRing::~SampleRing()
+{
+    delete[] slots;
+}
+
+/**
+ * @brief Aloca o buffer. A profundidade é arredondada para a potência de 2
+ * inferior e limitada a [SAMPLE_RING_MIN_DEPTH, SAMPLE_RING_MAX_DEPTH].
+ *
+ * @param depth Número de amostras desejado.
+ * @return true se a alocação foi bem-sucedida.
+ */
+bool SampleRing::begin(size_t depth)
+{
+    if (depth < SAMPLE_RING_MIN_DEPTH)
+    {
+        depth = SAMPLE_RING_MIN_DEPTH;
+    }
+    if (depth > SAMPLE_RING_MAX_DEPTH)
+    {
+        depth = SAMPLE_RING_MAX_DEPTH;
+    }
+    size_t pow2 = SAMPLE_RING_MIN_DEPTH;
+    while (pow2 * 2 <= depth)
+    {
+        pow2 *= 2;
+    }
+
+    delete[] slots;
+    slots = new (std::nothrow) Slot[pow2];
+    if (slots == NULL)
+    {
+        slotCount = mask = 0;
+        return false;
+    }
+    for (size_t i = 0; i < pow2; i++)
+    {
+        for (int w = 0; w < WORDS; w++)
+        {
+            slots[i].words[w].store(0, std::memory_order_relaxed);
+        }
+    }
+    slotCount = pow2;
+    mask = pow2 - 1;
+    last.store(0, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Insere uma amostra. Deve ser chamada por um único escritor, com
+ * sequências consecutivas a partir de 1.
+ */
+void SampleRing::push(const LidarSample &sample)
+{
+    if (slots == NULL)
+    {
+        return;
+    }
+    uint32_t raw[WORDS];
+    memcpy(raw, &sample, sizeof(raw));
+
+    Slot &slot = slots[sample.sequence & mask];
+    slot.words[0].store(0, std::memory_order_relaxed); // Invalida a posição durante a escrita
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int w = 1; w < WORDS; w++)
+    {
+        slot.words[w].store(raw[w], std::memory_order_relaxed);
+    }
+    slot.words[0].store(sample.sequence, std::memory_order_release);
+    last.store(sample.sequence, std::memory_order_release);
+}
+
+/**
+ * @brief Copia as amostras com sequência maior que `since`, em ordem.
+ *
+ * @param since Última sequência já recebida pelo leitor (0 para a mais antiga disponível).
+ * @param out Destino das amostras.
+ * @param maxSamples Capacidade de `out`.
+ * @param overrun Definido como true se amostras posteriores a `since` foram
+ *        perdidas (sobrescritas antes da leitura).
+ * @return Número de amostras copiadas.
+ */
+size_t SampleRing::readSince(uint32_t since, LidarSample *out, size_t maxSamples, bool &overrun) const
+{
+    overrun = false;
+    uint32_t newest = last.load(std::memory_order_acquire);
+    if (slots == NULL || newest == since || (int32_t)(newest - since) < 0)
+    {
+        return 0;
+    }
+
+    // Amostras mais antigas que a capacidade já foram sobrescritas; com
+    // since = 0 o leitor apenas começa pela mais antiga disponível
+    uint32_t first = since + 1;
+    if (newest - since > slotCount)
+    {
+        first = newest - slotCount + 1;
+        overrun = since != 0;
+    }
+
+    size_t count = 0;
+    uint32_t raw[WORDS];
+    for (uint32_t seq = first; seq != newest + 1 && count < maxSamples; seq++)
+    {
+        const Slot &slot = slots[seq & mask];
+        if (slot.words[0].load(std::memory_order_acquire) != seq)
+        {
+            overrun = true; // Sobrescrita pelo escritor durante a leitura
+            continue;
+        }
+        for (int w = 1; w < WORDS; w++)
+        {
+            raw[w] = slot.words[w].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.words[0].load(std::memory_order_relaxed) != seq)
+        {
+            overrun = true;
+            continue;
+        }
+        raw[0] = seq;
+        memcpy(&out[count++], raw, sizeof(raw));
+    }
+    return count;
+}
@@ -0,0 +1,138 @@
+// SamplingScheduler.cpp
+#include "SamplingScheduler.h"
+
+JitterHistogram::JitterHistogram() : maxMicros(0)
+{
+    for (uint32_t i = 0; i < JITTER_BUCKETS; i++)
+    {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+uint32_t JitterHistogram::upperBound(uint32_t index)
+{
+    if (index < JITTER_LINEAR_LIMIT)
+    {
+        return index;
+    }
+    uint32_t msb = (index - JITTER_LINEAR_LIMIT) / JITTER_SUB_BUCKETS + JITTER_LINEAR_SHIFT;
+    uint32_t sub = (index - JITTER_LINEAR_LIMIT) % JITTER_SUB_BUCKETS;
+    return ((JITTER_SUB_BUCKETS + sub + 1) << (msb - JITTER_SUB_SHIFT)) - 1;
+}
+
+/**
+ * @brief Total de desvios registrados (soma das faixas).
+ */
+uint32_t JitterHistogram::samples() const
+{
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < JITTER_BUCKETS; i++)
+    {
+        total += buckets[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @brief Estima um quantil pelo limite superior da faixa que o contém.
+ *
+ * @param q Quantil, de 0 a 1.
+ * @return Desvio em µs, limitado ao maior registrado; 0 sem amostras.
+ */
+uint32_t JitterHistogram::quantile(float q) const
+{
+    uint32_t total = samples();
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint32_t target = (uint32_t)(q * total);
+    uint32_t cumulative = 0;
+    for (uint32_t i = 0; i < JITTER_BUCKETS - 1; i++)
+    {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        if (cumulative > target)
+        {
+            uint32_t bound = upperBound(i);
+            return bound < maximum() ? bound : maximum();
+        }
+    }
+    return maximum();
+}
+
+void JitterHistogram::reset()
+{
+    for (uint32_t i = 0; i < JITTER_BUCKETS; i++)
+    {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    maxMicros.store(0, std::memory_order_relaxed);
+}
+
+SamplingScheduler::SamplingScheduler()
+    : targetRate(0), period(0), wakeCount(0), overrunCount(0), idleCount(0), lastWake(0),
+      skipInterval(false)
+{
+}
+
+/**
+ * @brief Define a taxa alvo e zera as estatísticas. Chamada pela tarefa de
+ *        aquisição, ao aplicar a configuração.
+ *
+ * @param targetHz Períodos por segundo; 0 desativa o ritmo fixo.
+ */
+void SamplingScheduler::configure(uint32_t targetHz)
+{
+    targetRate.store(targetHz, std::memory_order_relaxed);
+    period.store(targetHz ? (1000000UL + targetHz / 2) / targetHz : 0, std::memory_order_relaxed);
+    wakeCount.store(0, std::memory_order_relaxed);
+    overrunCount.store(0, std::memory_order_relaxed);
+    idleCount.store(0, std::memory_order_relaxed);
+    histogram.reset();
+    skipInterval = false;
+}
+
+/**
+ * @brief Troca a taxa alvo mantendo as estatísticas. Chamada pela tarefa de
+ *        aquisição, que reinicia o temporizador com o novo período.
+ */
+void SamplingScheduler::retarget(uint32_t targetHz)
+{
+    targetRate.store(targetHz, std::memory_order_relaxed);
+    period.store(targetHz ? (1000000UL + targetHz / 2) / targetHz : 0, std::memory_order_relaxed);
+    skipInterval = true;
+}
+
+/**
+ * @brief Registra um despertar da tarefa de aquisição.
+ *
+ * @param nowMicros Instante do despertar, em micros().
+ * @param notifications Notificações do temporizador acumuladas desde a espera anterior.
+ */
+void SamplingScheduler::wake(uint32_t nowMicros, uint32_t notifications)
+{
+    uint32_t count = wakeCount.load(std::memory_order_relaxed);
+    if (count > 0 && !skipInterval)
+    {
+        uint32_t interval = nowMicros - lastWake;
+        uint32_t target = periodMicros();
+        histogram.record(interval > target ? interval - target : target - interval);
+    }
+    lastWake = nowMicros;
+    skipInterval = false;
+    wakeCount.store(count + 1, std::memory_order_relaxed);
+    if (notifications > 1)
+    {
+        overrunCount.store(overrunCount.load(std::memory_order_relaxed) + notifications - 1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Registra um período sem nenhuma medição pronta; conta também como
+ *        overrun. Chamada pela tarefa de aquisição antes de esperar o próximo.
+ */
+void SamplingScheduler::idleWake()
+{
+    idleCount.store(idleCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    overrunCount.store(overrunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+// SignalQuality.cpp
+#include "SignalQuality.h"
+#include <string.h>
+
+QualityGate::QualityGate() : minimumSignal(0), rejectQualities(SIGNAL_REJECT_NONE), rejectedCount(0)
+{
+    memset(counts, 0, sizeof(counts));
+}
+
+/**
+ * @brief Define o limiar de sinal fraco e as classes descartadas.
+ *
+ * @param minSignal Força do sinal mínima de uma leitura válida; 0 desativa SIGNAL_WEAK.
+ * @param rejectMask Bit q ligado descarta as leituras da classe q (SignalQuality).
+ */
+void QualityGate::configure(uint8_t minSignal, uint8_t rejectMask)
+{
+    minimumSignal = minSignal;
+    rejectQualities = rejectMask;
+}
+
+/**
+ * @brief Classifica uma leitura.
+ *
+ * @param distance Distância lida, em cm.
+ * @param signalStrength Força do sinal (0x0e), ou -1 se não foi lida.
+ * @param status Registro de status (0x01) no fim da medição, ou -1 se não foi lido.
+ */
+SignalQuality QualityGate::classify(int distance, int signalStrength, int status) const
+{
+    if (signalStrength < 0 && status < 0)
+    {
+        return SIGNAL_VALID;
+    }
+    if (distance == 0 || (status >= 0 && (status & SIGNAL_STATUS_INVALID)))
+    {
+        return SIGNAL_NO_RETURN;
+    }
+    if ((status >= 0 && (status & SIGNAL_STATUS_OVERFLOW)) || signalStrength >= 0xff)
+    {
+        return SIGNAL_SATURATED;
+    }
+    if (signalStrength >= 0 && signalStrength < minimumSignal)
+    {
+        return SIGNAL_WEAK;
+    }
+    return SIGNAL_VALID;
+}
+
+/**
+ * @brief Contabiliza a classe de uma leitura e decide se ela segue para o filtro.
+ *
+ * @return false se a classe está na máscara de descarte.
+ */
+bool QualityGate::accept(SignalQuality quality)
+{
+    counts[quality]++;
+    if (rejectQualities & (1 << quality))
+    {
+        rejectedCount++;
+        return false;
+    }
+    return true;
+}
+
+void QualityGate::resetCounts()
+{
+    memset(counts, 0, sizeof(counts));
+    rejectedCount = 0;
+}
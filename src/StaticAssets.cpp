@@ -0,0 +1,143 @@
+// StaticAssets.cpp
+#include "StaticAssets.h"
+#include <SPIFFS.h>
+
+// Gerado na build (tools/compress_assets.py): define embeddedAssets[], terminado por path == NULL
+#include "EmbeddedAssets.h"
+
+StaticAssetStats staticAssetStats = {};
+
+// Arquivo no SPIFFS descrito em /assets.idx
+struct FileAsset
+{
+  char path[32];
+  char contentType[24];
+  bool gzip;
+  char etag[20];
+  size_t length;
+};
+
+static FileAsset fileAssets[STATIC_ASSETS_MAX];
+static int fileAssetCount = 0;
+
+/**
+ * @brief Lê /assets.idx e o tamanho de cada arquivo listado.
+ */
+static void carregarIndice()
+{
+  File indice = SPIFFS.open("/assets.idx", "r");
+  if (!indice)
+  {
+    Serial.println("Sem /assets.idx: arquivos servidos do SPIFFS sem compressão");
+    return;
+  }
+
+  while (indice.available() && fileAssetCount < STATIC_ASSETS_MAX)
+  {
+    String linha = indice.readStringUntil('\n');
+    FileAsset &asset = fileAssets[fileAssetCount];
+    int gzip;
+    if (sscanf(linha.c_str(), "%31s %23s %d %19s", asset.path, asset.contentType, &gzip, asset.etag) != 4)
+    {
+      continue;
+    }
+    asset.gzip = gzip != 0;
+
+    File arquivo = SPIFFS.open(String(asset.path) + (asset.gzip ? ".gz" : ""), "r");
+    if (!arquivo)
+    {
+      continue;
+    }
+    asset.length = arquivo.size();
+    arquivo.close();
+    fileAssetCount++;
+  }
+  indice.close();
+}
+
+/**
+ * @brief Envia um arquivo estático, ou 304 se o cliente já tem a versão atual.
+ *
+ * @param request Requisição recebida.
+ * @param path Caminho do arquivo em data/ (por exemplo "/home.html").
+ */
+static void enviarAsset(AsyncWebServerRequest *request, const char *path)
+{
+  const EmbeddedAsset *embutido = NULL;
+  for (const EmbeddedAsset *asset = embeddedAssets; asset->path != NULL; asset++)
+  {
+    if (strcmp(asset->path, path) == 0)
+    {
+      embutido = asset;
+    }
+  }
+  const FileAsset *arquivo = NULL;
+  for (int i = 0; i < fileAssetCount && embutido == NULL; i++)
+  {
+    if (strcmp(fileAssets[i].path, path) == 0)
+    {
+      arquivo = &fileAssets[i];
+    }
+  }
+
+  if (embutido == NULL && arquivo == NULL)
+  {
+    // Fora do índice: serve o arquivo do SPIFFS como está
+    request->send(SPIFFS, path);
+    return;
+  }
+
+  const char *contentType = embutido ? embutido->contentType : arquivo->contentType;
+  const char *etag = embutido ? embutido->etag : arquivo->etag;
+  bool gzip = embutido ? embutido->gzip : arquivo->gzip;
+
+  AsyncWebServerResponse *response;
+  AsyncWebHeader *ifNoneMatch = request->getHeader("If-None-Match");
+  if (ifNoneMatch != NULL && ifNoneMatch->value().indexOf(etag) >= 0)
+  {
+    response = request->beginResponse(304);
+    staticAssetStats.naoModificados++;
+  }
+  else
+  {
+    if (embutido)
+    {
+      response = request->beginResponse_P(200, contentType, embutido->data, embutido->length);
+      if (gzip)
+      {
+        response->addHeader("Content-Encoding", "gzip");
+      }
+    }
+    else
+    {
+      // Só "<path>.gz" existe no SPIFFS: AsyncFileResponse o envia com
+      // Content-Encoding: gzip, mantendo o nome original do arquivo
+      response = request->beginResponse(SPIFFS, path, contentType);
+    }
+    staticAssetStats.respostas++;
+    staticAssetStats.bytesEnviados += embutido ? embutido->length : arquivo->length;
+  }
+
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", strcmp(contentType, "text/html") == 0 ? "no-cache" : "max-age=600");
+  request->send(response);
+}
+
+void setupStaticAssets(AsyncWebServer &server)
+{
+  carregarIndice();
+
+  // Páginas da interface
+  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
+            { enviarAsset(request, "/home.html"); });
+  server.on("/configurar", HTTP_GET, [](AsyncWebServerRequest *request)
+            { enviarAsset(request, "/config.html"); });
+  server.on("/login", HTTP_GET, [](AsyncWebServerRequest *request)
+            { enviarAsset(request, "/login.html"); });
+
+  // Arquivos referenciados pelas páginas, como CSS e fontes
+  server.on("/styles.css", HTTP_GET, [](AsyncWebServerRequest *request)
+            { enviarAsset(request, "/styles.css"); });
+  server.on("/Roboto.woff2", HTTP_GET, [](AsyncWebServerRequest *request)
+            { enviarAsset(request, "/Roboto.woff2"); });
+}
@@ -0,0 +1,325 @@
+// Trace.cpp
+#include "Trace.h"
+#include <string.h>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<SamplePipeline>::value,
+              "O estado do pipeline e copiado byte a byte para o trace");
+static_assert(TRACE_HEADER_SIZE + sizeof(SamplePipeline) + SAMPLE_CODEC_FRAME_SIZE(TRACE_BATCH) <= TRACE_PAGE_SIZE,
+              "O cabecalho, o estado e um quadro devem caber em uma pagina");
+
+static void putU16(uint8_t *p, uint16_t value)
+{
+    p[0] = value & 0xff;
+    p[1] = value >> 8;
+}
+
+static void putU32(uint8_t *p, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+static uint16_t getU16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+TraceRecorder::TraceRecorder()
+    : storage(NULL), deviceId(0), recorderState(TRACE_IDLE), lastEnd(TRACE_END_NONE), stopRequested(false),
+      endSequence(0), recorded(0), written(0), maxSamples(0), firstSequence(0), lastSequence(0), flags(0),
+      pageUsed(0)
+{
+}
+
+/**
+ * @brief Associa o gravador ao armazenamento do trace (segmento TRACE_SEGMENT).
+ */
+void TraceRecorder::begin(LogStorage &storage, uint32_t deviceId)
+{
+    this->storage = &storage;
+    this->deviceId = deviceId;
+}
+
+/**
+ * @brief Pede uma gravação; o trace anterior é substituído quando ela começa.
+ *        Chamada por uma única tarefa (o servidor HTTP).
+ *
+ * @param maxSamples Número máximo de amostras gravadas.
+ * @return false se uma gravação já está em andamento ou não há armazenamento.
+ */
+bool TraceRecorder::start(uint32_t maxSamples)
+{
+    if (storage == NULL || maxSamples == 0 || active())
+    {
+        return false;
+    }
+    this->maxSamples = maxSamples;
+    stopRequested.store(false, std::memory_order_relaxed);
+    endSequence.store(0, std::memory_order_relaxed);
+    recorded.store(0, std::memory_order_relaxed);
+    written.store(0, std::memory_order_relaxed);
+    lastEnd.store(TRACE_END_NONE, std::memory_order_relaxed);
+    recorderState.store(TRACE_REQUESTED, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Copia o estado do pipeline se uma gravação foi pedida. Deve ser
+ *        chamada pela tarefa de aquisição, entre duas leituras.
+ *
+ * @param pipeline Pipeline que processará a próxima amostra.
+ * @param qualityRead Leitura da força do sinal e do status ativa.
+ * @param nextSequence Sequência da próxima amostra publicada.
+ */
+void TraceRecorder::service(const SamplePipeline &pipeline, bool qualityRead, uint32_t nextSequence)
+{
+    if (!pending())
+    {
+        return;
+    }
+    memcpy(pipelineState, &pipeline, sizeof(pipelineState));
+    flags = qualityRead ? TRACE_QUALITY_READ : 0;
+    firstSequence = nextSequence;
+    recorderState.store(TRACE_ARMED, std::memory_order_release);
+}
+
+/**
+ * @brief Encerra o trace antes da amostra `nextSequence`, processada com outra
+ *        configuração. Chamada pela tarefa de aquisição ao aplicar uma configuração.
+ */
+void TraceRecorder::limit(uint32_t nextSequence)
+{
+    int current = recorderState.load(std::memory_order_acquire);
+    if (current == TRACE_ARMED || current == TRACE_RECORDING)
+    {
+        uint32_t none = 0;
+        endSequence.compare_exchange_strong(none, nextSequence, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Grava as amostras publicadas desde a última chamada. Deve ser chamada
+ *        periodicamente por uma única tarefa, antes que o SampleRing dê a volta.
+ */
+void TraceRecorder::drain(const SampleRing &ring)
+{
+    int current = recorderState.load(std::memory_order_acquire);
+    if (current == TRACE_ARMED)
+    {
+        writeHeader();
+        recorderState.store(TRACE_RECORDING, std::memory_order_release);
+    }
+    else if (current != TRACE_RECORDING)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        if (stopRequested.load(std::memory_order_acquire))
+        {
+            finish(TRACE_END_STOPPED);
+            return;
+        }
+        uint32_t end = endSequence.load(std::memory_order_acquire);
+        if (end != 0 && lastSequence + 1 == end)
+        {
+            finish(TRACE_END_CONFIG);
+            return;
+        }
+
+        bool overrun;
+        size_t count = ring.readSince(lastSequence, batch, TRACE_BATCH, overrun);
+        if (overrun || (count > 0 && batch[0].sequence != lastSequence + 1))
+        {
+            finish(TRACE_END_OVERRUN);
+            return;
+        }
+
+        // Apenas as amostras processadas com o estado gravado e dentro do limite
+        size_t keep = 0;
+        uint32_t remaining = maxSamples - recorded.load(std::memory_order_relaxed);
+        while (keep < count && keep < remaining && (end == 0 || (int32_t)(batch[keep].sequence - end) < 0))
+        {
+            keep++;
+        }
+        if (keep > 0)
+        {
+            addFrame(batch, keep);
+            lastSequence = batch[keep - 1].sequence;
+            recorded.store(recorded.load(std::memory_order_relaxed) + keep, std::memory_order_relaxed);
+        }
+        if (recorderState.load(std::memory_order_relaxed) == TRACE_IDLE)
+        {
+            return; // Erro de escrita em addFrame()
+        }
+        if (recorded.load(std::memory_order_relaxed) >= maxSamples)
+        {
+            finish(TRACE_END_LIMIT);
+            return;
+        }
+        if (keep < count)
+        {
+            finish(TRACE_END_CONFIG);
+            return;
+        }
+        if (count < TRACE_BATCH)
+        {
+            return;
+        }
+    }
+}
+
+void TraceRecorder::writeHeader()
+{
+    storage->remove(TRACE_SEGMENT);
+    page[0] = 'L';
+    page[1] = 'T';
+    page[2] = TRACE_VERSION;
+    page[3] = flags;
+    putU32(page + 4, deviceId);
+    putU32(page + 8, firstSequence);
+    putU16(page + 12, sizeof(SamplePipeline));
+    putU16(page + 14, 0);
+    memcpy(page + TRACE_HEADER_SIZE, pipelineState, sizeof(pipelineState));
+    pageUsed = TRACE_HEADER_SIZE + sizeof(pipelineState);
+    lastSequence = firstSequence - 1;
+}
+
+void TraceRecorder::addFrame(const LidarSample *samples, size_t count)
+{
+    uint8_t codecFlags = SAMPLE_CODEC_ZONE;
+    if (flags & TRACE_QUALITY_READ)
+    {
+        codecFlags |= SAMPLE_CODEC_SIGNAL | SAMPLE_CODEC_STATUS;
+    }
+
+    for (size_t first = 0; first < count; first += TRACE_BATCH)
+    {
+        size_t n = count - first < TRACE_BATCH ? count - first : TRACE_BATCH;
+        if (pageUsed + SAMPLE_CODEC_FRAME_SIZE(n) > TRACE_PAGE_SIZE && !writePage())
+        {
+            return;
+        }
+        SampleEncoder encoder(page + pageUsed, TRACE_PAGE_SIZE - pageUsed, deviceId, codecFlags);
+        for (size_t i = 0; i < n; i++)
+        {
+            encoder.add(samples[first + i]);
+        }
+        pageUsed += encoder.finish();
+    }
+}
+
+bool TraceRecorder::writePage()
+{
+    if (pageUsed == 0)
+    {
+        return true;
+    }
+    if (!storage->append(TRACE_SEGMENT, page, pageUsed))
+    {
+        pageUsed = 0;
+        lastEnd.store(TRACE_END_WRITE_ERROR, std::memory_order_relaxed);
+        recorderState.store(TRACE_IDLE, std::memory_order_release);
+        return false;
+    }
+    written.store(written.load(std::memory_order_relaxed) + pageUsed, std::memory_order_relaxed);
+    pageUsed = 0;
+    return true;
+}
+
+void TraceRecorder::finish(TraceEnd reason)
+{
+    if (!writePage())
+    {
+        return;
+    }
+    lastEnd.store(reason, std::memory_order_relaxed);
+    recorderState.store(TRACE_IDLE, std::memory_order_release);
+}
+
+/**
+ * @brief Reproduz um trace com o SamplePipeline compilado e compara cada saída
+ *        com a gravada pelo dispositivo.
+ *
+ * @param data Conteúdo do arquivo de trace.
+ * @param length Tamanho do arquivo.
+ * @param result Recebe as contagens da reprodução e o erro, se houver.
+ * @param hook Chamada com o pipeline restaurado, antes da primeira amostra (opcional).
+ * @return false se o trace é inválido (result.error); as amostras anteriores
+ *         ao erro continuam contadas em result.
+ */
+bool replayTrace(const uint8_t *data, size_t length, TraceReplayResult &result, TraceReplayHook hook)
+{
+    memset(&result, 0, sizeof(result));
+    if (length < TRACE_HEADER_SIZE || data[0] != 'L' || data[1] != 'T' || data[2] != TRACE_VERSION ||
+        getU16(data + 12) != sizeof(SamplePipeline) || length < TRACE_HEADER_SIZE + sizeof(SamplePipeline))
+    {
+        result.error = TRACE_BAD_HEADER;
+        return false;
+    }
+    result.deviceId = getU32(data + 4);
+    uint32_t expected = getU32(data + 8);
+
+    SamplePipeline pipeline;
+    memcpy(&pipeline, data + TRACE_HEADER_SIZE, sizeof(SamplePipeline));
+    if (hook != NULL)
+    {
+        hook(pipeline);
+    }
+
+    LidarSample samples[TRACE_BATCH];
+    uint32_t firstTimestamp = 0;
+    size_t pos = TRACE_HEADER_SIZE + sizeof(SamplePipeline);
+    while (pos < length)
+    {
+        SampleFrameInfo info;
+        if (decodeSampleFrame(data + pos, length - pos, samples, TRACE_BATCH, info) != SAMPLE_CODEC_OK)
+        {
+            result.error = TRACE_BAD_FRAME;
+            return false;
+        }
+        pos += info.frameSize;
+
+        for (uint16_t i = 0; i < info.count; i++)
+        {
+            const LidarSample &sample = samples[i];
+            if (sample.sequence != expected)
+            {
+                result.error = TRACE_GAP;
+                return false;
+            }
+            expected++;
+            if (result.samples == 0)
+            {
+                firstTimestamp = sample.timestampMicros;
+            }
+
+            int signalStrength = (info.flags & SAMPLE_CODEC_SIGNAL) ? sample.signalStrength : -1;
+            int status = (info.flags & SAMPLE_CODEC_STATUS) ? sample.status : -1;
+            PipelineOutput out;
+            pipeline.process(sample.timestampMicros, sample.rawDistance, signalStrength, status, out);
+
+            result.samples++;
+            result.durationMicros = sample.timestampMicros - firstTimestamp;
+            result.zoneEvents += out.zoneChanged;
+            result.rejected += !out.accepted;
+            if ((uint16_t)out.filteredDistance != sample.filteredDistance || out.zone != sample.zone)
+            {
+                if (result.mismatches++ == 0)
+                {
+                    result.firstMismatch = sample.sequence;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -1,255 +1,903 @@
-#ifndef WIFI_MANAGER_H
-#define WIFI_MANAGER_H
-
-#include <Arduino.h>
-#include <WiFi.h>
-#include <Preferences.h>
-#include <ESPAsyncWebServer.h>
-#include <SPIFFS.h>
-
-#include <ESPAsyncHTTPUpdateServer.h>
-
-#include "Global.h"
-
-Preferences preferences;
-AsyncWebServer server(80);
-//create an object from the UpdateServer
-ESPAsyncHTTPUpdateServer updateServer;
-
-/**
- * @brief Inicia o modo Access Point para configuração do ESP32.
- *
- * Esta função configura o ESP32 para operar no modo Access Point (AP), permitindo que dispositivos se conectem a ele para realizar configurações via uma interface web.
- *
- * Funcionalidades:
- * - Inicia o modo AP com o nome de rede "ESP32-Config".
- * - Exibe no console o nome da rede e o IP do AP.
- * - Define várias rotas HTTP para servir páginas HTML e processar requisições de configuração e login.
- * - Realiza a varredura de redes Wi-Fi disponíveis e exibe uma lista dessas redes.
- * - Permite a conexão a uma rede Wi-Fi selecionada.
- * @note Esta função deve ser chamada para iniciar o modo AP e configurar as rotas HTTP.
- */
-void startAccessPoint()
-{
-  // Inicia o modo Access Point para configuração
-  String apName = "ESP32-Config";
-  WiFi.softAP(apName.c_str());
-
-  Serial.print("Modo AP iniciado. Nome da rede: ");
-  Serial.println(apName);
-  Serial.print("IP do AP: ");
-  Serial.println(WiFi.softAPIP());
-}
-
-/**
- * @brief Configura a conexão WiFi do dispositivo.
- *
- * Esta função inicializa o sistema de arquivos SPIFFS, recupera as credenciais de WiFi
- * armazenadas na memória não volátil (NVS), e tenta conectar ao WiFi usando essas credenciais.
- * Se não houver credenciais salvas, ou se a conexão falhar, o dispositivo entra em modo Access Point (AP)
- * para permitir a configuração das credenciais de WiFi.
- */
-void setupWiFi()
-{
-  // Inicializa o sistema de arquivos SPIFFS
-  if (!SPIFFS.begin(true))
-  {
-    Serial.println("Erro ao montar SPIFFS");
-    return;
-  }
-
-  // Recupera SSID e senha da memória não volátil (NVS)
-  String ssid =  preferences.getString("ssid", "");
-  String senha = preferences.getString("senha", "");
-  //String senha = "85542022";
-  // Imprime SSID e senha recuperados
-  Serial.printf("SSID: %s", ssid.c_str());
-  Serial.printf("Senha: %s", senha.c_str());
-
-  // Habilita CORS (Cross-Origin Resource Sharing)
-  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
-  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, PUT");
-  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type");
-
-  // Verifica se há credenciais salvas
-  if (ssid.isEmpty())
-  {
-    Serial.println("Nenhuma configuração de WiFi salva. Entrando em modo AP para configuração.");
-    startAccessPoint();
-  }
-
-  // Conecta ao WiFi usando as credenciais armazenadas
-  WiFi.begin(ssid.c_str(), senha.c_str());
-
-  Serial.print("Conectando-se a ");
-  Serial.println(ssid);
-
-  // Reconnect if connection is lost
-  WiFi.setAutoReconnect(true);
-  // Modem sleep when in WIFI_STA mode not a good idea as someone might want to talk to it
-  WiFi.setSleep(false);
-
-  // Aguarda conexão com limite de tempo
-  int tentativas = 0;
-  while (WiFi.status() != WL_CONNECTED && tentativas < 10)
-  { // Limite de 30 tentativas (~30 segundos)
-    delay(1000);
-    Serial.print(".");
-    tentativas++;
-  }
-
-  // Verifica se a conexão foi bem-sucedida
-  if (WiFi.status() == WL_CONNECTED)
-  {
-    Serial.println("");
-    Serial.print("Conectado ao WiFi: ");
-    Serial.println(WiFi.localIP());
-  }
-  else
-  {
-    Serial.println("");
-    Serial.println("Falha ao conectar ao WiFi. Verifique o SSID e a senha e tente novamente.");
-    // Limpa as credenciais salvas para evitar novas tentativas com dados incorretos
-    preferences.remove("ssid");
-    preferences.remove("senha");
-    Serial.println("Credenciais de WiFi removidas. Entrando em modo AP para configuração.");
-    startAccessPoint();
-  }
-
-  // Define a rota para servir a página home.html do sistema de arquivos SPIFFS
-  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
-            { request->send(SPIFFS, "/home.html", "text/html"); });
-
-  // Define a rota para configuração via web
-  server.on("/configurar", HTTP_GET, [](AsyncWebServerRequest *request)
-            { request->send(SPIFFS, "/config.html", "text/html"); });
-
-  // Define a rota para login via web
-  server.on("/login", HTTP_GET, [](AsyncWebServerRequest *request)
-            { request->send(SPIFFS, "/login.html", "text/html"); });
-
-  // Define a rota para validar credenciais
-  server.on("/validarCredenciais", HTTP_POST, [](AsyncWebServerRequest *request)
-            {
-    if (request->hasParam("username", true) && request->hasParam("password", true)) {
-      String username = request->getParam("username", true)->value();
-      String password = request->getParam("password", true)->value();
-
-      // Obtém a senha salva nas preferências
-      String passwordSalva = preferences.getString("LoginPassword", "admin");
-      String usernameSalvo = preferences.getString("LoginUserName", "admin");
- 
-      // se senha e password forem vazias, assume um valor padrão
-      if (passwordSalva.isEmpty()) {
-        passwordSalva = "admin";
-        usernameSalvo = "admin"; // TODO: tenho que implementar um hash para a senha
-      }
-
-      Serial.printf("Username: %s\n", username.c_str());
-      Serial.printf("Senha: %s\n", password.c_str());
-      Serial.println();
-      Serial.printf("Username salvo: %s\n", usernameSalvo.c_str());
-      Serial.printf("Senha salva: %s\n", passwordSalva.c_str());
-
-
-      if (password == passwordSalva && username == usernameSalvo) {
-        String response = "{\"success\": true}";
-        request->send(200, "application/json", response);
-      } else {
-        String response = "{\"success\": false}";
-        request->send(200, "application/json", response);
-      }
-    } else {
-      request->send(400, "application/json", "{\"error\": \"Parâmetros inválidos\"}");
-    } });
-
-  // Configura o servidor para responder à rota principal
-  server.on("/getWifi", HTTP_GET, [](AsyncWebServerRequest *request)
-            {
-        String htmlPage = "<html><head><title>Lista de WiFi</title></head><body>";
-        htmlPage += "<h1>Redes Wi-Fi Disponíveis</h1>";
-        htmlPage += "<ul>";
-
-        // Realiza a varredura de redes Wi-Fi disponíveis
-        int numberOfNetworks = WiFi.scanNetworks();
-        for (int i = 0; i < numberOfNetworks; i++) {
-            htmlPage += "<li>";
-            htmlPage += "<a href=\"/connect?ssid=" + WiFi.SSID(i) + "\">";
-            htmlPage += WiFi.SSID(i);
-            htmlPage += "</a> (Sinal: ";
-            htmlPage += WiFi.RSSI(i);
-            htmlPage += " dBm)";
-            htmlPage += "</li>";
-        }
-        htmlPage += "</ul>";
-        htmlPage += "</body></html>";
-
-        // Envia a página HTML como resposta
-        request->send(200, "text/html", htmlPage); });
-
-  // Configura o servidor para responder à rota de conexão
-  server.on("/connect", HTTP_GET, [](AsyncWebServerRequest *request)
-            {
-        if (request->hasParam("ssid")) {
-            String ssid = request->getParam("ssid")->value();
-            String htmlPage = "<html><head><title>Conectar ao WiFi</title></head><body>";
-            htmlPage += "<h1>Conectar à Rede Wi-Fi: " + ssid + "</h1>";
-            htmlPage += "<form action=\"/connectToWiFi\" method=\"POST\">";
-            htmlPage += "<input type=\"hidden\" name=\"ssid\" value=\"" + ssid + "\">";
-            htmlPage += "<label for=\"password\">Senha:</label>";
-            htmlPage += "<input type=\"password\" id=\"password\" name=\"password\"><br><br>";
-            htmlPage += "<input type=\"submit\" value=\"Conectar\">";
-            htmlPage += "</form>";
-            htmlPage += "</body></html>";
-
-            // Envia a página HTML como resposta
-            request->send(200, "text/html", htmlPage);
-        } else {
-            request->send(400, "text/plain", "SSID não fornecido");
-        } });
-
-  // Configura o servidor para responder à rota de conexão com a rede Wi-Fi
-  server.on("/connectToWiFi", HTTP_POST, [](AsyncWebServerRequest *request)
-            {
-        if (request->hasParam("ssid", true) && request->hasParam("password", true)) {
-            String ssid = request->getParam("ssid", true)->value();
-            String password = request->getParam("password", true)->value();
-
-            WiFi.begin(ssid.c_str(), password.c_str());
-
-            String htmlPage = "<html><head><title>Conectar ao WiFi</title></head><body>";
-            htmlPage += "<h1>Conectando à Rede Wi-Fi: " + ssid + "</h1>";
-            htmlPage += "<p>Aguarde enquanto tentamos conectar...</p>";
-            htmlPage += "</body></html>";
-
-            // Envia a página HTML como resposta
-            request->send(200, "text/html", htmlPage);
-        } else {
-            request->send(400, "text/plain", "Dados insuficientes para conectar");
-        } });
-
-  // Rota que retorna o valor do sensor
-  server.on("/getDistance", HTTP_GET, [](AsyncWebServerRequest *request)
-            {
-        // Protege o acesso à variável global de distância
-        int distanceCopy = 0;
-        if (xSemaphoreTake(xDistanceMutex, portMAX_DELAY) == pdTRUE)
-        {
-          distanceCopy = globalDistance;
-          xSemaphoreGive(xDistanceMutex);
-        }        
-        request->send(200, "text/plain", String(distanceCopy)); });
-
-  // Define a rota para servir arquivos estáticos, como CSS e JavaScript
-  server.serveStatic("/styles.css", SPIFFS, "/styles.css").setCacheControl("max-age=600");
-  server.serveStatic("/Roboto.woff2", SPIFFS, "/Roboto.woff2").setCacheControl("max-age=600");
-
-  
-    
-  //setup the updateServer with credentials
-  updateServer.setup(&server, "admin", "admin");
-
-  server.begin();
-}
-
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include <ESPAsyncWebServer.h>
+#include <SPIFFS.h>
+
+#include <ESPAsyncHTTPUpdateServer.h>
+#include <ArduinoJson.h>
+#include <memory>
+
+#include "Global.h"
+#include "AcquisitionMetrics.h"
+#include "ConfigHandler.h"
+#include "DeferredLog.h"
+#include "LiveStream.h"
+#include "MqttPublisher.h"
+#include "SampleCodec.h"
+#include "StaticAssets.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+//create an object from the UpdateServer
+ESPAsyncHTTPUpdateServer updateServer;
+
+/**
+ * @brief Estado de uma resposta de GET /samples enviada em blocos: posição no
+ *        sampleRing e o trecho de texto ainda não copiado para o bloco.
+ */
+struct SamplesCursor
+{
+  enum Etapa { INICIO, AMOSTRAS, FIM, ENCERRADA };
+
+  uint32_t since = 0;
+  size_t restantes = 0;
+  bool overrun = false;
+  bool primeira = true;
+  Etapa etapa = INICIO;
+  LidarSample bloco[16];
+  size_t lidas = 0, proxima = 0;
+  char texto[96];
+  size_t tamanho = 0, copiado = 0;
+
+  /**
+   * @brief Monta o próximo trecho do JSON em texto.
+   * @return false quando não há mais nada a enviar.
+   */
+  bool next()
+  {
+    copiado = 0;
+    tamanho = 0;
+    if (etapa == INICIO)
+    {
+      tamanho = snprintf(texto, sizeof(texto), "{\"amostras\":[");
+      etapa = AMOSTRAS;
+      return true;
+    }
+    if (etapa == AMOSTRAS)
+    {
+      if (proxima == lidas && restantes > 0)
+      {
+        bool overrunBloco;
+        lidas = sampleRing.readSince(since, bloco, min(restantes, (size_t)16), overrunBloco);
+        proxima = 0;
+        overrun |= overrunBloco;
+      }
+      if (proxima < lidas)
+      {
+        const LidarSample &a = bloco[proxima++];
+        tamanho = snprintf(texto, sizeof(texto), "%s[%u,%u,%u,%u,%u,%u,%u,%u]", primeira ? "" : ",",
+                           (unsigned)a.sequence, (unsigned)a.timestampMicros, a.rawDistance, a.filteredDistance,
+                           a.signalStrength, a.status, a.zone, (unsigned)a.quality);
+        primeira = false;
+        since = a.sequence;
+        restantes--;
+        return true;
+      }
+      etapa = FIM;
+    }
+    if (etapa == FIM)
+    {
+      tamanho = snprintf(texto, sizeof(texto), "],\"ultimo\":%u,\"recente\":%u,\"overrun\":%s}", (unsigned)since,
+                         (unsigned)sampleRing.lastSequence(), overrun ? "true" : "false");
+      etapa = ENCERRADA;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Preenche um bloco da resposta.
+   * @return Bytes escritos; 0 encerra a resposta.
+   */
+  size_t fill(uint8_t *buffer, size_t maxLen)
+  {
+    size_t escritos = 0;
+    while (escritos < maxLen)
+    {
+      if (copiado == tamanho && !next())
+      {
+        break;
+      }
+      size_t n = min(tamanho - copiado, maxLen - escritos);
+      memcpy(buffer + escritos, texto + copiado, n);
+      copiado += n;
+      escritos += n;
+    }
+    return escritos;
+  }
+};
+
+// Amostras por quadro de GET /samples.bin: cada quadro é codificado e enviado
+// inteiro antes do próximo (~0,4 byte/amostra de cabeçalho e CRC)
+#define SAMPLES_BIN_QUADRO 64
+
+/**
+ * @brief Estado de uma resposta de GET /samples.bin enviada em blocos: posição
+ *        no sampleRing e o quadro codificado ainda não copiado para o bloco.
+ */
+struct SamplesBinCursor
+{
+  uint32_t since = 0;
+  size_t restantes = 0;
+  uint32_t deviceId = 0;
+  bool overrun = false;
+  LidarSample bloco[SAMPLES_BIN_QUADRO];
+  uint8_t quadro[SAMPLE_CODEC_FRAME_SIZE(SAMPLES_BIN_QUADRO)];
+  size_t tamanho = 0, copiado = 0;
+
+  /**
+   * @brief Codifica o próximo quadro com as amostras seguintes do sampleRing.
+   * @return false quando não há mais amostras a enviar.
+   */
+  bool next()
+  {
+    copiado = 0;
+    tamanho = 0;
+    if (restantes == 0)
+    {
+      return false;
+    }
+    bool overrunBloco;
+    size_t n = sampleRing.readSince(since, bloco, min(restantes, (size_t)SAMPLES_BIN_QUADRO), overrunBloco);
+    overrun |= overrunBloco;
+    if (n == 0)
+    {
+      return false;
+    }
+    SampleEncoder encoder(quadro, sizeof(quadro), deviceId, SAMPLE_CODEC_SIGNAL | SAMPLE_CODEC_STATUS | SAMPLE_CODEC_ZONE);
+    for (size_t i = 0; i < n; i++)
+    {
+      encoder.add(bloco[i]);
+    }
+    tamanho = encoder.finish();
+    since = bloco[n - 1].sequence;
+    restantes -= n;
+    return true;
+  }
+
+  /**
+   * @brief Preenche um bloco da resposta.
+   * @return Bytes escritos; 0 encerra a resposta.
+   */
+  size_t fill(uint8_t *buffer, size_t maxLen)
+  {
+    size_t escritos = 0;
+    while (escritos < maxLen)
+    {
+      if (copiado == tamanho && !next())
+      {
+        break;
+      }
+      size_t n = min(tamanho - copiado, maxLen - escritos);
+      memcpy(buffer + escritos, quadro + copiado, n);
+      copiado += n;
+      escritos += n;
+    }
+    return escritos;
+  }
+};
+
+/**
+ * @brief Inicia o modo Access Point para configuração do ESP32.
+ *
+ * Esta função configura o ESP32 para operar no modo Access Point (AP), permitindo que dispositivos se conectem a ele para realizar configurações via uma interface web.
+ *
+ * Funcionalidades:
+ * - Inicia o modo AP com o nome de rede "ESP32-Config".
+ * - Exibe no console o nome da rede e o IP do AP.
+ * - Define várias rotas HTTP para servir páginas HTML e processar requisições de configuração e login.
+ * - Realiza a varredura de redes Wi-Fi disponíveis e exibe uma lista dessas redes.
+ * - Permite a conexão a uma rede Wi-Fi selecionada.
+ * @note Esta função deve ser chamada para iniciar o modo AP e configurar as rotas HTTP.
+ */
+void startAccessPoint()
+{
+  // Inicia o modo Access Point para configuração
+  String apName = "ESP32-Config";
+  WiFi.softAP(apName.c_str());
+
+  Serial.print("Modo AP iniciado. Nome da rede: ");
+  Serial.println(apName);
+  Serial.print("IP do AP: ");
+  Serial.println(WiFi.softAPIP());
+}
+
+/**
+ * @brief Configura a conexão WiFi do dispositivo.
+ *
+ * Esta função inicializa o sistema de arquivos SPIFFS, recupera as credenciais de WiFi
+ * armazenadas na memória não volátil (NVS), e tenta conectar ao WiFi usando essas credenciais.
+ * Se não houver credenciais salvas, ou se a conexão falhar, o dispositivo entra em modo Access Point (AP)
+ * para permitir a configuração das credenciais de WiFi.
+ */
+void setupWiFi()
+{
+  // Inicializa o sistema de arquivos SPIFFS
+  if (!SPIFFS.begin(true))
+  {
+    Serial.println("Erro ao montar SPIFFS");
+    return;
+  }
+
+  // SSID e senha da configuração em RAM, carregada da NVS por carregarConfiguracoes()
+  Config config;
+  configStore.snapshot(config);
+  String ssid = config.ssid;
+  String senha = config.senha;
+  // Imprime o SSID recuperado (a senha não vai para a serial)
+  Serial.printf("SSID: %s\n", ssid.c_str());
+
+  // Habilita CORS (Cross-Origin Resource Sharing)
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, PUT, PATCH");
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type");
+
+  // Verifica se há credenciais salvas
+  if (ssid.isEmpty())
+  {
+    Serial.println("Nenhuma configuração de WiFi salva. Entrando em modo AP para configuração.");
+    startAccessPoint();
+  }
+
+  // Conecta ao WiFi usando as credenciais armazenadas
+  WiFi.begin(ssid.c_str(), senha.c_str());
+
+  Serial.print("Conectando-se a ");
+  Serial.println(ssid);
+
+  // Reconnect if connection is lost
+  WiFi.setAutoReconnect(true);
+  // Modem sleep when in WIFI_STA mode not a good idea as someone might want to talk to it
+  WiFi.setSleep(false);
+
+  // Aguarda conexão com limite de tempo
+  int tentativas = 0;
+  while (WiFi.status() != WL_CONNECTED && tentativas < 10)
+  { // Limite de 30 tentativas (~30 segundos)
+    delay(1000);
+    Serial.print(".");
+    tentativas++;
+  }
+
+  // Verifica se a conexão foi bem-sucedida
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    Serial.println("");
+    Serial.print("Conectado ao WiFi: ");
+    Serial.println(WiFi.localIP());
+  }
+  else
+  {
+    Serial.println("");
+    Serial.println("Falha ao conectar ao WiFi. Verifique o SSID e a senha e tente novamente.");
+    // Limpa as credenciais salvas para evitar novas tentativas com dados incorretos
+    limparCredenciaisWiFi(preferences);
+    Serial.println("Credenciais de WiFi removidas. Entrando em modo AP para configuração.");
+    startAccessPoint();
+  }
+
+  // Define as rotas das páginas (home, configuração, login) e dos arquivos estáticos,
+  // comprimidos e com ETag (ver StaticAssets.h)
+  setupStaticAssets(server);
+
+  // Define a rota para validar credenciais
+  server.on("/validarCredenciais", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+    if (request->hasParam("username", true) && request->hasParam("password", true)) {
+      String username = request->getParam("username", true)->value();
+      String password = request->getParam("password", true)->value();
+
+      // Obtém a senha salva nas preferências
+      String passwordSalva = preferences.getString("LoginPassword", "admin");
+      String usernameSalvo = preferences.getString("LoginUserName", "admin");
+ 
+      // se senha e password forem vazias, assume um valor padrão
+      if (passwordSalva.isEmpty()) {
+        passwordSalva = "admin";
+        usernameSalvo = "admin"; // TODO: tenho que implementar um hash para a senha
+      }
+
+      if (password == passwordSalva && username == usernameSalvo) {
+        logEvent(LOG_LOGIN_ACCEPTED);
+        String response = "{\"success\": true}";
+        request->send(200, "application/json", response);
+      } else {
+        logEvent(LOG_LOGIN_REJECTED);
+        String response = "{\"success\": false}";
+        request->send(200, "application/json", response);
+      }
+    } else {
+      request->send(400, "application/json", "{\"error\": \"Parâmetros inválidos\"}");
+    } });
+
+  // Configura o servidor para responder à rota principal
+  server.on("/getWifi", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        String htmlPage = "<html><head><title>Lista de WiFi</title></head><body>";
+        htmlPage += "<h1>Redes Wi-Fi Disponíveis</h1>";
+        htmlPage += "<ul>";
+
+        // Realiza a varredura de redes Wi-Fi disponíveis
+        int numberOfNetworks = WiFi.scanNetworks();
+        for (int i = 0; i < numberOfNetworks; i++) {
+            htmlPage += "<li>";
+            htmlPage += "<a href=\"/connect?ssid=" + WiFi.SSID(i) + "\">";
+            htmlPage += WiFi.SSID(i);
+            htmlPage += "</a> (Sinal: ";
+            htmlPage += WiFi.RSSI(i);
+            htmlPage += " dBm)";
+            htmlPage += "</li>";
+        }
+        htmlPage += "</ul>";
+        htmlPage += "</body></html>";
+
+        // Envia a página HTML como resposta
+        request->send(200, "text/html", htmlPage); });
+
+  // Configura o servidor para responder à rota de conexão
+  server.on("/connect", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        if (request->hasParam("ssid")) {
+            String ssid = request->getParam("ssid")->value();
+            String htmlPage = "<html><head><title>Conectar ao WiFi</title></head><body>";
+            htmlPage += "<h1>Conectar à Rede Wi-Fi: " + ssid + "</h1>";
+            htmlPage += "<form action=\"/connectToWiFi\" method=\"POST\">";
+            htmlPage += "<input type=\"hidden\" name=\"ssid\" value=\"" + ssid + "\">";
+            htmlPage += "<label for=\"password\">Senha:</label>";
+            htmlPage += "<input type=\"password\" id=\"password\" name=\"password\"><br><br>";
+            htmlPage += "<input type=\"submit\" value=\"Conectar\">";
+            htmlPage += "</form>";
+            htmlPage += "</body></html>";
+
+            // Envia a página HTML como resposta
+            request->send(200, "text/html", htmlPage);
+        } else {
+            request->send(400, "text/plain", "SSID não fornecido");
+        } });
+
+  // Configura o servidor para responder à rota de conexão com a rede Wi-Fi
+  server.on("/connectToWiFi", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+        if (request->hasParam("ssid", true) && request->hasParam("password", true)) {
+            String ssid = request->getParam("ssid", true)->value();
+            String password = request->getParam("password", true)->value();
+
+            WiFi.begin(ssid.c_str(), password.c_str());
+
+            String htmlPage = "<html><head><title>Conectar ao WiFi</title></head><body>";
+            htmlPage += "<h1>Conectando à Rede Wi-Fi: " + ssid + "</h1>";
+            htmlPage += "<p>Aguarde enquanto tentamos conectar...</p>";
+            htmlPage += "</body></html>";
+
+            // Envia a página HTML como resposta
+            request->send(200, "text/html", htmlPage);
+        } else {
+            request->send(400, "text/plain", "Dados insuficientes para conectar");
+        } });
+
+  // Rota que retorna o valor do sensor
+  server.on("/getDistance", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        // Copia a amostra mais recente sem bloquear a tarefa do LiDAR
+        LidarSample amostra;
+        if (!samplePublisher.read(amostra))
+        {
+          request->send(503, "text/plain", "Leitura em andamento");
+          return;
+        }
+        request->send(200, "text/plain", String(amostra.filteredDistance)); });
+
+  // Rota que retorna em lote as amostras posteriores a uma sequência:
+  // GET /samples?since=N[&max=M]. A resposta traz as amostras como
+  // [seq, us, bruta, filtrada, sinal, status, zona, qualidade], "ultimo" (sequência da última
+  // amostra enviada, para o próximo since), "recente" (sequência mais recente no
+  // buffer) e "overrun" (amostras perdidas porque o cliente ficou para trás).
+  // Se "recente" for menor que since, o dispositivo reiniciou e o cliente deve recomeçar de 0.
+  server.on("/samples", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), NULL, 10) : 0;
+        size_t maximo = request->hasParam("max") ? request->getParam("max")->value().toInt() : 1000;
+        maximo = constrain(maximo, (size_t)1, (size_t)2000);
+
+        // Resposta em blocos (chunked): cada bloco é preenchido direto do
+        // sampleRing, de modo que o corpo nunca fica inteiro no heap; o estado
+        // da leitura acompanha a resposta até o último bloco
+        std::shared_ptr<SamplesCursor> cursor = std::make_shared<SamplesCursor>();
+        cursor->since = since;
+        cursor->restantes = maximo;
+        AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+            [cursor](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+            { return cursor->fill(buffer, maxLen); });
+        request->send(response); });
+
+  // Rota que retorna o mesmo lote de /samples no formato binário compacto de
+  // SampleCodec.h (delta + varint, com canais de sinal, status e zona e CRC-32):
+  // GET /samples.bin?since=N[&max=M]: quadros consecutivos de até
+  // SAMPLES_BIN_QUADRO amostras, cada um com cabeçalho e CRC próprios. Os
+  // cabeçalhos X-Recente e X-Overrun têm o mesmo significado de "recente" e
+  // "overrun" em /samples e valem para o primeiro quadro; uma perda durante o
+  // envio aparece como salto de sequência entre dois quadros.
+  server.on("/samples.bin", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), NULL, 10) : 0;
+        size_t maximo = request->hasParam("max") ? request->getParam("max")->value().toInt() : 512;
+        maximo = constrain(maximo, (size_t)1, (size_t)2000);
+
+        // Resposta em blocos como em /samples: só um quadro fica no heap; o
+        // primeiro é codificado aqui para que os cabeçalhos o descrevam
+        std::shared_ptr<SamplesBinCursor> cursor = std::make_shared<SamplesBinCursor>();
+        cursor->since = since;
+        cursor->restantes = maximo;
+        cursor->deviceId = (uint32_t)ESP.getEfuseMac();
+        cursor->next();
+        AsyncWebServerResponse *response = request->beginChunkedResponse("application/octet-stream",
+            [cursor](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+            { return cursor->fill(buffer, maxLen); });
+        response->addHeader("X-Recente", String(sampleRing.lastSequence()));
+        response->addHeader("X-Overrun", cursor->overrun ? "1" : "0");
+        request->send(response); });
+
+  // Rota que retorna as últimas transições de zona: GET /zonas?since=N. Cada
+  // evento traz a sequência, o tipo ("transicao" ou "alerta"), o instante
+  // (micros), as zonas de origem e destino, a distância e a velocidade (cm/s)
+  // da amostra que confirmou a transição; um alerta de aproximação traz em
+  // "ttc" o tempo previsto (ms) até a entrada na zona de destino, que ainda não
+  // é a atual. "atual" é a zona da amostra mais recente.
+  server.on("/zonas", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), NULL, 10) : 0;
+
+        ZoneEvent eventos[ZONE_EVENT_DEPTH];
+        size_t n = zoneEvents.readSince(since, eventos, ZONE_EVENT_DEPTH);
+
+        LidarSample amostra;
+        JsonDocument jsonResponse;
+        jsonResponse["atual"] = samplePublisher.read(amostra) ? amostra.zone : ZONE_NONE;
+        jsonResponse["recente"] = zoneEvents.lastSequence();
+        JsonArray lista = jsonResponse["eventos"].to<JsonArray>();
+        for (size_t i = 0; i < n; i++)
+        {
+          JsonObject evento = lista.add<JsonObject>();
+          evento["seq"] = eventos[i].sequence;
+          evento["tipo"] = eventos[i].type == ZONE_EVENT_APPROACH ? "alerta" : "transicao";
+          evento["t"] = eventos[i].timestampMicros;
+          evento["de"] = eventos[i].fromZone;
+          evento["para"] = eventos[i].toZone;
+          evento["d"] = eventos[i].distance;
+          evento["v"] = eventos[i].velocity;
+          evento["ttc"] = eventos[i].leadMillis;
+        }
+
+        String response;
+        serializeJson(jsonResponse, response);
+        request->send(200, "application/json", response); });
+
+  // Rota que pede uma captura do registro de correlação:
+  // POST /correlacao?palavras=N&sensor=S (padrão 256 palavras, sensor 0). A
+  // tarefa de aquisição copia o registro entre duas leituras; o resultado fica
+  // em GET /correlacao (análise) e GET /correlacao.bin (forma de onda).
+  server.on("/correlacao", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+        int palavras = request->hasParam("palavras") ? request->getParam("palavras")->value().toInt() : CORRELATION_DEFAULT_WORDS;
+        int sensor = request->hasParam("sensor") ? request->getParam("sensor")->value().toInt() : 0;
+        if (palavras < 1 || palavras > CORRELATION_MAX_WORDS || sensor < 0 || sensor >= lidars.count() || !lidars.present(sensor))
+        {
+          request->send(400, "application/json", "{\"message\":\"Parâmetros inválidos\"}");
+          return;
+        }
+        correlacao.request(palavras, sensor);
+        request->send(202, "application/json", "{\"message\":\"Captura pedida\"}"); });
+
+  // Rota que retorna a análise da última captura do registro de correlação:
+  // pico e vale principais, cruzamento por zero (em posições, com fração),
+  // ruído de fundo, segundo pico e a duração da captura
+  server.on("/correlacao", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        CorrelationAnalysis analise;
+        if (!correlacao.read(analise))
+        {
+          request->send(503, "application/json", "{\"message\":\"Captura em andamento\"}");
+          return;
+        }
+
+        JsonDocument json;
+        json["pendente"] = correlacao.pending();
+        json["captura"] = analise.sequence;
+        if (analise.sequence != 0)
+        {
+          json["sensor"] = analise.sensor;
+          json["t"] = analise.timestampMicros;
+          json["duracaoUs"] = analise.captureMicros;
+          json["palavras"] = analise.words;
+          json["pico"] = analise.peak;
+          json["posicaoPico"] = analise.peakIndex;
+          json["vale"] = analise.trough;
+          json["posicaoVale"] = analise.troughIndex;
+          if (analise.zeroCrossingQ8 >= 0)
+          {
+            json["cruzamentoZero"] = analise.zeroCrossingQ8 / 256.0f;
+          }
+          json["ruido"] = analise.noiseFloor;
+          json["relacaoPicoRuido"] = analise.noiseFloor ? (float)analise.peak / analise.noiseFloor : 0.0f;
+          json["segundoPico"] = analise.secondPeak;
+          json["posicaoSegundoPico"] = analise.secondPeakIndex;
+        }
+
+        String response;
+        serializeJson(json, response);
+        request->send(200, "application/json", response); });
+
+  // Rota que retorna a forma de onda da última captura: palavras int16 com
+  // sinal, little-endian. O cabeçalho X-Captura é o número da captura, o mesmo
+  // de "captura" em GET /correlacao.
+  server.on("/correlacao.bin", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        int16_t *quadro = (int16_t *)malloc(CORRELATION_MAX_WORDS * sizeof(int16_t));
+        if (quadro == NULL)
+        {
+          request->send(503, "text/plain", "Memória insuficiente");
+          return;
+        }
+        CorrelationAnalysis analise;
+        if (!correlacao.read(analise, quadro))
+        {
+          free(quadro);
+          request->send(503, "text/plain", "Captura em andamento");
+          return;
+        }
+
+        // ESP32 é little-endian: as palavras são enviadas como estão na memória
+        size_t tamanho = analise.words * sizeof(int16_t);
+        AsyncResponseStream *response = request->beginResponseStream("application/octet-stream", tamanho);
+        response->addHeader("X-Captura", String(analise.sequence));
+        response->write((uint8_t *)quadro, tamanho);
+        free(quadro);
+        request->send(response); });
+
+  // Rota que encerra a gravação do trace; registrada antes de /trace, que
+  // também atenderia /trace/parar
+  server.on("/trace/parar", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+        traceRecorder.stop();
+        request->send(200, "application/json", "{\"message\":\"Gravação encerrada\"}"); });
+
+  // Rota que inicia a gravação de um trace do sensor 0: POST /trace?amostras=N
+  // (padrão 60000, ~46 s a 1,3 kHz). O estado do pipeline é copiado antes da
+  // próxima amostra e as amostras seguintes são gravadas no SPIFFS até o
+  // limite, POST /trace/parar ou uma alteração da configuração (ver Trace.h).
+  // N cabe no espaço livre do SPIFFS (mais o trace anterior, substituído),
+  // menos a reserva do registro do MQTT; acima disso, 400 com o máximo
+  server.on("/trace", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+        long amostras = request->hasParam("amostras") ? request->getParam("amostras")->value().toInt() : 60000;
+        size_t livre = SPIFFS.totalBytes() - SPIFFS.usedBytes() + armazenamentoTrace.size(TRACE_SEGMENT);
+        size_t disponivel = livre > MQTT_REGISTRO_BYTES ? livre - MQTT_REGISTRO_BYTES : 0;
+        long maximo = (long)(disponivel / TRACE_BYTES_PER_SAMPLE);
+        if (amostras < 1 || amostras > maximo)
+        {
+          char json[80];
+          snprintf(json, sizeof(json), "{\"message\":\"Parâmetros inválidos\",\"maximo\":%ld}", maximo);
+          request->send(400, "application/json", json);
+          return;
+        }
+        if (!traceRecorder.start(amostras))
+        {
+          request->send(409, "application/json", "{\"message\":\"Gravação em andamento\"}");
+          return;
+        }
+        request->send(202, "application/json", "{\"message\":\"Gravação pedida\"}"); });
+
+  // Rota que retorna o estado da gravação: "estado" (parado, pedido, iniciando,
+  // gravando), amostras e bytes gravados e o motivo do fim da última gravação
+  server.on("/trace", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        static const char *const estados[] = {"parado", "pedido", "iniciando", "gravando"};
+        static const char *const motivos[] = {"", "parado", "limite", "configuracao", "overrun", "erroEscrita"};
+        JsonDocument json;
+        json["estado"] = estados[traceRecorder.state()];
+        json["amostras"] = traceRecorder.samples();
+        json["bytes"] = traceRecorder.bytes();
+        json["motivo"] = motivos[traceRecorder.endReason()];
+
+        String response;
+        serializeJson(json, response);
+        request->send(200, "application/json", response); });
+
+  // Rota que envia o último trace gravado, para reprodução no host
+  // (program replay <arquivo>, em [env:native])
+  server.on("/trace.bin", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        if (traceRecorder.active())
+        {
+          request->send(409, "text/plain", "Gravação em andamento");
+          return;
+        }
+        String caminho = armazenamentoTrace.path(TRACE_SEGMENT);
+        if (!SPIFFS.exists(caminho))
+        {
+          request->send(404, "text/plain", "Nenhum trace gravado");
+          return;
+        }
+        request->send(SPIFFS, caminho, "application/octet-stream"); });
+
+  // Rota que retorna cada sensor do barramento: endereço atribuído, presença,
+  // leituras/s na última janela de um segundo e a amostra mais recente do
+  // sensor (distância bruta e filtrada pelo filtro do próprio sensor)
+  server.on("/sensores", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        JsonDocument json;
+        JsonArray lista = json.to<JsonArray>();
+        for (int i = 0; i < lidars.count(); i++)
+        {
+          JsonObject sensor = lista.add<JsonObject>();
+          sensor["sensor"] = i;
+          sensor["endereco"] = lidars.address(i);
+          sensor["presente"] = lidars.present(i);
+          sensor["leituras"] = lidars.readings(i);
+          sensor["taxa"] = (uint32_t)taxaSensores[i];
+          sensor["nacks"] = lidars.driver(i).stats().nacks;
+          sensor["timeouts"] = lidars.driver(i).stats().readTimeouts;
+          const QualityGate &qualidade = lidars.quality(i);
+          sensor["validas"] = qualidade.count(SIGNAL_VALID);
+          sensor["fracas"] = qualidade.count(SIGNAL_WEAK);
+          sensor["saturadas"] = qualidade.count(SIGNAL_SATURATED);
+          sensor["semRetorno"] = qualidade.count(SIGNAL_NO_RETURN);
+          sensor["descartadas"] = qualidade.rejected();
+          LidarSample amostra;
+          if (lidars.latest(i, amostra) && amostra.sequence != 0)
+          {
+            sensor["distancia"] = amostra.rawDistance;
+            sensor["filtrada"] = amostra.filteredDistance;
+            sensor["t"] = amostra.timestampMicros;
+          }
+        }
+
+        String response;
+        serializeJson(json, response);
+        request->send(200, "application/json", response); });
+
+  // Rota com o ritmo da amostragem: taxa alvo e efetiva, percentis do desvio
+  // do período (jitter), overruns, latência de despertar da tarefa e estado da
+  // taxa adaptativa
+  server.on("/amostragem", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        const JitterHistogram &jitter = agendadorAmostragem.jitter();
+        const LatencyHistogram &despertar = acquisitionMetrics[METRICS_WAKE_LATENCY];
+        JsonDocument json;
+        json["taxaAlvo"] = agendadorAmostragem.targetHz();
+        json["periodoUs"] = agendadorAmostragem.periodMicros();
+        json["taxaAmostragem"] = (uint32_t)taxaAmostragem;
+        json["despertares"] = agendadorAmostragem.wakes();
+        json["overruns"] = agendadorAmostragem.overruns();
+        json["semLeitura"] = agendadorAmostragem.idleWakes();
+        json["jitterP50Us"] = jitter.quantile(0.5f);
+        json["jitterP90Us"] = jitter.quantile(0.9f);
+        json["jitterP99Us"] = jitter.quantile(0.99f);
+        json["jitterP999Us"] = jitter.quantile(0.999f);
+        json["jitterMaxUs"] = jitter.maximum();
+        json["despertarP50Us"] = despertar.quantileTicks(0.5f) / metricsTicksPerMicro();
+        json["despertarP99Us"] = despertar.quantileTicks(0.99f) / metricsTicksPerMicro();
+        json["adaptativo"] = agendadorAmostragem.paced() && taxaAdaptativa.enabled();
+        json["estadoAdaptativo"] = taxaAdaptativa.state() == ADAPTIVE_IDLE ? "ocioso" : "ativo";
+        json["taxaMaxima"] = taxaAdaptativa.maxHz();
+        json["taxaOciosa"] = taxaAdaptativa.idleHz();
+        json["saidasOciosa"] = taxaAdaptativa.wakeups();
+        json["tempoOciosoMs"] = taxaAdaptativa.idleMillis();
+
+        String response;
+        serializeJson(json, response);
+        request->send(200, "application/json", response); });
+
+  // Rota com a estimativa de movimento da última leitura aceita do sensor 0:
+  // velocidade (cm/s, negativa em aproximação), aceleração (cm/s²), tempo
+  // previsto até o próximo limite (ms, null sem previsão) e a zona cuja entrada
+  // foi prevista (0 = contato), além do total de alertas de aproximação
+  server.on("/movimento", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        MotionState movimento;
+        if (!estimadorMovimento.read(movimento))
+        {
+          request->send(503, "text/plain", "Sem estimativa");
+          return;
+        }
+        JsonDocument json;
+        json["seq"] = movimento.sequence;
+        json["t"] = movimento.timestampMicros;
+        json["velocidade"] = movimento.velocity;
+        json["aceleracao"] = movimento.acceleration;
+        if (movimento.timeToThresholdMs != MOTION_TTC_NONE)
+        {
+          json["ttcMs"] = movimento.timeToThresholdMs;
+        }
+        else
+        {
+          json["ttcMs"] = nullptr;
+        }
+        json["zonaPrevista"] = movimento.targetZone;
+        json["alertas"] = estimadorMovimento.alerts();
+
+        String response;
+        serializeJson(json, response);
+        request->send(200, "application/json", response); });
+
+  // Rota que retorna os contadores do caminho de aquisição do LiDAR
+  server.on("/estatisticas", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        const LIDARLiteStats &stats = lidars.driver(0).stats();
+        JsonDocument json;
+        json["aquisicoesComBias"] = stats.biasAcquisitions;
+        json["aquisicoesSemBias"] = stats.plainAcquisitions;
+        json["transacoes"] = stats.transactions;
+        json["nacks"] = stats.nacks;
+        json["timeouts"] = stats.readTimeouts;
+        json["bytesLidos"] = stats.bytesRead;
+        json["leituraQualidade"] = lidars.driver(0).qualityRead();
+        json["leiturasFracas"] = lidars.quality(0).count(SIGNAL_WEAK);
+        json["leiturasSaturadas"] = lidars.quality(0).count(SIGNAL_SATURATED);
+        json["leiturasSemRetorno"] = lidars.quality(0).count(SIGNAL_NO_RETURN);
+        json["leiturasDescartadas"] = lidars.quality(0).rejected();
+        json["modoAquisicao"] = lidars.freeRunning() ? "continuo" : "disparado";
+        json["taxaAmostragem"] = (uint32_t)taxaAmostragem;
+        json["leiturasContinuas"] = stats.freeRunReads;
+        json["leiturasRepetidas"] = stats.staleReads;
+        json["publicacaoMaxUs"] = (uint32_t)publicacaoMaxUs;
+        json["intervaloMaxUs"] = (uint32_t)intervaloMaxUs;
+        json["proporcaoRepetidas"] = stats.freeRunReads ? (float)stats.staleReads / stats.freeRunReads : 0.0f;
+        json["streamClientes"] = liveStreamStats.clientes;
+        json["streamTaxa"] = liveStreamStats.taxaEfetiva;
+        json["streamEnviados"] = liveStreamStats.quadrosEnviados;
+        json["streamDescartados"] = liveStreamStats.quadrosDescartados;
+        json["mqttConectado"] = mqttStats.conectado;
+        json["mqttReconexoes"] = mqttStats.reconexoes;
+        json["mqttMensagens"] = mqttStats.mensagensEnviadas;
+        json["mqttAmostras"] = mqttStats.amostrasEnviadas;
+        json["mqttEventos"] = mqttStats.eventosEnviados;
+        json["mqttPerdidas"] = mqttStats.amostrasPerdidas;
+        json["mqttAdiadas"] = mqttStats.publicacoesAdiadas;
+        json["mqttTaxaMensagens"] = mqttStats.taxaMensagens;
+        json["mqttTaxaAmostras"] = mqttStats.taxaAmostras;
+        json["registroSegmentos"] = mqttStats.registroSegmentos;
+        json["registroGravados"] = mqttStats.registroGravados;
+        json["registroDescartados"] = mqttStats.registroDescartados;
+        json["assetsRespostas"] = staticAssetStats.respostas;
+        json["assetsNaoModificados"] = staticAssetStats.naoModificados;
+        json["assetsBytes"] = staticAssetStats.bytesEnviados;
+        json["heapLivre"] = ESP.getFreeHeap();
+        json["heapMinimo"] = ESP.getMinFreeHeap();
+
+        String response;
+        serializeJson(json, response);
+        request->send(200, "application/json", response); });
+
+  // Rota com as métricas da aquisição no formato de texto do Prometheus:
+  // histogramas de duração por etapa (em segundos), contadores de nacks e
+  // timeouts por sensor, taxa efetiva, jitter do laço e heap livre
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+        AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+        double segundosPorTick = 1e-6 / metricsTicksPerMicro();
+
+        response->print("# HELP lidar_stage_seconds Duracao de cada etapa da aquisicao\n"
+                        "# TYPE lidar_stage_seconds histogram\n");
+        for (int etapa = 0; etapa < METRICS_STAGE_COUNT; etapa++)
+        {
+          const LatencyHistogram &histograma = acquisitionMetrics[etapa];
+          const char *nome = metricsStageNames[etapa];
+          uint32_t acumulado = 0;
+          for (int faixa = 0; faixa < METRICS_BUCKETS - 1; faixa++)
+          {
+            acumulado += histograma.bucket(faixa);
+            response->printf("lidar_stage_seconds_bucket{stage=\"%s\",le=\"%.3g\"} %u\n", nome,
+                             LatencyHistogram::upperBoundTicks(faixa) * segundosPorTick, acumulado);
+          }
+          acumulado += histograma.bucket(METRICS_BUCKETS - 1);
+          response->printf("lidar_stage_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %u\n", nome, acumulado);
+          response->printf("lidar_stage_seconds_sum{stage=\"%s\"} %.6f\n", nome, histograma.totalMicros() * 1e-6);
+          response->printf("lidar_stage_seconds_count{stage=\"%s\"} %u\n", nome, acumulado);
+        }
+
+        response->print("# HELP lidar_nacks_total Transacoes I2C nao reconhecidas\n"
+                        "# TYPE lidar_nacks_total counter\n");
+        for (int i = 0; i < lidars.count(); i++)
+        {
+          response->printf("lidar_nacks_total{sensor=\"%d\"} %u\n", i, lidars.driver(i).stats().nacks);
+        }
+        response->print("# HELP lidar_read_timeouts_total Leituras abortadas pelo sinalizador de ocupado\n"
+                        "# TYPE lidar_read_timeouts_total counter\n");
+        for (int i = 0; i < lidars.count(); i++)
+        {
+          response->printf("lidar_read_timeouts_total{sensor=\"%d\"} %u\n", i, lidars.driver(i).stats().readTimeouts);
+        }
+
+        response->printf("# HELP lidar_sample_rate Amostras publicadas por segundo\n"
+                         "# TYPE lidar_sample_rate gauge\n"
+                         "lidar_sample_rate %u\n", (uint32_t)taxaAmostragem);
+        response->printf("# HELP lidar_sample_interval_max_seconds Maior intervalo entre amostras no ultimo segundo\n"
+                         "# TYPE lidar_sample_interval_max_seconds gauge\n"
+                         "lidar_sample_interval_max_seconds %.6f\n", intervaloMaxUs * 1e-6);
+        response->printf("# HELP lidar_publish_max_seconds Maior duracao de publicacao no ultimo segundo\n"
+                         "# TYPE lidar_publish_max_seconds gauge\n"
+                         "lidar_publish_max_seconds %.6f\n", publicacaoMaxUs * 1e-6);
+        const JitterHistogram &jitter = agendadorAmostragem.jitter();
+        response->printf("# HELP lidar_sampling_target_hz Taxa alvo do temporizador de amostragem (0 = sem ritmo fixo)\n"
+                         "# TYPE lidar_sampling_target_hz gauge\n"
+                         "lidar_sampling_target_hz %u\n", agendadorAmostragem.targetHz());
+        response->printf("# HELP lidar_sampling_overruns_total Periodos sem leitura nova (perdidos pela tarefa ou sem medicao pronta)\n"
+                         "# TYPE lidar_sampling_overruns_total counter\n"
+                         "lidar_sampling_overruns_total %u\n", agendadorAmostragem.overruns());
+        response->printf("# HELP lidar_sampling_idle_wakes_total Periodos sem medicao pronta\n"
+                         "# TYPE lidar_sampling_idle_wakes_total counter\n"
+                         "lidar_sampling_idle_wakes_total %u\n", agendadorAmostragem.idleWakes());
+        response->printf("# HELP lidar_sampling_idle Taxa adaptativa na taxa ociosa (1) ou na maxima (0)\n"
+                         "# TYPE lidar_sampling_idle gauge\n"
+                         "lidar_sampling_idle %d\n", taxaAdaptativa.state() == ADAPTIVE_IDLE ? 1 : 0);
+        response->printf("# HELP lidar_sampling_idle_exits_total Retornos a taxa maxima por movimento ou zona ocupada\n"
+                         "# TYPE lidar_sampling_idle_exits_total counter\n"
+                         "lidar_sampling_idle_exits_total %u\n", taxaAdaptativa.wakeups());
+        MotionState movimento;
+        if (estimadorMovimento.read(movimento))
+        {
+          response->printf("# HELP lidar_motion_velocity_cm_per_second Velocidade estimada do alvo (negativa em aproximacao)\n"
+                           "# TYPE lidar_motion_velocity_cm_per_second gauge\n"
+                           "lidar_motion_velocity_cm_per_second %d\n", movimento.velocity);
+          if (movimento.timeToThresholdMs != MOTION_TTC_NONE)
+          {
+            response->printf("# HELP lidar_motion_time_to_threshold_seconds Tempo previsto ate o proximo limite de zona\n"
+                             "# TYPE lidar_motion_time_to_threshold_seconds gauge\n"
+                             "lidar_motion_time_to_threshold_seconds{zone=\"%u\"} %.3f\n", movimento.targetZone,
+                             movimento.timeToThresholdMs * 1e-3);
+          }
+        }
+        response->printf("# HELP lidar_approach_alerts_total Alertas de aproximacao antes da entrada em uma zona\n"
+                         "# TYPE lidar_approach_alerts_total counter\n"
+                         "lidar_approach_alerts_total %u\n", estimadorMovimento.alerts());
+        response->printf("# HELP lidar_log_messages_total Mensagens gravadas no registro diferido\n"
+                         "# TYPE lidar_log_messages_total counter\n"
+                         "lidar_log_messages_total %u\n"
+                         "# HELP lidar_log_dropped_total Mensagens descartadas com o buffer do registro cheio\n"
+                         "# TYPE lidar_log_dropped_total counter\n"
+                         "lidar_log_dropped_total %u\n"
+                         "# HELP lidar_log_suppressed_total Mensagens suprimidas pelo limite de repeticao\n"
+                         "# TYPE lidar_log_suppressed_total counter\n"
+                         "lidar_log_suppressed_total %u\n",
+                         deferredLog.written(), deferredLog.dropped(), deferredLog.suppressed());
+        response->print("# HELP lidar_sampling_jitter_seconds Desvio do intervalo entre despertares em relacao ao periodo\n"
+                        "# TYPE lidar_sampling_jitter_seconds summary\n");
+        const float quantis[] = {0.5f, 0.9f, 0.99f, 0.999f};
+        for (float q : quantis)
+        {
+          response->printf("lidar_sampling_jitter_seconds{quantile=\"%g\"} %.6f\n", q, jitter.quantile(q) * 1e-6);
+        }
+        response->printf("lidar_sampling_jitter_seconds_count %u\n", jitter.samples());
+        response->printf("# HELP esp_free_heap_bytes Heap livre\n"
+                         "# TYPE esp_free_heap_bytes gauge\n"
+                         "esp_free_heap_bytes %u\n", ESP.getFreeHeap());
+        response->printf("# HELP esp_min_free_heap_bytes Menor heap livre desde a inicializacao\n"
+                         "# TYPE esp_min_free_heap_bytes gauge\n"
+                         "esp_min_free_heap_bytes %u\n", ESP.getMinFreeHeap());
+        request->send(response); });
+
+  
+    
+  //setup the updateServer with credentials
+  updateServer.setup(&server, "admin", "admin");
+
+  // Preflight CORS (ex.: PATCH /config de outra origem): nenhuma rota trata
+  // OPTIONS, então a resposta vem daqui, com os cabeçalhos padrão acima
+  server.onNotFound([](AsyncWebServerRequest *request)
+                    {
+        if (request->method() == HTTP_OPTIONS)
+        {
+          request->send(204);
+          return;
+        }
+        request->send(404, "text/plain", "Não encontrado"); });
+
+  server.begin();
+}
+
 #endif
\ No newline at end of file
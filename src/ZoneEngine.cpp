@@ -0,0 +1,183 @@
+// ZoneEngine.cpp
+#include "ZoneEngine.h"
+#include <string.h>
+
+ZoneEngine::ZoneEngine()
+    : zoneCount(0), hysteresis(0), dwell(0), currentZone(ZONE_NONE), leaving(false),
+      pendingSinceMicros(0), eventSequence(0)
+{
+}
+
+/**
+ * @brief Define as zonas, a histerese e a permanência mínima.
+ *
+ * A zona atual é mantida se ainda existir; transições pendentes são descartadas.
+ *
+ * @param zones Limites das zonas, a primeira é a zona 1.
+ * @param count Número de zonas (no máximo ZONE_MAX).
+ * @param hysteresisCm Margem além dos limites da zona atual antes de deixá-la, em cm.
+ * @param dwellMicros Tempo em que a nova zona precisa se manter antes da transição.
+ */
+void ZoneEngine::configure(const Zone *zones, int count, uint16_t hysteresisCm, uint32_t dwellMicros)
+{
+    zoneCount = count < 0 ? 0 : count > ZONE_MAX ? ZONE_MAX : count;
+    memcpy(zoneList, zones, zoneCount * sizeof(Zone));
+    hysteresis = hysteresisCm;
+    dwell = dwellMicros;
+    if (currentZone > zoneCount || (currentZone != ZONE_NONE && zoneList[currentZone - 1].startCm >= zoneList[currentZone - 1].endCm))
+    {
+        currentZone = ZONE_NONE;
+    }
+    leaving = false;
+}
+
+bool ZoneEngine::contains(uint8_t zone, uint16_t distance, uint16_t margin) const
+{
+    const Zone &z = zoneList[zone - 1];
+    if (z.startCm >= z.endCm)
+    {
+        return false;
+    }
+    // Intervalo [início, fim): zonas vizinhas que compartilham um limite não se sobrepõem
+    int start = (int)z.startCm - margin;
+    int end = (int)z.endCm + margin;
+    return distance >= start && distance < end;
+}
+
+/**
+ * @brief Zona que contém a distância, sem histerese (ZONE_NONE se nenhuma).
+ */
+uint8_t ZoneEngine::classify(uint16_t distance) const
+{
+    for (int i = 1; i <= zoneCount; i++)
+    {
+        if (contains(i, distance, 0))
+        {
+            return i;
+        }
+    }
+    return ZONE_NONE;
+}
+
+/**
+ * @brief Avalia uma amostra.
+ *
+ * @param distance Distância da amostra, em cm.
+ * @param timestampMicros Instante da amostra, em micros().
+ * @param event Recebe a transição quando a função retorna true.
+ * @return true se a amostra confirmou uma transição de zona.
+ */
+bool ZoneEngine::update(uint16_t distance, uint32_t timestampMicros, ZoneEvent &event)
+{
+    // Dentro da zona atual, considerando a histerese: nada muda
+    uint8_t candidate = currentZone;
+    if (currentZone == ZONE_NONE || !contains(currentZone, distance, hysteresis))
+    {
+        candidate = classify(distance);
+    }
+
+    if (candidate == currentZone)
+    {
+        leaving = false;
+        return false;
+    }
+
+    // Fora da zona atual: a transição só é confirmada após a permanência mínima,
+    // mesmo que a zona candidata oscile entre zonas vizinhas nesse intervalo
+    if (!leaving)
+    {
+        leaving = true;
+        pendingSinceMicros = timestampMicros;
+    }
+    if (timestampMicros - pendingSinceMicros < dwell)
+    {
+        return false;
+    }
+
+    event.sequence = ++eventSequence;
+    event.timestampMicros = timestampMicros;
+    event.fromZone = currentZone;
+    event.toZone = candidate;
+    event.distance = distance;
+    event.velocity = 0;
+    event.leadMillis = 0;
+    event.type = ZONE_EVENT_TRANSITION;
+    currentZone = candidate;
+    leaving = false;
+    return true;
+}
+
+ZoneEventRing::ZoneEventRing() : last(0)
+{
+    for (int i = 0; i < ZONE_EVENT_DEPTH; i++)
+    {
+        for (int w = 0; w < WORDS; w++)
+        {
+            slots[i].words[w].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Insere um evento. Deve ser chamada por um único escritor, com
+ * sequências consecutivas a partir de 1.
+ */
+void ZoneEventRing::push(const ZoneEvent &event)
+{
+    uint32_t raw[WORDS];
+    memcpy(raw, &event, sizeof(raw));
+
+    Slot &slot = slots[event.sequence & (ZONE_EVENT_DEPTH - 1)];
+    slot.words[0].store(0, std::memory_order_relaxed); // Invalida a posição durante a escrita
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int w = 1; w < WORDS; w++)
+    {
+        slot.words[w].store(raw[w], std::memory_order_relaxed);
+    }
+    slot.words[0].store(event.sequence, std::memory_order_release);
+    last.store(event.sequence, std::memory_order_release);
+}
+
+/**
+ * @brief Copia os eventos com sequência maior que `since`, em ordem. Eventos
+ * já sobrescritos são pulados.
+ *
+ * @return Número de eventos copiados.
+ */
+size_t ZoneEventRing::readSince(uint32_t since, ZoneEvent *out, size_t maxEvents) const
+{
+    uint32_t newest = last.load(std::memory_order_acquire);
+    if (newest == since || (int32_t)(newest - since) < 0)
+    {
+        return 0;
+    }
+
+    uint32_t first = since + 1;
+    if (newest - since > ZONE_EVENT_DEPTH)
+    {
+        first = newest - ZONE_EVENT_DEPTH + 1;
+    }
+
+    size_t count = 0;
+    uint32_t raw[WORDS];
+    for (uint32_t seq = first; seq != newest + 1 && count < maxEvents; seq++)
+    {
+        const Slot &slot = slots[seq & (ZONE_EVENT_DEPTH - 1)];
+        if (slot.words[0].load(std::memory_order_acquire) != seq)
+        {
+            continue;
+        }
+        for (int w = 1; w < WORDS; w++)
+        {
+            raw[w] = slot.words[w].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.words[0].load(std::memory_order_relaxed) != seq)
+        {
+            continue;
+        }
+        raw[0] = seq;
+        memcpy(&out[count++], raw, sizeof(raw));
+    }
+    return count;
+}
@@ -1,197 +1,535 @@
-#include <Wire.h>
-#include <HardwareSerial.h>
-#include "Arduino.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/semphr.h"
-#include "freertos/queue.h"
-#include <string.h>
-#include <math.h>
-#include <stdlib.h>  // Biblioteca necessária para atoi()
-
-using namespace std;
-
-#include <Preferences.h>
-#include "WiFiManager.h"
-#include "ConfigHandler.h"
-
-#include "LIDARLite.h"
-
-// Inicialização de variáveis globais e defines
-#include "Global.h"
-
-
-const int pinoControleTensao = 15;   // Pino de saída do PWM que controla a tensão
-const int canalSaidaAnalogica = 26;   // Canal PWM que gerencia a saída analógica simulada
-const int frequenciaPWM = 5000;      // Frequência do PWM em Hz
-const int resolucaoPWM = 8;          // Resolução do PWM (8 bits: valores entre 0 e 255)
-
-// Configurações da leitura do LiDAR
-const int distanciaMinima = 0;        // Distância mínima esperada (em milímetros)
-const int distanciaMaxima = 400;     // Distância máxima esperada (em milímetros)
-
-// Inicialização do objeto LIDARLite
-LIDARLite lidarLite;
-
-// Variáveis para o filtro de Kalman
-float Q = 0.001; // Variância do processo (aumentado para maior responsividade)
-float R = 0.5;   // Variância da medição (ajustado para maior responsividade)
-float P = 1, K;
-float filteredDistance = 0;
-/*
-    Filtro de Kalman
-    ----------------
-    O filtro de Kalman é um método estatístico avançado que estima o estado de um sistema dinâmico a partir de medições ruidosas.
-    Implementação:
-    - Requer a definição de modelos de previsão e atualização.
-    - A implementação envolve cálculos de variância e aplicação de matrizes.
-*/
-void lidarTask(void *pvParameters)
-{
-  // Inicialização do LIDARLite
-  lidarLite.begin(0, true);
-
-  // Define a primeira leitura como o valor inicial filtrado
-  filteredDistance = lidarLite.distance();
-
-  while (1)
-  {
-    int distance = lidarLite.distance(); // Faz uma leitura da distância
-
-    // Escalonamento da distância para o intervalo de PWM (0-255)
-    int valorPWM = map(distance, distanciaMinima, fator_divisao, 0, 255);
-    valorPWM = constrain(valorPWM, 0, 255);  // Garante que o valor esteja entre 0 e 255
-
-    // Define o valor de saída PWM (duty cycle)
-    dacWrite(canalSaidaAnalogica, valorPWM);
-   // ledcWrite(canalSaidaAnalogica, valorPWM);
-
-   if (FiltroKalman==1)
-    {
-      // Filtro de Kalman
-      // ----------------
-      // Previsão do valor futuro
-      P = P + Q;
-
-      // Atualização do filtro de Kalman
-      K = P / (P + R);
-      filteredDistance = filteredDistance + K * (distance - filteredDistance);
-      P = (1 - K) * P;
-
-      // Proteção para o acesso à variável global
-      if (xSemaphoreTake(xDistanceMutex, portMAX_DELAY) == pdTRUE)
-      {
-        globalDistance = (int)filteredDistance;
-        xSemaphoreGive(xDistanceMutex);
-      }
-    }
-    else
-    {
-      // Proteção para o acesso à variável global
-      if (xSemaphoreTake(xDistanceMutex, portMAX_DELAY) == pdTRUE)
-      {
-        globalDistance = distance;
-        xSemaphoreGive(xDistanceMutex);
-      }
-    }
-
-    // Aguarda 1 milissegundos antes da próxima medição (reduzido para aumentar a frequência)
-    vTaskDelay(pdMS_TO_TICKS(1));   
-  }
-
-}
-
-// Função de configuração inicial do ESP32-S3
-void setup()
-{
-  String fator;
-  // Inicializa a comunicação serial para depuração
-  Serial.begin(115200);
-
-    // Configura o canal PWM com a frequência e resolução
-  ledcSetup(canalSaidaAnalogica, frequenciaPWM, resolucaoPWM);
-
-  // Associa o canal PWM ao pino de saída para controle da tensão
-  ledcAttachPin(pinoControleTensao, canalSaidaAnalogica);
-
-  // Inicializa a memória não volátil
-  preferences.begin("config", false);
-
-  fator_divisao = 12000;// stoi(preferences.getString("fatorDivisao" , "120").c_str());
- 
-  printf("Fato divisão: %s" , preferences.getString("fatorDivisao" , "120").c_str());
-
-  if (!preferences.getBool("configSalva", false)) {
-    printf("Configurações não salvas. Resetando para valores padrão.\n");
-    resetarConfiguracoes(preferences);
-    
-    String ssid = preferences.getString("ssid");
-    String senha = preferences.getString("senha");
-
-    printf("SSID: %s" , ssid.c_str());
-    printf("Senha: %s" , senha.c_str());
-  }
-
-  // Configura o servidor para salvar e recuperar configurações
-  setupConfigHandler(server, preferences);
-
-  // Configura e conecta ao WiFi
-  setupWiFi();
-
-  // Cria o mutex para sincronização de acesso à variável de distância
-  xDistanceMutex = xSemaphoreCreateMutex();
-
-  // Verifica se o mutex foi criado com sucesso
-  if (xDistanceMutex == NULL)
-  {
-    Serial.println("Erro ao criar o mutex");
-    while (1)
-      ; // Para o programa em caso de falha
-  }
-
-  // Cria a tarefa para lidar com o LIDAR-Lite
-  xTaskCreate(
-      lidarTask,    // Função da tarefa
-      "Lidar Task", // Nome da tarefa
-      4096,         // Tamanho da stack alocada para a tarefa
-      NULL,         // Parâmetros passados para a tarefa (neste caso, nenhum)
-      1,            // Prioridade da tarefa
-      NULL);        // Referência da tarefa criada
-
-  Serial.println("Inicializando LiDAR-Lite v3HP...");
-}
-
-int blink = 0;
-int lastDistance = -1;
-/**
- * @brief Função principal de loop do programa.
- *
- * Esta função é executada continuamente e realiza as seguintes operações:
- * - Protege o acesso à variável global de distância utilizando um mutex.
- * - Copia o valor da variável global de distância para uma variável local.
- * - Exibe a distância medida no terminal serial apenas se houver uma mudança significativa (>= 2 unidades).
- * - Atualiza a última distância medida.
- * - Aguarda 100 ms antes de repetir a leitura para maior responsividade.
- */
-void loop()
-{
-  int distanceCopy;
-
-  // Protege o acesso à variável global de distância
-  if (xSemaphoreTake(xDistanceMutex, portMAX_DELAY) == pdTRUE)
-  {
-    distanceCopy = globalDistance;
-    xSemaphoreGive(xDistanceMutex);
-  }
-
-  // Exibe a distância medida no terminal serial apenas se houver uma mudança significativa
-  if (abs(distanceCopy - lastDistance) >= 20)
-  {
-    Serial.print("Distância medida: ");
-    Serial.println(distanceCopy);
-    lastDistance = distanceCopy;
-  }
-
-  delay(100); // Aguarda 100 ms antes de repetir a leitura (reduzido para maior responsividade)
-}
-
+#include <Wire.h>
+#include <HardwareSerial.h>
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>  // Biblioteca necessária para atoi()
+
+using namespace std;
+
+#include <Preferences.h>
+#include "WiFiManager.h"
+#include "ConfigHandler.h"
+#include "LiveStream.h"
+#include "MqttPublisher.h"
+
+#include "LidarArray.h"
+#include "AcquisitionMetrics.h"
+#include "AnalogOutput.h"
+#include "MotionEstimator.h"
+#include "DeferredLog.h"
+
+// Inicialização de variáveis globais e defines
+#include "Global.h"
+
+
+const int canalSaidaAnalogica = 26;   // Pino do DAC (GPIO26, DAC2) da saída analógica
+
+// Configurações da leitura do LiDAR
+const int distanciaMinima = 0;        // Distância mínima esperada (em milímetros)
+const int distanciaMaxima = 400;     // Distância máxima esperada (em milímetros)
+
+// Pino de habilitação de alimentação de cada LiDAR no barramento (até
+// LIDAR_ARRAY_MAX_SENSORS). Com um único sensor sem pino ele fica em 0x62; com
+// vários, cada um precisa do seu pino para receber um endereço na inicialização
+const int pinosHabilitacaoLidar[] = {LIDAR_ARRAY_NO_PIN};
+const int numeroSensores = sizeof(pinosHabilitacaoLidar) / sizeof(pinosHabilitacaoLidar[0]);
+
+// Sensores LiDAR, cada um com o próprio driver e a própria cadeia de filtros
+// (ver FilterBank.h), usados apenas pela tarefa do LiDAR
+LidarArray lidars;
+
+// Tarefa do LiDAR: fixa no núcleo da aplicação, longe da pilha WiFi/lwIP (núcleo
+// 0), e acima das tarefas HTTP, MQTT e de loop(); espera bloqueada a cada período
+const int nucleoTarefaLidar = 1;
+const int prioridadeTarefaLidar = 5;
+TaskHandle_t tarefaLidar = NULL;
+
+// Temporizador de hardware da amostragem (1 MHz): a interrupção notifica a
+// tarefa do LiDAR a cada período da taxa alvo (ver SamplingScheduler.h)
+const int temporizadorHardwareAmostragem = 0;
+hw_timer_t *temporizadorAmostragem = NULL;
+volatile uint32_t instanteDisparo = 0;
+
+// Reinicia a contagem do temporizador: o próximo disparo ocorre um período
+// depois desta chamada; período 0 desliga o alarme
+void programarTemporizadorAmostragem(uint32_t periodo)
+{
+  timerAlarmDisable(temporizadorAmostragem);
+  if (periodo > 0)
+  {
+    timerWrite(temporizadorAmostragem, 0);
+    timerAlarmWrite(temporizadorAmostragem, periodo, true);
+    timerAlarmEnable(temporizadorAmostragem);
+  }
+}
+
+void IRAM_ATTR dispararAmostragem()
+{
+  instanteDisparo = metricsNow();
+  BaseType_t acordou = pdFALSE;
+  vTaskNotifyGiveFromISR(tarefaLidar, &acordou);
+  if (acordou)
+  {
+    portYIELD_FROM_ISR();
+  }
+}
+
+// Saída analógica desacoplada da aquisição: a tarefa do LiDAR entrega a
+// distância de cada leitura aceita e o temporizador escreve no DAC em ritmo
+// fixo, interpolando entre as amostras (ver AnalogOutput.h)
+AnalogOutput saidaAnalogica;
+esp_timer_handle_t temporizadorSaida = NULL;
+
+void atualizarSaidaAnalogica(void *arg)
+{
+  // Jitter do temporizador: intervalo entre duas atualizações do DAC
+  static uint32_t ultimaAtualizacao = 0;
+  uint32_t agora = metricsNow();
+  if (ultimaAtualizacao != 0)
+  {
+    metricsRecord(METRICS_OUTPUT_INTERVAL, agora - ultimaAtualizacao);
+  }
+  ultimaAtualizacao = agora;
+
+  dacWrite(canalSaidaAnalogica, saidaAnalogica.tick());
+}
+
+void lidarTask(void *pvParameters)
+{
+  // Atribui os endereços e inicializa os sensores
+  int presentes = lidars.begin(pinosHabilitacaoLidar, numeroSensores, 0);
+  Serial.printf("LiDAR: %d de %d sensores encontrados\n", presentes, numeroSensores);
+
+  // Referência notificada pela interrupção, guardada antes de ligar o alarme
+  tarefaLidar = xTaskGetCurrentTaskHandle();
+
+  // Temporizador criado por esta tarefa, para que a interrupção seja atendida
+  // no mesmo núcleo (e com o mesmo contador de ciclos) que a tarefa; o alarme é
+  // ligado ao aplicar a taxa alvo
+  temporizadorAmostragem = timerBegin(temporizadorHardwareAmostragem, 80, true);
+  timerAttachInterrupt(temporizadorAmostragem, &dispararAmostragem, true);
+
+  // Configuração em uso; uma versão diferente da atual força a aplicação inicial.
+  // A recebida fica fora da stack (~400 bytes cada)
+  Config config;
+  static Config recebida;
+  configDefaults(config);
+  uint32_t versaoAplicada = configStore.version() + 1;
+
+  // Campos que mudam o estado do SamplePipeline copiado no trace; os demais
+  // (taxas, bias, saída, MQTT) não afetam a reprodução das amostras gravadas
+  static const char *const camposPipeline[] = {
+      "cadeiaFiltro", "leituraQualidade", "sinalMinimo", "rejeicaoQualidade",
+      "inicioZona1", "fimZona1", "inicioZona2", "fimZona2", "inicioZona3", "fimZona3",
+      "zonaHisterese", "zonaPermanencia"};
+  const uint64_t mascaraPipeline = configMask(camposPipeline, sizeof(camposPipeline) / sizeof(camposPipeline[0]));
+  int biasModoAplicado = -1, biasParametroAplicado = -1;
+  int cadeiaFiltroAplicada = -1;
+  int leituraQualidadeAplicada = -1, sinalMinimoAplicado = -1, rejeicaoAplicada = -1;
+  int modoAquisicaoAplicado = -1, taxaLivreAplicada = -1;
+  int fonteSaida = OUTPUT_SOURCE_FILTERED, taxaSaidaAplicada = -1;
+  int taxaAlvoAplicada = -1, taxaOciosaAplicada = -1, faixaMovimentoAplicada = -1, tempoEstavelAplicado = -1;
+  int leiturasPeriodo = -1; // Leituras desde o último despertar; -1 antes do primeiro
+  TickType_t proximaLeitura = xTaskGetTickCount();
+  TickType_t periodoLivre = 1;
+
+  // Janela de medição da taxa de amostragem efetiva e do jitter do escritor
+  unsigned long inicioJanela = millis();
+  uint32_t amostrasJanela = 0;
+  uint32_t publicacaoMaxJanela = 0;
+  uint32_t intervaloMaxJanela = 0;
+  unsigned long ultimaPublicacao = 0;
+  uint32_t sequenciaAmostra = 0;
+  uint32_t sequenciaEvento = 0; // Transições e alertas no zoneEvents, numerados juntos
+  uint32_t leiturasInicioJanela[LIDAR_ARRAY_MAX_SENSORS] = {};
+
+  while (1)
+  {
+    // Aplica a configuração quando substituída via /salvar: uma leitura atômica
+    // por iteração; a cópia só é feita quando a versão muda
+    uint32_t versao = configStore.version();
+    if (versao != versaoAplicada && configStore.snapshot(recebida))
+    {
+      versaoAplicada = versao;
+
+      // As amostras seguintes usam outro estado do pipeline: o trace em
+      // gravação termina antes delas. Outras alterações não o interrompem
+      if (configDiff(config, recebida) & mascaraPipeline)
+      {
+        traceRecorder.limit(sequenciaAmostra + 1);
+      }
+      config = recebida;
+
+      // Política de correção de bias
+      if (config.biasModo != biasModoAplicado || config.biasParametro != biasParametroAplicado)
+      {
+        biasModoAplicado = config.biasModo;
+        biasParametroAplicado = config.biasParametro;
+        lidars.configureBias((BiasCorrectionMode)biasModoAplicado, biasParametroAplicado);
+      }
+
+      // Cadeia de filtros: a nova cadeia parte da próxima leitura
+      if (config.cadeiaFiltro != cadeiaFiltroAplicada)
+      {
+        cadeiaFiltroAplicada = config.cadeiaFiltro;
+        lidars.selectFilter((FilterChainId)cadeiaFiltroAplicada);
+      }
+
+      // Qualidade: leitura da força do sinal e do status e descarte por classe
+      if (config.leituraQualidade != leituraQualidadeAplicada || config.sinalMinimo != sinalMinimoAplicado ||
+          config.rejeicaoQualidade != rejeicaoAplicada)
+      {
+        leituraQualidadeAplicada = config.leituraQualidade;
+        sinalMinimoAplicado = config.sinalMinimo;
+        rejeicaoAplicada = config.rejeicaoQualidade;
+        lidars.configureQuality(leituraQualidadeAplicada != 0, sinalMinimoAplicado, rejeicaoAplicada);
+      }
+
+      // Zonas: a zona atual é mantida
+      Zone limites[3];
+      for (int i = 0; i < 3; i++)
+      {
+        limites[i].startCm = (uint16_t)config.inicioZona[i];
+        limites[i].endCm = (uint16_t)config.fimZona[i];
+      }
+      lidars.configureZones(limites, 3, config.zonaHisterese, config.zonaPermanencia * 1000UL);
+      estimadorMovimento.configure(limites, 3, config.antecedenciaAlerta * 1000UL, config.velocidadeMinima);
+
+      // Ritmo fixo: o temporizador passa a disparar com o novo período, a taxa
+      // adaptativa recomeça na taxa máxima e as notificações do período
+      // anterior são descartadas
+      if (config.taxaAlvo != taxaAlvoAplicada || config.taxaOciosa != taxaOciosaAplicada ||
+          config.faixaMovimento != faixaMovimentoAplicada || config.tempoEstavel != tempoEstavelAplicado)
+      {
+        taxaAlvoAplicada = config.taxaAlvo;
+        taxaOciosaAplicada = config.taxaOciosa;
+        faixaMovimentoAplicada = config.faixaMovimento;
+        tempoEstavelAplicado = config.tempoEstavel;
+        agendadorAmostragem.configure(taxaAlvoAplicada);
+        taxaAdaptativa.configure(taxaAlvoAplicada, taxaOciosaAplicada, faixaMovimentoAplicada,
+                                 tempoEstavelAplicado * 1000UL);
+        programarTemporizadorAmostragem(agendadorAmostragem.periodMicros());
+        ulTaskNotifyTake(pdTRUE, 0);
+        leiturasPeriodo = -1;
+      }
+
+      // Saída analógica: fonte, escala e modo; o temporizador só é reiniciado
+      // quando a taxa de atualização muda
+      fonteSaida = config.fonteSaida;
+      saidaAnalogica.configure(config.fatorDivisao, (AnalogOutputMode)config.modoSaida, config.taxaSaida,
+                               config.rampaSaida);
+      if (config.taxaSaida != taxaSaidaAplicada && temporizadorSaida != NULL)
+      {
+        taxaSaidaAplicada = config.taxaSaida;
+        esp_timer_stop(temporizadorSaida);
+        esp_timer_start_periodic(temporizadorSaida, 1000000UL / taxaSaidaAplicada);
+      }
+
+      // Modo de aquisição (disparado ou contínuo)
+      if (config.modoAquisicao != modoAquisicaoAplicado || config.taxaLivre != taxaLivreAplicada)
+      {
+        modoAquisicaoAplicado = config.modoAquisicao;
+        taxaLivreAplicada = config.taxaLivre;
+        if (modoAquisicaoAplicado == 1)
+        {
+          lidars.startFreeRunning(taxaLivreAplicada);
+          periodoLivre = max((TickType_t)1, (TickType_t)pdMS_TO_TICKS(1000 / max(taxaLivreAplicada, 1)));
+          proximaLeitura = xTaskGetTickCount();
+        }
+        else if (lidars.freeRunning())
+        {
+          lidars.stopFreeRunning();
+        }
+      }
+    }
+
+    // Captura do registro de correlação pedida via HTTP: a medição em andamento
+    // termina, o registro é copiado palavra a palavra e o resultado de distância segue
+    // para a próxima leitura; o stream pausa apenas durante a cópia
+    if (correlacao.pending())
+    {
+      int sensor = correlacao.requestedSensor();
+      correlacao.service(lidars.driver(sensor), lidars.address(sensor), sensor);
+    }
+
+    // Gravação de trace pedida via HTTP: copia o estado do pipeline do sensor 0
+    // antes da próxima amostra; as amostras são gravadas por loop()
+    if (traceRecorder.pending())
+    {
+      traceRecorder.service(lidars.pipeline(0), lidars.driver(0).qualityRead(), sequenciaAmostra + 1);
+    }
+
+    // Medição em pipeline intercalada entre os sensores: cada sensor pronto tem
+    // o resultado lido e a próxima medição disparada, enquanto os demais medem
+    LidarArrayReading leitura;
+    if (!lidars.next(leitura))
+    {
+      if (agendadorAmostragem.paced())
+      {
+        // Ritmo fixo: as medições prontas no período já foram lidas; espera a
+        // notificação do próximo. Notificações acumuladas além da primeira e
+        // períodos sem leitura (taxa alvo acima da dos sensores) são overruns
+        if (leiturasPeriodo == 0)
+        {
+          agendadorAmostragem.idleWake();
+        }
+        uint32_t notificacoes = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        if (notificacoes > 0)
+        {
+          metricsRecord(METRICS_WAKE_LATENCY, metricsNow() - instanteDisparo);
+          agendadorAmostragem.wake(micros(), notificacoes);
+          leiturasPeriodo = 0;
+        }
+      }
+      else if (lidars.freeRunning())
+      {
+        // Modo contínuo: os sensores medem sozinhos e a tarefa apenas lê o
+        // resultado mais recente, no ritmo da taxa interna configurada
+        vTaskDelayUntil(&proximaLeitura, periodoLivre);
+      }
+      else
+      {
+        // Todos ainda ocupados: cede a CPU por um tick em vez de consultar o
+        // barramento continuamente (também mantém o watchdog da tarefa ociosa)
+        vTaskDelay(1);
+      }
+      continue;
+    }
+
+    if (leiturasPeriodo >= 0)
+    {
+      leiturasPeriodo++;
+    }
+
+    // Taxas de amostragem efetivas e jitter do escritor, atualizados a cada segundo
+    unsigned long agora = millis();
+    if (agora - inicioJanela >= 1000)
+    {
+      taxaAmostragem = amostrasJanela * 1000UL / (agora - inicioJanela);
+      for (int i = 0; i < numeroSensores; i++)
+      {
+        taxaSensores[i] = (lidars.readings(i) - leiturasInicioJanela[i]) * 1000UL / (agora - inicioJanela);
+        leiturasInicioJanela[i] = lidars.readings(i);
+      }
+      publicacaoMaxUs = publicacaoMaxJanela;
+      intervaloMaxUs = intervaloMaxJanela;
+      amostrasJanela = 0;
+      publicacaoMaxJanela = 0;
+      intervaloMaxJanela = 0;
+      inicioJanela = agora;
+    }
+
+    // Os demais sensores têm apenas a própria saída (lidars.latest())
+    if (leitura.sensor != 0)
+    {
+      continue;
+    }
+
+    amostrasJanela++;
+    int distance = leitura.rawDistance;
+    unsigned long instanteLeitura = leitura.timestampMicros;
+
+    // Filtrada em ponto fixo com a cadeia selecionada, pelo filtro do sensor;
+    // repete a última aceita se a leitura foi descartada pela qualidade
+    int filteredDistance = leitura.filteredDistance;
+
+    // Taxa adaptativa: reduz com a cena estável e sem zona ocupada e volta à
+    // máxima com movimento ou zona ocupada; o novo período conta a partir daqui
+    if (agendadorAmostragem.paced() && taxaAdaptativa.enabled())
+    {
+      uint32_t taxa = taxaAdaptativa.update(instanteLeitura, distance, filteredDistance, leitura.zone, leitura.accepted);
+      if (taxa != agendadorAmostragem.targetHz())
+      {
+        agendadorAmostragem.retarget(taxa);
+        programarTemporizadorAmostragem(agendadorAmostragem.periodMicros());
+      }
+    }
+
+    // Velocidade e tempo previsto até o próximo limite de zona, sobre a
+    // distância filtrada: o alerta antecede a entrada na zona
+    MotionState movimento;
+    bool alerta;
+    {
+      StageTimer timer(METRICS_MOTION);
+      alerta = estimadorMovimento.update(sequenciaAmostra + 1, instanteLeitura, filteredDistance, leitura.accepted,
+                                         movimento);
+    }
+
+    // Leituras descartadas não chegam à saída analógica nem às zonas
+    if (leitura.accepted)
+    {
+      // Distância bruta ou filtrada entregue à saída analógica, sem esperar
+      // pelo DAC: a escrita é feita pelo temporizador
+      {
+        StageTimer timer(METRICS_DAC);
+        saidaAnalogica.submit(fonteSaida == OUTPUT_SOURCE_RAW ? distance : filteredDistance);
+      }
+
+      // Transições de zona, classificadas sobre a distância filtrada, e alertas
+      // de aproximação são publicados como eventos para o stream ao vivo, o
+      // MQTT e GET /zonas, com a velocidade estimada na amostra
+      if (leitura.zoneChanged)
+      {
+        ZoneEvent evento = leitura.zoneEvent;
+        evento.sequence = ++sequenciaEvento;
+        evento.velocity = movimento.velocity;
+        zoneEvents.push(evento);
+      }
+      if (alerta)
+      {
+        ZoneEvent evento = {};
+        evento.sequence = ++sequenciaEvento;
+        evento.timestampMicros = instanteLeitura;
+        evento.fromZone = leitura.zone;
+        evento.toZone = movimento.targetZone;
+        evento.distance = (uint16_t)filteredDistance;
+        evento.velocity = movimento.velocity;
+        evento.leadMillis = max(movimento.timeToThresholdMs, (uint16_t)1);
+        evento.type = ZONE_EVENT_APPROACH;
+        zoneEvents.push(evento);
+      }
+    }
+
+    // Publica a amostra sem bloqueio: leitores (loop, HTTP) nunca atrasam esta tarefa
+    LidarSample amostra = {};
+    amostra.sequence = ++sequenciaAmostra;
+    amostra.timestampMicros = instanteLeitura;
+    amostra.rawDistance = (uint16_t)distance;
+    amostra.filteredDistance = (uint16_t)filteredDistance;
+    amostra.signalStrength = leitura.signalStrength < 0 ? 0 : leitura.signalStrength;
+    amostra.status = leitura.status < 0 ? 0 : leitura.status;
+    amostra.quality = leitura.quality;
+    amostra.zone = leitura.zone;
+
+    unsigned long inicioPublicacao = micros();
+    {
+      StageTimer timer(METRICS_PUBLISH);
+      samplePublisher.publish(amostra);
+      sampleRing.push(amostra);
+    }
+    unsigned long duracaoPublicacao = micros() - inicioPublicacao;
+
+    // Jitter do escritor: maior duração de publicação e maior intervalo entre
+    // publicações na janela de um segundo
+    publicacaoMaxJanela = max(publicacaoMaxJanela, (uint32_t)duracaoPublicacao);
+    if (ultimaPublicacao != 0)
+    {
+      uint32_t intervalo = inicioPublicacao - ultimaPublicacao;
+      intervaloMaxJanela = max(intervaloMaxJanela, intervalo);
+      // Em ticks; intervalos acima de ~17 s (a 240 MHz) caem na última faixa
+      metricsRecord(METRICS_SAMPLE_INTERVAL, min(intervalo, (uint32_t)(0xffffffffUL / metricsTicksPerMicro())) * metricsTicksPerMicro());
+    }
+    ultimaPublicacao = inicioPublicacao;
+  }
+
+}
+
+// Função de configuração inicial do ESP32-S3
+void setup()
+{
+  String fator;
+  // Inicializa a comunicação serial para depuração
+  Serial.begin(115200);
+
+  // Tarefa que escreve na serial as mensagens das tarefas e do servidor web
+  setupDeferredLog();
+
+  // Inicializa a memória não volátil
+  preferences.begin("config", false);
+
+  // Carrega a configuração da NVS para a RAM, validada e convertida; a partir
+  // daqui as tarefas só leem configStore
+  carregarConfiguracoes(preferences);
+  Config config;
+  configStore.snapshot(config);
+
+  // Configura o servidor para salvar e recuperar configurações
+  setupConfigHandler(server, preferences);
+
+  // Configura o stream ao vivo de distância (WebSocket /ws)
+  setupLiveStream(server);
+
+  // Configura e conecta ao WiFi
+  setupWiFi();
+
+  // Frequência da CPU para converter os ciclos medidos pela instrumentação
+  metricsBegin();
+
+  // Trace gravado no SPIFFS, montado por setupWiFi()
+  traceRecorder.begin(armazenamentoTrace, (uint32_t)ESP.getEfuseMac());
+
+  // Aloca o buffer circular de amostras antes de iniciar a aquisição
+  if (!sampleRing.begin(config.profundidadeBuffer))
+  {
+    Serial.println("Erro ao alocar o buffer de amostras");
+  }
+
+  // Temporizador da saída analógica, iniciado pela tarefa do LiDAR com a taxa
+  // configurada
+  esp_timer_create_args_t argumentosSaida = {};
+  argumentosSaida.callback = atualizarSaidaAnalogica;
+  argumentosSaida.name = "saida_analogica";
+  if (esp_timer_create(&argumentosSaida, &temporizadorSaida) != ESP_OK)
+  {
+    Serial.println("Erro ao criar o temporizador da saída analógica");
+    temporizadorSaida = NULL;
+  }
+
+  // Cria a tarefa para lidar com o LIDAR-Lite, fixa no núcleo da aplicação
+  xTaskCreatePinnedToCore(
+      lidarTask,             // Função da tarefa
+      "Lidar Task",          // Nome da tarefa
+      4096,                  // Tamanho da stack alocada para a tarefa
+      NULL,                  // Parâmetros passados para a tarefa (neste caso, nenhum)
+      prioridadeTarefaLidar, // Prioridade da tarefa
+      NULL,                  // Referência da tarefa criada (a própria tarefa a guarda)
+      nucleoTarefaLidar);    // Núcleo da aplicação
+
+  // Publica amostras, transições de zona e saúde no broker MQTT configurado
+  setupMqttPublisher();
+
+  Serial.println("Inicializando LiDAR-Lite v3HP...");
+}
+
+int blink = 0;
+int lastDistance = -1;
+/**
+ * @brief Função principal de loop do programa.
+ *
+ * Esta função é executada continuamente e realiza as seguintes operações:
+ * - Grava no trace em andamento as amostras novas do buffer circular.
+ * - Copia a amostra mais recente publicada pela tarefa do LiDAR, sem bloqueio.
+ * - Registra a distância medida (DeferredLog.h) apenas se houver uma mudança significativa (>= 20 cm).
+ * - Atualiza a última distância medida.
+ * - Aguarda 100 ms antes de repetir a leitura para maior responsividade.
+ */
+void loop()
+{
+  // Grava no trace as amostras publicadas desde a última passagem (~130 a
+  // 1,3 kHz, bem abaixo da capacidade do sampleRing)
+  traceRecorder.drain(sampleRing);
+
+  LidarSample amostra;
+  if (!samplePublisher.read(amostra))
+  {
+    delay(100);
+    return; // Escrita concorrente em todas as tentativas; tenta no próximo ciclo
+  }
+  int distanceCopy = amostra.filteredDistance;
+
+  // Registra a distância medida apenas se houver uma mudança significativa
+  if (abs(distanceCopy - lastDistance) >= 20)
+  {
+    logEvent(LOG_DISTANCE, distanceCopy, amostra.zone);
+    lastDistance = distanceCopy;
+  }
+
+  delay(100); // Aguarda 100 ms antes de repetir a leitura (reduzido para maior responsividade)
+}
+
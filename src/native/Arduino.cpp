@@ -0,0 +1,65 @@
+// Arduino.cpp (ambiente nativo)
+#include "Arduino.h"
+
+NativeSerial Serial;
+
+// Relógio virtual em microssegundos
+static unsigned long virtualMicros = 0;
+
+unsigned long micros()
+{
+    return virtualMicros;
+}
+
+unsigned long millis()
+{
+    return virtualMicros / 1000UL;
+}
+
+void delay(unsigned long ms)
+{
+    virtualMicros += ms * 1000UL;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    virtualMicros += us;
+}
+
+void nativeAdvanceMicros(unsigned long us)
+{
+    virtualMicros += us;
+}
+
+// Nível de cada GPIO simulado
+#define NATIVE_GPIO_COUNT 64
+static uint8_t gpioLevels[NATIVE_GPIO_COUNT];
+static unsigned long gpioChangeMicros[NATIVE_GPIO_COUNT];
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < NATIVE_GPIO_COUNT && gpioLevels[pin] != (value ? HIGH : LOW))
+    {
+        gpioLevels[pin] = value ? HIGH : LOW;
+        gpioChangeMicros[pin] = virtualMicros;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pin < NATIVE_GPIO_COUNT ? gpioLevels[pin] : LOW;
+}
+
+unsigned long nativePinChangeMicros(uint8_t pin)
+{
+    return pin < NATIVE_GPIO_COUNT ? gpioChangeMicros[pin] : 0;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
@@ -0,0 +1,70 @@
+/*------------------------------------------------------------------------------
+
+  Arduino.h (ambiente nativo)
+
+  Substituto mínimo do núcleo Arduino para compilar o driver LIDARLite e os
+  módulos de processamento no host (`[env:native]`). O tempo é virtual: micros()
+  e millis() só avançam quando o barramento simulado consome latência ou quando
+  delay()/delayMicroseconds() são chamados, o que torna os benchmarks
+  reproduzíveis independentemente da máquina.
+
+------------------------------------------------------------------------------*/
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Avança o relógio virtual (usado pelo barramento simulado)
+void nativeAdvanceMicros(unsigned long us);
+
+// GPIO simulado: apenas guarda o nível de cada pino (lido pelos sensores
+// simulados, por exemplo o pino de habilitação de alimentação)
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// Instante da última mudança de nível do pino, no relógio virtual
+unsigned long nativePinChangeMicros(uint8_t pin);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high)
+{
+    return value < (T)low ? (T)low : (value > (T)high ? (T)high : value);
+}
+
+// Serial descarta a saída por padrão para não distorcer as medições
+class NativeSerial
+{
+  public:
+      bool echo = false;
+      void begin(unsigned long) {}
+      void print(const char *text) { if (echo) fputs(text, stdout); }
+      void print(char c) { if (echo) fputc(c, stdout); }
+      void print(int value) { if (echo) printf("%d", value); }
+      void println(const char *text = "") { if (echo) puts(text); }
+      void println(int value) { if (echo) printf("%d\n", value); }
+};
+
+extern NativeSerial Serial;
+
+#endif
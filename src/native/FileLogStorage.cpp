@@ -0,0 +1,108 @@
+// FileLogStorage.cpp (ambiente nativo)
+#include "FileLogStorage.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+FileLogStorage::FileLogStorage(const std::string &dir) : dir(dir)
+{
+    mkdir(dir.c_str(), 0755);
+}
+
+std::string FileLogStorage::path(uint32_t segment) const
+{
+    return dir + "/" + std::to_string(segment) + ".seg";
+}
+
+bool FileLogStorage::append(uint32_t segment, const uint8_t *data, size_t length)
+{
+    appends++;
+    FILE *file = fopen(path(segment).c_str(), "ab");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    // Falha simulada: grava só parte dos dados, como uma queda de energia
+    size_t toWrite = length;
+    if (failAfterBytes != 0)
+    {
+        if (bytesUntilFailure == 0)
+        {
+            bytesUntilFailure = failAfterBytes;
+        }
+        if (length >= bytesUntilFailure)
+        {
+            toWrite = bytesUntilFailure / 2;
+            bytesUntilFailure = 0;
+            failAfterBytes = 0;
+        }
+        else
+        {
+            bytesUntilFailure -= length;
+        }
+    }
+
+    size_t written = fwrite(data, 1, toWrite, file);
+    fclose(file);
+    return written == length;
+}
+
+size_t FileLogStorage::read(uint32_t segment, size_t offset, uint8_t *data, size_t length)
+{
+    reads++;
+    FILE *file = fopen(path(segment).c_str(), "rb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    if (fseek(file, (long)offset, SEEK_SET) == 0)
+    {
+        count = fread(data, 1, length, file);
+    }
+    fclose(file);
+    return count;
+}
+
+size_t FileLogStorage::size(uint32_t segment)
+{
+    struct stat info;
+    return stat(path(segment).c_str(), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+bool FileLogStorage::remove(uint32_t segment)
+{
+    return ::remove(path(segment).c_str()) == 0;
+}
+
+size_t FileLogStorage::list(uint32_t *segments, size_t maxSegments)
+{
+    size_t count = 0;
+    DIR *handle = opendir(dir.c_str());
+    if (handle == NULL)
+    {
+        return 0;
+    }
+    for (struct dirent *entry = readdir(handle); entry != NULL && count < maxSegments; entry = readdir(handle))
+    {
+        if (strstr(entry->d_name, ".seg") != NULL)
+        {
+            segments[count++] = strtoul(entry->d_name, NULL, 10);
+        }
+    }
+    closedir(handle);
+    return count;
+}
+
+void FileLogStorage::clear()
+{
+    uint32_t segments[1024];
+    size_t count = list(segments, 1024);
+    for (size_t i = 0; i < count; i++)
+    {
+        remove(segments[i]);
+    }
+}
@@ -0,0 +1,42 @@
+/*------------------------------------------------------------------------------
+
+  FileLogStorage.h (ambiente nativo)
+
+  Substituto da flash para o FlashLog no host: cada segmento é um arquivo
+  "<dir>/<número>.seg". Conta as operações para o benchmark e permite simular
+  falhas de escrita.
+
+------------------------------------------------------------------------------*/
+#ifndef FileLogStorage_h
+#define FileLogStorage_h
+
+#include <string>
+#include "LogStorage.h"
+
+class FileLogStorage : public LogStorage
+{
+  public:
+      explicit FileLogStorage(const std::string &dir);
+
+      bool append(uint32_t segment, const uint8_t *data, size_t length) override;
+      size_t read(uint32_t segment, size_t offset, uint8_t *data, size_t length) override;
+      size_t size(uint32_t segment) override;
+      bool remove(uint32_t segment) override;
+      size_t list(uint32_t *segments, size_t maxSegments) override;
+
+      // Remove todos os segmentos do diretório
+      void clear();
+
+      uint32_t appends = 0;
+      uint32_t reads = 0;
+      // Número de bytes gravados antes de uma falha simulada (0 = sem falha)
+      size_t failAfterBytes = 0;
+
+  private:
+      std::string path(uint32_t segment) const;
+
+      std::string dir;
+      size_t bytesUntilFailure = 0;
+};
+
+#endif
@@ -0,0 +1,383 @@
+// SimulatedLidar.cpp (ambiente nativo)
+#include "SimulatedLidar.h"
+
+// Registradores do LiDAR-Lite v3HP usados pelo modelo
+#define REG_ACQ_COMMAND 0x00
+#define REG_STATUS 0x01
+#define STATUS_SIGNAL_OVERFLOW 0x04
+#define STATUS_INVALID_SIGNAL 0x08
+#define REG_SIG_COUNT_VAL 0x02
+#define REG_ACQ_CONFIG 0x04
+#define REG_SIGNAL_STRENGTH 0x0e
+#define REG_FULL_DELAY_HIGH 0x0f
+#define REG_FULL_DELAY_LOW 0x10
+#define REG_OUTER_LOOP_COUNT 0x11
+#define REG_UNIT_ID_HIGH 0x16
+#define REG_UNIT_ID_LOW 0x17
+#define REG_I2C_ID_HIGH 0x18
+#define REG_I2C_ID_LOW 0x19
+#define REG_I2C_SEC_ADDR 0x1a
+#define REG_I2C_CONFIG 0x1e
+#define REG_THRESHOLD_BYPASS 0x1c
+#define REG_TEST_COMMAND 0x40
+#define REG_CORR_DATA 0x52
+#define REG_ACQ_SETTINGS 0x5d
+#define REG_MEASURE_DELAY 0x45
+
+// Atraso padrão entre medições automáticas (0x14 unidades de 0,5 ms)
+#define DEFAULT_MEASURE_DELAY 0x14
+#define MEASURE_DELAY_UNIT_US 500
+
+// Número de palavras da memória de correlação
+#define CORRELATION_WORDS 1024
+
+// Números de série distintos para os sensores simulados
+static uint16_t nextUnitId = 0x4c01;
+
+SimulatedLidar::SimulatedLidar(uint8_t address)
+    : i2cAddress(address), secondaryAddress(0), unitId(nextUnitId++), powerPin(-1), wasPowered(true),
+      powerOnMicros(0), pointer(0), traceIndex(0), signalStrength(120), signalIndex(0), pendingSignal(0), statusFlags(0), active(false),
+      freeRunning(false), freeRunBias(false), measurementStart(0), measurementEnd(0), pendingDistance(0), measurementCount(0), biasMeasurementCount(0),
+      correlationIndex(0), correlationHighByte(false)
+{
+    distanceTrace.push_back(250);
+    resetRegisters();
+}
+
+void SimulatedLidar::setDistanceTrace(const std::vector<uint16_t> &trace)
+{
+    if (!trace.empty())
+    {
+        distanceTrace = trace;
+        traceIndex = 0;
+    }
+}
+
+void SimulatedLidar::setSignalTrace(const std::vector<uint8_t> &trace)
+{
+    signalTrace = trace;
+    signalIndex = 0;
+}
+
+void SimulatedLidar::setUnitId(uint16_t id)
+{
+    unitId = id;
+    regs[REG_UNIT_ID_HIGH] = id >> 8;
+    regs[REG_UNIT_ID_LOW] = id & 0xff;
+}
+
+// Também restaura o endereço padrão: o endereço secundário não é persistente
+void SimulatedLidar::resetRegisters()
+{
+    memset(regs, 0, sizeof(regs));
+    regs[REG_UNIT_ID_HIGH] = unitId >> 8;
+    regs[REG_UNIT_ID_LOW] = unitId & 0xff;
+    regs[REG_SIG_COUNT_VAL] = 0x80;
+    regs[REG_ACQ_CONFIG] = 0x08;
+    regs[REG_MEASURE_DELAY] = DEFAULT_MEASURE_DELAY;
+    active = false;
+    freeRunning = false;
+}
+
+uint16_t SimulatedLidar::nextDistance()
+{
+    uint16_t value = distanceTrace[traceIndex];
+    traceIndex = (traceIndex + 1) % distanceTrace.size();
+    return value;
+}
+
+uint8_t SimulatedLidar::nextSignal()
+{
+    if (signalTrace.empty())
+    {
+        return signalStrength;
+    }
+    uint8_t value = signalTrace[signalIndex];
+    signalIndex = (signalIndex + 1) % signalTrace.size();
+    return value;
+}
+
+// Resultado da aquisição: distância, força do sinal e bits de status
+void SimulatedLidar::completeMeasurement()
+{
+    regs[REG_FULL_DELAY_HIGH] = pendingDistance >> 8;
+    regs[REG_FULL_DELAY_LOW] = pendingDistance & 0xff;
+    regs[REG_SIGNAL_STRENGTH] = pendingSignal;
+    statusFlags = pendingSignal == 0 ? STATUS_INVALID_SIGNAL : (pendingSignal == 0xff ? STATUS_SIGNAL_OVERFLOW : 0);
+}
+
+// Duração de uma aquisição conforme a configuração atual dos registradores
+uint32_t SimulatedLidar::measurementMicros(bool biasCorrection) const
+{
+    uint32_t acquisition = timing.microsPerSignalCount * regs[REG_SIG_COUNT_VAL];
+    // Bit 3 de ACQ_CONFIG em 0 habilita a terminação rápida
+    bool quickTermination = (regs[REG_ACQ_CONFIG] & 0x08) == 0;
+    if (quickTermination && pendingDistance < timing.quickTerminationRangeCm)
+    {
+        acquisition /= 2;
+    }
+    uint32_t duration = timing.baseMicros + acquisition;
+    if (biasCorrection)
+    {
+        duration += timing.biasCorrectionMicros;
+    }
+    return duration;
+}
+
+void SimulatedLidar::startMeasurement(bool biasCorrection)
+{
+    update();
+    pendingDistance = nextDistance();
+    pendingSignal = nextSignal();
+    measurementStart = micros();
+    measurementEnd = measurementStart + measurementMicros(biasCorrection);
+    active = true;
+    freeRunning = regs[REG_OUTER_LOOP_COUNT] == 0xff;
+    freeRunBias = biasCorrection;
+    measurementCount++;
+    if (biasCorrection)
+    {
+        biasMeasurementCount++;
+    }
+}
+
+// Conclui a aquisição em andamento quando o relógio virtual passa do seu fim
+void SimulatedLidar::update()
+{
+    while (active && (long)(micros() - measurementEnd) >= 0)
+    {
+        completeMeasurement();
+        correlationIndex = 0;
+        correlationHighByte = false;
+        active = false;
+
+        // Medição contínua (0x11 = 0xff): a próxima aquisição começa após o
+        // atraso de 0x45 (se o bit 5 de 0x04 estiver definido) ou o atraso padrão
+        if (freeRunning && regs[REG_OUTER_LOOP_COUNT] == 0xff)
+        {
+            uint8_t delayCounts = (regs[REG_ACQ_CONFIG] & 0x20) ? regs[REG_MEASURE_DELAY] : DEFAULT_MEASURE_DELAY;
+            measurementStart = measurementEnd + (unsigned long)delayCounts * MEASURE_DELAY_UNIT_US;
+            pendingDistance = nextDistance();
+            pendingSignal = nextSignal();
+            measurementEnd = measurementStart + measurementMicros(freeRunBias);
+            active = true;
+            measurementCount++;
+        }
+    }
+}
+
+// Sinalizador de ocupado: em 1 somente durante a aquisição (não durante o atraso)
+bool SimulatedLidar::busy()
+{
+    update();
+    return active && (long)(micros() - measurementStart) >= 0;
+}
+
+void SimulatedLidar::writeRegister(uint8_t reg, uint8_t value)
+{
+    if (reg == REG_ACQ_COMMAND)
+    {
+        if (value == 0x00)
+        {
+            resetRegisters();
+        }
+        else if (value == 0x03 || value == 0x04)
+        {
+            startMeasurement(value == 0x04);
+        }
+        return;
+    }
+    if (reg == REG_UNIT_ID_HIGH || reg == REG_UNIT_ID_LOW)
+    {
+        return; // Somente leitura
+    }
+    if (reg == REG_I2C_CONFIG && (value & 0x10))
+    {
+        // O endereço secundário só é aceito com o número de série correto em I2C_ID
+        if (regs[REG_I2C_ID_HIGH] == regs[REG_UNIT_ID_HIGH] && regs[REG_I2C_ID_LOW] == regs[REG_UNIT_ID_LOW])
+        {
+            secondaryAddress = regs[REG_I2C_SEC_ADDR] >> 1;
+        }
+        else
+        {
+            value &= ~0x18;
+        }
+    }
+    if (reg == REG_ACQ_SETTINGS || reg == REG_TEST_COMMAND)
+    {
+        correlationIndex = 0;
+        correlationHighByte = false;
+    }
+    regs[reg] = value;
+}
+
+// Forma de onda bipolar centrada no atraso correspondente à distância medida
+uint8_t SimulatedLidar::correlationByte()
+{
+    uint16_t distance = (regs[REG_FULL_DELAY_HIGH] << 8) | regs[REG_FULL_DELAY_LOW];
+    int center = 40 + (distance % (CORRELATION_WORDS - 80));
+    int offset = (int)correlationIndex - center;
+    int value = 0;
+    if (offset > -8 && offset <= 0)
+    {
+        value = 16 * (8 + offset);
+    }
+    else if (offset > 0 && offset < 8)
+    {
+        value = -16 * (8 - offset);
+    }
+
+    if (!correlationHighByte)
+    {
+        correlationHighByte = true;
+        return (uint8_t)(value & 0xff);
+    }
+    correlationHighByte = false;
+    correlationIndex = (correlationIndex + 1) % CORRELATION_WORDS;
+    return value < 0 ? 1 : 0;
+}
+
+uint8_t SimulatedLidar::readRegister(uint8_t reg)
+{
+    update();
+    if (reg == REG_STATUS)
+    {
+        return (busy() ? 0x01 : 0x00) | statusFlags;
+    }
+    if (reg == REG_CORR_DATA)
+    {
+        return correlationByte();
+    }
+    return regs[reg];
+}
+
+void SimulatedLidar::advancePointer()
+{
+    // Com o bit 7 definido o ponteiro avança a cada byte; a memória de correlação
+    // avança internamente e mantém o ponteiro fixo
+    if ((pointer & 0x80) && (pointer & 0x7f) != REG_CORR_DATA)
+    {
+        pointer = 0x80 | ((pointer + 1) & 0x7f);
+    }
+}
+
+void SimulatedLidar::writeNext(uint8_t value)
+{
+    writeRegister(pointer & 0x7f, value);
+    advancePointer();
+}
+
+uint8_t SimulatedLidar::readNext()
+{
+    uint8_t value = readRegister(pointer & 0x7f);
+    advancePointer();
+    return value;
+}
+
+// Alimentação pelo pino de habilitação; ao ligar o sensor reinicia
+bool SimulatedLidar::powered()
+{
+    bool on = powerPin < 0 || digitalRead(powerPin) == HIGH;
+    if (on && !wasPowered)
+    {
+        resetRegisters();
+        powerOnMicros = nativePinChangeMicros(powerPin);
+    }
+    wasPowered = on;
+    return on && (long)(micros() - powerOnMicros) >= (long)timing.powerUpMicros;
+}
+
+bool SimulatedLidar::responds(uint8_t address)
+{
+    if (powerPin >= 0 && !powered())
+    {
+        return false;
+    }
+    uint8_t config = regs[REG_I2C_CONFIG];
+    if (config & 0x10)
+    {
+        return address == secondaryAddress || (address == i2cAddress && !(config & 0x08));
+    }
+    return address == i2cAddress;
+}
+
+/*------------------------------------------------------------------------------
+  Barramento simulado
+------------------------------------------------------------------------------*/
+SimulatedLidar *SimulatedI2CBus::find(uint8_t address)
+{
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        if (devices[i]->responds(address))
+        {
+            return devices[i];
+        }
+    }
+    return NULL;
+}
+
+void SimulatedI2CBus::beginTransmission(uint8_t address)
+{
+    txAddress = address;
+    txBuffer.clear();
+}
+
+size_t SimulatedI2CBus::write(uint8_t value)
+{
+    txBuffer.push_back(value);
+    return 1;
+}
+
+uint8_t SimulatedI2CBus::endTransmission(bool)
+{
+    transactionCount++;
+    nativeAdvanceMicros(transactionOverheadMicros + microsPerByte * txBuffer.size());
+
+    SimulatedLidar *device = find(txAddress);
+    if (device == NULL)
+    {
+        return 2; // NACK no endereço
+    }
+    if (!txBuffer.empty())
+    {
+        device->setPointer(txBuffer[0]);
+        for (size_t i = 1; i < txBuffer.size(); i++)
+        {
+            device->writeNext(txBuffer[i]);
+        }
+    }
+    return 0;
+}
+
+uint8_t SimulatedI2CBus::requestFrom(uint8_t address, uint8_t quantity)
+{
+    transactionCount++;
+    nativeAdvanceMicros(transactionOverheadMicros + microsPerByte * quantity);
+
+    rxBuffer.clear();
+    rxIndex = 0;
+    SimulatedLidar *device = find(address);
+    if (device == NULL)
+    {
+        return 0;
+    }
+    for (uint8_t i = 0; i < quantity; i++)
+    {
+        rxBuffer.push_back(device->readNext());
+    }
+    return quantity;
+}
+
+int SimulatedI2CBus::available()
+{
+    return (int)(rxBuffer.size() - rxIndex);
+}
+
+int SimulatedI2CBus::read()
+{
+    if (rxIndex >= rxBuffer.size())
+    {
+        return -1;
+    }
+    return rxBuffer[rxIndex++];
+}
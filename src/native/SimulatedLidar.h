@@ -0,0 +1,150 @@
+/*------------------------------------------------------------------------------
+
+  SimulatedLidar.h (ambiente nativo)
+
+  Modelo de registradores do LIDAR-Lite v3HP e barramento I2C simulado para
+  executar o driver LIDARLite no host. O modelo cobre o que o driver usa:
+
+  - 0x00 ACQ_COMMAND: 0x03/0x04 inicia uma aquisição (sem/com correção de bias),
+    0x00 reinicia os registradores;
+  - 0x01 STATUS: bit 0 (ocupado) fica em 1 até o fim da aquisição; bit 2
+    (sinal saturado) com força 0xff e bit 3 (sinal inválido) com força 0;
+  - 0x0e SIGNAL_STRENGTH: força do sinal da última medição (constante ou de
+    uma sequência, como a distância);
+  - 0x02, 0x04, 0x1c: contagem de aquisição, configuração e limiar, que
+    determinam a duração da medição;
+  - 0x11 OUTER_LOOP_COUNT = 0xff: medição contínua, com o atraso de 0x45
+    MEASURE_DELAY (unidades de 0,5 ms) quando o bit 5 de 0x04 está definido;
+  - 0x0f/0x10 (lidos via 0x8f com autoincremento): distância em centímetros;
+  - 0x52 (lido via 0xd2): memória de correlação, uma palavra por leitura;
+  - 0x16/0x17 UNIT_ID, 0x18/0x19 I2C_ID, 0x1a I2C_SEC_ADDR e 0x1e I2C_CONFIG:
+    endereço secundário, aceito apenas se I2C_ID conferir com o número de
+    série; o bit 3 de 0x1e desabilita o endereço padrão.
+
+  O sensor pode ter um pino de habilitação de alimentação (GPIO simulado):
+  desligado não responde no barramento, e ao ser ligado volta aos registradores
+  e ao endereço padrão e só responde depois do tempo de inicialização.
+
+  A duração da medição e a latência de cada transação são configuráveis e
+  consomem o relógio virtual de micros().
+
+------------------------------------------------------------------------------*/
+#ifndef SimulatedLidar_h
+#define SimulatedLidar_h
+
+#include <Arduino.h>
+#include <vector>
+#include "I2CBus.h"
+
+// Parâmetros de tempo da medição simulada, em microssegundos
+struct SimulatedLidarTiming
+{
+    uint32_t baseMicros = 150;           // Custo fixo de cada aquisição
+    uint32_t microsPerSignalCount = 3;   // Custo por unidade de SIG_COUNT_VAL (0x02)
+    uint32_t biasCorrectionMicros = 200; // Custo adicional do comando 0x04
+    uint32_t quickTerminationRangeCm = 500; // Abaixo disso a terminação rápida reduz a aquisição pela metade
+    uint32_t powerUpMicros = 22000;      // Inicialização após habilitar a alimentação
+};
+
+class SimulatedLidar
+{
+  public:
+      explicit SimulatedLidar(uint8_t address = 0x62);
+
+      SimulatedLidarTiming timing;
+
+      // true se o sensor está alimentado, inicializado e responde em address
+      bool responds(uint8_t address);
+      void setPowerPin(int pin)
+      {
+          powerPin = pin;
+          wasPowered = false;
+      }
+      void setUnitId(uint16_t id);
+      void setDistanceTrace(const std::vector<uint16_t> &trace);
+      void setSignalStrength(uint8_t strength) { signalStrength = strength; }
+      void setSignalTrace(const std::vector<uint8_t> &trace);
+
+      // Interface usada pelo barramento: o primeiro byte escrito define o ponteiro
+      // de registrador (bit 7 = autoincremento), os seguintes são escritos nele
+      void setPointer(uint8_t reg) { pointer = reg; }
+      void writeNext(uint8_t value);
+      uint8_t readNext();
+
+      uint32_t measurements() const { return measurementCount; }
+      uint32_t biasMeasurements() const { return biasMeasurementCount; }
+
+  private:
+      void resetRegisters();
+      bool powered();
+      void startMeasurement(bool biasCorrection);
+      void update();
+      bool busy();
+      uint32_t measurementMicros(bool biasCorrection) const;
+      uint16_t nextDistance();
+      uint8_t nextSignal();
+      void completeMeasurement();
+      uint8_t correlationByte();
+
+      void writeRegister(uint8_t reg, uint8_t value);
+      uint8_t readRegister(uint8_t reg);
+      void advancePointer();
+
+      uint8_t i2cAddress;
+      uint8_t secondaryAddress;
+      uint16_t unitId;
+      int powerPin;
+      bool wasPowered;
+      unsigned long powerOnMicros;
+      uint8_t pointer;
+      uint8_t regs[128];
+      std::vector<uint16_t> distanceTrace;
+      size_t traceIndex;
+      uint8_t signalStrength;
+      std::vector<uint8_t> signalTrace;
+      size_t signalIndex;
+      uint8_t pendingSignal;
+      uint8_t statusFlags;
+      bool active;
+      bool freeRunning;
+      bool freeRunBias;
+      unsigned long measurementStart;
+      unsigned long measurementEnd;
+      uint16_t pendingDistance;
+      uint32_t measurementCount;
+      uint32_t biasMeasurementCount;
+      uint16_t correlationIndex;
+      bool correlationHighByte;
+};
+
+class SimulatedI2CBus : public I2CBus
+{
+  public:
+      // Latência de uma transação: overhead fixo (start, endereço, stop) + bytes de dados
+      uint32_t transactionOverheadMicros = 25;
+      uint32_t microsPerByte = 23;
+
+      void attach(SimulatedLidar &device) { devices.push_back(&device); }
+      uint32_t transactions() const { return transactionCount; }
+      void resetCounters() { transactionCount = 0; }
+
+      void begin(int, int, uint32_t) override {}
+      void beginTransmission(uint8_t address) override;
+      size_t write(uint8_t value) override;
+      uint8_t endTransmission(bool sendStop = true) override;
+      uint8_t requestFrom(uint8_t address, uint8_t quantity) override;
+      int available() override;
+      int read() override;
+
+  private:
+      SimulatedLidar *find(uint8_t address);
+
+      std::vector<SimulatedLidar *> devices;
+      uint8_t txAddress = 0;
+      std::vector<uint8_t> txBuffer;
+      std::vector<uint8_t> rxBuffer;
+      size_t rxIndex = 0;
+      uint32_t transactionCount = 0;
+};
+
+#endif
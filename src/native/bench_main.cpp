@@ -0,0 +1,2630 @@
+/*------------------------------------------------------------------------------
+
+  bench_main.cpp (ambiente nativo)
+
+  Benchmarks do caminho de aquisição executados contra o LIDAR-Lite v3HP
+  simulado. As taxas em leituras/s usam o relógio virtual (latência de
+  barramento e duração de medição modeladas), portanto são reproduzíveis; o
+  custo em ns/leitura é o tempo real de CPU do host.
+
+  Uso: pio run -e native && .pio/build/native/program [leituras]
+       .pio/build/native/program replay <trace.bin>...
+
+  Além dos números, algumas seções conferem resultados esperados (check()):
+  cada falha é impressa e o programa termina com código 1.
+
+------------------------------------------------------------------------------*/
+#include <Arduino.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AcquisitionMetrics.h"
+#include "AdaptiveRate.h"
+#include "AnalogOutput.h"
+#include "Config.h"
+#include "CorrelationRecord.h"
+#include "DeferredLog.h"
+#include "FileLogStorage.h"
+#include "FilterBank.h"
+#include "FlashLog.h"
+#include "LIDARLite.h"
+#include "LidarArray.h"
+#include "MotionEstimator.h"
+#include "SampleCodec.h"
+#include "SamplePublisher.h"
+#include "SampleRing.h"
+#include "SamplingScheduler.h"
+#include "SimulatedLidar.h"
+#include "Trace.h"
+#include "ZoneEngine.h"
+
+static uint64_t hostNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static int benchFailures = 0;
+
+/**
+ * @brief Confere um resultado esperado; a falha é impressa e contada no
+ *        código de saída do programa.
+ */
+static void check(bool condition, const char *what)
+{
+    if (!condition)
+    {
+        printf("FALHA: %s\n", what);
+        benchFailures++;
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Aquisição bloqueante: distance() com correção de bias, para cada modo de
+  configure()
+------------------------------------------------------------------------------*/
+static void benchConfigureModes(int readings)
+{
+    printf("\n== distance() por modo de configure() (%d leituras) ==\n", readings);
+    printf("%-5s %12s %12s %14s %14s %12s\n",
+           "modo", "leituras/s", "trans/leit", "poll us/leit", "polls/leit", "host ns/leit");
+
+    for (int mode = 0; mode <= 5; mode++)
+    {
+        SimulatedI2CBus bus;
+        SimulatedLidar sensor;
+        bus.attach(sensor);
+        LIDARLite lidar(bus);
+        lidar.begin(mode, true);
+        lidar.resetStats();
+
+        unsigned long start = micros();
+        uint64_t hostStart = hostNanos();
+        for (int i = 0; i < readings; i++)
+        {
+            lidar.distance();
+        }
+        uint64_t hostElapsed = hostNanos() - hostStart;
+        unsigned long elapsed = micros() - start;
+
+        const LIDARLiteStats &stats = lidar.stats();
+        printf("%-5d %12.1f %12.2f %14.1f %14.2f %12.1f\n",
+               mode,
+               readings * 1e6 / elapsed,
+               (double)stats.transactions / readings,
+               (double)stats.busyPollMicros / readings,
+               (double)stats.busyPolls / readings,
+               (double)hostElapsed / readings);
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Bloqueante x pipeline: mesma carga de processamento por amostra (filtro,
+  DAC, publicação) simulada com delayMicroseconds(). No pipeline a próxima
+  medição já está em andamento enquanto a amostra anterior é processada.
+------------------------------------------------------------------------------*/
+static void benchPipeline(int readings)
+{
+    printf("\n== distance() bloqueante x distanceAsync() em pipeline (%d leituras) ==\n", readings);
+    printf("%-12s %8s %12s %12s %14s\n", "modo", "proc us", "leituras/s", "trans/leit", "poll us/leit");
+
+    const unsigned int processingCosts[] = {0, 300};
+    for (unsigned int processing : processingCosts)
+    {
+        for (int pipelined = 0; pipelined <= 1; pipelined++)
+        {
+            SimulatedI2CBus bus;
+            SimulatedLidar sensor;
+            bus.attach(sensor);
+            LIDARLite lidar(bus);
+            lidar.begin(0, true);
+            lidar.resetStats();
+
+            unsigned long start = micros();
+            int done = 0;
+            if (pipelined)
+            {
+                while (done < readings)
+                {
+                    int distance;
+                    if (lidar.distanceAsync(distance))
+                    {
+                        delayMicroseconds(processing);
+                        done++;
+                    }
+                }
+            }
+            else
+            {
+                for (; done < readings; done++)
+                {
+                    lidar.distance();
+                    delayMicroseconds(processing);
+                }
+            }
+            unsigned long elapsed = micros() - start;
+
+            const LIDARLiteStats &stats = lidar.stats();
+            printf("%-12s %8u %12.1f %12.2f %14.1f\n",
+                   pipelined ? "pipeline" : "bloqueante",
+                   processing,
+                   readings * 1e6 / elapsed,
+                   (double)stats.transactions / readings,
+                   (double)stats.busyPollMicros / readings);
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Política de correção de bias: leituras/s em pipeline e comandos usados
+------------------------------------------------------------------------------*/
+static void benchBiasPolicy(int readings)
+{
+    printf("\n== Política de correção de bias, pipeline (%d leituras) ==\n", readings);
+    printf("%-22s %12s %10s %10s\n", "política", "leituras/s", "0x04", "0x03");
+
+    struct
+    {
+        const char *name;
+        BiasCorrectionMode mode;
+        uint32_t parameter;
+    } policies[] = {
+        {"toda leitura", BIAS_ALWAYS, 1},
+        {"a cada 100 leituras", BIAS_EVERY_N, 100},
+        {"a cada 1000 ms", BIAS_PERIODIC, 1000},
+        {"deriva (max 100)", BIAS_DRIFT, 100},
+    };
+
+    // Cena com saltos ocasionais de distância para exercitar a heurística de deriva
+    std::vector<uint16_t> trace;
+    for (int i = 0; i < 1000; i++)
+    {
+        trace.push_back(i % 250 < 125 ? 300 : 150);
+    }
+
+    for (auto &policy : policies)
+    {
+        SimulatedI2CBus bus;
+        SimulatedLidar sensor;
+        sensor.setDistanceTrace(trace);
+        bus.attach(sensor);
+        LIDARLite lidar(bus);
+        lidar.begin(0, true);
+        lidar.biasCorrection().configure(policy.mode, policy.parameter);
+        lidar.resetStats();
+
+        unsigned long start = micros();
+        int done = 0;
+        while (done < readings)
+        {
+            int distance;
+            if (lidar.distanceAsync(distance))
+            {
+                done++;
+            }
+        }
+        unsigned long elapsed = micros() - start;
+
+        const LIDARLiteStats &stats = lidar.stats();
+        printf("%-22s %12.1f %10u %10u\n", policy.name, readings * 1e6 / elapsed,
+               stats.biasAcquisitions, stats.plainAcquisitions);
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Modo contínuo (free-running): o host lê apenas o resultado mais recente em
+  intervalos fixos; compara com o modo disparado em pipeline
+------------------------------------------------------------------------------*/
+static void benchFreeRunning(int readings)
+{
+    printf("\n== Modo contínuo x disparado (%d leituras do host) ==\n", readings);
+    printf("%-22s %12s %12s %12s %10s\n", "modo", "amostras/s", "trans/amost", "trans/leit", "repetidas");
+
+    // Leitura disparada em pipeline, como referência
+    {
+        SimulatedI2CBus bus;
+        SimulatedLidar sensor;
+        bus.attach(sensor);
+        LIDARLite lidar(bus);
+        lidar.begin(0, true);
+        lidar.biasCorrection().configure(BIAS_EVERY_N, 100);
+        lidar.resetStats();
+
+        unsigned long start = micros();
+        int done = 0;
+        while (done < readings)
+        {
+            int distance;
+            if (lidar.distanceAsync(distance))
+            {
+                done++;
+            }
+        }
+        unsigned long elapsed = micros() - start;
+        const LIDARLiteStats &stats = lidar.stats();
+        printf("%-22s %12.1f %12.2f %12.2f %9.1f%%\n", "disparado (pipeline)",
+               done * 1e6 / elapsed, (double)stats.transactions / done,
+               (double)stats.transactions / done, 0.0);
+    }
+
+    // Alvo parado com ruído de medição de alguns centímetros
+    std::vector<uint16_t> trace;
+    uint32_t seed = 12345;
+    for (int i = 0; i < 4096; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        trace.push_back(250 + (seed >> 16) % 7);
+    }
+
+    // Leitura contínua: host lendo a 1 kHz com diferentes taxas internas
+    const unsigned int rates[] = {100, 500, 1000};
+    for (unsigned int rate : rates)
+    {
+        SimulatedI2CBus bus;
+        SimulatedLidar sensor;
+        sensor.setDistanceTrace(trace);
+        bus.attach(sensor);
+        LIDARLite lidar(bus);
+        lidar.begin(0, true);
+        lidar.startFreeRunning(rate);
+        lidar.resetStats();
+
+        unsigned long start = micros();
+        int fresh = 0;
+        for (int i = 0; i < readings; i++)
+        {
+            unsigned long readStart = micros();
+            int distance;
+            if (lidar.readLatest(distance))
+            {
+                fresh++;
+            }
+            unsigned long spent = micros() - readStart;
+            if (spent < 1000)
+            {
+                delayMicroseconds(1000 - spent);
+            }
+        }
+        unsigned long elapsed = micros() - start;
+
+        const LIDARLiteStats &stats = lidar.stats();
+        char name[32];
+        snprintf(name, sizeof(name), "contínuo %u Hz", rate);
+        printf("%-22s %12.1f %12.2f %12.2f %9.1f%%\n", name,
+               fresh * 1e6 / elapsed,
+               fresh ? (double)stats.transactions / fresh : 0.0,
+               (double)stats.transactions / readings,
+               100.0 * stats.staleReads / stats.freeRunReads);
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Vários sensores no mesmo barramento: endereços atribuídos na inicialização
+  pelos pinos de habilitação e aquisições intercaladas por LidarArray::next(),
+  comparadas com a leitura bloqueante de um sensor de cada vez. Cada sensor
+  mede uma distância constante diferente, que deve aparecer na sua saída.
+------------------------------------------------------------------------------*/
+static void benchMultiSensor(int readings)
+{
+    printf("\n== Vários sensores em um barramento (%d leituras por sensor) ==\n", readings);
+    printf("%-12s %8s %9s %12s %12s %12s %10s\n",
+           "modo", "sensores", "presentes", "leituras/s", "por sensor", "trans/leit", "trocadas");
+
+    const int enablePins[LIDAR_ARRAY_MAX_SENSORS] = {12, 13, 14, 15};
+    for (int count = 1; count <= LIDAR_ARRAY_MAX_SENSORS; count++)
+    {
+        for (int interleaved = 0; interleaved <= 1; interleaved++)
+        {
+            SimulatedI2CBus bus;
+            std::vector<SimulatedLidar> sensors(count);
+            for (int i = 0; i < count; i++)
+            {
+                sensors[i].setPowerPin(enablePins[i]);
+                sensors[i].setDistanceTrace(std::vector<uint16_t>(1, 100 + 50 * i));
+                bus.attach(sensors[i]);
+            }
+            LidarArray lidars(bus);
+            int present = lidars.begin(enablePins, count);
+            lidars.selectFilter(FILTER_MEDIAN_EMA);
+            lidars.configureBias(BIAS_EVERY_N, 100);
+            bus.resetCounters();
+
+            std::vector<uint32_t> perSensor(count, 0);
+            uint32_t mismatches = 0;
+            int total = readings * count;
+            unsigned long start = micros();
+            if (interleaved)
+            {
+                int done = 0;
+                while (done < total)
+                {
+                    LidarArrayReading reading;
+                    if (lidars.next(reading))
+                    {
+                        perSensor[reading.sensor]++;
+                        done++;
+                    }
+                }
+            }
+            else
+            {
+                // Referência: um sensor de cada vez, aguardando o fim da medição
+                for (int r = 0; r < readings; r++)
+                {
+                    for (int i = 0; i < count; i++)
+                    {
+                        LIDARLite &lidar = lidars.driver(i);
+                        lidar.distance(lidar.biasCorrection().shouldCorrect(millis()), lidars.address(i));
+                        perSensor[i]++;
+                    }
+                }
+            }
+            unsigned long elapsed = micros() - start;
+
+            for (int i = 0; i < count && interleaved; i++)
+            {
+                LidarSample sample;
+                if (!lidars.latest(i, sample) || sample.sensor != i || sample.rawDistance != 100 + 50 * i)
+                {
+                    mismatches++;
+                }
+            }
+
+            uint32_t minimum = *std::min_element(perSensor.begin(), perSensor.end());
+            printf("%-12s %8d %9d %12.1f %12.1f %12.2f %10u\n",
+                   interleaved ? "intercalado" : "sequencial", count, present,
+                   total * 1e6 / elapsed, minimum * 1e6 / elapsed,
+                   (double)bus.transactions() / total, mismatches);
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Amostragem em ritmo fixo: o temporizador é emulado no relógio virtual (a
+  tarefa acorda no início de cada período, ou atrasada se o anterior ainda não
+  terminou) e cada despertar lê as medições prontas de todos os sensores. Os
+  percentis do JitterHistogram são comparados com os exatos.
+------------------------------------------------------------------------------*/
+static void benchSampling(int readings)
+{
+    printf("\n== Amostragem em ritmo fixo (%d períodos) ==\n", readings);
+
+    // Desvios de 0 a 63 µs, com 5% de atrasos de até 5 ms
+    std::vector<uint32_t> deviations(readings * 10);
+    uint32_t seed = 17;
+    JitterHistogram histogram;
+    for (uint32_t &deviation : deviations)
+    {
+        seed = seed * 1103515245 + 12345;
+        deviation = (seed >> 16) % 100 < 5 ? (seed >> 8) % 5000 : (seed >> 16) % 64;
+        histogram.record(deviation);
+    }
+    std::sort(deviations.begin(), deviations.end());
+    printf("%-8s %10s %10s\n", "quantil", "exato us", "faixa us");
+    const float quantiles[] = {0.5f, 0.9f, 0.99f, 0.999f};
+    for (float q : quantiles)
+    {
+        printf("p%-7g %10u %10u\n", q * 100, deviations[(size_t)(q * deviations.size())], histogram.quantile(q));
+    }
+
+    printf("%-8s %8s %12s %12s %10s %10s %10s %10s\n",
+           "alvo Hz", "sensores", "leituras/s", "por sensor", "p99 us", "máx us", "overruns", "sem leit.");
+    const int enablePins[LIDAR_ARRAY_MAX_SENSORS] = {12, 13, 14, 15};
+    const uint32_t rates[] = {250, 500, 1000, 1300, 2000};
+    for (int count = 1; count <= 2; count++)
+    {
+        for (uint32_t rate : rates)
+        {
+            SimulatedI2CBus bus;
+            std::vector<SimulatedLidar> sensors(count);
+            for (int i = 0; i < count; i++)
+            {
+                sensors[i].setPowerPin(enablePins[i]);
+                sensors[i].setDistanceTrace(std::vector<uint16_t>(1, 100 + 50 * i));
+                bus.attach(sensors[i]);
+            }
+            LidarArray lidars(bus);
+            lidars.begin(enablePins, count);
+            lidars.selectFilter(FILTER_MEDIAN_EMA);
+            lidars.configureBias(BIAS_EVERY_N, 100);
+
+            SamplingScheduler scheduler;
+            scheduler.configure(rate);
+            uint32_t period = scheduler.periodMicros();
+            unsigned long start = micros();
+            unsigned long tick = start + period; // Próximo disparo ainda não atendido
+            uint32_t total = 0;
+            for (int w = 0; w < readings; w++)
+            {
+                unsigned long now = micros();
+                uint32_t notifications = 1;
+                if ((long)(tick - now) > 0)
+                {
+                    delayMicroseconds(tick - now);
+                }
+                else
+                {
+                    notifications += (now - tick) / period;
+                }
+                tick += notifications * period;
+                scheduler.wake(micros(), notifications);
+
+                int got = 0;
+                LidarArrayReading reading;
+                while (lidars.next(reading))
+                {
+                    got++;
+                }
+                if (got == 0 && w > 0) // O primeiro período só dispara as medições
+                {
+                    scheduler.idleWake();
+                }
+                total += got;
+            }
+            unsigned long elapsed = micros() - start;
+
+            printf("%-8u %8d %12.1f %12.1f %10u %10u %10u %10u\n", rate, count, total * 1e6 / elapsed,
+                   total * 1e6 / elapsed / count, scheduler.jitter().quantile(0.99f), scheduler.jitter().maximum(),
+                   scheduler.overruns(), scheduler.idleWakes());
+            if (rate <= 1000)
+            {
+                check(scheduler.overruns() == 0, "ritmo fixo: taxa alvo atingível sem overruns");
+            }
+            else if (count == 1 && rate == 2000)
+            {
+                // O sensor entrega ~1000 leituras/s: metade dos períodos fica sem leitura
+                check(scheduler.overruns() >= (uint32_t)readings * 2 / 5,
+                      "ritmo fixo: taxa alvo inatingível contada como overrun");
+            }
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Qualidade das leituras: custo de barramento da leitura da força do sinal e do
+  status e efeito do descarte no erro da saída filtrada. Alvo parado a 300 cm
+  com ruído de +-3 cm; 4% das medições sem retorno (distância aleatória), 3%
+  fracas (erro de até +-40 cm) e 1% saturadas (-20 cm).
+------------------------------------------------------------------------------*/
+static void benchQualityGating(int readings)
+{
+    printf("\n== Qualidade das leituras (%d leituras, cadeia kalman) ==\n", readings);
+    printf("%-26s %11s %10s %10s %9s %9s %9s %11s %9s\n", "configuração", "leituras/s", "bytes/leit",
+           "trans/leit", "fracas", "saturadas", "sem ret.", "descartadas", "RMS cm");
+
+    std::vector<uint16_t> distances;
+    std::vector<uint8_t> signals;
+    uint32_t seed = 2024;
+    for (int i = 0; i < 4096; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32_t r = (seed >> 16) % 100;
+        int noise = (int)((seed >> 8) % 7) - 3;
+        if (r < 4)
+        {
+            distances.push_back((seed >> 4) % 1200);
+            signals.push_back(0);
+        }
+        else if (r < 7)
+        {
+            distances.push_back(300 + (int)((seed >> 6) % 81) - 40);
+            signals.push_back(8);
+        }
+        else if (r < 8)
+        {
+            distances.push_back(280);
+            signals.push_back(255);
+        }
+        else
+        {
+            distances.push_back(300 + noise);
+            signals.push_back(90 + (seed >> 12) % 60);
+        }
+    }
+
+    struct Setup
+    {
+        const char *name;
+        bool readQuality;
+        uint8_t rejectMask;
+    };
+    const Setup setups[] = {
+        {"sem leitura de qualidade", false, SIGNAL_REJECT_NONE},
+        {"leitura, sem descarte", true, SIGNAL_REJECT_NONE},
+        {"descarta sem retorno", true, SIGNAL_REJECT_NO_RETURN},
+        {"descarta sem ret./sat.", true, SIGNAL_REJECT_NO_RETURN | (1 << SIGNAL_SATURATED)},
+        {"descarta sem ret./sat./fr.", true, SIGNAL_REJECT_NO_RETURN | (1 << SIGNAL_SATURATED) | (1 << SIGNAL_WEAK)},
+    };
+    const int noPin[1] = {LIDAR_ARRAY_NO_PIN};
+    for (const Setup &setup : setups)
+    {
+        SimulatedI2CBus bus;
+        SimulatedLidar sensor;
+        sensor.setDistanceTrace(distances);
+        sensor.setSignalTrace(signals);
+        bus.attach(sensor);
+        LidarArray lidars(bus);
+        lidars.begin(noPin, 1);
+        lidars.selectFilter(FILTER_KALMAN);
+        lidars.configureBias(BIAS_EVERY_N, 100);
+        lidars.configureQuality(setup.readQuality, 16, setup.rejectMask);
+        lidars.driver(0).resetStats();
+
+        double squaredError = 0;
+        int done = 0, skipped = 0;
+        unsigned long start = micros();
+        while (done < readings)
+        {
+            LidarArrayReading reading;
+            if (!lidars.next(reading))
+            {
+                continue;
+            }
+            done++;
+            if (done <= 100)
+            {
+                skipped++; // Convergência do filtro
+                continue;
+            }
+            double error = reading.filteredDistance - 300.0;
+            squaredError += error * error;
+        }
+        unsigned long elapsed = micros() - start;
+
+        const LIDARLiteStats &stats = lidars.driver(0).stats();
+        const QualityGate &gate = lidars.quality(0);
+        printf("%-26s %11.1f %10.2f %10.2f %9u %9u %9u %11u %9.2f\n", setup.name,
+               done * 1e6 / elapsed, (double)stats.bytesRead / done, (double)stats.transactions / done,
+               gate.count(SIGNAL_WEAK), gate.count(SIGNAL_SATURATED), gate.count(SIGNAL_NO_RETURN),
+               gate.rejected(), sqrt(squaredError / (done - skipped)));
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Registro de correlação: leitura palavra a palavra (padrão de
+  correlationRecord) x leitura em bloco (setCorrelationBulkRead), a
+  pausa causada no stream de distância por capturas periódicas e a precisão da
+  análise sobre uma forma de onda sintética com ruído e um segundo alvo.
+------------------------------------------------------------------------------*/
+static void benchCorrelation(int readings)
+{
+    printf("\n== Registro de correlação ==\n");
+    printf("%-16s %8s %12s %12s\n", "leitura", "palavras", "captura ms", "transações");
+    const int sizes[] = {256, 1024};
+    static int16_t records[2][CORRELATION_MAX_WORDS];
+    for (int words : sizes)
+    {
+        int copied[2];
+        for (int bulk = 0; bulk <= 1; bulk++)
+        {
+            SimulatedI2CBus bus;
+            SimulatedLidar sensor;
+            bus.attach(sensor);
+            LIDARLite lidar(bus);
+            lidar.begin(0, true);
+            lidar.setCorrelationBulkRead(bulk != 0);
+            lidar.distance();
+            bus.resetCounters();
+
+            unsigned long start = micros();
+            copied[bulk] = lidar.correlationRecord(records[bulk], words);
+            unsigned long elapsed = micros() - start;
+            printf("%-16s %8d %12.2f %12u\n", bulk ? "em bloco" : "palavra a palavra",
+                   words, elapsed / 1000.0, bus.transactions());
+        }
+        check(copied[0] == words && copied[1] == words &&
+                  memcmp(records[0], records[1], words * sizeof(int16_t)) == 0,
+              "correlação: leitura em bloco igual à palavra a palavra no simulador");
+    }
+
+    // Stream em pipeline com uma captura de 256 palavras a cada 100 ms; a 150 cm
+    // o retorno simulado fica dentro das 256 primeiras palavras
+    {
+        SimulatedI2CBus bus;
+        SimulatedLidar sensor;
+        sensor.setDistanceTrace(std::vector<uint16_t>(1, 150));
+        bus.attach(sensor);
+        LIDARLite lidar(bus);
+        lidar.begin(0, true);
+        lidar.biasCorrection().configure(BIAS_EVERY_N, 100);
+        CorrelationCapture capture;
+
+        unsigned long start = micros();
+        unsigned long last = 0, maxGap = 0, nextCapture = start + 100000;
+        int done = 0, mismatches = 0;
+        while (done < readings)
+        {
+            if ((long)(micros() - nextCapture) >= 0)
+            {
+                capture.request(CORRELATION_DEFAULT_WORDS);
+                nextCapture += 100000;
+            }
+            capture.service(lidar, LIDARLITE_ADDR_DEFAULT);
+
+            int distance;
+            if (lidar.distanceAsync(distance))
+            {
+                unsigned long now = micros();
+                if (last != 0)
+                {
+                    maxGap = std::max(maxGap, now - last);
+                }
+                last = now;
+                if (distance != 150)
+                {
+                    mismatches++;
+                }
+                done++;
+            }
+        }
+        unsigned long elapsed = micros() - start;
+
+        CorrelationAnalysis analysis;
+        capture.read(analysis);
+        printf("stream com capturas a cada 100 ms: %.1f leituras/s, maior intervalo %.2f ms, "
+               "%u capturas, distâncias erradas %d\n",
+               done * 1e6 / elapsed, maxGap / 1000.0, analysis.sequence, mismatches);
+        printf("cruzamento por zero no simulador: %.2f (esperado %.2f)\n",
+               analysis.zeroCrossingQ8 / 256.0, 40 + 150 + 128.0 / 240);
+    }
+
+    // Forma de onda sintética: retorno principal com cruzamento em 300,4, segundo
+    // alvo com metade da amplitude em 700 e ruído uniforme de +-6
+    std::vector<int16_t> synthetic(CORRELATION_MAX_WORDS);
+    uint32_t seed = 777;
+    for (int i = 0; i < CORRELATION_MAX_WORDS; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        double value = (int)((seed >> 16) % 13) - 6;
+        double main = i - 300.4, second = i - 700.0;
+        value -= 120 * sin(M_PI * main / 12) * (fabs(main) < 12);
+        value -= 60 * sin(M_PI * second / 12) * (fabs(second) < 12);
+        synthetic[i] = (int16_t)lround(value);
+    }
+    CorrelationAnalysis analysis = {};
+    uint64_t hostStart = hostNanos();
+    const int rounds = 1000;
+    for (int r = 0; r < rounds; r++)
+    {
+        analyzeCorrelation(synthetic.data(), CORRELATION_MAX_WORDS, analysis);
+    }
+    uint64_t hostElapsed = hostNanos() - hostStart;
+    printf("análise de 1024 palavras: %.1f us; pico %d em %u, cruzamento %.2f (real 300.40), "
+           "ruído %u, segundo pico %d em %u\n",
+           hostElapsed / 1000.0 / rounds, analysis.peak, analysis.peakIndex, analysis.zeroCrossingQ8 / 256.0,
+           analysis.noiseFloor, analysis.secondPeak, analysis.secondPeakIndex);
+}
+
+/*------------------------------------------------------------------------------
+  Instrumentação do caminho crítico: histogramas por etapa em uma aquisição em
+  pipeline de um sensor (durações no relógio virtual, em µs) e custo de cada
+  medição no host, com e sem a instrumentação compilada (LIDAR_METRICS)
+------------------------------------------------------------------------------*/
+static void benchMetrics(int readings)
+{
+    printf("\n== Instrumentação da aquisição (%d leituras, LIDAR_METRICS=%d) ==\n", readings, LIDAR_METRICS);
+
+    SimulatedI2CBus bus;
+    SimulatedLidar sensor;
+    bus.attach(sensor);
+    LidarArray lidars(bus);
+    const int noPin = LIDAR_ARRAY_NO_PIN;
+    lidars.begin(&noPin, 1);
+    lidars.selectFilter(FILTER_MEDIAN_EMA);
+    lidars.configureBias(BIAS_EVERY_N, 100);
+    for (int i = 0; i < METRICS_STAGE_COUNT; i++)
+    {
+        acquisitionMetrics[i].reset();
+    }
+
+    unsigned long last = 0;
+    int done = 0;
+    uint64_t hostStart = hostNanos();
+    while (done < readings)
+    {
+        LidarArrayReading reading;
+        if (lidars.next(reading))
+        {
+            unsigned long now = micros();
+            if (done++ > 0)
+            {
+                metricsRecord(METRICS_SAMPLE_INTERVAL, now - last);
+            }
+            last = now;
+        }
+    }
+    uint64_t hostElapsed = hostNanos() - hostStart;
+
+    printf("%-16s %10s %10s %10s %10s\n", "etapa", "amostras", "média us", "p50 <us", "p99 <us");
+    for (int i = 0; i < METRICS_STAGE_COUNT; i++)
+    {
+        const LatencyHistogram &histogram = acquisitionMetrics[i];
+        uint32_t samples = histogram.samples();
+        printf("%-16s %10u %10.1f %10u %10u\n", metricsStageNames[i], samples,
+               samples ? (double)histogram.totalMicros() / samples : 0.0,
+               histogram.quantileTicks(0.5f), histogram.quantileTicks(0.99f));
+    }
+    const LIDARLiteStats &stats = lidars.driver(0).stats();
+    printf("nacks %u, timeouts %u; host %.1f ns/leitura\n", stats.nacks, stats.readTimeouts,
+           (double)hostElapsed / readings);
+
+    // Custo de uma medição isolada (par de metricsNow() e registro)
+    const int rounds = readings * 200;
+    hostStart = hostNanos();
+    for (int i = 0; i < rounds; i++)
+    {
+        StageTimer timer(METRICS_FILTER);
+        nativeAdvanceMicros(i & 63);
+    }
+    hostElapsed = hostNanos() - hostStart;
+    printf("StageTimer: %.2f ns por medição (inclui avanço do relógio virtual)\n", (double)hostElapsed / rounds);
+}
+
+/*------------------------------------------------------------------------------
+  Trace e reprodução: a aquisição simulada (LidarArray, cadeia mediana+EMA,
+  zonas e qualidade) publica as amostras no SampleRing como a tarefa de
+  aquisição; a gravação começa depois de 1000 leituras, com os filtros e as
+  zonas já em regime, e é esvaziada a cada 100 ms do relógio virtual. O trace
+  é então reproduzido pelo SamplePipeline no host e comparado bit a bit.
+  Alvo: veículo que se aproxima de 600 cm a 40 cm e se afasta, com ruído de
+  +-3 cm e 3% de leituras sem retorno.
+------------------------------------------------------------------------------*/
+static bool loadTraceFile(const char *path, std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    uint8_t chunk[4096];
+    size_t n;
+    data.clear();
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static void replayWithStableChain(SamplePipeline &pipeline)
+{
+    pipeline.selectFilter(FILTER_STABLE);
+}
+
+// Zonas das gravações simuladas
+static const Zone traceZones[3] = {{300, 500}, {150, 300}, {0, 150}};
+
+// Grava pelo caminho do dispositivo (LidarArray, SampleRing, TraceRecorder)
+// `samples` leituras do sensor simulado, a partir da 1001a, e lê o arquivo
+static void recordSimulatedTrace(const char *dir, const std::vector<uint16_t> &distances,
+                                 const std::vector<uint8_t> &signals, int samples, std::vector<uint8_t> &data)
+{
+    SimulatedI2CBus bus;
+    SimulatedLidar sensor;
+    sensor.setDistanceTrace(distances);
+    sensor.setSignalTrace(signals);
+    bus.attach(sensor);
+    LidarArray lidars(bus);
+    const int noPin[1] = {LIDAR_ARRAY_NO_PIN};
+    lidars.begin(noPin, 1);
+    lidars.selectFilter(FILTER_MEDIAN_EMA);
+    lidars.configureQuality(true, 16, SIGNAL_REJECT_NO_RETURN);
+    lidars.configureZones(traceZones, 3, 5, 50000);
+
+    FileLogStorage storage(dir);
+    storage.clear();
+    TraceRecorder recorder;
+    recorder.begin(storage, 0x1234abcd);
+    SampleRing ring;
+    ring.begin(SAMPLE_RING_DEPTH);
+
+    uint32_t sequence = 0;
+    unsigned long lastDrain = micros();
+    while (recorder.active() || recorder.endReason() == TRACE_END_NONE)
+    {
+        if (sequence == 1000 && !recorder.active())
+        {
+            recorder.start(samples);
+        }
+        if (recorder.pending())
+        {
+            recorder.service(lidars.pipeline(0), lidars.driver(0).qualityRead(), sequence + 1);
+        }
+        LidarArrayReading reading;
+        if (lidars.next(reading))
+        {
+            LidarSample sample = {};
+            sample.sequence = ++sequence;
+            sample.timestampMicros = reading.timestampMicros;
+            sample.rawDistance = reading.rawDistance;
+            sample.filteredDistance = reading.filteredDistance;
+            sample.signalStrength = reading.signalStrength < 0 ? 0 : reading.signalStrength;
+            sample.status = reading.status < 0 ? 0 : reading.status;
+            sample.quality = reading.quality;
+            sample.zone = reading.zone;
+            ring.push(sample);
+        }
+        if (micros() - lastDrain >= 100000)
+        {
+            recorder.drain(ring);
+            lastDrain = micros();
+        }
+    }
+    printf("gravação: %u amostras, %u bytes (%.2f bytes/amostra), fim: %d\n",
+           recorder.samples(), recorder.bytes(), (double)recorder.bytes() / recorder.samples(), recorder.endReason());
+    check(recorder.endReason() == TRACE_END_LIMIT && recorder.samples() == (uint32_t)samples,
+          "trace: gravação encerrada pelo limite, com todas as amostras pedidas");
+    check(recorder.bytes() <= recorder.samples() * TRACE_BYTES_PER_SAMPLE,
+          "trace: tamanho dentro da estimativa usada por POST /trace");
+
+    char path[64];
+    snprintf(path, sizeof(path), "%s/%u.seg", dir, TRACE_SEGMENT);
+    loadTraceFile(path, data);
+}
+
+static void benchTrace(int readings)
+{
+    printf("\n== Trace e reprodução (%d leituras gravadas) ==\n", readings);
+    const char *dir = "/tmp/lidar-trace";
+
+    std::vector<uint16_t> distances;
+    std::vector<uint8_t> signals;
+    uint32_t seed = 77;
+    for (int i = 0; i < 6000; i++)
+    {
+        int phase = i % 3000;
+        int truth = phase < 1500 ? 600 - phase * 560 / 1500 : 40 + (phase - 1500) * 560 / 1500;
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 100 < 3)
+        {
+            distances.push_back(0);
+            signals.push_back(4);
+        }
+        else
+        {
+            distances.push_back(truth + (int)((seed >> 8) % 7) - 3);
+            signals.push_back(60 + (seed >> 12) % 90);
+        }
+    }
+
+    std::vector<uint8_t> data;
+    recordSimulatedTrace(dir, distances, signals, readings, data);
+
+    printf("%-22s %9s %11s %10s %8s %10s %14s\n", "reprodução", "amostras", "divergentes", "1a diverg.",
+           "eventos", "descart.", "amostras/s");
+    const TraceReplayHook hooks[] = {NULL, replayWithStableChain};
+    const char *names[] = {"mesmo pipeline", "cadeia estável"};
+    for (int h = 0; h < 2; h++)
+    {
+        const int rounds = 20;
+        TraceReplayResult result;
+        uint64_t hostStart = hostNanos();
+        for (int r = 0; r < rounds; r++)
+        {
+            replayTrace(data.data(), data.size(), result, hooks[h]);
+        }
+        uint64_t hostElapsed = hostNanos() - hostStart;
+        printf("%-22s %9u %11u %10u %8u %10u %14.0f\n", names[h], result.samples, result.mismatches,
+               result.firstMismatch, result.zoneEvents, result.rejected,
+               (double)result.samples * rounds * 1e9 / hostElapsed);
+        check(result.error == TRACE_OK && result.samples == (uint32_t)readings,
+              "trace: reprodução de todas as amostras gravadas, sem erro");
+        if (hooks[h] == NULL)
+        {
+            check(result.mismatches == 0, "trace: o mesmo pipeline reproduz a gravação sem divergências");
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Taxa adaptativa sobre um trace gravado: o temporizador é reproduzido sobre
+  os instantes do trace. A cada disparo a amostra medida no disparo anterior é
+  entregue (como no modo disparado em pipeline) ao SamplePipeline e ao
+  AdaptiveRate, e a medição seguinte é a primeira amostra do trace a partir do
+  disparo. A reação é medida da primeira amostra do trace, desde a medição
+  anterior, que se afasta mais que a faixa da distância filtrada (exceto
+  leituras sem retorno) até a entrega que volta à taxa máxima.
+------------------------------------------------------------------------------*/
+struct AdaptiveReplay
+{
+    uint32_t delivered = 0, wakeups = 0;
+    double seconds = 0, idleSeconds = 0;
+    double reactionMaxMs = 0, reactionSumMs = 0;
+    uint32_t zoneEventsFull = 0, zoneEventsAdaptive = 0;
+    double zoneDelayMaxMs = 0;
+    bool zoneEventsPaired = false;
+};
+
+static bool decodeTraceSamples(const std::vector<uint8_t> &data, SamplePipeline &pipeline,
+                               std::vector<LidarSample> &samples, bool &qualityRead)
+{
+    TraceReplayResult check;
+    if (!replayTrace(data.data(), data.size(), check))
+    {
+        return false;
+    }
+    qualityRead = (data[3] & TRACE_QUALITY_READ) != 0;
+    memcpy(&pipeline, data.data() + TRACE_HEADER_SIZE, sizeof(SamplePipeline));
+    samples.clear();
+    LidarSample batch[TRACE_BATCH];
+    size_t pos = TRACE_HEADER_SIZE + sizeof(SamplePipeline);
+    while (pos < data.size())
+    {
+        SampleFrameInfo info;
+        decodeSampleFrame(data.data() + pos, data.size() - pos, batch, TRACE_BATCH, info);
+        samples.insert(samples.end(), batch, batch + info.count);
+        pos += info.frameSize;
+    }
+    return true;
+}
+
+static AdaptiveReplay replayAdaptive(const std::vector<LidarSample> &samples, const SamplePipeline &initial,
+                                     bool qualityRead, uint32_t maxHz, uint32_t idleHz, int bandCm,
+                                     uint32_t holdMicros)
+{
+    AdaptiveReplay result;
+    std::vector<uint32_t> fullEvents, adaptiveEvents;
+    PipelineOutput out;
+
+    // Referência: todas as amostras do trace
+    SamplePipeline full = initial;
+    for (const LidarSample &sample : samples)
+    {
+        full.process(sample.timestampMicros, sample.rawDistance, qualityRead ? sample.signalStrength : -1,
+                     qualityRead ? sample.status : -1, out);
+        if (out.zoneChanged && out.zoneEvent.fromZone == 0)
+        {
+            fullEvents.push_back(sample.timestampMicros);
+        }
+    }
+
+    SamplePipeline pipeline = initial;
+    AdaptiveRate controller;
+    controller.configure(maxHz, idleHz, bandCm, holdMicros);
+    uint32_t period = 1000000 / maxHz;
+    uint32_t wake = samples.front().timestampMicros;
+    size_t next = 0;       // Primeira amostra ainda não medida
+    long pending = -1;     // Amostra medida no disparo anterior
+    size_t measuredFrom = 0;
+    while (true)
+    {
+        if (pending >= 0)
+        {
+            const LidarSample &sample = samples[pending];
+            int filteredBefore = pipeline.lastFiltered();
+            pipeline.process(wake, sample.rawDistance, qualityRead ? sample.signalStrength : -1,
+                             qualityRead ? sample.status : -1, out);
+            result.delivered++;
+            if (out.zoneChanged && out.zoneEvent.fromZone == 0)
+            {
+                adaptiveEvents.push_back(wake);
+            }
+
+            AdaptiveRateState before = controller.state();
+            uint32_t rate = controller.update(wake, sample.rawDistance, out.filteredDistance, out.zone, out.accepted);
+            if (before == ADAPTIVE_IDLE && controller.state() == ADAPTIVE_ACTIVE)
+            {
+                uint32_t onset = sample.timestampMicros;
+                for (size_t i = measuredFrom; i <= (size_t)pending; i++)
+                {
+                    if (samples[i].quality != SIGNAL_NO_RETURN &&
+                        std::abs(samples[i].rawDistance - filteredBefore) > bandCm)
+                    {
+                        onset = samples[i].timestampMicros;
+                        break;
+                    }
+                }
+                double reaction = (wake - onset) / 1000.0;
+                result.reactionMaxMs = std::max(result.reactionMaxMs, reaction);
+                result.reactionSumMs += reaction;
+                result.wakeups++;
+            }
+            period = 1000000 / rate;
+        }
+        if (controller.state() == ADAPTIVE_IDLE)
+        {
+            result.idleSeconds += period / 1e6;
+        }
+
+        // Medição disparada neste despertar
+        measuredFrom = next;
+        while (next < samples.size() && (int32_t)(samples[next].timestampMicros - wake) < 0)
+        {
+            next++;
+        }
+        if (next >= samples.size())
+        {
+            break;
+        }
+        pending = next++;
+        wake += period;
+    }
+    result.seconds = (samples.back().timestampMicros - samples.front().timestampMicros) / 1e6;
+
+    result.zoneEventsFull = fullEvents.size();
+    result.zoneEventsAdaptive = adaptiveEvents.size();
+    result.zoneEventsPaired = fullEvents.size() == adaptiveEvents.size();
+    for (size_t i = 0; i < fullEvents.size() && result.zoneEventsPaired; i++)
+    {
+        result.zoneDelayMaxMs = std::max(result.zoneDelayMaxMs, (int32_t)(adaptiveEvents[i] - fullEvents[i]) / 1000.0);
+    }
+    return result;
+}
+
+static void printAdaptiveReplay(const char *name, uint32_t idleHz, const AdaptiveReplay &result)
+{
+    char zones[24];
+    snprintf(zones, sizeof(zones), "%u / %u", result.zoneEventsAdaptive, result.zoneEventsFull);
+    char delay[16] = "-";
+    if (result.zoneEventsPaired)
+    {
+        snprintf(delay, sizeof(delay), "%.0f", result.zoneDelayMaxMs);
+    }
+    char bound[16] = "-";
+    if (idleHz != 0)
+    {
+        snprintf(bound, sizeof(bound), "%.0f", 2000.0 / idleHz);
+    }
+    printf("%-14s %10.1f %9.1f%% %8u %11.1f %11.1f %9s %12s %11s\n", name, result.delivered / result.seconds,
+           result.idleSeconds * 100 / result.seconds, result.wakeups, result.reactionMaxMs,
+           result.wakeups ? result.reactionSumMs / result.wakeups : 0.0, bound, zones, delay);
+}
+
+static void printAdaptiveHeader()
+{
+    printf("%-14s %10s %10s %8s %11s %11s %9s %12s %11s\n", "taxa ociosa", "amostras/s", "ociosa",
+           "saídas", "reação máx", "reação méd", "limite", "entradas", "atraso máx");
+}
+
+static void benchAdaptiveRate()
+{
+    printf("\n== Taxa adaptativa (trace gravado, taxa máxima 1000 Hz, faixa 5 cm, 2 s estável) ==\n");
+    const char *dir = "/tmp/lidar-adaptive";
+
+    // Cena parada a 700 cm (fora das zonas) por 20 s; aproximação até 100 cm em
+    // 3 s, passando pelas três zonas; 5 s parado na zona 3; afastamento até
+    // 700 cm em 3 s; depois, fora das zonas, deslocamentos de 20 cm a 200 cm/s
+    // em instantes sem relação com o período ocioso. Ruído de +-3 cm e 3% de
+    // leituras sem retorno
+    const double rate = 1020.0; // Leituras/s do sensor simulado com a leitura de qualidade
+    const double moves[] = {36.37, 39.71, 43.13, 46.59, 50.02, 53.44, 56.88};
+    std::vector<uint16_t> distances;
+    std::vector<uint8_t> signals;
+    uint32_t seed = 41;
+    for (int i = 0; i < (int)(61 * rate); i++)
+    {
+        double t = i / rate;
+        double truth = t < 20 ? 700 : t < 23 ? 700 - (t - 20) * 200 : t < 28 ? 100 : t < 31 ? 100 + (t - 28) * 200 : 700;
+        for (int m = 0; m < (int)(sizeof(moves) / sizeof(moves[0])); m++)
+        {
+            double direction = m % 2 ? 1 : -1;
+            truth += direction * std::min(std::max(t - moves[m], 0.0), 0.1) * 200;
+        }
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 100 < 3)
+        {
+            distances.push_back(0);
+            signals.push_back(4);
+        }
+        else
+        {
+            distances.push_back((int)lround(truth) + (int)((seed >> 8) % 7) - 3);
+            signals.push_back(60 + (seed >> 12) % 90);
+        }
+    }
+
+    std::vector<uint8_t> data;
+    recordSimulatedTrace(dir, distances, signals, (int)(60 * rate), data);
+    SamplePipeline initial;
+    std::vector<LidarSample> samples;
+    bool qualityRead;
+    if (!decodeTraceSamples(data, initial, samples, qualityRead))
+    {
+        check(false, "taxa adaptativa: trace gravado inválido");
+        return;
+    }
+    printf("trace: %.1f s\n", (samples.back().timestampMicros - samples.front().timestampMicros) / 1e6);
+
+    printAdaptiveHeader();
+    const uint32_t idleRates[] = {1000, 50, 20, 10, 5};
+    for (uint32_t idle : idleRates)
+    {
+        AdaptiveReplay result = replayAdaptive(samples, initial, qualityRead, 1000, idle, 5, 2000000);
+        char name[24];
+        if (idle >= 1000)
+        {
+            snprintf(name, sizeof(name), "desativada");
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "%u Hz", idle);
+        }
+        printAdaptiveReplay(name, idle >= 1000 ? 0 : idle, result);
+        check(result.zoneEventsPaired && result.zoneEventsAdaptive == result.zoneEventsFull,
+              "taxa adaptativa: todas as entradas em zona do trace completo são detectadas");
+        if (idle < 1000)
+        {
+            check(result.wakeups > 0 && result.reactionMaxMs <= 2000.0 / idle,
+                  "taxa adaptativa: reação máxima dentro de 2 períodos ociosos");
+        }
+    }
+    printf("(reação e limite em ms: do movimento visível no trace à volta à taxa máxima; limite = 2 períodos\n"
+           " ociosos; entradas em zona e atraso máximo em relação ao trace completo)\n");
+}
+
+/*------------------------------------------------------------------------------
+  Velocidade e alerta de aproximação sobre um trace gravado: o SamplePipeline
+  reproduz as amostras e o MotionEstimator recebe a distância filtrada de cada
+  uma, como na tarefa de aquisição. Cada entrada em zona confirmada com o alvo
+  se aproximando (velocidade estimada negativa) é pareada com o último alerta
+  para a mesma zona; alertas sem entrada são falsos alarmes. Com a cena
+  conhecida, a velocidade estimada é comparada com a real (diferença finita
+  da distância real) onde a velocidade real está constante há 0,5 s.
+------------------------------------------------------------------------------*/
+struct MotionEntry
+{
+    uint32_t entryMicros;
+    uint8_t zone;
+    double truthVelocity; // cm/s, NAN sem a cena
+    bool alerted;
+    uint32_t alertMicros;
+    uint16_t predictedMs;
+    int alertVelocity;
+};
+
+struct MotionReplay
+{
+    std::vector<MotionEntry> entries;
+    uint32_t alerts = 0, falseAlerts = 0;
+    double velocitySquares = 0, velocityMaxError = 0;
+    uint32_t velocitySamples = 0;
+    double stillSquares = 0;
+    uint32_t stillSamples = 0;
+    double accelerationSquares = 0;
+    uint32_t accelerationSamples = 0;
+    double nsPerUpdate = 0;
+};
+
+static MotionReplay replayMotion(const std::vector<LidarSample> &samples, const SamplePipeline &initial,
+                                 bool qualityRead, uint32_t leadMicros, uint16_t minSpeed,
+                                 const std::vector<double> &truth, double readingsPerSecond)
+{
+    MotionReplay result;
+    SamplePipeline pipeline = initial;
+    MotionEstimator estimator;
+    estimator.configure(traceZones, 3, leadMicros, minSpeed);
+
+    struct PendingAlert
+    {
+        bool valid;
+        uint32_t micros;
+        uint16_t predictedMs;
+        int velocity;
+    } pending[ZONE_MAX + 1] = {};
+
+    // Velocidade real pela diferença finita da cena, em cm/s
+    auto truthVelocity = [&](long index) -> double
+    {
+        if (index < 1 || index + 1 >= (long)truth.size())
+        {
+            return NAN;
+        }
+        return (truth[index + 1] - truth[index - 1]) / 2 * readingsPerSecond;
+    };
+    auto truthAcceleration = [&](long index) -> double
+    {
+        if (index < 1 || index + 1 >= (long)truth.size())
+        {
+            return NAN;
+        }
+        return (truth[index + 1] - 2 * truth[index] + truth[index - 1]) * readingsPerSecond * readingsPerSecond;
+    };
+    long settle = lround(readingsPerSecond / 2);
+
+    std::vector<int> filtered;
+    std::vector<uint8_t> accepted;
+    PipelineOutput out;
+    for (const LidarSample &sample : samples)
+    {
+        pipeline.process(sample.timestampMicros, sample.rawDistance, qualityRead ? sample.signalStrength : -1,
+                         qualityRead ? sample.status : -1, out);
+        filtered.push_back(out.filteredDistance);
+        accepted.push_back(out.accepted);
+
+        MotionState state;
+        if (estimator.update(sample.sequence, sample.timestampMicros, out.filteredDistance, out.accepted, state))
+        {
+            result.alerts++;
+            PendingAlert &alert = pending[state.targetZone];
+            result.falseAlerts += alert.valid;
+            alert = {true, sample.timestampMicros, state.timeToThresholdMs, state.velocity};
+        }
+        if (out.zoneChanged && out.zoneEvent.toZone != ZONE_NONE && state.velocity < 0)
+        {
+            PendingAlert &alert = pending[out.zoneEvent.toZone];
+            MotionEntry entry = {sample.timestampMicros, out.zoneEvent.toZone, truthVelocity(sample.sequence - 1),
+                                 alert.valid, alert.micros, alert.predictedMs, alert.velocity};
+            result.entries.push_back(entry);
+            alert.valid = false;
+        }
+
+        double velocity = truthVelocity(sample.sequence - 1);
+        double before = truthVelocity(sample.sequence - 1 - settle);
+        if (out.accepted && !std::isnan(velocity) && !std::isnan(before) && std::abs(velocity - before) < 0.5)
+        {
+            double error = state.velocity - velocity;
+            if (std::abs(velocity) < 0.5)
+            {
+                result.stillSquares += error * error;
+                result.stillSamples++;
+            }
+            else
+            {
+                result.velocitySquares += error * error;
+                result.velocityMaxError = std::max(result.velocityMaxError, std::abs(error));
+                result.velocitySamples++;
+            }
+        }
+
+        // Aceleração em frenagem constante há 0,5 s
+        double acceleration = truthAcceleration(sample.sequence - 1);
+        double accelerationBefore = truthAcceleration(sample.sequence - 1 - settle);
+        if (out.accepted && !std::isnan(acceleration) && !std::isnan(accelerationBefore) &&
+            std::abs(acceleration) > 1 && std::abs(acceleration - accelerationBefore) < 1)
+        {
+            double error = state.acceleration - acceleration;
+            result.accelerationSquares += error * error;
+            result.accelerationSamples++;
+        }
+    }
+    for (const PendingAlert &alert : pending)
+    {
+        result.falseAlerts += alert.valid;
+    }
+
+    // Custo da estimativa isolada, sobre as mesmas distâncias filtradas
+    const int rounds = 20;
+    MotionState state;
+    uint64_t hostStart = hostNanos();
+    for (int r = 0; r < rounds; r++)
+    {
+        estimator.reset();
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            estimator.update(samples[i].sequence, samples[i].timestampMicros, filtered[i], accepted[i], state);
+        }
+    }
+    result.nsPerUpdate = (double)(hostNanos() - hostStart) / (rounds * samples.size());
+    return result;
+}
+
+static void printMotionReplay(const MotionReplay &result)
+{
+    if (result.velocitySamples > 0)
+    {
+        printf("velocidade: erro RMS %.1f cm/s em movimento (máx %.0f, %u amostras), %.1f cm/s parado (%u amostras)\n",
+               sqrt(result.velocitySquares / result.velocitySamples), result.velocityMaxError,
+               result.velocitySamples, result.stillSamples ? sqrt(result.stillSquares / result.stillSamples) : 0.0,
+               result.stillSamples);
+    }
+    if (result.accelerationSamples > 0)
+    {
+        printf("aceleração: erro RMS %.1f cm/s² em frenagem constante (%u amostras)\n",
+               sqrt(result.accelerationSquares / result.accelerationSamples), result.accelerationSamples);
+    }
+    printf("custo: %.0f ns/leitura no host\n", result.nsPerUpdate);
+    printf("%10s %5s %8s %10s %13s %13s\n", "entrada s", "zona", "v real", "v alerta", "prevista ms",
+           "antecedência");
+    uint32_t missed = 0;
+    double leadMin = 1e9, leadMax = 0;
+    for (const MotionEntry &entry : result.entries)
+    {
+        char truth[16] = "-";
+        if (!std::isnan(entry.truthVelocity))
+        {
+            snprintf(truth, sizeof(truth), "%.0f", entry.truthVelocity);
+        }
+        if (!entry.alerted)
+        {
+            printf("%10.2f %5u %8s %10s %13s %13s\n", (entry.entryMicros - result.entries[0].entryMicros) / 1e6,
+                   entry.zone, truth, "-", "-", "sem alerta");
+            missed++;
+            continue;
+        }
+        double lead = (entry.entryMicros - entry.alertMicros) / 1000.0;
+        leadMin = std::min(leadMin, lead);
+        leadMax = std::max(leadMax, lead);
+        printf("%10.2f %5u %8s %10d %13u %13.0f\n", (entry.entryMicros - result.entries[0].entryMicros) / 1e6,
+               entry.zone, truth, entry.alertVelocity, entry.predictedMs, lead);
+    }
+    printf("alertas: %u, falsos: %u, entradas em aproximação: %zu, sem alerta: %u",
+           result.alerts, result.falseAlerts, result.entries.size(), missed);
+    if (missed < result.entries.size())
+    {
+        printf(", antecedência real %.0f a %.0f ms", leadMin, leadMax);
+    }
+    printf("\n");
+}
+
+static void benchMotion()
+{
+    printf("\n== Velocidade e alerta de aproximação (trace gravado, antecedência 500 ms, mínimo 20 cm/s) ==\n");
+    const char *dir = "/tmp/lidar-motion";
+
+    // Parado a 700 cm; aproximações até 60 cm a 100 e 300 cm/s, cada uma
+    // seguida de afastamento a 200 cm/s; aproximação freando de 400 cm/s até
+    // parar a 60 cm; aproximação freando de 200 cm/s até parar a 510 cm, 10 cm
+    // antes da zona 1. Ruído de +-3 cm e 3% de leituras sem retorno
+    const double rate = 1020.0; // Leituras/s do sensor simulado com a leitura de qualidade
+    struct Segment
+    {
+        double duration, speed, acceleration; // s, cm/s, cm/s²
+    };
+    const Segment scene[] = {{4, 0, 0},        {6.4, -100, 0},   {2, 0, 0},       {3.2, 200, 0}, {2, 0, 0},
+                             {64.0 / 30, -300, 0}, {2, 0, 0},     {3.2, 200, 0},   {2, 0, 0},     {3.2, -400, 125},
+                             {2, 0, 0},        {3.2, 200, 0},    {2, 0, 0},       {1.9, -200, 40000.0 / 380}, {3, 0, 0}};
+    std::vector<double> truth;
+    std::vector<uint16_t> distances;
+    std::vector<uint8_t> signals;
+    double position = 700;
+    uint32_t seed = 53;
+    for (const Segment &segment : scene)
+    {
+        int count = (int)lround(segment.duration * rate);
+        double start = position;
+        for (int i = 0; i < count; i++)
+        {
+            double t = i / rate;
+            position = start + segment.speed * t + segment.acceleration * t * t / 2;
+            truth.push_back(position);
+            seed = seed * 1103515245 + 12345;
+            if ((seed >> 16) % 100 < 3)
+            {
+                distances.push_back(0);
+                signals.push_back(4);
+            }
+            else
+            {
+                distances.push_back((int)lround(position) + (int)((seed >> 8) % 7) - 3);
+                signals.push_back(60 + (seed >> 12) % 90);
+            }
+        }
+        position = start + segment.speed * segment.duration + segment.acceleration * segment.duration * segment.duration / 2;
+    }
+
+    std::vector<uint8_t> data;
+    recordSimulatedTrace(dir, distances, signals, (int)truth.size() - 2000, data);
+    SamplePipeline initial;
+    std::vector<LidarSample> samples;
+    bool qualityRead;
+    if (!decodeTraceSamples(data, initial, samples, qualityRead))
+    {
+        check(false, "movimento: trace gravado inválido");
+        return;
+    }
+    double seconds = (samples.back().timestampMicros - samples.front().timestampMicros) / 1e6;
+    printf("trace: %.1f s\n", seconds);
+
+    MotionReplay result = replayMotion(samples, initial, qualityRead, 500000, 20, truth, (samples.size() - 1) / seconds);
+    printMotionReplay(result);
+
+    // Cada entrada em aproximação alertada com antecedência próxima da
+    // configurada; o único falso alerta aceito é o da parada 10 cm antes da zona 1
+    bool allAlerted = !result.entries.empty();
+    double leadMin = 1e9, leadMax = 0;
+    for (const MotionEntry &entry : result.entries)
+    {
+        allAlerted &= entry.alerted;
+        if (entry.alerted)
+        {
+            double lead = (entry.entryMicros - entry.alertMicros) / 1000.0;
+            leadMin = std::min(leadMin, lead);
+            leadMax = std::max(leadMax, lead);
+        }
+    }
+    check(result.velocitySamples > 0 && sqrt(result.velocitySquares / result.velocitySamples) < 5 &&
+              result.stillSamples > 0 && sqrt(result.stillSquares / result.stillSamples) < 5,
+          "movimento: erro RMS da velocidade abaixo de 5 cm/s");
+    check(result.accelerationSamples > 0 && sqrt(result.accelerationSquares / result.accelerationSamples) < 50,
+          "movimento: erro RMS da aceleração na frenagem abaixo de 50 cm/s²");
+    check(allAlerted && result.entries.size() == 9, "movimento: as 9 entradas em aproximação são alertadas");
+    check(allAlerted && leadMin >= 350 && leadMax <= 900, "movimento: antecedência real entre 350 e 900 ms");
+    check(result.falseAlerts <= 1, "movimento: no máximo 1 falso alerta");
+}
+
+/*------------------------------------------------------------------------------
+  Reprodução de traces gravados no dispositivo (GET /trace.bin): program
+  replay <arquivo>... Retorna 1 se algum trace é inválido ou diverge. Cada
+  trace válido também é reproduzido com a taxa adaptativa.
+------------------------------------------------------------------------------*/
+static int replayFiles(int count, char **paths)
+{
+    int failures = 0;
+    for (int i = 0; i < count; i++)
+    {
+        std::vector<uint8_t> data;
+        if (!loadTraceFile(paths[i], data))
+        {
+            printf("%s: não foi possível ler\n", paths[i]);
+            failures++;
+            continue;
+        }
+        TraceReplayResult result;
+        uint64_t hostStart = hostNanos();
+        bool valid = replayTrace(data.data(), data.size(), result);
+        uint64_t hostElapsed = hostNanos() - hostStart;
+        printf("%s: dispositivo %08x, %u amostras (%.1f s), %u divergentes (1a: %u), %u eventos, "
+               "%u descartadas, %.0f amostras/s%s\n",
+               paths[i], result.deviceId, result.samples, result.durationMicros / 1e6, result.mismatches,
+               result.firstMismatch, result.zoneEvents, result.rejected,
+               hostElapsed ? (double)result.samples * 1e9 / hostElapsed : 0.0,
+               valid ? "" : result.error == TRACE_BAD_HEADER ? ", cabeçalho inválido"
+                          : result.error == TRACE_BAD_FRAME  ? ", quadro inválido"
+                                                             : ", lacuna na sequência");
+        if (!valid || result.mismatches != 0)
+        {
+            failures++;
+            continue;
+        }
+
+        // Taxa adaptativa com a configuração padrão sobre o mesmo trace
+        SamplePipeline initial;
+        std::vector<LidarSample> samples;
+        bool qualityRead;
+        if (decodeTraceSamples(data, initial, samples, qualityRead) && samples.size() > 1)
+        {
+            printAdaptiveHeader();
+            const uint32_t idleRates[] = {50, 20, 10};
+            for (uint32_t idle : idleRates)
+            {
+                char name[24];
+                snprintf(name, sizeof(name), "%u Hz", idle);
+                printAdaptiveReplay(name, idle, replayAdaptive(samples, initial, qualityRead, 1000, idle, 5, 2000000));
+            }
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+/*------------------------------------------------------------------------------
+  Publicação da amostra: mutex (como o antigo xDistanceMutex) x seqlock.
+  Um escritor publica em ritmo fixo enquanto leitores simulam handlers HTTP;
+  ocasionalmente um leitor é "preemptado" dentro da seção crítica, como o
+  handler assíncrono interrompido pela pilha WiFi. Mede a latência de
+  publicação do escritor (tempo real do host).
+------------------------------------------------------------------------------*/
+static void printPercentiles(const char *name, int readers, std::vector<uint32_t> &latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    printf("%-10s %8d %10u %10u %10u %10u\n", name, readers,
+           latencies[n / 2], latencies[n * 99 / 100], latencies[n * 999 / 1000], latencies[n - 1]);
+}
+
+static void benchPublication(int samples)
+{
+    printf("\n== Publicação da amostra com leitores concorrentes (%d amostras, ns) ==\n", samples);
+    printf("%-10s %8s %10s %10s %10s %10s\n", "método", "leitores", "p50", "p99", "p99.9", "máx");
+
+    const int readerCounts[] = {0, 4};
+    for (int readers : readerCounts)
+    {
+        for (int useMutex = 1; useMutex >= 0; useMutex--)
+        {
+            std::mutex mutex;
+            LidarSample locked = {};
+            SamplePublisher publisher;
+            std::atomic<bool> running(true);
+            std::atomic<uint32_t> reads(0), inconsistent(0);
+            std::vector<std::thread> threads;
+
+            for (int r = 0; r < readers; r++)
+            {
+                threads.emplace_back([&, r]() {
+                    uint32_t iteration = 0;
+                    volatile uint32_t sink = 0;
+                    while (running.load(std::memory_order_relaxed))
+                    {
+                        bool preempted = (++iteration % 97) == (uint32_t)r;
+                        if (useMutex)
+                        {
+                            std::lock_guard<std::mutex> guard(mutex);
+                            sink = locked.filteredDistance;
+                            if (preempted)
+                            {
+                                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                            }
+                        }
+                        else
+                        {
+                            // Cada amostra publicada tem as duas distâncias iguais a
+                            // (sequência - 1) % 400: outra combinação é uma cópia rasgada
+                            LidarSample copy;
+                            if (publisher.read(copy))
+                            {
+                                sink = copy.filteredDistance;
+                                reads.fetch_add(1, std::memory_order_relaxed);
+                                if (copy.sequence != 0 && (copy.rawDistance != copy.filteredDistance ||
+                                                           copy.rawDistance != (copy.sequence - 1) % 400))
+                                {
+                                    inconsistent.fetch_add(1, std::memory_order_relaxed);
+                                }
+                            }
+                            if (preempted)
+                            {
+                                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                            }
+                        }
+                        (void)sink;
+                    }
+                });
+            }
+
+            std::vector<uint32_t> latencies;
+            latencies.reserve(samples);
+            for (int i = 0; i < samples; i++)
+            {
+                LidarSample sample = {};
+                sample.sequence = i + 1;
+                sample.rawDistance = sample.filteredDistance = (uint16_t)(i % 400);
+
+                uint64_t start = hostNanos();
+                if (useMutex)
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    locked = sample;
+                }
+                else
+                {
+                    publisher.publish(sample);
+                }
+                latencies.push_back((uint32_t)(hostNanos() - start));
+
+                // Intervalo entre amostras (~20 µs)
+                uint64_t next = start + 20000;
+                while (hostNanos() < next)
+                {
+                }
+            }
+
+            running = false;
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            printPercentiles(useMutex ? "mutex" : "seqlock", readers, latencies);
+            if (!useMutex && readers > 0)
+            {
+                printf("%-10s leituras concorrentes: %u, inconsistentes: %u\n", "", reads.load(), inconsistent.load());
+                check(reads.load() > 0 && inconsistent.load() == 0,
+                      "publicação: toda leitura concorrente do seqlock é consistente");
+            }
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Buffer circular de amostras: custo de inserção e de retirada em lote, e
+  detecção de overrun quando o cliente retira menos do que é produzido
+------------------------------------------------------------------------------*/
+static void benchSampleRing(int samples)
+{
+    printf("\n== Buffer circular de amostras (%d amostras, profundidade %d) ==\n", samples, SAMPLE_RING_DEPTH);
+    printf("%-24s %12s %12s %12s %10s\n", "cliente", "push ns", "leitura ns", "recebidas", "overruns");
+
+    // Lote por requisição a cada 100 amostras produzidas: 1000 acompanha, 50 fica para trás
+    const size_t batches[] = {1000, 50};
+    for (size_t batch : batches)
+    {
+        SampleRing ring;
+        ring.begin(SAMPLE_RING_DEPTH);
+        std::vector<LidarSample> out(batch);
+
+        uint64_t pushNanos = 0, readNanos = 0;
+        uint32_t since = 0, received = 0, overruns = 0;
+        for (int i = 1; i <= samples; i++)
+        {
+            LidarSample sample = {};
+            sample.sequence = i;
+            sample.timestampMicros = i * 770;
+            sample.rawDistance = sample.filteredDistance = (uint16_t)(i % 400);
+
+            uint64_t start = hostNanos();
+            ring.push(sample);
+            pushNanos += hostNanos() - start;
+
+            if (i % 100 == 0)
+            {
+                bool overrun;
+                start = hostNanos();
+                size_t n = ring.readSince(since, out.data(), batch, overrun);
+                readNanos += hostNanos() - start;
+                if (n > 0)
+                {
+                    since = out[n - 1].sequence;
+                }
+                received += n;
+                overruns += overrun ? 1 : 0;
+            }
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "lote de %zu / 100 amostras", batch);
+        printf("%-24s %12.1f %12.1f %12u %10u\n", name, (double)pushNanos / samples,
+               received ? (double)readNanos / received : 0.0, received, overruns);
+        if (batch > 100)
+        {
+            check(received == (uint32_t)(samples / 100 * 100) && overruns == 0,
+                  "buffer circular: o cliente rápido recebe todas as amostras, sem overrun");
+        }
+        else
+        {
+            // O atraso cresce 50 amostras a cada 100: passa da profundidade após 2x
+            check(samples <= 2 * SAMPLE_RING_DEPTH || overruns > 0,
+                  "buffer circular: o cliente lento é avisado do overrun");
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Formato binário de amostras: tamanho x JSON, custo de codificação e conferência
+  de ida e volta sobre um trace gravado do simulador
+------------------------------------------------------------------------------*/
+static void benchSampleCodec(int samples)
+{
+    printf("\n== Formato binário de amostras (%d amostras, quadros de 64) ==\n", samples);
+
+    // Alvo se aproximando com ruído, lido em pipeline como na tarefa do LiDAR
+    std::vector<uint16_t> trace;
+    uint32_t seed = 777;
+    for (int i = 0; i < 4096; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        trace.push_back(600 - i / 10 + (seed >> 16) % 5);
+    }
+    SimulatedI2CBus bus;
+    SimulatedLidar sensor;
+    sensor.setDistanceTrace(trace);
+    bus.attach(sensor);
+    LIDARLite lidar(bus);
+    lidar.begin(0, true);
+    lidar.biasCorrection().configure(BIAS_EVERY_N, 100);
+
+    std::vector<LidarSample> recorded;
+    float filtered = 0;
+    uint32_t sequence = 0;
+    while ((int)recorded.size() < samples)
+    {
+        int distance;
+        if (!lidar.distanceAsync(distance))
+        {
+            continue;
+        }
+        filtered += 0.2f * (distance - filtered);
+        LidarSample sample = {};
+        sample.sequence = ++sequence;
+        sample.timestampMicros = micros();
+        sample.rawDistance = distance;
+        sample.filteredDistance = (uint16_t)filtered;
+        sample.signalStrength = 180 + (sequence % 3);
+        sample.zone = sample.filteredDistance < 300 ? 1 : 0;
+        recorded.push_back(sample);
+
+        // Amostras perdidas de vez em quando (buffer sobrescrito)
+        if (sequence % 997 == 0)
+        {
+            sequence += 3;
+        }
+    }
+
+    // JSON no formato das linhas de /samples: [seq,us,raw,filt,sig,status]
+    size_t jsonBytes = 0;
+    for (const LidarSample &sample : recorded)
+    {
+        char row[80];
+        jsonBytes += snprintf(row, sizeof(row), "[%u,%u,%u,%u,%u,%u],", (unsigned)sample.sequence,
+                              (unsigned)sample.timestampMicros, sample.rawDistance,
+                              sample.filteredDistance, sample.signalStrength, sample.status);
+    }
+
+    const size_t frameSamples = 64; // SAMPLES_BIN_QUADRO, como em /samples.bin
+    std::vector<uint8_t> frame(SAMPLE_CODEC_FRAME_SIZE(frameSamples));
+    std::vector<LidarSample> decoded(frameSamples);
+    size_t binaryBytes = 0, mismatches = 0, errors = 0, frames = 0, corruptAccepted = 0;
+    uint64_t encodeNanos = 0, decodeNanos = 0;
+    for (size_t first = 0; first < recorded.size(); first += frameSamples)
+    {
+        size_t n = std::min(frameSamples, recorded.size() - first);
+
+        uint64_t start = hostNanos();
+        SampleEncoder encoder(frame.data(), frame.size(), 0x1234abcd,
+                              SAMPLE_CODEC_SIGNAL | SAMPLE_CODEC_STATUS | SAMPLE_CODEC_ZONE);
+        for (size_t i = 0; i < n; i++)
+        {
+            encoder.add(recorded[first + i]);
+        }
+        size_t size = encoder.finish();
+        encodeNanos += hostNanos() - start;
+        binaryBytes += size;
+
+        SampleFrameInfo info;
+        start = hostNanos();
+        SampleCodecError error = decodeSampleFrame(frame.data(), size, decoded.data(), decoded.size(), info);
+        decodeNanos += hostNanos() - start;
+        if (error != SAMPLE_CODEC_OK || info.count != n || info.frameSize != size)
+        {
+            errors++;
+            continue;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            if (memcmp(&decoded[i], &recorded[first + i], sizeof(LidarSample)) != 0)
+            {
+                mismatches++;
+            }
+        }
+
+        // Quadro truncado e um bit trocado no corpo devem ser rejeitados
+        frames++;
+        if (decodeSampleFrame(frame.data(), size - 1, decoded.data(), decoded.size(), info) == SAMPLE_CODEC_OK)
+        {
+            corruptAccepted++;
+        }
+        frame[SAMPLE_CODEC_HEADER_SIZE + n] ^= 0x10;
+        if (decodeSampleFrame(frame.data(), size, decoded.data(), decoded.size(), info) == SAMPLE_CODEC_OK)
+        {
+            corruptAccepted++;
+        }
+    }
+
+    printf("%-24s %12s %12s\n", "formato", "bytes", "bytes/amost");
+    printf("%-24s %12zu %12.2f\n", "LidarSample (memória)", recorded.size() * sizeof(LidarSample), (double)sizeof(LidarSample));
+    printf("%-24s %12zu %12.2f\n", "JSON (/samples)", jsonBytes, (double)jsonBytes / recorded.size());
+    printf("%-24s %12zu %12.2f\n", "binário (/samples.bin)", binaryBytes, (double)binaryBytes / recorded.size());
+    printf("codificação %.1f ns/amostra, decodificação %.1f ns/amostra, divergências %zu, erros %zu\n",
+           (double)encodeNanos / recorded.size(), (double)decodeNanos / recorded.size(), mismatches, errors);
+    printf("quadros corrompidos aceitos: %zu de %zu\n", corruptAccepted, 2 * frames);
+    check(mismatches == 0 && errors == 0, "formato binário: decodificação idêntica, sem erros");
+    check(frames > 0 && corruptAccepted == 0, "formato binário: quadros truncados ou corrompidos são rejeitados");
+}
+
+/*------------------------------------------------------------------------------
+  Cadeias de filtros: custo por amostra e erro em relação à distância real
+------------------------------------------------------------------------------*/
+template <typename Chain>
+static void benchFilterChain(const char *name, const std::vector<int> &measured, const std::vector<int> &truth)
+{
+    Chain chain;
+    std::vector<int> out(measured.size());
+    chain.reset(FILTER_Q8(measured[0]));
+
+    uint64_t start = hostNanos();
+    for (size_t i = 0; i < measured.size(); i++)
+    {
+        out[i] = FILTER_CM(chain.process(FILTER_Q8(measured[i])));
+    }
+    uint64_t elapsed = hostNanos() - start;
+
+    double squares = 0;
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        squares += (double)(out[i] - truth[i]) * (out[i] - truth[i]);
+    }
+    printf("%-24s %12.2f %12.2f\n", name, (double)elapsed / measured.size(), sqrt(squares / out.size()));
+}
+
+static void benchFilters(int samples)
+{
+    printf("\n== Cadeias de filtros (%d amostras) ==\n", samples);
+
+    // Alvo parado, degrau de 1 m e rampa, com ruído de ±3 cm e picos de 2 m a cada 200 amostras
+    std::vector<int> measured(samples), truth(samples);
+    uint32_t seed = 4242;
+    for (int i = 0; i < samples; i++)
+    {
+        int phase = i % 3000;
+        truth[i] = phase < 1000 ? 300 : phase < 2000 ? 400 : 400 - (phase - 2000) / 5;
+        seed = seed * 1103515245 + 12345;
+        measured[i] = truth[i] + (int)((seed >> 16) % 7) - 3;
+        if (i % 200 == 199)
+        {
+            measured[i] += 200;
+        }
+    }
+
+    printf("%-24s %12s %12s\n", "cadeia", "ns/amostra", "erro RMS cm");
+    benchFilterChain<FilterChain<>>("nenhum", measured, truth);
+    benchFilterChain<KalmanChain>("kalman", measured, truth);
+    benchFilterChain<MedianEmaChain>("mediana5 + ema", measured, truth);
+    benchFilterChain<MedianKalmanChain>("mediana5 + kalman", measured, truth);
+    benchFilterChain<StableChain>("estavel", measured, truth);
+
+    // Seleção em tempo de execução (switch no FilterBank), com a cadeia mais longa
+    FilterBank bank;
+    bank.select(FILTER_STABLE);
+    volatile int sink = 0;
+    uint64_t start = hostNanos();
+    for (int i = 0; i < samples; i++)
+    {
+        sink = bank.process(measured[i]);
+    }
+    printf("%-24s %12.2f\n", "FilterBank (estavel)", (double)(hostNanos() - start) / samples);
+    (void)sink;
+
+    // Kalman original em float, para conferir a versão em ponto fixo
+    float q = 0.001f, r = 0.5f, p = 1, k, estimate = measured[0];
+    KalmanChain fixed;
+    fixed.reset(FILTER_Q8(measured[0]));
+    int maxDiff = 0;
+    for (int i = 1; i < samples; i++)
+    {
+        p = p + q;
+        k = p / (p + r);
+        estimate = estimate + k * (measured[i] - estimate);
+        p = (1 - k) * p;
+        int diff = abs((int)estimate - FILTER_CM(fixed.process(FILTER_Q8(measured[i]))));
+        maxDiff = std::max(maxDiff, diff);
+    }
+    printf("kalman Q8 x float: maior diferença %d cm\n", maxDiff);
+}
+
+/*------------------------------------------------------------------------------
+  Motor de zonas: replay de um trace com ruído, transições detectadas com e
+  sem histerese/permanência e custo por amostra
+------------------------------------------------------------------------------*/
+static void benchZones(int samples)
+{
+    // Ciclos inteiros do trace, para que a última transição não fique pendente
+    // da permanência no fim
+    samples = (samples + 29999) / 30000 * 30000;
+    printf("\n== Motor de zonas (%d amostras a 1300 Hz) ==\n", samples);
+
+    // Zonas padrão da configuração (10-20, 20-30, 30-40 cm). O alvo vai de 60 cm
+    // a 2 cm e volta a 5-8 cm/s, parando 6 s em cima do limite entre as zonas 2
+    // e 3 (30 cm), com ruído de ±2 cm
+    const Zone limits[3] = {{10, 20}, {20, 30}, {30, 40}};
+    const uint32_t periodMicros = 770;
+    std::vector<uint16_t> truth(samples), measured(samples);
+    uint32_t seed = 99;
+    for (int i = 0; i < samples; i++)
+    {
+        int phase = i % 30000;
+        int cm = phase < 7000    ? 60 - phase * 30 / 7000               // Aproximação até 30 cm
+                 : phase < 15000 ? 30                                   // Parado no limite
+                 : phase < 21000 ? 30 - (phase - 15000) * 28 / 6000     // Até 2 cm
+                                 : 2 + (phase - 21000) * 58 / 9000;     // Afastamento
+        truth[i] = cm;
+        seed = seed * 1103515245 + 12345;
+        measured[i] = cm + (int)((seed >> 16) % 5) - 2;
+    }
+
+    // Transições "reais": classificação do trace sem ruído
+    ZoneEngine reference;
+    reference.configure(limits, 3, 0, 0);
+    int expected = 0;
+    ZoneEvent event;
+    for (int i = 0; i < samples; i++)
+    {
+        expected += reference.update(truth[i], i * periodMicros, event) ? 1 : 0;
+    }
+
+    printf("%-26s %12s %12s %12s\n", "configuração", "transições", "esperadas", "ns/amostra");
+    const struct
+    {
+        uint16_t hysteresis;
+        uint32_t dwellMicros;
+    } configs[] = {{0, 0}, {5, 0}, {0, 100000}, {5, 100000}};
+    for (const auto &config : configs)
+    {
+        ZoneEngine engine;
+        engine.configure(limits, 3, config.hysteresis, config.dwellMicros);
+        ZoneEventRing ring;
+        int transitions = 0;
+        uint64_t start = hostNanos();
+        for (int i = 0; i < samples; i++)
+        {
+            if (engine.update(measured[i], i * periodMicros, event))
+            {
+                ring.push(event);
+                transitions++;
+            }
+        }
+        uint64_t elapsed = hostNanos() - start;
+
+        // Os eventos guardados devem ser os últimos, em ordem e encadeados
+        ZoneEvent recent[ZONE_EVENT_DEPTH];
+        size_t n = ring.readSince(0, recent, ZONE_EVENT_DEPTH);
+        bool chained = n == (size_t)std::min(transitions, ZONE_EVENT_DEPTH);
+        for (size_t i = 1; i < n; i++)
+        {
+            chained &= recent[i].sequence == recent[i - 1].sequence + 1 && recent[i].fromZone == recent[i - 1].toZone;
+        }
+
+        char name[40];
+        snprintf(name, sizeof(name), "histerese %u cm, %u ms%s", config.hysteresis,
+                 (unsigned)(config.dwellMicros / 1000), chained ? "" : " (ERRO)");
+        printf("%-26s %12d %12d %12.2f\n", name, transitions, expected, (double)elapsed / samples);
+        check(chained, "zonas: eventos guardados em ordem e encadeados");
+        if (config.hysteresis > 0 || config.dwellMicros > 0)
+        {
+            check(transitions == expected, "zonas: com histerese ou permanência, só as transições reais");
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Saída analógica: escala em ponto fixo contra constrain(map()) e
+  comportamento entre amostras de cada modo, com amostras a ~100 Hz (intervalo
+  de 9 a 11 ticks) e o temporizador a 1 kHz
+------------------------------------------------------------------------------*/
+static int mapCode(int distance, int fullScale)
+{
+    long value = (long)distance * OUTPUT_CODE_MAX / fullScale;
+    return value < 0 ? 0 : value > OUTPUT_CODE_MAX ? OUTPUT_CODE_MAX : (int)value;
+}
+
+static void benchAnalogOutput(int ticks)
+{
+    printf("\n== Saída analógica (escala e %d ticks a 1 kHz) ==\n", ticks);
+
+    printf("%-12s %14s %14s\n", "fundo (cm)", "dif. máx.", "códigos dif.");
+    const int fullScales[] = {100, 400, 1000, 4000, 12000, 65535};
+    for (int fullScale : fullScales)
+    {
+        AnalogOutput output;
+        output.configure(fullScale, OUTPUT_DIRECT, 1000, 1);
+        int maxDiff = 0, differ = 0, total = 0;
+        for (int d = -10; d <= fullScale + 100; d++, total++)
+        {
+            output.submit(d);
+            int diff = std::abs(output.tick() - mapCode(d, fullScale));
+            maxDiff = std::max(maxDiff, diff);
+            differ += diff != 0;
+        }
+        printf("%-12d %14d %13.2f%%\n", fullScale, maxDiff, differ * 100.0 / total);
+        check(maxDiff <= 1, "saída analógica: escala Q16 a no máximo 1 código do cálculo exato");
+    }
+
+    // Senoide de 0 a 400 cm com período de 2 s, seguida de um degrau de 100 a
+    // 300 cm; as amostras chegam a cada 9-11 ticks
+    const int fullScale = 400;
+    std::vector<int> truth(ticks);
+    int stepTick = ticks * 3 / 4;
+    for (int t = 0; t < ticks; t++)
+    {
+        truth[t] = t < stepTick ? (int)lround(200 - 200 * cos(2 * M_PI * t / 2000.0)) : t < stepTick + 1000 ? 100 : 300;
+    }
+    std::vector<bool> sampled(ticks, false);
+    uint32_t seed = 5;
+    for (int t = 0; t < ticks;)
+    {
+        sampled[t] = true;
+        seed = seed * 1103515245 + 12345;
+        t += 9 + (seed >> 16) % 3;
+    }
+
+    printf("%-14s %10s %12s %12s %14s %12s\n", "modo", "atraso", "erro médio", "degrau máx.", "acomodação", "ns/tick");
+    const char *names[] = {"direto", "interpolacao", "rampa"};
+    int sineSteps[OUTPUT_SLEW + 1], settles[OUTPUT_SLEW + 1];
+    for (int mode = OUTPUT_DIRECT; mode <= OUTPUT_SLEW; mode++)
+    {
+        AnalogOutput output;
+        output.configure(fullScale, (AnalogOutputMode)mode, 1000, 5000);
+        std::vector<int> codes(ticks);
+        uint64_t start = hostNanos();
+        for (int t = 0; t < ticks; t++)
+        {
+            if (sampled[t])
+            {
+                output.submit(truth[t]);
+            }
+            codes[t] = output.tick();
+        }
+        uint64_t elapsed = hostNanos() - start;
+
+        // Atraso (em ticks) que minimiza o erro em relação à senoide ideal
+        int bestLag = 0;
+        double bestError = 1e9;
+        for (int lag = 0; lag <= 30; lag++)
+        {
+            double error = 0;
+            for (int t = 100; t < stepTick; t++)
+            {
+                error += std::fabs(codes[t] - truth[t - lag] * (double)OUTPUT_CODE_MAX / fullScale);
+            }
+            error /= stepTick - 100;
+            if (error < bestError)
+            {
+                bestError = error;
+                bestLag = lag;
+            }
+        }
+
+        int maxStep = 0;
+        for (int t = 1; t < stepTick; t++)
+        {
+            maxStep = std::max(maxStep, std::abs(codes[t] - codes[t - 1]));
+        }
+        int stepMax = 0, settle = 0;
+        int final = mapCode(300, fullScale);
+        for (int t = stepTick + 1000; t < ticks; t++)
+        {
+            stepMax = std::max(stepMax, std::abs(codes[t] - codes[t - 1]));
+            if (std::abs(codes[t] - final) > 1)
+            {
+                settle = t - (stepTick + 1000) + 1;
+            }
+        }
+
+        char step[24];
+        snprintf(step, sizeof(step), "%d / %d", maxStep, stepMax);
+        printf("%-14s %7d ms %12.2f %12s %11d ms %12.2f\n", names[mode], bestLag, bestError, step, settle,
+               (double)elapsed / ticks);
+        sineSteps[mode] = maxStep;
+        settles[mode] = settle;
+        check(bestError < 2 && bestLag <= 15, "saída analógica: acompanha a senoide com atraso de até 15 ms");
+        if (mode == OUTPUT_SLEW)
+        {
+            // 5000 cm/s a 1 kHz: 5 cm = 3,2 códigos por tick
+            check(maxStep <= 4 && stepMax <= 4, "saída analógica: rampa limitada a 4 códigos por tick");
+        }
+    }
+    printf("(degrau máx.: senoide / degrau de 100 a 300 cm, em códigos por tick)\n");
+    check(sineSteps[OUTPUT_INTERPOLATE] < sineSteps[OUTPUT_DIRECT],
+          "saída analógica: interpolação com degraus menores que o modo direto");
+    check(settles[OUTPUT_DIRECT] <= 15 && settles[OUTPUT_INTERPOLATE] <= 25 && settles[OUTPUT_SLEW] <= 60,
+          "saída analógica: acomodação após o degrau dentro do esperado para cada modo");
+}
+
+/*------------------------------------------------------------------------------
+  Registro store-and-forward: escrita sustentada, esvaziamento, limite de
+  espaço, retomada após reinício e escrita interrompida, com arquivos do host
+  no lugar da flash
+------------------------------------------------------------------------------*/
+struct FlashLogDrain
+{
+    uint32_t records = 0, samples = 0, events = 0, gaps = 0;
+    uint32_t firstSequence = 0, lastSequence = 0;
+    uint64_t nanos = 0;
+};
+
+static FlashLogDrain drainFlashLog(FlashLog &log)
+{
+    FlashLogDrain result;
+    std::vector<uint8_t> payload(FLASH_LOG_MAX_PAYLOAD);
+    std::vector<LidarSample> samples(FLASH_LOG_BATCH);
+    uint8_t type;
+    size_t length;
+    uint64_t start = hostNanos();
+    while ((length = log.peek(type, payload.data(), payload.size())) > 0)
+    {
+        SampleFrameInfo info;
+        if (type == FLASH_LOG_SAMPLES &&
+            decodeSampleFrame(payload.data(), length, samples.data(), samples.size(), info) == SAMPLE_CODEC_OK)
+        {
+            for (size_t i = 0; i < info.count; i++)
+            {
+                if (result.lastSequence != 0 && samples[i].sequence != result.lastSequence + 1)
+                {
+                    result.gaps++;
+                }
+                if (result.firstSequence == 0)
+                {
+                    result.firstSequence = samples[i].sequence;
+                }
+                result.lastSequence = samples[i].sequence;
+            }
+            result.samples += info.count;
+        }
+        else if (type == FLASH_LOG_EVENT)
+        {
+            result.events++;
+        }
+        log.pop();
+        result.records++;
+    }
+    result.nanos = hostNanos() - start;
+    return result;
+}
+
+static void appendTrace(FlashLog &log, uint32_t first, int count)
+{
+    uint32_t seed = first;
+    for (int i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        LidarSample sample = {};
+        sample.sequence = first + i;
+        sample.timestampMicros = (first + i) * 770;
+        sample.rawDistance = 300 + (seed >> 16) % 7;
+        sample.filteredDistance = 303;
+        sample.signalStrength = 180;
+        sample.zone = 2;
+        log.append(sample);
+        if ((first + i) % 500 == 0)
+        {
+            ZoneEvent event = {};
+            event.sequence = (first + i) / 500;
+            event.timestampMicros = sample.timestampMicros;
+            event.fromZone = 2;
+            event.toZone = 3;
+            event.distance = 303;
+            event.type = ZONE_EVENT_TRANSITION;
+            log.append(event);
+        }
+    }
+}
+
+static void benchFlashLog(int samples)
+{
+    printf("\n== Registro store-and-forward (%d amostras, segmentos de 16 KB) ==\n", samples);
+    const char *dir = "/tmp/lidar-flashlog";
+
+    // Escrita sustentada e esvaziamento completo
+    {
+        FileLogStorage storage(dir);
+        storage.clear();
+        FlashLog log;
+        log.begin(storage, 16384, 48, 0x1234abcd);
+
+        uint64_t start = hostNanos();
+        appendTrace(log, 1, samples);
+        log.flush();
+        uint64_t writeNanos = hostNanos() - start;
+        const FlashLogStats &stats = log.stats();
+        double seconds = samples / 1300.0; // Duração da queda a 1300 amostras/s
+
+        FlashLogDrain drained = drainFlashLog(log);
+        printf("escrita: %.0f amostras/s no host, %.2f bytes/amostra, %u páginas\n",
+               samples * 1e9 / writeNanos, (double)stats.bytesWritten / samples, stats.pageWrites);
+        printf("  a 1300 amostras/s: %.1f KB/s, %.1f escritas de página/s, 384 KB = %.0f s de queda\n",
+               stats.bytesWritten / seconds / 1024, stats.pageWrites / seconds,
+               384.0 * 1024 / (stats.bytesWritten / seconds));
+        printf("esvaziamento: %.0f registros/s, %.0f amostras/s; %u..%u, %u eventos, %u lacunas, %u segmentos descartados\n",
+               drained.records * 1e9 / drained.nanos, drained.samples * 1e9 / drained.nanos,
+               drained.firstSequence, drained.lastSequence, drained.events, drained.gaps,
+               stats.segmentsDropped);
+        // Até 48 segmentos (~90 mil amostras) nada é descartado
+        check(drained.lastSequence == (uint32_t)samples && drained.gaps == 0 &&
+                  drained.samples == drained.lastSequence - drained.firstSequence + 1,
+              "registro: esvaziamento em ordem até a última amostra, sem lacunas");
+        check(stats.segmentsDropped > 0 || (drained.firstSequence == 1 && drained.events == (uint32_t)samples / 500),
+              "registro: sem descartes, todas as amostras e eventos são devolvidos");
+    }
+
+    // Limite de espaço: 4 segmentos, escrevendo bem mais que a capacidade; o
+    // que sobra deve ser o trecho mais recente, em ordem
+    {
+        FileLogStorage storage(dir);
+        storage.clear();
+        FlashLog log;
+        log.begin(storage, 16384, 4, 0x1234abcd);
+        appendTrace(log, 1, samples);
+        log.flush();
+        uint32_t segments = log.segments();
+        FlashLogDrain drained = drainFlashLog(log);
+        printf("limite de 4 segmentos: %u segmentos, %u descartados, restaram %u..%u (%u lacunas)\n",
+               segments, log.stats().segmentsDropped, drained.firstSequence, drained.lastSequence, drained.gaps);
+        check(segments <= 4, "registro: limite de 4 segmentos respeitado");
+        check(drained.lastSequence == (uint32_t)samples && drained.gaps == 0 &&
+                  drained.samples == drained.lastSequence - drained.firstSequence + 1,
+              "registro: com o limite restam as amostras mais recentes, em ordem");
+    }
+
+    // Reinício no meio do esvaziamento: a nova instância retoma do segmento mais antigo
+    {
+        FileLogStorage storage(dir);
+        storage.clear();
+        uint32_t retained;
+        {
+            FlashLog log;
+            log.begin(storage, 16384, 48, 0x1234abcd);
+            appendTrace(log, 1, 20000);
+            log.flush();
+            std::vector<uint8_t> payload(FLASH_LOG_MAX_PAYLOAD);
+            uint8_t type;
+            for (int i = 0; i < 100 && log.peek(type, payload.data(), payload.size()) > 0; i++)
+            {
+                log.pop();
+            }
+            retained = log.segments();
+        }
+        FlashLog resumed;
+        resumed.begin(storage, 16384, 48, 0x1234abcd);
+        appendTrace(resumed, 20001, 1000);
+        resumed.flush();
+        FlashLogDrain drained = drainFlashLog(resumed);
+        printf("reinício: %u segmentos retomados, leitura de %u..%u (%u lacunas)\n",
+               retained, drained.firstSequence, drained.lastSequence, drained.gaps);
+        check(retained > 0 && drained.firstSequence > 1 && drained.firstSequence <= 20000 &&
+                  drained.lastSequence == 21000 && drained.gaps == 0 &&
+                  drained.samples == drained.lastSequence - drained.firstSequence + 1,
+              "registro: reinício retoma do segmento mais antigo até a última amostra, sem lacunas");
+    }
+
+    // Escrita interrompida no meio de uma página: só essa página se perde
+    {
+        FileLogStorage storage(dir);
+        storage.clear();
+        storage.failAfterBytes = 40000;
+        FlashLog log;
+        log.begin(storage, 16384, 48, 0x1234abcd);
+        appendTrace(log, 1, 20000);
+        log.flush();
+        FlashLogDrain drained = drainFlashLog(log);
+        printf("escrita interrompida: %u erros, %u de 20000 amostras lidas, %u lacunas\n",
+               log.stats().writeErrors, drained.samples, drained.gaps);
+        check(log.stats().writeErrors >= 1 && drained.gaps <= 1 && drained.samples < 20000 &&
+                  20000 - drained.samples <= FLASH_LOG_PAGE_SIZE / 4,
+              "registro: escrita interrompida perde no máximo uma página");
+        storage.clear();
+    }
+}
+
+/*------------------------------------------------------------------------------
+  Configuração em RAM: custo da verificação de versão feita a cada iteração da
+  tarefa do LiDAR e da cópia feita quando a versão muda, e consistência das
+  cópias com um escritor publicando sem parar
+------------------------------------------------------------------------------*/
+static bool uniformConfig(const Config &config, int32_t &value)
+{
+    value = config.fatorDivisao;
+    for (size_t i = 0; i < configFieldCount; i++)
+    {
+        if (configFields[i].type == CONFIG_INT && configInt(config, configFields[i]) != value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void benchConfigStore(int iterations)
+{
+    printf("\n== Configuração em RAM (%d iterações) ==\n", iterations);
+
+    ConfigStore store;
+    Config config;
+    configDefaults(config);
+    store.publish(config);
+
+    volatile uint32_t sink = 0;
+    uint64_t start = hostNanos();
+    for (int i = 0; i < iterations; i++)
+    {
+        sink = sink + store.version();
+    }
+    double versionNs = (double)(hostNanos() - start) / iterations;
+
+    start = hostNanos();
+    for (int i = 0; i < iterations; i++)
+    {
+        store.snapshot(config);
+        sink = sink + config.fatorDivisao;
+    }
+    double snapshotNs = (double)(hostNanos() - start) / iterations;
+    printf("version(): %.1f ns, snapshot(): %.1f ns (%u bytes)\n", versionNs, snapshotNs, (unsigned)sizeof(Config));
+
+    // Gravação apenas das diferenças: chaves gravadas por um /salvar típico
+    Config edited = config;
+    edited.fimZona[0] += 5;
+    edited.inicioZona[1] += 5;
+    start = hostNanos();
+    uint64_t mask = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        mask |= configDiff(config, edited);
+    }
+    double diffNs = (double)(hostNanos() - start) / iterations;
+    int changed = 0;
+    for (size_t i = 0; i < configFieldCount; i++)
+    {
+        changed += (mask >> i) & 1;
+    }
+    printf("configDiff(): %.1f ns; edição de uma divisa entre zonas: %d de %u chaves gravadas\n",
+           diffNs, changed, (unsigned)configFieldCount);
+    static const char *const divisa[] = {"fimZona1", "inicioZona2", "chaveInexistente"};
+    check(configMask(divisa, 3) == mask, "configuração: configMask() marca os mesmos bits que configDiff()");
+    check(changed == 2, "configuração: a edição de uma divisa grava apenas as 2 chaves alteradas");
+
+    // Escritor publica configurações em que todos os campos inteiros têm o mesmo
+    // valor; uma cópia com valores misturados seria uma leitura rasgada
+    std::atomic<bool> running(true);
+    std::atomic<uint32_t> published(0);
+    std::thread writer([&]() {
+        Config next;
+        configDefaults(next);
+        for (int32_t k = 1; running.load(std::memory_order_relaxed); k++)
+        {
+            for (size_t i = 0; i < configFieldCount; i++)
+            {
+                if (configFields[i].type == CONFIG_INT)
+                {
+                    configInt(next, configFields[i]) = k;
+                }
+            }
+            store.publish(next);
+            published.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    while (published.load() == 0)
+    {
+        std::this_thread::yield(); // A configuração padrão não é uniforme
+    }
+
+    uint32_t copies = 0, failures = 0, torn = 0, regressions = 0;
+    int32_t last = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        int32_t value;
+        if (!store.snapshot(config))
+        {
+            failures++;
+            continue;
+        }
+        copies++;
+        if (!uniformConfig(config, value))
+        {
+            torn++;
+        }
+        else if (value < last)
+        {
+            regressions++;
+        }
+        last = value;
+    }
+    running = false;
+    writer.join();
+    printf("escritor contínuo: %u publicações, %u cópias, %u desistências, %u rasgadas, %u regressões\n",
+           published.load(), copies, failures, torn, regressions);
+    check(copies > 0 && torn == 0 && regressions == 0,
+          "configuração: cópias concorrentes consistentes e sem regressão de versão");
+}
+
+/*------------------------------------------------------------------------------
+  Registro diferido: custo de cada chamada (gravada, suprimida e descartada),
+  escritores concorrentes com um leitor, transbordamento do buffer e limite
+  de repetição no relógio virtual
+------------------------------------------------------------------------------*/
+static void benchDeferredLog(int messages)
+{
+    printf("\n== Registro diferido (%d mensagens, buffer de %d) ==\n", messages, LOG_RING_DEPTH);
+    LogRecord record;
+    char line[LOG_LINE_MAX];
+
+    // Custo por chamada em um escritor; cada mensagem em uma janela própria
+    // para não ser suprimida, com o leitor esvaziando o buffer a cada 64
+    {
+        static DeferredLog log;
+        uint64_t writeNanos = 0;
+        for (int i = 0; i < messages; i++)
+        {
+            uint64_t start = hostNanos();
+            log.write(LOG_I2C_NACK, (uint32_t)i << LOG_RATE_WINDOW_SHIFT, 0x62, i);
+            writeNanos += hostNanos() - start;
+            if ((i & 63) == 63)
+            {
+                while (log.read(record))
+                {
+                }
+            }
+        }
+        uint64_t start = hostNanos();
+        for (int i = 0; i < messages; i++)
+        {
+            log.write(LOG_I2C_NACK, 0xfff00000UL, 0x62, i);
+        }
+        double suppressedNanos = (double)(hostNanos() - start) / messages;
+        while (log.read(record))
+        {
+        }
+        for (int i = 0; i < LOG_RING_DEPTH; i++)
+        {
+            log.write(LOG_DISTANCE, (uint32_t)i << LOG_RATE_WINDOW_SHIFT, i, 0);
+        }
+        start = hostNanos();
+        for (int i = 0; i < messages; i++)
+        {
+            log.write(LOG_DISTANCE, (uint32_t)(LOG_RING_DEPTH + i) << LOG_RATE_WINDOW_SHIFT, i, 0);
+        }
+        double droppedNanos = (double)(hostNanos() - start) / messages;
+        uint64_t formatNanos = 0;
+        int formatted = 0;
+        while (log.read(record))
+        {
+            start = hostNanos();
+            DeferredLog::format(record, false, line, sizeof(line));
+            formatNanos += hostNanos() - start;
+            formatted++;
+        }
+        printf("chamada (ns no host): gravada %.1f, suprimida %.1f, descartada %.1f; formatação %.1f\n",
+               (double)writeNanos / messages, suppressedNanos, droppedNanos, (double)formatNanos / formatted);
+
+        record.timestampMicros = 12345678;
+        record.code = LOG_I2C_NACK;
+        record.repeats = 3;
+        record.args[0] = 0x62;
+        record.args[1] = 0x8f;
+        size_t length = DeferredLog::format(record, false, line, sizeof(line));
+        printf("linha: %s", line);
+        check(strcmp(line, "[   12.345678] E i2c: nack do 0x62 no registro 0x8f (+3 suprimidas)\n") == 0 &&
+                  length == strlen(line),
+              "registro diferido: formatação da linha");
+        printf("serial síncrona a 115200 baud: %.2f ms por linha de %u caracteres\n", length * 10 / 115.2, (unsigned)length);
+    }
+
+    // Escritores concorrentes e um leitor: cada mensagem leva o escritor, sua
+    // ordem e uma soma de verificação; o leitor confere ordem e integridade
+    const int writerCounts[] = {1, 4};
+    printf("%-10s %10s %10s %10s %10s %10s %10s\n", "escritores", "gravadas", "lidas", "descart.", "p50 ns", "p99 ns",
+           "erros");
+    static DeferredLog concurrentLogs[2];
+    for (int run = 0; run < 2; run++)
+    {
+        int writers = writerCounts[run];
+        DeferredLog &log = concurrentLogs[run];
+        std::atomic<int> active(writers);
+        std::vector<std::vector<uint32_t>> latencies(writers);
+        std::vector<std::thread> threads;
+        int perWriter = messages / writers;
+        for (int w = 0; w < writers; w++)
+        {
+            threads.emplace_back([&, w]() {
+                latencies[w].reserve(perWriter);
+                for (int i = 0; i < perWriter; i++)
+                {
+                    // Instantes distintos entre todos os escritores: nenhuma supressão
+                    uint32_t timestamp = (uint32_t)(i * writers + w) << LOG_RATE_WINDOW_SHIFT;
+                    uint64_t start = hostNanos();
+                    log.write(LOG_CONFIG_BODY, timestamp, w, i, w ^ i ^ 0x5a5a);
+                    latencies[w].push_back((uint32_t)(hostNanos() - start));
+                    if ((i & 15) == 15)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                active--;
+            });
+        }
+
+        uint32_t received = 0, errors = 0;
+        std::vector<int32_t> last(writers, -1);
+        for (;;)
+        {
+            bool done = active.load() == 0;
+            while (log.read(record))
+            {
+                received++;
+                int32_t w = record.args[0];
+                if (w < 0 || w >= writers || record.args[2] != (w ^ record.args[1] ^ 0x5a5a) ||
+                    record.args[1] <= last[w])
+                {
+                    errors++;
+                    continue;
+                }
+                last[w] = record.args[1];
+            }
+            if (done)
+            {
+                break;
+            }
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        std::vector<uint32_t> all;
+        for (auto &l : latencies)
+        {
+            all.insert(all.end(), l.begin(), l.end());
+        }
+        std::sort(all.begin(), all.end());
+        errors += (log.written() != received) + (log.written() + log.dropped() != (uint32_t)(perWriter * writers));
+        printf("%-10d %10u %10u %10u %10u %10u %10u\n", writers, log.written(), received, log.dropped(),
+               all[all.size() / 2], all[all.size() * 99 / 100], errors);
+        check(errors == 0, "registro diferido: escritores concorrentes sem perda, desordem ou mensagem corrompida");
+    }
+
+    // Transbordamento: sem leitor, o buffer guarda as primeiras e conta o resto
+    {
+        static DeferredLog log;
+        for (int i = 0; i < 1000; i++)
+        {
+            log.write(LOG_DISTANCE, (uint32_t)i << LOG_RATE_WINDOW_SHIFT, i, 0);
+        }
+        uint32_t received = 0;
+        int32_t first = -1, lastArg = -1;
+        while (log.read(record))
+        {
+            first = received++ == 0 ? record.args[0] : first;
+            lastArg = record.args[0];
+        }
+        printf("sem leitor: 1000 mensagens, %u gravadas (%d..%d), %u descartadas\n", received, first, lastArg,
+               log.dropped());
+        check(received == LOG_RING_DEPTH && first == 0 && lastArg == LOG_RING_DEPTH - 1 &&
+                  log.dropped() == 1000 - LOG_RING_DEPTH,
+              "registro diferido: buffer cheio guarda as primeiras e conta as descartadas");
+    }
+
+    // Limite de repetição: um código a 200 mensagens/s por 5 s de relógio
+    // virtual; as suprimidas vão nas mensagens seguintes e no resumo final
+    {
+        static DeferredLog log;
+        const int total = 1000;
+        uint32_t repeats = 0, received = 0, summaries = 0;
+        for (int i = 0; i < total; i++)
+        {
+            log.write(LOG_I2C_READ_TIMEOUT, (uint32_t)i * 5000, 0x62, 20000, 0x01);
+            while (log.read(record))
+            {
+                received++;
+                repeats += record.repeats;
+            }
+        }
+        while (log.readSuppressed(total * 5000 + (1UL << LOG_RATE_WINDOW_SHIFT), record))
+        {
+            summaries++;
+            repeats += record.repeats;
+            DeferredLog::format(record, true, line, sizeof(line));
+        }
+        uint32_t windows = ((total - 1) * 5000 >> LOG_RATE_WINDOW_SHIFT) + 1;
+        printf("limite de repetição: %d mensagens em %u janelas, %u gravadas (esperadas %u), %u suprimidas, "
+               "%u relatadas (%u em resumo)\n",
+               total, windows, received, windows * LOG_RATE_BURST, log.suppressed(), repeats, summaries);
+        printf("resumo: %s", line);
+        check(received == windows * LOG_RATE_BURST && log.suppressed() == total - received &&
+                  repeats == log.suppressed() && summaries == 1,
+              "registro diferido: limite de repetição e relato de todas as suprimidas");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 2 && strcmp(argv[1], "replay") == 0)
+    {
+        return replayFiles(argc - 2, argv + 2);
+    }
+
+    int readings = argc > 1 ? atoi(argv[1]) : 5000;
+    if (readings <= 0)
+    {
+        readings = 5000;
+    }
+
+    benchConfigureModes(readings);
+    benchPipeline(readings);
+    benchBiasPolicy(readings);
+    benchFreeRunning(readings);
+    benchMultiSensor(readings);
+    benchSampling(readings);
+    benchQualityGating(readings * 4);
+    benchCorrelation(readings);
+    benchMetrics(readings * 4);
+    benchTrace(readings * 4);
+    benchAdaptiveRate();
+    benchMotion();
+    benchPublication(readings * 4);
+    benchSampleRing(readings * 20);
+    benchSampleCodec(readings * 4);
+    benchFilters(readings * 40);
+    benchZones(readings * 18);
+    benchAnalogOutput(readings * 4);
+    benchFlashLog(readings * 20);
+    benchConfigStore(readings * 20);
+    benchDeferredLog(readings * 20);
+
+    if (benchFailures > 0)
+    {
+        printf("\n%d verificações falharam\n", benchFailures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+# compress_assets.py
+#
+# Etapa de build (extra_scripts = pre:tools/compress_assets.py) que prepara os
+# arquivos de data/ para o servidor web:
+#
+# - comprime com gzip cada arquivo de texto (o woff2 e as imagens já são
+#   comprimidos e são copiados como estão);
+# - calcula um ETag forte (SHA-256 do conteúdo enviado) para cada arquivo;
+# - embute na firmware, como arrays PROGMEM, os arquivos cujo conteúdo enviado
+#   não passa de custom_assets_embed_max bytes, que deixam de ir para o SPIFFS;
+# - grava os demais em $BUILD_DIR/data, com o índice /assets.idx, e aponta a
+#   imagem do sistema de arquivos (buildfs/uploadfs) para esse diretório.
+#
+# O índice tem uma linha por arquivo: "<caminho> <tipo MIME> <gzip 0|1> <ETag>".
+# Os arquivos embutidos são descritos em $BUILD_DIR/generated/EmbeddedAssets.h.
+
+Import("env")
+
+import gzip
+import hashlib
+import os
+import shutil
+
+TIPOS = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".woff2": "font/woff2",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".ico": "image/x-icon",
+}
+JA_COMPRIMIDOS = {".woff2", ".png", ".jpg", ".ico"}
+
+origem = env.subst("$PROJECT_DATA_DIR")
+destino = os.path.join(env.subst("$BUILD_DIR"), "data")
+gerados = os.path.join(env.subst("$BUILD_DIR"), "generated")
+limite = int(env.GetProjectOption("custom_assets_embed_max", "1536"))
+
+
+def identificador(caminho):
+    return "asset_" + "".join(c if c.isalnum() else "_" for c in caminho.strip("/"))
+
+
+def preparar():
+    shutil.rmtree(destino, ignore_errors=True)
+    os.makedirs(destino)
+    os.makedirs(gerados, exist_ok=True)
+
+    indice = []
+    embutidos = []
+    for nome in sorted(os.listdir(origem)):
+        arquivo = os.path.join(origem, nome)
+        if not os.path.isfile(arquivo):
+            continue
+        extensao = os.path.splitext(nome)[1].lower()
+        with open(arquivo, "rb") as f:
+            conteudo = f.read()
+
+        comprimir = extensao not in JA_COMPRIMIDOS
+        if comprimir:
+            # mtime = 0: a mesma entrada gera sempre os mesmos bytes (e o mesmo ETag)
+            conteudo = gzip.compress(conteudo, compresslevel=9, mtime=0)
+        etag = '"%s"' % hashlib.sha256(conteudo).hexdigest()[:16]
+        caminho = "/" + nome
+        tipo = TIPOS.get(extensao, "application/octet-stream")
+
+        if len(conteudo) <= limite:
+            embutidos.append((caminho, tipo, comprimir, etag, conteudo))
+        else:
+            with open(os.path.join(destino, nome + (".gz" if comprimir else "")), "wb") as f:
+                f.write(conteudo)
+            indice.append("%s %s %d %s" % (caminho, tipo, 1 if comprimir else 0, etag))
+
+    with open(os.path.join(destino, "assets.idx"), "w", newline="\n") as f:
+        f.write("\n".join(indice) + "\n")
+
+    linhas = [
+        "// Gerado por tools/compress_assets.py a partir de data/; não editar",
+        "#include <pgmspace.h>",
+        "",
+    ]
+    for caminho, tipo, comprimir, etag, conteudo in embutidos:
+        bytes_ = ",".join(str(b) for b in conteudo)
+        linhas.append("static const uint8_t %s[] PROGMEM = {%s};" % (identificador(caminho), bytes_))
+    linhas.append("")
+    linhas.append("static const EmbeddedAsset embeddedAssets[] = {")
+    for caminho, tipo, comprimir, etag, conteudo in embutidos:
+        linhas.append('    {"%s", "%s", %s, "%s", %s, %d},' % (
+            caminho, tipo, "true" if comprimir else "false", etag.replace('"', '\\"'),
+            identificador(caminho), len(conteudo)))
+    linhas.append("    {NULL, NULL, false, NULL, NULL, 0}};")
+    with open(os.path.join(gerados, "EmbeddedAssets.h"), "w", newline="\n") as f:
+        f.write("\n".join(linhas) + "\n")
+
+    print("Assets: %d embutidos (%d bytes), %d no SPIFFS" % (
+        len(embutidos), sum(len(e[4]) for e in embutidos), len(indice)))
+
+
+preparar()
+env.Append(CPPPATH=[gerados])
+env.Replace(PROJECT_DATA_DIR=destino)